@@ -1,18 +1,24 @@
+import copy
 import uuid
 import warnings
-from typing import TYPE_CHECKING, Optional
+from typing import TYPE_CHECKING, Coroutine, Dict, Optional, Union
 
 from fastapi import HTTPException
-from sqlmodel import Session
+from sqlmodel.ext.asyncio.session import AsyncSession
 
 from langflow.graph.graph.base import Graph
+from langflow.graph.graph.plan import FlowPlan, build_flow_plan_key
 from langflow.services.chat.service import ChatService
 from langflow.services.database.models.flow import Flow
+from langflow.services.deps import async_session_scope, get_cache_service, get_settings_service
+from langflow.services.session.utils import compute_dict_hash
 from langflow.services.store.schema import StoreComponentCreate
 from langflow.services.store.utils import get_lf_version_from_pypi
 
 if TYPE_CHECKING:
     from langflow.graph.vertex.base import Vertex
+    from langflow.schema.graph import Tweaks
+    from langflow.services.cache.lookups import FlowRef
     from langflow.services.database.models.flow.model import Flow
 
 
@@ -123,9 +129,96 @@ def format_elapsed_time(elapsed_time: float) -> str:
         return f"{minutes} {minutes_unit}, {seconds} {seconds_unit}"
 
 
-async def build_graph_from_db(flow_id: str, session: Session, chat_service: "ChatService"):
+def get_run_cache_key(flow_id: str, run_id: Optional[str] = None) -> str:
+    """
+    Get the key the graph of a playground run is cached under.
+
+    Each run gets its own entry (and its own lock) so concurrent runs of the same flow
+    do not share their state. Requests without a run ID use the flow ID, as before.
+    """
+    if not run_id:
+        return flow_id
+    return f"{flow_id}:{run_id}"
+
+
+def get_last_run_cache_key(flow_id: str) -> str:
+    """Get the key the ID of the last playground run of a flow is cached under."""
+    return f"{flow_id}:last_run"
+
+
+async def get_last_run_id(flow_id: str, chat_service: "ChatService") -> Optional[str]:
+    cached = await chat_service.get_cache(get_last_run_cache_key(flow_id))
+    if isinstance(cached, dict) and isinstance(cached.get("result"), str):
+        return cached["result"]
+    return None
+
+
+async def resolve_run_cache_key(flow_id: str, run_id: Optional[str], chat_service: "ChatService") -> str:
+    """Get the key of the run a request builds. Requests without a run ID continue the last run of the flow."""
+    if not run_id:
+        run_id = await get_last_run_id(flow_id, chat_service)
+    return get_run_cache_key(flow_id, run_id)
+
+
+async def get_last_built_graph(flow_id: str, chat_service: "ChatService") -> Optional[Graph]:
+    """Get the graph of the last playground run of a flow, in the state it reached, if it is still cached."""
+    if not (run_id := await get_last_run_id(flow_id, chat_service)):
+        return None
+    cached = await chat_service.get_cache(get_run_cache_key(flow_id, run_id))
+    if isinstance(cached, dict) and isinstance(cached.get("result"), Graph):
+        return cached["result"]
+    return None
+
+
+async def end_run_if_done(flow_id: str, graph: Graph, chat_service: "ChatService") -> bool:
+    """
+    Drops the cached graph of a playground run once none of its vertices is left to run.
+
+    The last run of a flow is kept when incremental builds are on, the next run reuses its results.
+    Returns True if the entry was dropped.
+    """
+    run_id = graph.run_context.run_id
+    if graph.vertices_to_run or not run_id:
+        return False
+    if get_settings_service().settings.incremental_builds and await get_last_run_id(flow_id, chat_service) == run_id:
+        return False
+    await chat_service.clear_cache(get_run_cache_key(flow_id, run_id))
+    return True
+
+
+def get_variables_hashes(
+    graph: Graph, user_id: Optional[Union[str, uuid.UUID]], fallback_to_env_vars: bool = False
+) -> Dict[str, str]:
+    """
+    Resolves the global variables of the vertices of a graph as their build would, and returns the
+    `hash_load_from_db_fields` of each vertex that has some, to tell which ones changed since the last build.
+    """
+    from langflow.interface.initialize.loading import hash_load_from_db_fields, resolve_load_from_db_fields
+    from langflow.services.deps import get_variable_service, session_scope
+
+    variable_service = get_variable_service()
+    hashes: Dict[str, str] = {}
+    with session_scope() as session:
+
+        def get_variable(name: str, field: str):
+            if not user_id:
+                raise ValueError("User id is not set")
+            return variable_service.get_variable(user_id=user_id, name=name, field=field, session=session)
+
+        for vertex in graph.vertices:
+            if not vertex.load_from_db_fields:
+                continue
+            params = resolve_load_from_db_fields(
+                get_variable, dict(vertex.params), vertex.load_from_db_fields, fallback_to_env_vars
+            )
+            if (variables_hash := hash_load_from_db_fields(params, vertex.load_from_db_fields)) is not None:
+                hashes[vertex.id] = variables_hash
+    return hashes
+
+
+async def build_graph_from_db(flow_id: str, session: AsyncSession, chat_service: "ChatService", cache: bool = True):
     """Build and cache the graph."""
-    flow: Optional[Flow] = session.get(Flow, flow_id)
+    flow: Optional[Flow] = await session.get(Flow, uuid.UUID(flow_id))
     if not flow or not flow.data:
         raise ValueError("Invalid flow ID")
     graph = Graph.from_payload(flow.data, flow_id, flow_name=flow.name, user_id=str(flow.user_id))
@@ -140,7 +233,8 @@ async def build_graph_from_db(flow_id: str, session: Session, chat_service: "Cha
     graph.set_run_id(run_id)
     graph.set_run_name()
     await graph.initialize_run()
-    await chat_service.set_cache(flow_id, graph)
+    if cache:
+        await chat_service.set_cache(flow_id, graph)
     return graph
 
 
@@ -148,13 +242,71 @@ async def build_and_cache_graph_from_data(
     flow_id: str,
     chat_service: "ChatService",
     graph_data: dict,
+    cache: bool = True,
 ):  # -> Graph | Any:
-    """Build and cache the graph."""
+    """Build and cache the graph. Playground runs pass `cache=False` and cache it under their run."""
     graph = Graph.from_payload(graph_data, flow_id)
-    await chat_service.set_cache(flow_id, graph)
+    if cache:
+        await chat_service.set_cache(flow_id, graph)
+    return graph
+
+
+async def build_graph_from_flow_plan(
+    flow: Union["Flow", "FlowRef"],
+    tweaks: Optional[Union["Tweaks", dict]] = None,
+    stream: bool = False,
+    user_id: Optional[str] = None,
+) -> Graph:
+    """
+    Build a graph for a run from the compiled plan of the flow.
+
+    The plan is cached in the cache service keyed by the flow ID, its `updated_at` and the tweaks,
+    so only the first run of each flow version pays for ungrouping, handle validation and sorting.
+    When `flow` is a `FlowRef`, the data of the flow is only read from the database if the plan
+    is not cached.
+    """
+    from langflow.processing.process import process_tweaks
+
+    flow_id_str = str(flow.id)
+    flow_data = flow.data if isinstance(flow, Flow) else None
+    if isinstance(flow, Flow) and flow_data is None:
+        raise ValueError(f"Flow {flow_id_str} has no data")
+    if tweaks is None:
+        tweaks_dict: dict = {}
+    else:
+        tweaks_dict = tweaks if isinstance(tweaks, dict) else tweaks.model_dump()
+    if flow.updated_at is None and flow_data is None:
+        flow_data = await get_flow_data(flow.id)
+    version = flow.updated_at.isoformat() if flow.updated_at else compute_dict_hash(flow_data)
+    key = build_flow_plan_key(flow_id_str, version, {"tweaks": tweaks_dict, "stream": stream})
+
+    cache_service = get_cache_service()
+    plan = cache_service.get(key)
+    if isinstance(plan, Coroutine):
+        plan = await plan
+    if isinstance(plan, FlowPlan):
+        return Graph.from_plan(plan, flow_id=flow_id_str, flow_name=flow.name, user_id=user_id)
+
+    if flow_data is None:
+        flow_data = await get_flow_data(flow.id)
+    graph_data = process_tweaks(copy.deepcopy(flow_data), tweaks_dict, stream=stream)
+    graph = Graph.from_payload(graph_data, flow_id=flow_id_str, flow_name=flow.name, user_id=user_id)
+    result = cache_service.set(key, FlowPlan.from_graph(graph))
+    if isinstance(result, Coroutine):
+        await result
     return graph
 
 
+async def get_flow_data(flow_id: uuid.UUID) -> dict:
+    from sqlmodel import select
+
+    async with async_session_scope() as session:
+        flow_data = (await session.exec(select(Flow.data).where(Flow.id == flow_id))).first()  # type: ignore
+    if flow_data is None:
+        raise ValueError(f"Flow {flow_id} has no data")
+    return flow_data
+
+
 def format_syntax_error_message(exc: SyntaxError) -> str:
     """Format a SyntaxError message for returning to the frontend."""
     if exc.text is None:
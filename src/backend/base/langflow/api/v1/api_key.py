@@ -6,6 +6,7 @@ from sqlmodel import Session
 
 from langflow.api.v1.schemas import ApiKeyCreateRequest, ApiKeysResponse
 from langflow.services.auth import utils as auth_utils
+from langflow.services.cache.lookups import invalidate_api_key
 
 # Assuming you have these methods in your service layer
 from langflow.services.database.models.api_key.crud import create_api_key, delete_api_key, get_api_keys
@@ -54,6 +55,7 @@ def delete_api_key_route(
 ):
     try:
         delete_api_key(db, api_key_id)
+        invalidate_api_key(api_key_id)
         return {"detail": "API Key deleted"}
     except Exception as e:
         raise HTTPException(status_code=400, detail=str(e)) from e
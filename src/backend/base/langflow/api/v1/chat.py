@@ -1,6 +1,8 @@
+import asyncio
 import time
 import traceback
 import uuid
+from contextlib import aclosing
 from functools import partial
 from typing import TYPE_CHECKING, Annotated, Optional
 
@@ -11,10 +13,16 @@ from loguru import logger
 from langflow.api.utils import (
     build_and_cache_graph_from_data,
     build_graph_from_db,
+    end_run_if_done,
     format_elapsed_time,
     format_exception_message,
+    get_last_built_graph,
+    get_last_run_cache_key,
+    get_run_cache_key,
     get_top_level_vertices,
+    get_variables_hashes,
     parse_exception,
+    resolve_run_cache_key,
 )
 from langflow.api.v1.schemas import (
     FlowDataRequest,
@@ -29,8 +37,16 @@ from langflow.graph.graph.base import Graph
 from langflow.schema.schema import OutputLog
 from langflow.services.auth.utils import get_current_active_user
 from langflow.services.chat.service import ChatService
-from langflow.services.deps import get_chat_service, get_session, get_session_service, get_telemetry_service
+from langflow.services.deps import (
+    async_session_scope,
+    get_async_session,
+    get_chat_service,
+    get_session_service,
+    get_settings_service,
+    get_telemetry_service,
+)
 from langflow.services.monitor.utils import log_vertex_build
+from langflow.services.task.admission import AdmissionRejectedException, Priority, get_execution_scheduler
 from langflow.services.telemetry.schema import ComponentPayload, PlaygroundPayload
 from langflow.services.telemetry.service import TelemetryService
 
@@ -65,8 +81,9 @@ async def retrieve_vertices_order(
     stop_component_id: Optional[str] = None,
     start_component_id: Optional[str] = None,
     chat_service: "ChatService" = Depends(get_chat_service),
-    session=Depends(get_session),
+    session=Depends(get_async_session),
     telemetry_service: "TelemetryService" = Depends(get_telemetry_service),
+    current_user=Depends(get_current_active_user),
 ):
     """
     Retrieve the vertices order for a given flow.
@@ -77,7 +94,8 @@ async def retrieve_vertices_order(
         stop_component_id (str, optional): The ID of the stop component. Defaults to None.
         start_component_id (str, optional): The ID of the start component. Defaults to None.
         chat_service (ChatService, optional): The chat service dependency. Defaults to Depends(get_chat_service).
-        session (Session, optional): The session dependency. Defaults to Depends(get_session).
+        session (AsyncSession, optional): The session dependency. Defaults to Depends(get_async_session).
+        current_user (Any, optional): The current user dependency, whose global variables the components use.
 
     Returns:
         VerticesOrderResponse: The response containing the ordered vertex IDs and the run ID.
@@ -89,14 +107,29 @@ async def retrieve_vertices_order(
     components_count = None
     try:
         flow_id_str = str(flow_id)
+        # The last build is read before the new graph replaces it in the cache
+        previous_graph = None
+        if get_settings_service().settings.incremental_builds:
+            previous_graph = await get_last_built_graph(flow_id_str, chat_service)
         # First, we need to check if the flow_id is in the cache
         if not data:
-            graph = await build_graph_from_db(flow_id=flow_id_str, session=session, chat_service=chat_service)
+            graph = await build_graph_from_db(
+                flow_id=flow_id_str, session=session, chat_service=chat_service, cache=False
+            )
         else:
             graph = await build_and_cache_graph_from_data(
-                flow_id=flow_id_str, graph_data=data.model_dump(), chat_service=chat_service
+                flow_id=flow_id_str, graph_data=data.model_dump(), chat_service=chat_service, cache=False
             )
         graph.validate_stream()
+        if previous_graph is not None:
+            # Components that did not change since the last build keep their results.
+            # The components the user asked to run are always rebuilt.
+            # So do the components whose global variables, like API keys, have other values.
+            forced_vertex_ids = [vertex_id for vertex_id in (start_component_id, stop_component_id) if vertex_id]
+            variables_hashes = await asyncio.to_thread(get_variables_hashes, graph, current_user.id)
+            graph.reuse_unchanged_vertices(
+                previous_graph, force_vertex_ids=forced_vertex_ids, variables_hashes=variables_hashes
+            )
         if stop_component_id or start_component_id:
             try:
                 first_layer = graph.sort_vertices(stop_component_id, start_component_id)
@@ -117,7 +150,15 @@ async def retrieve_vertices_order(
         # and return the same structure but only with the ids
         components_count = len(graph.vertices)
         vertices_to_run = list(graph.vertices_to_run) + get_top_level_vertices(graph, graph.vertices_to_run)
-        await chat_service.set_cache(str(flow_id), graph)
+        if not graph.run_context.run_id:
+            graph.set_run_id()
+        # The graph is cached under its run only, so other runs of the same flow do not overwrite its
+        # state. The flow points to its last run, for the clients that do not send the run ID.
+        await chat_service.set_cache(get_run_cache_key(flow_id_str, graph.run_id), graph)
+        await chat_service.set_cache(get_last_run_cache_key(flow_id_str), graph.run_id)
+        if previous_graph is not None and previous_graph.run_context.run_id != graph.run_id:
+            # The previous run was only kept for this build to reuse its results
+            await end_run_if_done(flow_id_str, previous_graph, chat_service)
         background_tasks.add_task(
             telemetry_service.log_package_playground,
             PlaygroundPayload(
@@ -126,7 +167,7 @@ async def retrieve_vertices_order(
                 playgroundSuccess=True,
             ),
         )
-        return VerticesOrderResponse(ids=first_layer, run_id=graph._run_id, vertices_to_run=vertices_to_run)
+        return VerticesOrderResponse(ids=first_layer, run_id=graph.run_id, vertices_to_run=vertices_to_run)
     except Exception as exc:
         background_tasks.add_task(
             telemetry_service.log_package_playground,
@@ -151,6 +192,7 @@ async def build_vertex(
     background_tasks: BackgroundTasks,
     inputs: Annotated[Optional[InputValueRequest], Body(embed=True)] = None,
     files: Optional[list[str]] = None,
+    run_id: Optional[str] = None,
     chat_service: "ChatService" = Depends(get_chat_service),
     current_user=Depends(get_current_active_user),
     telemetry_service: "TelemetryService" = Depends(get_telemetry_service),
@@ -162,6 +204,7 @@ async def build_vertex(
         vertex_id (str): The ID of the vertex to build.
         background_tasks (BackgroundTasks): The background tasks object for logging.
         inputs (Optional[InputValueRequest], optional): The input values for the vertex. Defaults to None.
+        run_id (Optional[str], optional): The ID of the run returned by `retrieve_vertices_order`. Defaults to None.
         chat_service (ChatService, optional): The chat service dependency. Defaults to Depends(get_chat_service).
         current_user (Any, optional): The current user dependency. Defaults to Depends(get_current_active_user).
 
@@ -173,39 +216,43 @@ async def build_vertex(
 
     """
     flow_id_str = str(flow_id)
+    cache_key = await resolve_run_cache_key(flow_id_str, run_id, chat_service)
 
     next_runnable_vertices = []
     top_level_vertices = []
     start_time = time.perf_counter()
     try:
-        cache = await chat_service.get_cache(flow_id_str)
+        cache = await chat_service.get_cache(cache_key)
         if not cache:
             # If there's no cache
-            logger.warning(f"No cache found for {flow_id_str}. Building graph starting at {vertex_id}")
-            graph: "Graph" = await build_graph_from_db(
-                flow_id=flow_id_str, session=next(get_session()), chat_service=chat_service
-            )
+            logger.warning(f"No cache found for {cache_key}. Building graph starting at {vertex_id}")
+            async with async_session_scope() as session:
+                graph: "Graph" = await build_graph_from_db(
+                    flow_id=flow_id_str, session=session, chat_service=chat_service, cache=False
+                )
         else:
             graph = cache.get("result")
             await graph.initialize_run()
         vertex = graph.get_vertex(vertex_id)
 
         try:
-            lock = chat_service._cache_locks[flow_id_str]
-            (
-                result_dict,
-                params,
-                valid,
-                artifacts,
-                vertex,
-            ) = await graph.build_vertex(
-                chat_service=chat_service,
-                vertex_id=vertex_id,
-                user_id=current_user.id,
-                inputs_dict=inputs.model_dump() if inputs else {},
-                files=files,
-            )
-            set_cache_coro = partial(get_chat_service().set_cache, key=flow_id_str)
+            lock = chat_service._cache_locks[cache_key]
+            # Rejected builds are answered with a 429 by the exception handler of the app
+            async with get_execution_scheduler().admit(Priority.INTERACTIVE, current_user.id, flow_id):
+                (
+                    result_dict,
+                    params,
+                    valid,
+                    artifacts,
+                    vertex,
+                ) = await graph.build_vertex(
+                    chat_service=chat_service,
+                    vertex_id=vertex_id,
+                    user_id=current_user.id,
+                    inputs_dict=inputs.model_dump() if inputs else {},
+                    files=files,
+                )
+            set_cache_coro = partial(get_chat_service().set_cache, key=cache_key)
             next_runnable_vertices = await graph.run_manager.get_next_runnable_vertices(
                 lock, set_cache_coro, graph=graph, vertex=vertex, cache=False
             )
@@ -214,6 +261,8 @@ async def build_vertex(
             result_data_response = ResultDataResponse(**result_dict.model_dump())
 
             result_data_response = ResultDataResponse.model_validate(result_dict, from_attributes=True)
+        except AdmissionRejectedException:
+            raise
         except Exception as exc:
             if isinstance(exc, ComponentBuildException):
                 params = exc.message
@@ -231,7 +280,7 @@ async def build_vertex(
             background_tasks.add_task(graph.end_all_traces, error=message["errorMessage"])
             # If there's an error building the vertex
             # we need to clear the cache
-            await chat_service.clear_cache(flow_id_str)
+            await chat_service.clear_cache(cache_key)
 
         result_data_response.message = artifacts
 
@@ -256,7 +305,7 @@ async def build_vertex(
         graph.reset_inactivated_vertices()
         graph.reset_activated_vertices()
 
-        await chat_service.set_cache(flow_id_str, graph)
+        await chat_service.set_cache(cache_key, graph)
 
         # graph.stop_vertex tells us if the user asked
         # to stop the build of the graph at a certain vertex
@@ -267,6 +316,9 @@ async def build_vertex(
 
         if not next_runnable_vertices:
             background_tasks.add_task(graph.end_all_traces)
+            # A vertex that streams is read from the cache by the stream endpoint, which ends the run
+            if not vertex.will_stream:
+                await end_run_if_done(flow_id_str, graph, chat_service)
 
         build_response = VertexBuildResponse(
             inactivated_vertices=inactivated_vertices,
@@ -287,6 +339,8 @@ async def build_vertex(
             ),
         )
         return build_response
+    except AdmissionRejectedException:
+        raise
     except Exception as exc:
         background_tasks.add_task(
             telemetry_service.log_package_component,
@@ -308,13 +362,14 @@ async def build_vertex_stream(
     flow_id: uuid.UUID,
     vertex_id: str,
     session_id: Optional[str] = None,
+    run_id: Optional[str] = None,
     chat_service: "ChatService" = Depends(get_chat_service),
     session_service: "SessionService" = Depends(get_session_service),
 ):
     """Build a vertex instead of the entire graph.
 
     This function is responsible for building a single vertex instead of the entire graph.
-    It takes the `flow_id` and `vertex_id` as required parameters, and an optional `session_id`.
+    It takes the `flow_id` and `vertex_id` as required parameters, and an optional `session_id` and `run_id`.
     It also depends on the `ChatService` and `SessionService` services.
 
     If `session_id` is not provided, it retrieves the graph from the cache using the `chat_service`.
@@ -338,13 +393,15 @@ async def build_vertex_stream(
     """
     try:
         flow_id_str = str(flow_id)
+        cache_key = await resolve_run_cache_key(flow_id_str, run_id, chat_service)
 
         async def stream_vertex():
+            graph: Optional["Graph"] = None
             try:
-                cache = await chat_service.get_cache(flow_id_str)
+                cache = await chat_service.get_cache(cache_key)
                 if not cache:
                     # If there's no cache
-                    raise ValueError(f"No cache found for {flow_id_str}.")
+                    raise ValueError(f"No cache found for {cache_key}.")
                 else:
                     graph = cache.get("result")
 
@@ -370,12 +427,13 @@ async def build_vertex_stream(
                         data={"message": f"Streaming vertex {vertex_id}"},
                     )
                     yield str(stream_data)
-                    async for chunk in vertex.stream():
-                        stream_data = StreamData(
-                            event="message",
-                            data={"chunk": chunk},
-                        )
-                        yield str(stream_data)
+                    async with aclosing(vertex.stream()) as chunks:
+                        async for chunk in chunks:
+                            stream_data = StreamData(
+                                event="message",
+                                data={"chunk": chunk},
+                            )
+                            yield str(stream_data)
                 elif vertex.result is not None:
                     stream_data = StreamData(
                         event="message",
@@ -385,16 +443,25 @@ async def build_vertex_stream(
                 else:
                     raise ValueError(f"No result found for vertex {vertex_id}")
 
+            except (asyncio.CancelledError, GeneratorExit):
+                # The client disconnected, so the rest of its run is cancelled instead of
+                # building vertices and generating tokens nobody reads
+                logger.debug(f"Client of {cache_key} disconnected while streaming {vertex_id}")
+                if graph is not None:
+                    graph.cancellation.cancel("The client disconnected")
+                    await chat_service.set_cache(cache_key, graph)
+                raise
             except Exception as exc:
                 logger.exception(f"Error building Component: {exc}")
                 exc_message = parse_exception(exc)
                 if exc_message == "The message must be an iterator or an async iterator.":
                     exc_message = "This stream has already been closed."
                 yield str(StreamData(event="error", data={"error": exc_message}))
-            finally:
-                logger.debug("Closing stream")
-                await chat_service.set_cache(flow_id_str, graph)
-                yield str(StreamData(event="close", data={"message": "Stream closed"}))
+            logger.debug("Closing stream")
+            if graph is not None:
+                await chat_service.set_cache(cache_key, graph)
+                await end_run_if_done(flow_id_str, graph, chat_service)
+            yield str(StreamData(event="close", data={"message": "Stream closed"}))
 
         return StreamingResponse(stream_vertex(), media_type="text/event-stream")
     except Exception as exc:
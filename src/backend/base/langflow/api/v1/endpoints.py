@@ -1,15 +1,23 @@
+import asyncio
 import time
 from asyncio import Lock
+from collections import defaultdict
 from http import HTTPStatus
-from typing import TYPE_CHECKING, Annotated, List, Optional, Union
+from typing import TYPE_CHECKING, Annotated, AsyncIterator, Awaitable, Callable, Dict, List, Optional, Tuple, Union
 from uuid import UUID
 
+import orjson
 import sqlalchemy as sa
 from fastapi import APIRouter, BackgroundTasks, Body, Depends, HTTPException, Request, UploadFile, status
+from fastapi.responses import StreamingResponse
 from loguru import logger
 from sqlmodel import Session, select
 
+from langflow.api.utils import build_graph_from_flow_plan
 from langflow.api.v1.schemas import (
+    BatchRunRequest,
+    BatchRunResponse,
+    BatchRunResult,
     ConfigResponse,
     CustomComponentRequest,
     CustomComponentResponse,
@@ -24,11 +32,15 @@ from langflow.api.v1.schemas import (
 from langflow.custom.custom_component.component import Component
 from langflow.custom.utils import build_custom_component_template
 from langflow.graph.graph.base import Graph
+from langflow.graph.graph.cancellation import CancellationToken, RunCancelledException
+from langflow.graph.graph.profiling import RunProfile
+from langflow.graph.graph.token_channel import TokenChannel
 from langflow.graph.schema import RunOutputs
-from langflow.helpers.flow import get_flow_by_id_or_endpoint_name
+from langflow.helpers.flow import get_flow_by_id_or_endpoint_name, get_flow_ref_by_id_or_endpoint_name
 from langflow.processing.process import process_tweaks, run_graph_internal
 from langflow.schema.graph import Tweaks
 from langflow.services.auth.utils import api_key_security, get_current_active_user
+from langflow.services.cache.lookups import FlowRef
 from langflow.services.cache.utils import save_uploaded_file
 from langflow.services.database.models.flow import Flow
 from langflow.services.database.models.flow.utils import get_all_webhook_components_in_flow
@@ -42,7 +54,14 @@ from langflow.services.deps import (
     get_telemetry_service,
 )
 from langflow.services.session.service import SessionService
+from langflow.services.task.admission import (
+    Admission,
+    AdmissionRejectedException,
+    Priority,
+    get_execution_scheduler,
+)
 from langflow.services.task.service import TaskService
+from langflow.services.task.webhook_queue import enqueue_webhook_run
 from langflow.services.telemetry.schema import RunPayload
 from langflow.services.telemetry.service import TelemetryService
 from langflow.utils.version import get_version_info
@@ -75,20 +94,31 @@ async def get_all(
 
 
 async def simple_run_flow(
-    flow: Flow,
+    flow: Union[Flow, FlowRef],
     input_request: SimplifiedAPIRequest,
     stream: bool = False,
     api_key_user: Optional[User] = None,
+    shared_graph: Optional[Graph] = None,
+    shared_vertices: Optional[List[str]] = None,
+    cancellation: Optional[CancellationToken] = None,
+    token_channel: Optional[TokenChannel] = None,
 ):
     try:
         task_result: List[RunOutputs] = []
         user_id = api_key_user.id if api_key_user else None
         flow_id_str = str(flow.id)
-        if flow.data is None:
-            raise ValueError(f"Flow {flow_id_str} has no data")
-        graph_data = flow.data.copy()
-        graph_data = process_tweaks(graph_data, input_request.tweaks or {}, stream=stream)
-        graph = Graph.from_payload(graph_data, flow_id=flow_id_str, user_id=str(user_id), flow_name=flow.name)
+        graph = await build_graph_from_flow_plan(
+            flow, tweaks=input_request.tweaks, stream=stream, user_id=str(user_id)
+        )
+        if cancellation is None:
+            cancellation = CancellationToken()
+        cancellation.set_timeout(input_request.timeout or get_settings_service().settings.run_timeout)
+        graph.cancellation = cancellation
+        graph.token_channel = token_channel
+        if input_request.profile:
+            graph.profile = RunProfile()
+        if shared_graph is not None and shared_vertices:
+            graph.share_built_vertices(shared_graph, shared_vertices)
         inputs = [
             InputValueRequest(components=[], input_value=input_request.input_value, type=input_request.input_type)
         ]
@@ -113,7 +143,8 @@ async def simple_run_flow(
             stream=stream,
         )
 
-        return RunResponse(outputs=task_result, session_id=session_id)
+        profile = graph.profile.to_list() if graph.profile is not None else None
+        return RunResponse(outputs=task_result, session_id=session_id, profile=profile)
 
     except sa.exc.StatementError as exc:
         raise ValueError(str(exc)) from exc
@@ -129,12 +160,13 @@ async def simple_run_flow_task(
     Run a flow task as a BackgroundTask, therefore it should not throw exceptions.
     """
     try:
-        result = await simple_run_flow(
-            flow=flow,
-            input_request=input_request,
-            stream=stream,
-            api_key_user=api_key_user,
-        )
+        async with get_execution_scheduler().admit(Priority.BACKGROUND, flow.user_id, flow.id, queue_timeout=0):
+            result = await simple_run_flow(
+                flow=flow,
+                input_request=input_request,
+                stream=stream,
+                api_key_user=api_key_user,
+            )
         return result
 
     except Exception as exc:
@@ -143,8 +175,9 @@ async def simple_run_flow_task(
 
 @router.post("/run/{flow_id_or_name}", response_model=RunResponse, response_model_exclude_none=True)
 async def simplified_run_flow(
+    request: Request,
     background_tasks: BackgroundTasks,
-    flow: Annotated[Flow, Depends(get_flow_by_id_or_endpoint_name)],
+    flow: Annotated[FlowRef, Depends(get_flow_ref_by_id_or_endpoint_name)],
     input_request: SimplifiedAPIRequest = SimplifiedAPIRequest(),
     stream: bool = False,
     api_key_user: User = Depends(api_key_security),
@@ -159,6 +192,8 @@ async def simplified_run_flow(
     - `input_request` (SimplifiedAPIRequest): Request object containing input values, types, output selection, tweaks, and session ID.
     - `api_key_user` (User): User object derived from the provided API key, used for authentication.
     - `session_service` (SessionService): Service for managing flow sessions, essential for session reuse and caching.
+    - `stream` (bool): If true, the run is streamed as server-sent events on this connection: `token` events as the
+      chat outputs generate their messages, then an `end` event with the `RunResponse` (see `stream_run_flow`).
 
     ### SimplifiedAPIRequest:
     - `input_value` (Optional[str], default=""): Input value to pass to the flow.
@@ -199,13 +234,39 @@ async def simplified_run_flow(
     This endpoint provides a powerful interface for executing flows with enhanced flexibility and efficiency, supporting a wide range of applications by allowing for dynamic input and output configuration along with performance optimizations through session management and caching.
     """
     start_time = time.perf_counter()
-    try:
-        result = await simple_run_flow(
-            flow=flow,
-            input_request=input_request,
-            stream=stream,
-            api_key_user=api_key_user,
+    cancellation = CancellationToken()
+    # Rejected requests are answered with a 429 by the exception handler of the app
+    admission = get_execution_scheduler().admit(Priority.API, api_key_user.id, flow.id)
+    if stream:
+
+        async def log_telemetry(error: str = ""):
+            payload = RunPayload(
+                runIsWebhook=False,
+                runSeconds=int(time.perf_counter() - start_time),
+                runSuccess=not error,
+                runErrorMessage=error,
+            )
+            await telemetry_service.log_package_run(payload)
+
+        # The slot is waited for before the response starts, so a rejection is still a 429 and not an error event
+        await admission.__aenter__()
+        # Released when the stream ends, or after the response if the stream never started
+        background_tasks.add_task(admission.release)
+        return StreamingResponse(
+            stream_run_flow(flow, input_request, api_key_user, admission, cancellation, log_telemetry),
+            media_type="text/event-stream",
+            background=background_tasks,
         )
+    disconnect_watcher = asyncio.create_task(cancel_on_disconnect(request, cancellation))
+    try:
+        async with admission:
+            result = await simple_run_flow(
+                flow=flow,
+                input_request=input_request,
+                stream=stream,
+                api_key_user=api_key_user,
+                cancellation=cancellation,
+            )
         end_time = time.perf_counter()
         background_tasks.add_task(
             telemetry_service.log_package_run,
@@ -213,6 +274,19 @@ async def simplified_run_flow(
         )
         return result
 
+    except AdmissionRejectedException:
+        raise
+    except RunCancelledException as exc:
+        end_time = time.perf_counter()
+        logger.info(f"Run of flow {flow.id} was cancelled: {exc.reason}")
+        background_tasks.add_task(
+            telemetry_service.log_package_run,
+            RunPayload(
+                runIsWebhook=False, runSeconds=int(end_time - start_time), runSuccess=False, runErrorMessage=exc.reason
+            ),
+        )
+        # Nobody is waiting for the response, 499 is what proxies log for it
+        raise HTTPException(status_code=499, detail=exc.reason) from exc
     except ValueError as exc:
         end_time = time.perf_counter()
         background_tasks.add_task(
@@ -238,6 +312,219 @@ async def simplified_run_flow(
             ),
         )
         raise HTTPException(status_code=status.HTTP_500_INTERNAL_SERVER_ERROR, detail=str(exc)) from exc
+    finally:
+        disconnect_watcher.cancel()
+
+
+def encode_sse_event(event: bytes, data: bytes) -> bytes:
+    return b"event: " + event + b"\ndata: " + data + b"\n\n"
+
+
+async def stream_run_flow(
+    flow: FlowRef,
+    input_request: SimplifiedAPIRequest,
+    api_key_user: User,
+    admission: Admission,
+    cancellation: CancellationToken,
+    log_telemetry: Optional[Callable[[str], Awaitable[None]]] = None,
+) -> AsyncIterator[bytes]:
+    """
+    Runs a flow and streams it as server-sent events, on the connection of the request.
+
+    The chat outputs send `token` events, `{"vertex_id": ..., "chunk": ...}`, as their messages are generated.
+    The stream ends with an `end` event holding the `RunResponse`, or an `error` event holding its `detail`.
+    The run is cancelled when the client disconnects.
+
+    `admission` is the slot of the run, already granted, and released when the run ends. `log_telemetry`
+    is called with the error of the run, empty if it succeeded, once the stream ends.
+    """
+    channel = TokenChannel(get_settings_service().settings.run_stream_buffer_size)
+    run: Optional[asyncio.Task] = None
+    error = ""
+    try:
+        run = asyncio.create_task(
+            simple_run_flow(
+                flow=flow,
+                input_request=input_request,
+                stream=True,
+                api_key_user=api_key_user,
+                cancellation=cancellation,
+                token_channel=channel,
+            )
+        )
+        run.add_done_callback(lambda _: channel.close())
+        async for vertex_id, chunk in channel:
+            yield encode_sse_event(b"token", orjson.dumps({"vertex_id": vertex_id, "chunk": chunk}))
+        result = await run
+        yield encode_sse_event(b"end", result.model_dump_json(exclude_none=True).encode())
+    except (asyncio.CancelledError, GeneratorExit):
+        error = "The client disconnected"
+        cancellation.cancel(error)
+        raise
+    except Exception as exc:
+        error = exc.reason if isinstance(exc, RunCancelledException) else str(exc)
+        logger.error(f"Error streaming the run of flow {flow.id}: {error}")
+        yield encode_sse_event(b"error", orjson.dumps({"detail": error}))
+    finally:
+        # Wakes the chat outputs waiting for room, nothing reads the channel anymore
+        channel.close()
+        if run is not None and not run.done():
+            run.cancel()
+        admission.release()
+        if log_telemetry is not None:
+            await log_telemetry(error)
+
+
+async def cancel_on_disconnect(request: Request, cancellation: CancellationToken, interval: float = 1.0):
+    """Cancels a run once the client that requested it disconnects."""
+    while not cancellation.cancelled:
+        if await request.is_disconnected():
+            cancellation.cancel("The client disconnected")
+            return
+        await asyncio.sleep(interval)
+
+
+async def run_flow_batch(
+    flow: Union[Flow, FlowRef],
+    batch_request: BatchRunRequest,
+    api_key_user: Optional[User] = None,
+) -> AsyncIterator[BatchRunResult]:
+    """
+    Runs a flow once per input and yields the results as the runs finish.
+
+    With `share_setup`, inputs with the same tweaks share one graph whose input independent vertices
+    are built before the first run, so LLM clients, vector store connections and the like are only set
+    up once. If that setup fails, every input with those tweaks fails with its error.
+    """
+    settings = get_settings_service().settings
+    max_concurrency = settings.batch_run_max_concurrency
+    concurrency = min(batch_request.concurrency or max_concurrency, max_concurrency)
+    semaphore = asyncio.Semaphore(concurrency)
+    user_id = str(api_key_user.id) if api_key_user else None
+    scheduler = get_execution_scheduler()
+
+    # One shared graph per set of tweaks, built by the first run that needs it, or the error that built it
+    shared_graphs: Dict[str, Union[Tuple[Graph, List[str]], Exception]] = {}
+    shared_graph_locks: Dict[str, asyncio.Lock] = defaultdict(asyncio.Lock)
+
+    async def get_shared_graph(input_request: SimplifiedAPIRequest) -> Tuple[Optional[Graph], List[str]]:
+        if not batch_request.share_setup:
+            return None, []
+        tweaks = input_request.tweaks.model_dump() if input_request.tweaks else {}
+        key = orjson.dumps(tweaks, option=orjson.OPT_SORT_KEYS, default=str).decode()
+        async with shared_graph_locks[key]:
+            if key not in shared_graphs:
+                try:
+                    graph = await build_graph_from_flow_plan(flow, tweaks=input_request.tweaks, user_id=user_id)
+                    vertex_ids = graph.get_input_independent_vertices()
+                    await graph.build_shared_vertices(vertex_ids, fallback_to_env_vars=settings.fallback_to_env_var)
+                    shared_graphs[key] = (graph, vertex_ids)
+                except Exception as exc:
+                    # The setup does not depend on the input, the other inputs would fail the same way
+                    shared_graphs[key] = exc
+        shared = shared_graphs[key]
+        if isinstance(shared, Exception):
+            raise shared
+        return shared
+
+    async def run_one(index: int, input_request: SimplifiedAPIRequest) -> BatchRunResult:
+        async with semaphore:
+            try:
+                # The inputs past the caps wait for a slot instead of failing
+                async with scheduler.admit(Priority.BACKGROUND, user_id, flow.id, queue_timeout=0):
+                    shared_graph, shared_vertices = await get_shared_graph(input_request)
+                    result = await simple_run_flow(
+                        flow=flow,
+                        input_request=input_request,
+                        api_key_user=api_key_user,
+                        shared_graph=shared_graph,
+                        shared_vertices=shared_vertices,
+                    )
+                return BatchRunResult(index=index, outputs=result.outputs, session_id=result.session_id)
+            except Exception as exc:
+                logger.error(f"Error running input {index} of the batch run of flow {flow.id}: {exc}")
+                return BatchRunResult(index=index, session_id=input_request.session_id, error=str(exc))
+
+    # Runs are started as slots free up so a large batch does not create all its tasks at once
+    pending: set[asyncio.Task] = set()
+    inputs = iter(enumerate(batch_request.inputs))
+    try:
+        for index, input_request in inputs:
+            pending.add(asyncio.create_task(run_one(index, input_request)))
+            if len(pending) >= concurrency:
+                done, pending = await asyncio.wait(pending, return_when=asyncio.FIRST_COMPLETED)
+                for task in done:
+                    yield task.result()
+        while pending:
+            done, pending = await asyncio.wait(pending, return_when=asyncio.FIRST_COMPLETED)
+            for task in done:
+                yield task.result()
+    finally:
+        for task in pending:
+            task.cancel()
+
+
+@router.post("/run/{flow_id_or_name}/batch", response_model=BatchRunResponse, response_model_exclude_none=True)
+async def simplified_run_flow_batch(
+    background_tasks: BackgroundTasks,
+    flow: Annotated[FlowRef, Depends(get_flow_ref_by_id_or_endpoint_name)],
+    batch_request: BatchRunRequest,
+    stream: bool = False,
+    api_key_user: User = Depends(api_key_security),
+    telemetry_service: "TelemetryService" = Depends(get_telemetry_service),
+):
+    """
+    Executes a flow once for each input of `batch_request.inputs`.
+
+    The flow is looked up and the API key checked once for the whole batch. With `share_setup`, the components
+    that do not depend on the inputs (see `Graph.get_input_independent_vertices`) are built once and reused by
+    every run.
+    A failed run does not stop the batch, its result holds the error instead of the outputs.
+
+    ### Parameters:
+    - `batch_request` (BatchRunRequest): The inputs, each a `SimplifiedAPIRequest` as accepted by `/run/{flow_id}`,
+      the number of runs to execute at once and whether to share the setup between runs.
+    - `stream` (bool): If true, the results are streamed as newline delimited JSON in the order the runs finish.
+      Otherwise they are returned together, in the order of the inputs.
+
+    ### Returns:
+    - A `BatchRunResponse` with one `BatchRunResult` per input, or a stream of `BatchRunResult` objects.
+    """
+    settings = get_settings_service().settings
+    if len(batch_request.inputs) > settings.batch_run_max_inputs:
+        raise HTTPException(
+            status_code=status.HTTP_400_BAD_REQUEST,
+            detail=f"A batch run accepts at most {settings.batch_run_max_inputs} inputs",
+        )
+    start_time = time.perf_counter()
+
+    async def log_telemetry(error: str = ""):
+        payload = RunPayload(
+            runIsWebhook=False,
+            runSeconds=int(time.perf_counter() - start_time),
+            runSuccess=not error,
+            runErrorMessage=error,
+        )
+        await telemetry_service.log_package_run(payload)
+
+    results = run_flow_batch(flow=flow, batch_request=batch_request, api_key_user=api_key_user)
+    if stream:
+
+        async def stream_results():
+            async for result in results:
+                yield result.model_dump_json(exclude_none=True) + "\n"
+            await log_telemetry()
+
+        return StreamingResponse(stream_results(), media_type="application/x-ndjson")
+
+    try:
+        batch_results = sorted([result async for result in results], key=lambda result: result.index)
+    except Exception as exc:
+        logger.exception(exc)
+        background_tasks.add_task(log_telemetry, str(exc))
+        raise HTTPException(status_code=status.HTTP_500_INTERNAL_SERVER_ERROR, detail=str(exc)) from exc
+    background_tasks.add_task(log_telemetry)
+    return BatchRunResponse(results=batch_results)
 
 
 @router.post("/webhook/{flow_id_or_name}", response_model=dict, status_code=HTTPStatus.ACCEPTED)
@@ -258,11 +545,19 @@ async def webhook_run_flow(
         flow (Flow, optional): The flow to be executed. Defaults to Depends(get_flow_by_id).
 
     Returns:
-        dict: A dictionary containing the status of the task.
+        dict: A dictionary containing the status of the task. When `webhook_execution_mode` is 'queue',
+            it also holds the ID of the task, whose status is read with `/task/{task_id}`. Requests with an
+            `Idempotency-Key` header already received return the task of the first one.
 
     Raises:
         HTTPException: If the flow is not found or if there is an error processing the request.
     """
+    queued = get_settings_service().settings.webhook_execution_mode == "queue"
+    if queued and not get_task_service().use_celery:
+        raise HTTPException(status_code=503, detail="The webhook queue requires celery, which is not available")
+    if not queued:
+        # The flow runs after the response is sent, so a full execution queue is reported now
+        get_execution_scheduler().raise_if_full(Priority.BACKGROUND)
     try:
         start_time = time.perf_counter()
         logger.debug("Received webhook request")
@@ -286,19 +581,28 @@ async def webhook_run_flow(
             tweaks=tweaks,
             session_id=None,
         )
-        logger.debug("Starting background task")
-        background_tasks.add_task(  # type: ignore
-            simple_run_flow_task,
-            flow=flow,
-            input_request=input_request,
-        )
+        if queued:
+            task_id, enqueued = enqueue_webhook_run(
+                flow.id, input_request.model_dump(mode="json"), request.headers.get("Idempotency-Key")
+            )
+            response = {"message": "Task queued", "status": "queued", "task_id": task_id}
+            if not enqueued:
+                response = {"message": "Task already received", "status": "duplicate", "task_id": task_id}
+        else:
+            logger.debug("Starting background task")
+            background_tasks.add_task(  # type: ignore
+                simple_run_flow_task,
+                flow=flow,
+                input_request=input_request,
+            )
+            response = {"message": "Task started in the background", "status": "in progress"}
         background_tasks.add_task(
             telemetry_service.log_package_run,
             RunPayload(
                 runIsWebhook=True, runSeconds=int(time.perf_counter() - start_time), runSuccess=True, runErrorMessage=""
             ),
         )
-        return {"message": "Task started in the background", "status": "in progress"}
+        return response
     except Exception as exc:
         background_tasks.add_task(
             telemetry_service.log_package_run,
@@ -492,7 +796,8 @@ async def create_upload_file(
 ):
     try:
         flow_id_str = str(flow_id)
-        file_path = save_uploaded_file(file, folder_name=flow_id_str)
+        # The file is hashed and copied in chunks, off the event loop
+        file_path = await asyncio.to_thread(save_uploaded_file, file, folder_name=flow_id_str)
 
         return UploadFileResponse(
             flowId=flow_id_str,
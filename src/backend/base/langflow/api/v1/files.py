@@ -1,11 +1,11 @@
-import hashlib
 from http import HTTPStatus
 from io import BytesIO
+from typing import Optional
 from uuid import UUID
 from pathlib import Path
 
-from fastapi import APIRouter, Depends, HTTPException, UploadFile
-from fastapi.responses import StreamingResponse
+from fastapi import APIRouter, Depends, HTTPException, Request, UploadFile
+from fastapi.responses import FileResponse, Response, StreamingResponse
 
 
 from langflow.api.v1.schemas import UploadFileResponse
@@ -13,7 +13,13 @@ from langflow.services.auth.utils import get_current_active_user
 from langflow.services.database.models.flow import Flow
 from langflow.services.deps import get_session, get_storage_service
 from langflow.services.storage.service import StorageService
-from langflow.services.storage.utils import build_content_type_from_extension
+from langflow.services.storage.utils import (
+    RangeNotSatisfiableError,
+    build_content_type_from_extension,
+    hash_upload_file,
+    iter_upload_file,
+    parse_range_header,
+)
 
 router = APIRouter(tags=["Files"], prefix="/files")
 
@@ -44,17 +50,59 @@ async def upload_file(
 ):
     try:
         flow_id_str = str(flow_id)
-        file_content = await file.read()
-        file_name = file.filename or hashlib.sha256(file_content).hexdigest()
+        file_name = file.filename or await hash_upload_file(file)
         folder = flow_id_str
-        await storage_service.save_file(flow_id=folder, file_name=file_name, data=file_content)
+        # Written in chunks as it is read, so large uploads are never held in memory
+        await storage_service.save_file_stream(folder, file_name, iter_upload_file(file))
         return UploadFileResponse(flowId=flow_id_str, file_path=f"{folder}/{file_name}")
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
 
 
+async def build_file_response(
+    request: Request,
+    storage_service: StorageService,
+    folder: str,
+    file_name: str,
+    media_type: str,
+    headers: Optional[dict] = None,
+) -> Response:
+    """
+    Serves a stored file without reading it whole.
+
+    Files on the local disk are sent with `FileResponse`, which lets the server use `sendfile`.
+    Other files and `Range` requests are streamed from the storage service in chunks.
+    """
+    headers = dict(headers or {})
+    headers["Accept-Ranges"] = "bytes"
+    range_header = request.headers.get("range")
+    local_path = storage_service.get_local_path(folder, file_name)
+    if local_path is not None and not range_header:
+        return FileResponse(local_path, media_type=media_type, headers=headers)
+
+    size = await storage_service.get_file_size(folder, file_name)
+    try:
+        byte_range = parse_range_header(range_header, size)
+    except RangeNotSatisfiableError:
+        return Response(status_code=416, headers={"Content-Range": f"bytes */{size}"})
+    start, end = byte_range or (0, size)
+    headers["Content-Length"] = str(end - start)
+    status_code = 200
+    if byte_range is not None:
+        headers["Content-Range"] = f"bytes {start}-{end - 1}/{size}"
+        status_code = 206
+    return StreamingResponse(
+        storage_service.iter_file(folder, file_name, start, end),
+        status_code=status_code,
+        media_type=media_type,
+        headers=headers,
+    )
+
+
 @router.get("/download/{flow_id}/{file_name}")
-async def download_file(file_name: str, flow_id: UUID, storage_service: StorageService = Depends(get_storage_service)):
+async def download_file(
+    request: Request, file_name: str, flow_id: UUID, storage_service: StorageService = Depends(get_storage_service)
+):
     try:
         flow_id_str = str(flow_id)
         extension = file_name.split(".")[-1]
@@ -67,19 +115,19 @@ async def download_file(file_name: str, flow_id: UUID, storage_service: StorageS
         if not content_type:
             raise HTTPException(status_code=500, detail=f"Content type not found for extension {extension}")
 
-        file_content = await storage_service.get_file(flow_id=flow_id_str, file_name=file_name)
         headers = {
             "Content-Disposition": f"attachment; filename={file_name} filename*=UTF-8''{file_name}",
             "Content-Type": "application/octet-stream",
-            "Content-Length": str(len(file_content)),
         }
-        return StreamingResponse(BytesIO(file_content), media_type=content_type, headers=headers)
+        return await build_file_response(request, storage_service, flow_id_str, file_name, content_type, headers)
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
 
 
 @router.get("/images/{flow_id}/{file_name}")
-async def download_image(file_name: str, flow_id: UUID, storage_service: StorageService = Depends(get_storage_service)):
+async def download_image(
+    request: Request, file_name: str, flow_id: UUID, storage_service: StorageService = Depends(get_storage_service)
+):
     try:
         extension = file_name.split(".")[-1]
         flow_id_str = str(flow_id)
@@ -94,8 +142,7 @@ async def download_image(file_name: str, flow_id: UUID, storage_service: Storage
         elif not content_type.startswith("image"):
             raise HTTPException(status_code=500, detail=f"Content type {content_type} is not an image")
 
-        file_content = await storage_service.get_file(flow_id=flow_id_str, file_name=file_name)
-        return StreamingResponse(BytesIO(file_content), media_type=content_type)
+        return await build_file_response(request, storage_service, flow_id_str, file_name, content_type)
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
 
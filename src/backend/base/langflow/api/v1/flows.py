@@ -8,17 +8,19 @@ from fastapi import APIRouter, Depends, File, HTTPException, UploadFile
 from fastapi.encoders import jsonable_encoder
 from loguru import logger
 from sqlmodel import Session, col, select
+from sqlmodel.ext.asyncio.session import AsyncSession
 
 from langflow.api.utils import remove_api_keys, validate_is_component
 from langflow.api.v1.schemas import FlowListCreate, FlowListRead
 from langflow.initial_setup.setup import STARTER_FOLDER_NAME
 from langflow.services.auth.utils import get_current_active_user
+from langflow.services.cache.lookups import invalidate_flow
 from langflow.services.database.models.flow import Flow, FlowCreate, FlowRead, FlowUpdate
 from langflow.services.database.models.flow.utils import get_webhook_component_in_flow
 from langflow.services.database.models.folder.constants import DEFAULT_FOLDER_NAME
 from langflow.services.database.models.folder.model import Folder
 from langflow.services.database.models.user.model import User
-from langflow.services.deps import get_session, get_settings_service
+from langflow.services.deps import get_async_session, get_session, get_settings_service
 from langflow.services.settings.service import SettingsService
 
 # build router
@@ -115,10 +117,10 @@ def create_flow(
 
 
 @router.get("/", response_model=list[FlowRead], status_code=200)
-def read_flows(
+async def read_flows(
     *,
     current_user: User = Depends(get_current_active_user),
-    session: Session = Depends(get_session),
+    session: AsyncSession = Depends(get_async_session),
     settings_service: "SettingsService" = Depends(get_settings_service),
     remove_example_flows: bool = False,
 ):
@@ -127,7 +129,7 @@ def read_flows(
 
     Args:
         current_user (User): The current authenticated user.
-        session (Session): The database session.
+        session (AsyncSession): The async database session.
         settings_service (SettingsService): The settings service.
         remove_example_flows (bool, optional): Whether to remove example flows. Defaults to False.
 
@@ -139,22 +141,23 @@ def read_flows(
     try:
         auth_settings = settings_service.auth_settings
         if auth_settings.AUTO_LOGIN:
-            flows = session.exec(
-                select(Flow).where(
-                    (Flow.user_id == None) | (Flow.user_id == current_user.id)  # noqa
-                )
-            ).all()
+            stmt = select(Flow).where(
+                (Flow.user_id == None) | (Flow.user_id == current_user.id)  # noqa
+            )
         else:
-            flows = current_user.flows
+            stmt = select(Flow).where(Flow.user_id == current_user.id)
+        flows = list((await session.exec(stmt)).all())
 
         flows = validate_is_component(flows)  # type: ignore
         flow_ids = [flow.id for flow in flows]
         # with the session get the flows that DO NOT have a user_id
         if not remove_example_flows:
             try:
-                folder = session.exec(select(Folder).where(Folder.name == STARTER_FOLDER_NAME)).first()
+                folder = (await session.exec(select(Folder).where(Folder.name == STARTER_FOLDER_NAME))).first()
 
-                example_flows = folder.flows if folder else []
+                example_flows = (
+                    (await session.exec(select(Flow).where(Flow.folder_id == folder.id))).all() if folder else []
+                )
                 for example_flow in example_flows:
                     if example_flow.id not in flow_ids:
                         flows.append(example_flow)  # type: ignore
@@ -223,6 +226,8 @@ def update_flow(
         session.add(db_flow)
         session.commit()
         session.refresh(db_flow)
+        # The cached lookups hold the previous version and endpoint name of the flow
+        invalidate_flow(flow_id)
         return db_flow
     except Exception as e:
         # If it is a validation error, return the error message
@@ -264,6 +269,7 @@ def delete_flow(
         raise HTTPException(status_code=404, detail="Flow not found")
     session.delete(flow)
     session.commit()
+    invalidate_flow(flow_id)
     return {"message": "Flow deleted successfully"}
 
 
@@ -311,12 +317,12 @@ async def upload_file(
 @router.get("/download/", response_model=FlowListRead, status_code=200)
 async def download_file(
     *,
-    session: Session = Depends(get_session),
+    session: AsyncSession = Depends(get_async_session),
     settings_service: "SettingsService" = Depends(get_settings_service),
     current_user: User = Depends(get_current_active_user),
 ):
     """Download all flows as a file."""
-    flows = read_flows(current_user=current_user, session=session, settings_service=settings_service)
+    flows = await read_flows(current_user=current_user, session=session, settings_service=settings_service)
     return FlowListRead(flows=flows)
 
 
@@ -340,6 +346,8 @@ async def delete_multiple_flows(
         for flow in deleted_flows:
             db.delete(flow)
         db.commit()
+        for flow in deleted_flows:
+            invalidate_flow(flow.id)
         return {"deleted": len(deleted_flows)}
     except Exception as exc:
         logger.exception(exc)
@@ -1,3 +1,4 @@
+import asyncio
 from typing import List, Optional
 from uuid import UUID
 
@@ -8,8 +9,15 @@ from sqlmodel import Session, col, select
 from langflow.services.auth.utils import get_current_active_user
 from langflow.services.database.models.message.model import MessageRead, MessageTable, MessageUpdate
 from langflow.services.database.models.user.model import User
-from langflow.services.deps import get_monitor_service, get_session
-from langflow.services.monitor.schema import MessageModelResponse, TransactionModelResponse, VertexBuildMapModel
+from langflow.services.cache.base import CacheService
+from langflow.services.chat.message_window import invalidate_message_windows
+from langflow.services.deps import get_cache_service, get_monitor_service, get_session
+from langflow.services.monitor.schema import (
+    CacheStatsResponse,
+    MessageModelResponse,
+    TransactionModelResponse,
+    VertexBuildMapModel,
+)
 from langflow.services.monitor.service import MonitorService
 
 router = APIRouter(prefix="/monitor", tags=["Monitor"])
@@ -25,8 +33,9 @@ async def get_vertex_builds(
     monitor_service: MonitorService = Depends(get_monitor_service),
 ):
     try:
-        vertex_build_dicts = monitor_service.get_vertex_builds(
-            flow_id=flow_id, vertex_id=vertex_id, valid=valid, order_by=order_by
+        # The monitor service flushes its pending rows and queries DuckDB synchronously
+        vertex_build_dicts = await asyncio.to_thread(
+            monitor_service.get_vertex_builds, flow_id=flow_id, vertex_id=vertex_id, valid=valid, order_by=order_by
         )
         vertex_build_map = VertexBuildMapModel.from_list_of_dicts(vertex_build_dicts)
         return vertex_build_map
@@ -40,7 +49,7 @@ async def delete_vertex_builds(
     monitor_service: MonitorService = Depends(get_monitor_service),
 ):
     try:
-        monitor_service.delete_vertex_builds(flow_id=flow_id)
+        await asyncio.to_thread(monitor_service.delete_vertex_builds, flow_id=flow_id)
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
 
@@ -80,8 +89,12 @@ async def delete_messages(
     current_user: User = Depends(get_current_active_user),
 ):
     try:
+        session_ids = session.exec(
+            select(MessageTable.session_id).where(col(MessageTable.id).in_(message_ids)).distinct()
+        ).all()
         session.exec(delete(MessageTable).where(MessageTable.id.in_(message_ids)))  # type: ignore
         session.commit()
+        invalidate_message_windows(session_ids)
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
 
@@ -102,6 +115,7 @@ async def update_message(
         session.add(db_message)
         session.commit()
         session.refresh(db_message)
+        invalidate_message_windows([db_message.session_id])
         return db_message
     except HTTPException as e:
         raise e
@@ -121,6 +135,7 @@ async def delete_messages_session(
             .execution_options(synchronize_session="fetch")
         )
         session.commit()
+        invalidate_message_windows([session_id])
         return {"message": "Messages deleted successfully"}
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
@@ -136,8 +151,13 @@ async def get_transactions(
     monitor_service: MonitorService = Depends(get_monitor_service),
 ):
     try:
-        dicts = monitor_service.get_transactions(
-            source=source, target=target, status=status, order_by=order_by, flow_id=flow_id
+        dicts = await asyncio.to_thread(
+            monitor_service.get_transactions,
+            source=source,
+            target=target,
+            status=status,
+            order_by=order_by,
+            flow_id=flow_id,
         )
         result = []
         for d in dicts:
@@ -157,3 +177,15 @@ async def get_transactions(
         return result
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
+
+
+@router.get("/cache", response_model=CacheStatsResponse)
+async def get_cache_stats(
+    cache_service: CacheService = Depends(get_cache_service),
+):
+    if not hasattr(cache_service, "get_stats"):
+        raise HTTPException(status_code=404, detail=f"{type(cache_service).__name__} does not report statistics")
+    try:
+        return CacheStatsResponse(**cache_service.get_stats())
+    except Exception as e:
+        raise HTTPException(status_code=500, detail=str(e))
@@ -55,11 +55,15 @@ class RunResponse(BaseModel):
 
     outputs: Optional[List[RunOutputs]] = []
     session_id: Optional[str] = None
+    profile: Optional[List[dict]] = None
+    """The timings of the builds of the run (see `RunProfile`), if the request asked for them."""
 
     @model_serializer(mode="plain")
     def serialize(self):
         # Serialize all the outputs if they are base models
         serialized = {"session_id": self.session_id, "outputs": []}
+        if self.profile is not None:
+            serialized["profile"] = self.profile
         if self.outputs:
             serialized_outputs = []
             for output in self.outputs:
@@ -312,6 +316,38 @@ class SimplifiedAPIRequest(BaseModel):
     )
     tweaks: Optional[Tweaks] = Field(default=None, description="The tweaks")
     session_id: Optional[str] = Field(default=None, description="The session id")
+    timeout: Optional[float] = Field(
+        default=None,
+        gt=0,
+        description="Seconds after which the run stops and returns the outputs built so far.",
+    )
+    profile: bool = Field(
+        default=False,
+        description="Whether to return the timings of the components, what each waited and took to build.",
+    )
+
+
+class BatchRunRequest(BaseModel):
+    inputs: List[SimplifiedAPIRequest] = Field(description="The inputs to run the flow with, one run each")
+    concurrency: Optional[int] = Field(
+        default=None, ge=1, description="How many runs to execute at once. Capped by the server settings."
+    )
+    share_setup: bool = Field(
+        default=False,
+        description="Whether to build the components that do not depend on the inputs once for all the runs. "
+        "Only turn it on when those components have no side effects and their results can be used by runs at once.",
+    )
+
+
+class BatchRunResult(BaseModel):
+    index: int
+    outputs: Optional[List[RunOutputs]] = None
+    session_id: Optional[str] = None
+    error: Optional[str] = None
+
+
+class BatchRunResponse(BaseModel):
+    results: List[BatchRunResult]
 
 
 # (alias) type ReactFlowJsonObject<NodeData = any, EdgeData = any> = {
@@ -13,6 +13,7 @@ from langflow.services.auth.utils import (
     get_password_hash,
     verify_password,
 )
+from langflow.services.cache.lookups import invalidate_user
 from langflow.services.database.models.folder.utils import create_default_folder_if_it_doesnt_exist
 from langflow.services.database.models.user import User, UserCreate, UserRead, UserUpdate
 from langflow.services.database.models.user.crud import get_user_by_id, update_user
@@ -97,7 +98,10 @@ def patch_user(
         user_update.password = get_password_hash(user_update.password)
 
     if user_db := get_user_by_id(session, user_id):
-        return update_user(user_db, user_update, session)
+        updated_user = update_user(user_db, user_update, session)
+        # Runs authenticated with the cached API keys of the user see the change right away
+        invalidate_user(user_id)
+        return updated_user
     else:
         raise HTTPException(status_code=404, detail="User not found")
 
@@ -147,5 +151,6 @@ def delete_user(
 
     session.delete(user_db)
     session.commit()
+    invalidate_user(user_id)
 
     return {"detail": "User deleted"}
@@ -0,0 +1,163 @@
+"""
+Streaming ingestion, from the loaders through the text splitters to the vector stores.
+
+With `Stream` on, a loader returns a `DataStream` instead of a list and nothing is read when it is
+built: the files are loaded as the stream is consumed, a few at a time. A splitter given a stream
+returns a stream too, which splits each document in the component process pool while the next ones
+load, and a vector store given a stream adds its chunks in batches of `ingestion_batch_size` as they
+arrive, so loading, splitting and embedding overlap. Only the documents in flight are in memory,
+whatever the size of the corpus.
+
+A stream is never iterated to be logged, traced or serialized. Each component that reads it opens it,
+which reads its source again from the start, so a stream can feed more than one component and can be
+read again when a frozen vertex, a shared setup or a restored graph hands the same stream to another
+run. Its source is a picklable callable (a `functools.partial` of a module level function), so the
+vertex that holds it can still be pickled.
+"""
+
+import pickle
+from collections import deque
+from concurrent.futures import Future
+from functools import partial
+from typing import Any, Callable, Iterable, Iterator, List, Optional
+
+from langchain_core.documents import Document
+from loguru import logger
+
+from langflow.schema import Data
+
+DEFAULT_BATCH_SIZE = 256
+DEFAULT_MAX_IN_FLIGHT = 16
+
+
+class DataStream:
+    """
+    A lazily produced sequence of `Data`, read from its source each time it is opened.
+
+    It is deliberately not iterable, so the code that walks results to log, trace or serialize them
+    sees its description instead of reading the corpus.
+    """
+
+    def __init__(self, source: Callable[[], Iterable[Data]], description: str = "Data stream"):
+        self._source = source
+        self.description = description
+        self.reads = 0
+
+    def open(self) -> Iterator[Data]:
+        """Returns a new iterator over the items of the stream, read from its source as they are consumed."""
+        self.reads += 1
+        if self.reads > 1:
+            logger.debug(f"Reading {self.description} again, {self.reads} times so far")
+        return iter(self._source())
+
+    def __repr__(self) -> str:
+        return self.description
+
+
+def contains_stream(value: Any) -> bool:
+    return isinstance(value, DataStream) or (
+        isinstance(value, list) and any(isinstance(item, DataStream) for item in value)
+    )
+
+
+def iter_inputs(value: Any) -> Iterator[Any]:
+    """Yields the items of an input that holds a stream, a list of items and streams, or a single item."""
+    if value is None:
+        return
+    if not isinstance(value, list):
+        value = [value]
+    for item in value:
+        if isinstance(item, DataStream):
+            yield from item.open()
+        else:
+            yield item
+
+
+def iter_documents(value: Any) -> Iterator[Document]:
+    for item in iter_inputs(value):
+        yield item.to_lc_document() if isinstance(item, Data) else item
+
+
+def iter_batches(items: Iterable[Any], batch_size: int) -> Iterator[List[Any]]:
+    batch: List[Any] = []
+    for item in items:
+        batch.append(item)
+        if len(batch) >= batch_size:
+            yield batch
+            batch = []
+    if batch:
+        yield batch
+
+
+def bounded_map(
+    func: Callable[[Any], Any], items: Iterable[Any], submit: Callable[..., Future], max_in_flight: int
+) -> Iterator[Any]:
+    """
+    Yields `func(item)` for each item, in order. The calls are submitted to an executor with
+    `submit`, and the items are only pulled from `items` while fewer than `max_in_flight` calls
+    are pending, so a lazy source is never read ahead of its consumer by more than that.
+    """
+    pending: deque[Future] = deque()
+    try:
+        for item in items:
+            pending.append(submit(func, item))
+            if len(pending) >= max(max_in_flight, 1):
+                yield pending.popleft().result()
+        while pending:
+            yield pending.popleft().result()
+    finally:
+        # The consumer stopped early or failed, the calls that did not start are dropped
+        for future in pending:
+            future.cancel()
+
+
+def split_document(splitter: Any, document: Document) -> List[Document]:
+    # Runs in the component process pool
+    return splitter.split_documents([document])
+
+
+def iter_split_data(splitter: Any, value: Any, max_in_flight: Optional[int] = None) -> Iterator[Data]:
+    """Splits the documents of `value` one at a time in the component process pool, as they arrive."""
+    from langflow.custom.custom_component.execution import get_execution_pools
+
+    pools = get_execution_pools()
+    split = partial(split_document, splitter)
+    try:
+        pickle.dumps(split)
+        submit = pools.submit_to_process
+    except Exception as exc:
+        logger.debug(f"Splitting in threads, {type(splitter).__name__} cannot be pickled: {exc}")
+        submit = pools.submit_to_thread
+    for chunks in bounded_map(split, iter_documents(value), submit, max_in_flight or get_ingestion_max_in_flight()):
+        for chunk in chunks:
+            yield Data.from_document(chunk)
+
+
+def add_documents_in_batches(
+    add_documents: Callable[[List[Document]], Any], documents: Iterable[Document], batch_size: Optional[int] = None
+) -> int:
+    """Calls `add_documents` with bounded batches of `documents` and returns the number of documents added."""
+    count = 0
+    for batch in iter_batches(documents, batch_size or get_ingestion_batch_size()):
+        add_documents(batch)
+        count += len(batch)
+        logger.debug(f"Added {count} documents to the Vector Store.")
+    return count
+
+
+def get_ingestion_batch_size() -> int:
+    from langflow.services.deps import get_settings_service
+
+    try:
+        return get_settings_service().settings.ingestion_batch_size
+    except Exception:
+        return DEFAULT_BATCH_SIZE
+
+
+def get_ingestion_max_in_flight() -> int:
+    from langflow.services.deps import get_settings_service
+
+    try:
+        return get_settings_service().settings.ingestion_max_in_flight
+    except Exception:
+        return DEFAULT_MAX_IN_FLIGHT
@@ -2,14 +2,18 @@ import unicodedata
 import xml.etree.ElementTree as ET
 from concurrent import futures
 from pathlib import Path
-from typing import Callable, List, Optional
+from typing import TYPE_CHECKING, Callable, Iterator, List, Optional
 
 import chardet
 import orjson
 import yaml
 
+from langflow.base.data.ingestion import bounded_map
 from langflow.schema import Data
 
+if TYPE_CHECKING:
+    from langflow.services.storage.blobs import BlobStore
+
 # Types of files that can be read simply by file.read()
 # and have 100% to be completely readable
 TEXT_FILE_TYPES = [
@@ -95,10 +99,13 @@ def partition_file_to_data(file_path: str, silent_errors: bool) -> Optional[Data
 
 
 def read_text_file(file_path: str) -> str:
+    # The encoding is detected from the first chunks, which is usually enough, instead of the whole file
+    detector = chardet.UniversalDetector()
     with open(file_path, "rb") as f:
-        raw_data = f.read()
-        result = chardet.detect(raw_data)
-        encoding = result["encoding"]
+        while not detector.done and (chunk := f.read(64 * 1024)):
+            detector.feed(chunk)
+        detector.close()
+        encoding = detector.result["encoding"]
 
         if encoding in ["Windows-1252", "Windows-1254", "MacRoman"]:
             encoding = "utf-8"
@@ -122,29 +129,55 @@ def parse_pdf_to_text(file_path: str) -> str:
         return "\n\n".join([page.extract_text() for page in reader.pages])
 
 
+def parse_text_file(file_path: str):
+    if file_path.endswith(".pdf"):
+        text = parse_pdf_to_text(file_path)
+    elif file_path.endswith(".docx"):
+        text = read_docx_file(file_path)
+    else:
+        text = read_text_file(file_path)
+
+    # if file is json, yaml, or xml, we can parse it
+    if file_path.endswith(".json"):
+        text = orjson.loads(text)
+        if isinstance(text, dict):
+            text = {k: normalize_text(v) if isinstance(v, str) else v for k, v in text.items()}
+        elif isinstance(text, list):
+            text = [normalize_text(item) if isinstance(item, str) else item for item in text]
+        text = orjson.dumps(text).decode("utf-8")
+
+    elif file_path.endswith(".yaml") or file_path.endswith(".yml"):
+        text = yaml.safe_load(text)
+    elif file_path.endswith(".xml"):
+        xml_element = ET.fromstring(text)
+        text = ET.tostring(xml_element, encoding="unicode")
+    return text
+
+
+def get_blob_store() -> Optional["BlobStore"]:
+    """Returns the blob store of the local storage, or None if parsed documents are not cached."""
+    from langflow.services.deps import get_settings_service, get_storage_service
+
+    try:
+        if not get_settings_service().settings.parsed_document_cache:
+            return None
+        return getattr(get_storage_service(), "blob_store", None)
+    except Exception:
+        # Loaders also run where the services are not set up, such as the component process pool
+        return None
+
+
 def parse_text_file_to_data(file_path: str, silent_errors: bool) -> Optional[Data]:
     try:
-        if file_path.endswith(".pdf"):
-            text = parse_pdf_to_text(file_path)
-        elif file_path.endswith(".docx"):
-            text = read_docx_file(file_path)
-        else:
-            text = read_text_file(file_path)
-
-        # if file is json, yaml, or xml, we can parse it
-        if file_path.endswith(".json"):
-            text = orjson.loads(text)
-            if isinstance(text, dict):
-                text = {k: normalize_text(v) if isinstance(v, str) else v for k, v in text.items()}
-            elif isinstance(text, list):
-                text = [normalize_text(item) if isinstance(item, str) else item for item in text]
-            text = orjson.dumps(text).decode("utf-8")
-
-        elif file_path.endswith(".yaml") or file_path.endswith(".yml"):
-            text = yaml.safe_load(text)
-        elif file_path.endswith(".xml"):
-            xml_element = ET.fromstring(text)
-            text = ET.tostring(xml_element, encoding="unicode")
+        blob_store = get_blob_store()
+        # Files uploaded to the storage are parsed once per content, whichever flow they belong to
+        digest = blob_store.get_blob_digest(Path(file_path)) if blob_store is not None else None
+        kind = Path(file_path).suffix.lstrip(".").lower() or "txt"
+        text = blob_store.get_parsed(digest, kind) if blob_store is not None and digest else None
+        if text is None:
+            text = parse_text_file(file_path)
+            if blob_store is not None and digest:
+                blob_store.set_parsed(digest, kind, text)
     except Exception as e:
         if not silent_errors:
             raise ValueError(f"Error loading file {file_path}: {e}") from e
@@ -183,3 +216,25 @@ def parallel_load_data(
         )
     # loaded_files is an iterator, so we need to convert it to a list
     return list(loaded_files)
+
+
+def iter_load_data(
+    file_paths: List[str],
+    silent_errors: bool,
+    max_concurrency: int,
+    load_function: Callable = parse_text_file_to_data,
+) -> Iterator[Data]:
+    """
+    Like `parallel_load_data`, but yields the files in order as they load, without reading more than
+    twice `max_concurrency` files ahead of the consumer. Files that fail with `silent_errors` are skipped.
+    """
+    with futures.ThreadPoolExecutor(max_workers=max_concurrency) as executor:
+        loaded_files = bounded_map(
+            lambda file_path: load_function(file_path, silent_errors),
+            file_paths,
+            executor.submit,
+            max(max_concurrency, 1) * 2,
+        )
+        for data in loaded_files:
+            if data is not None:
+                yield data
@@ -0,0 +1,307 @@
+"""
+Batches, limits and caches the requests the embedding components send to their providers.
+
+The embedding components wrap their client with `dispatch_embeddings`. The wrapper splits the
+texts into batches bounded by a number of texts and an estimated number of tokens, sends up to
+`embedding_max_concurrency` batches at the same time to each provider, shared by every flow
+running in the process, and retries the batches that were rate limited with exponential backoff.
+
+Embeddings are cached per text, keyed by the client class, its model, a hash of the rest of its
+settings (the endpoint, the credentials, the dimensions and other model or encode kwargs) and the
+hash of the text, so the same chunks ingested twice or the same query asked again are only sent
+once. The cache is bounded by the bytes of the vectors, stored as arrays of doubles rather than
+lists of floats. The dispatcher does the retries, those of the provider's SDK are turned off.
+"""
+
+import asyncio
+import hashlib
+import random
+import re
+import threading
+import time
+from array import array
+from collections import OrderedDict
+from concurrent.futures import ThreadPoolExecutor
+from typing import Any, Dict, List, Optional
+
+import orjson
+from langchain_core.embeddings import Embeddings
+from loguru import logger
+
+# Rough number of characters per token, used to bound the size of the batches without a tokenizer
+CHARS_PER_TOKEN = 4
+MODEL_ATTRIBUTES = ("model", "model_name", "model_id", "deployment", "azure_deployment", "repo_id")
+# Settings hashed apart from the others in the key of the cached embeddings, so they are never dumped
+SECRET_ATTRIBUTE = re.compile(r"key|token|secret|password|credential", re.IGNORECASE)
+
+
+class EmbeddingCache:
+    """A thread-safe LRU of embeddings keyed by model and text hash, bounded by the bytes of the vectors."""
+
+    def __init__(self, max_bytes: int):
+        self.max_bytes = max_bytes
+        self.size_bytes = 0
+        self._entries: OrderedDict[str, array] = OrderedDict()
+        self._lock = threading.Lock()
+
+    @staticmethod
+    def build_key(model_key: str, text: str) -> str:
+        return f"{model_key}:{hashlib.sha256(text.encode('utf-8')).hexdigest()}"
+
+    def get(self, key: str) -> Optional[List[float]]:
+        with self._lock:
+            if (embedding := self._entries.get(key)) is None:
+                return None
+            self._entries.move_to_end(key)
+        return embedding.tolist()
+
+    def set(self, key: str, embedding: List[float]) -> None:
+        vector = array("d", embedding)
+        size = _entry_size(key, vector)
+        if size > self.max_bytes:
+            return
+        with self._lock:
+            if (previous := self._entries.pop(key, None)) is not None:
+                self.size_bytes -= _entry_size(key, previous)
+            self._entries[key] = vector
+            self.size_bytes += size
+            while self.size_bytes > self.max_bytes:
+                evicted_key, evicted = self._entries.popitem(last=False)
+                self.size_bytes -= _entry_size(evicted_key, evicted)
+
+    def __len__(self):
+        return len(self._entries)
+
+
+def _entry_size(key: str, vector: array) -> int:
+    return len(key) + vector.itemsize * len(vector)
+
+
+class EmbeddingDispatcher:
+    """Sends the batches of every wrapped client, with a concurrency limit per provider."""
+
+    def __init__(
+        self,
+        batch_size: int = 64,
+        max_batch_tokens: int = 50_000,
+        max_concurrency: int = 4,
+        max_retries: int = 5,
+        cache_max_bytes: int = 64 * 1024 * 1024,
+    ):
+        self.batch_size = batch_size
+        self.max_batch_tokens = max_batch_tokens
+        self.max_concurrency = max_concurrency
+        self.max_retries = max_retries
+        self.cache = EmbeddingCache(cache_max_bytes)
+        self._semaphores: Dict[str, threading.BoundedSemaphore] = {}
+        self._lock = threading.Lock()
+        self._executor: Optional[ThreadPoolExecutor] = None
+
+    def _get_semaphore(self, provider: str) -> threading.BoundedSemaphore:
+        with self._lock:
+            if provider not in self._semaphores:
+                self._semaphores[provider] = threading.BoundedSemaphore(self.max_concurrency)
+            return self._semaphores[provider]
+
+    def _get_executor(self) -> ThreadPoolExecutor:
+        with self._lock:
+            if self._executor is None:
+                self._executor = ThreadPoolExecutor(thread_name_prefix="embeddings")
+            return self._executor
+
+    def make_batches(self, texts: List[str]) -> List[List[int]]:
+        """Splits the texts into batches of indexes, each within the text and token budgets."""
+        batches: List[List[int]] = []
+        batch: List[int] = []
+        tokens = 0
+        for index, text in enumerate(texts):
+            text_tokens = len(text) // CHARS_PER_TOKEN + 1
+            if batch and (len(batch) >= self.batch_size or tokens + text_tokens > self.max_batch_tokens):
+                batches.append(batch)
+                batch, tokens = [], 0
+            batch.append(index)
+            tokens += text_tokens
+        if batch:
+            batches.append(batch)
+        return batches
+
+    def embed_documents(self, client: Embeddings, provider: str, model_key: str, texts: List[str]) -> List[List[float]]:
+        embeddings: List[Optional[List[float]]] = [None] * len(texts)
+        keys = [self.cache.build_key(model_key, text) for text in texts]
+        missing: Dict[str, List[int]] = {}
+        for index, key in enumerate(keys):
+            if (cached := self.cache.get(key)) is not None:
+                embeddings[index] = cached
+            else:
+                # Texts repeated in the same call are sent once
+                missing.setdefault(key, []).append(index)
+        if missing:
+            first_indexes = [indexes[0] for indexes in missing.values()]
+            unique_texts = [texts[index] for index in first_indexes]
+            batches = self.make_batches(unique_texts)
+            if len(batches) == 1:
+                results = [self._send(client, provider, unique_texts)]
+            else:
+                executor = self._get_executor()
+                futures = [
+                    executor.submit(self._send, client, provider, [unique_texts[i] for i in batch]) for batch in batches
+                ]
+                results = [future.result() for future in futures]
+            for batch, batch_embeddings in zip(batches, results):
+                for position, embedding in zip(batch, batch_embeddings):
+                    key = keys[first_indexes[position]]
+                    self.cache.set(key, embedding)
+                    for index in missing[key]:
+                        embeddings[index] = embedding
+        return embeddings  # type: ignore
+
+    def embed_query(self, client: Embeddings, provider: str, model_key: str, text: str) -> List[float]:
+        key = self.cache.build_key(f"{model_key}:query", text)
+        if (cached := self.cache.get(key)) is not None:
+            return cached
+        with self._get_semaphore(provider):
+            embedding = self._with_backoff(client.embed_query, text)
+        self.cache.set(key, embedding)
+        return embedding
+
+    def _send(self, client: Embeddings, provider: str, texts: List[str]) -> List[List[float]]:
+        with self._get_semaphore(provider):
+            return self._with_backoff(client.embed_documents, texts)
+
+    def _with_backoff(self, func, *args):
+        for attempt in range(self.max_retries + 1):
+            try:
+                return func(*args)
+            except Exception as exc:
+                if attempt == self.max_retries or not is_rate_limit_error(exc):
+                    raise
+                delay = min(2**attempt, 60) * (0.5 + random.random())
+                logger.debug(f"Embedding request rate limited, retrying in {delay:.1f}s: {exc}")
+                time.sleep(delay)
+
+
+def is_rate_limit_error(exc: Exception) -> bool:
+    status = getattr(exc, "status_code", None) or getattr(getattr(exc, "response", None), "status_code", None)
+    if status == 429:
+        return True
+    message = f"{type(exc).__name__} {exc}".lower()
+    return "ratelimit" in message or "rate limit" in message or "too many requests" in message
+
+
+class DispatchedEmbeddings(Embeddings):
+    """
+    Embeddings that send the requests of `client` through the shared dispatcher.
+
+    Other attributes are read from the client, so components that inspect the embeddings they
+    receive still see the provider's settings.
+    """
+
+    def __init__(self, client: Embeddings):
+        disable_client_retries(client)
+        self.client = client
+        self.provider = type(client).__name__
+        self.model_key = f"{self.provider}:{get_model_name(client)}:{get_config_hash(client)}"
+
+    def __getattr__(self, name: str) -> Any:
+        # Private and special names are not forwarded, pickle and copy would find the client's
+        if name == "client" or name.startswith("_"):
+            raise AttributeError(name)
+        return getattr(self.client, name)
+
+    def embed_documents(self, texts: List[str]) -> List[List[float]]:
+        return get_embedding_dispatcher().embed_documents(self.client, self.provider, self.model_key, texts)
+
+    def embed_query(self, text: str) -> List[float]:
+        return get_embedding_dispatcher().embed_query(self.client, self.provider, self.model_key, text)
+
+    async def aembed_documents(self, texts: List[str]) -> List[List[float]]:
+        return await asyncio.to_thread(self.embed_documents, texts)
+
+    async def aembed_query(self, text: str) -> List[float]:
+        return await asyncio.to_thread(self.embed_query, text)
+
+
+def get_model_name(client: Embeddings) -> str:
+    for attribute in MODEL_ATTRIBUTES:
+        if value := getattr(client, attribute, None):
+            return str(value)
+    return ""
+
+
+def disable_client_retries(client: Embeddings) -> None:
+    """Sets the retries of the client, and of the SDK clients it wraps, to 0. The dispatcher retries the requests."""
+    for wrapped in (client, getattr(client, "client", None), getattr(client, "async_client", None)):
+        for target in (wrapped, getattr(wrapped, "_client", None)):
+            retries = getattr(target, "max_retries", None)
+            if isinstance(retries, int) and not isinstance(retries, bool) and retries:
+                try:
+                    target.max_retries = 0  # type: ignore
+                except Exception:  # noqa: BLE001
+                    logger.debug(f"Could not turn off the retries of {type(target).__name__}")
+
+
+def get_config_hash(client: Embeddings) -> str:
+    """
+    Hashes the plain settings of the client. The secrets are hashed on their own, a vector computed
+    with one API key is not served to a client configured with another.
+    """
+    config = {name: value for name, value in vars(client).items() if not name.startswith("_")}
+    secrets = sorted(
+        f"{name}={_secret_value(value)}" for name, value in config.items() if SECRET_ATTRIBUTE.search(name) and value
+    )
+    digest = hashlib.sha256(orjson.dumps(_plain_values(config), option=orjson.OPT_SORT_KEYS))
+    digest.update("\0".join(secrets).encode("utf-8"))
+    return digest.hexdigest()[:16]
+
+
+def _secret_value(value: Any) -> str:
+    if hasattr(value, "get_secret_value"):
+        value = value.get_secret_value()
+    return str(value)
+
+
+_DROPPED = object()
+
+
+def _plain_values(value: Any) -> Any:
+    # The clients of the providers and the secret values are dropped, their repr is not stable
+    if value is None or isinstance(value, (str, int, float, bool)):
+        return value
+    if isinstance(value, (set, frozenset)):
+        value = sorted(value, key=str)
+    if isinstance(value, (list, tuple)):
+        return [item for item in map(_plain_values, value) if item is not _DROPPED]
+    if isinstance(value, dict):
+        items = {str(key): _plain_values(item) for key, item in value.items() if not SECRET_ATTRIBUTE.search(str(key))}
+        return {key: item for key, item in items.items() if item is not _DROPPED}
+    return _DROPPED
+
+
+_dispatcher: Optional[EmbeddingDispatcher] = None
+_dispatcher_lock = threading.Lock()
+
+
+def get_embedding_dispatcher() -> EmbeddingDispatcher:
+    global _dispatcher
+    with _dispatcher_lock:
+        if _dispatcher is None:
+            from langflow.services.deps import get_settings_service
+
+            settings = get_settings_service().settings
+            _dispatcher = EmbeddingDispatcher(
+                batch_size=settings.embedding_batch_size,
+                max_batch_tokens=settings.embedding_max_batch_tokens,
+                max_concurrency=settings.embedding_max_concurrency,
+                max_retries=settings.embedding_max_retries,
+                cache_max_bytes=settings.embedding_cache_max_bytes,
+            )
+        return _dispatcher
+
+
+def dispatch_embeddings(client: Embeddings) -> Embeddings:
+    """Wraps the client of an embedding component, unless `embedding_dispatcher` is disabled."""
+    from langflow.services.deps import get_settings_service
+
+    if not get_settings_service().settings.embedding_dispatcher:
+        return client
+    return DispatchedEmbeddings(client)
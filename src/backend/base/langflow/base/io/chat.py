@@ -2,7 +2,7 @@ from typing import Optional, Union
 
 from langflow.base.data.utils import IMG_FILE_TYPES, TEXT_FILE_TYPES
 from langflow.custom import Component
-from langflow.memory import store_message
+from langflow.memory import async_store_message, store_message
 from langflow.schema import Data
 from langflow.schema.message import Message
 
@@ -61,6 +61,18 @@ class ChatComponent(Component):
         self.status = messages
         return messages
 
+    async def async_store_message(
+        self,
+        message: Message,
+    ) -> list[Message]:
+        messages = await async_store_message(
+            message,
+            flow_id=self.graph.flow_id,
+        )
+
+        self.status = messages
+        return messages
+
     def build_with_data(
         self,
         sender: Optional[str] = "User",
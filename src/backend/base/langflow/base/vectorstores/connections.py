@@ -0,0 +1,251 @@
+"""
+A process-wide registry of the clients the vector store components connect with.
+
+Building a vector store component used to open a new client on every run, which repeats the
+connection handshake, the TLS setup and, for Cassandra, the schema discovery. Components now borrow
+their client from the registry, keyed by the kind of store and the normalized connection params,
+so every run with the same params shares one client.
+
+Each borrow is held by an owner, usually the component that built the store, until the owner is
+garbage collected, since the store it returns keeps using the client after the build. Only clients
+with no holders are closed: a client released for `max_idle` seconds is closed and removed, and when
+there are more than `max_size` clients the oldest free one is. A client borrowed again after
+`health_check_interval` seconds is checked first. If the check fails it is replaced for the next
+borrows and closed once its last holder is gone.
+"""
+
+import hashlib
+import threading
+import time
+import weakref
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, Optional, Tuple
+
+import orjson
+from loguru import logger
+
+
+@dataclass
+class PooledConnection:
+    client: Any
+    close: Optional[Callable[[Any], None]]
+    last_used: float = field(default_factory=time.monotonic)
+    last_checked: float = field(default_factory=time.monotonic)
+    # The finalizers of the owners holding the client, by the id of the owner
+    holders: Dict[int, weakref.finalize] = field(default_factory=dict)
+    # Set once the client is replaced, so it is closed when its last holder is gone
+    retired: bool = False
+
+
+def build_connection_key(kind: str, params: Dict[str, Any]) -> str:
+    """Builds the registry key of a connection. Params set to None or empty strings are left out."""
+    normalized = {
+        key: value.strip() if isinstance(value, str) else value
+        for key, value in params.items()
+        if value is not None and value != ""
+    }
+    # The params usually hold credentials, so only their hash is kept
+    digest = hashlib.sha256(orjson.dumps(normalized, option=orjson.OPT_SORT_KEYS, default=str)).hexdigest()
+    return f"{kind}:{digest}"
+
+
+class ConnectionRegistry:
+    def __init__(self, max_idle: float = 300, health_check_interval: float = 30, max_size: int = 64):
+        self.max_idle = max_idle
+        self.health_check_interval = health_check_interval
+        self.max_size = max_size
+        self._connections: Dict[str, PooledConnection] = {}
+        # Reentrant, a holder may be collected, and released, while the lock is held
+        self._lock = threading.RLock()
+        # Held while a client is created, so concurrent runs do not open one each
+        self._key_locks: Dict[str, threading.Lock] = {}
+
+    def borrow(
+        self,
+        kind: str,
+        params: Dict[str, Any],
+        factory: Callable[[], Any],
+        health_check: Optional[Callable[[Any], Any]] = None,
+        close: Optional[Callable[[Any], None]] = None,
+        owner: Any = None,
+    ) -> Any:
+        """
+        Returns the client for `params`, created with `factory` if there is none.
+
+        Args:
+            kind (str): The kind of store, which namespaces the params.
+            params (Dict[str, Any]): The params the client connects with.
+            factory (Callable[[], Any]): Creates the client.
+            health_check (Optional[Callable]): Raises or returns False if the client cannot be used anymore.
+            close (Optional[Callable]): Closes the client when it is evicted.
+            owner (Any): Holds the client until it is garbage collected or `release` is called.
+        """
+        key = build_connection_key(kind, params)
+        self.evict_idle()
+        with self._lock:
+            key_lock = self._key_locks.setdefault(key, threading.Lock())
+        with key_lock:
+            with self._lock:
+                connection = self._connections.get(key)
+            if connection is not None and not self._is_healthy(kind, connection, health_check):
+                self._retire(key, connection)
+                connection = None
+            if connection is None:
+                connection = PooledConnection(client=factory(), close=close)
+                with self._lock:
+                    self._connections[key] = connection
+                evicted = self._evict_oldest_free(exclude=key)
+                if evicted is not None:
+                    self._close(evicted)
+            with self._lock:
+                connection.last_used = time.monotonic()
+                if owner is not None and id(owner) not in connection.holders:
+                    connection.holders[id(owner)] = weakref.finalize(owner, self._release, connection, id(owner))
+            return connection.client
+
+    def release(self, client: Any, owner: Any) -> None:
+        """Drops the hold of `owner` on `client` before the owner is garbage collected."""
+        with self._lock:
+            connections = [connection for connection in self._connections.values() if connection.client is client]
+        for connection in connections:
+            if (finalizer := connection.holders.get(id(owner))) is not None:
+                finalizer()
+
+    def _release(self, connection: PooledConnection, owner_id: int) -> None:
+        with self._lock:
+            connection.holders.pop(owner_id, None)
+            connection.last_used = time.monotonic()
+            close = connection.retired and not connection.holders
+        if close:
+            self._close(connection)
+
+    def _evict_oldest_free(self, exclude: str) -> Optional[PooledConnection]:
+        with self._lock:
+            if len(self._connections) <= self.max_size:
+                return None
+            free = [
+                key for key, connection in self._connections.items() if not connection.holders and key != exclude
+            ]
+            if not free:
+                # Every client is in use, the registry grows until some are released
+                return None
+            oldest_key = min(free, key=lambda k: self._connections[k].last_used)
+            return self._connections.pop(oldest_key)
+
+    def _is_healthy(self, kind: str, connection: PooledConnection, health_check) -> bool:
+        now = time.monotonic()
+        if health_check is None or now - connection.last_checked < self.health_check_interval:
+            return True
+        connection.last_checked = now
+        try:
+            return health_check(connection.client) is not False
+        except Exception as exc:
+            logger.debug(f"Replacing a {kind} client that failed its health check: {exc}")
+            return False
+
+    def evict_idle(self) -> None:
+        now = time.monotonic()
+        with self._lock:
+            idle = [
+                key
+                for key, connection in self._connections.items()
+                if not connection.holders and now - connection.last_used > self.max_idle
+            ]
+            evicted = [self._connections.pop(key) for key in idle]
+        for connection in evicted:
+            self._close(connection)
+
+    def _retire(self, key: str, connection: PooledConnection) -> None:
+        with self._lock:
+            if self._connections.get(key) is connection:
+                del self._connections[key]
+            connection.retired = True
+            close = not connection.holders
+        if close:
+            self._close(connection)
+
+    @staticmethod
+    def _close(connection: PooledConnection) -> None:
+        if connection.close is None:
+            return
+        try:
+            connection.close(connection.client)
+        except Exception as exc:
+            logger.debug(f"Error closing a vector store client: {exc}")
+
+    def close_all(self) -> None:
+        """Closes every client, held or not. Called when the process shuts down."""
+        with self._lock:
+            connections = list(self._connections.values())
+            self._connections.clear()
+        for connection in connections:
+            for finalizer in list(connection.holders.values()):
+                finalizer.detach()
+            connection.holders.clear()
+            self._close(connection)
+
+    def __len__(self):
+        return len(self._connections)
+
+
+_registry: Optional[ConnectionRegistry] = None
+_registry_lock = threading.Lock()
+
+
+def get_connection_registry() -> Optional[ConnectionRegistry]:
+    """Returns the registry, or None if `vector_store_connection_pooling` is disabled."""
+    global _registry
+    from langflow.services.deps import get_settings_service
+
+    settings = get_settings_service().settings
+    if not settings.vector_store_connection_pooling:
+        return None
+    with _registry_lock:
+        if _registry is None:
+            _registry = ConnectionRegistry(
+                max_idle=settings.vector_store_connection_max_idle,
+                health_check_interval=settings.vector_store_connection_health_check_interval,
+            )
+        return _registry
+
+
+def borrow_client(
+    kind: str,
+    params: Dict[str, Any],
+    factory: Callable[[], Any],
+    health_check: Optional[Callable[[Any], Any]] = None,
+    close: Optional[Callable[[Any], None]] = None,
+    owner: Any = None,
+) -> Any:
+    """Borrows a client from the registry for `owner`, or creates a new one if pooling is disabled."""
+    if (registry := get_connection_registry()) is None:
+        return factory()
+    return registry.borrow(kind, params, factory, health_check=health_check, close=close, owner=owner)
+
+
+_cassio_init_lock = threading.Lock()
+
+
+def connect_cassio(**init_kwargs) -> Tuple[Any, Optional[str]]:
+    """
+    Returns the session and keyspace `cassio.init` resolves for `init_kwargs`.
+
+    `cassio.init` sets the process-wide cassio defaults, which the runs connected to other
+    clusters would then use, so they are restored once the session is resolved.
+    """
+    import cassio
+
+    with _cassio_init_lock:
+        defaults = {name: value for name, value in vars(cassio.config).items() if name.startswith("default_")}
+        try:
+            cassio.init(**init_kwargs)
+            return cassio.config.resolve_session(), cassio.config.resolve_keyspace()
+        finally:
+            for name, value in defaults.items():
+                setattr(cassio.config, name, value)
+
+
+def close_connections() -> None:
+    with _registry_lock:
+        if _registry is not None:
+            _registry.close_all()
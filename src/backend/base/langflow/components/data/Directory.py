@@ -1,6 +1,13 @@
+from functools import partial
 from typing import List, Optional
 
-from langflow.base.data.utils import parallel_load_data, parse_text_file_to_data, retrieve_file_paths
+from langflow.base.data.ingestion import DataStream
+from langflow.base.data.utils import (
+    iter_load_data,
+    parallel_load_data,
+    parse_text_file_to_data,
+    retrieve_file_paths,
+)
 from langflow.custom import Component
 from langflow.io import BoolInput, IntInput, MessageTextInput
 from langflow.schema import Data
@@ -60,6 +67,12 @@ class DirectoryComponent(Component):
             advanced=True,
             info="If true, multithreading will be used.",
         ),
+        BoolInput(
+            name="stream",
+            display_name="Stream",
+            advanced=True,
+            info="If true, the files are loaded as the next component reads them instead of all at once.",
+        ),
     ]
 
     outputs = [
@@ -77,6 +90,14 @@ class DirectoryComponent(Component):
 
         resolved_path = self.resolve_path(path)
         file_paths = retrieve_file_paths(resolved_path, load_hidden, recursive, depth)
+        if self.stream:
+            # Loaded with a single thread unless multithreading is on, as the list is
+            concurrency = max_concurrency if use_multithreading else 1
+            self.status = f"Streaming {len(file_paths)} files."
+            return DataStream(  # type: ignore[return-value]
+                partial(iter_load_data, file_paths, silent_errors, concurrency),
+                f"Data stream of {len(file_paths)} files in {resolved_path}",
+            )
         loaded_data = []
 
         if use_multithreading:
@@ -1,5 +1,6 @@
 from langchain_community.embeddings import BedrockEmbeddings
 
+from langflow.base.embeddings.dispatcher import dispatch_embeddings
 from langflow.base.models.model import LCModelComponent
 from langflow.field_typing import Embeddings
 from langflow.io import DropdownInput, MessageTextInput, Output
@@ -46,4 +47,4 @@ class AmazonBedrockEmbeddingsComponent(LCModelComponent):
             )  # type: ignore
         except Exception as e:
             raise ValueError("Could not connect to Amazon Bedrock API.") from e
-        return output
+        return dispatch_embeddings(output)
@@ -1,6 +1,7 @@
 from langchain_openai import AzureOpenAIEmbeddings
 from pydantic.v1 import SecretStr
 
+from langflow.base.embeddings.dispatcher import dispatch_embeddings
 from langflow.base.models.model import LCModelComponent
 from langflow.field_typing import Embeddings
 from langflow.io import DropdownInput, IntInput, MessageTextInput, Output, SecretStrInput
@@ -74,4 +75,4 @@ class AzureOpenAIEmbeddingsComponent(LCModelComponent):
         except Exception as e:
             raise ValueError("Could not connect to AzureOpenAIEmbeddings API.") from e
 
-        return embeddings
+        return dispatch_embeddings(embeddings)
@@ -1,5 +1,6 @@
 from langchain_community.embeddings.cohere import CohereEmbeddings
 
+from langflow.base.embeddings.dispatcher import dispatch_embeddings
 from langflow.base.models.model import LCModelComponent
 from langflow.field_typing import Embeddings
 from langflow.io import DropdownInput, FloatInput, IntInput, MessageTextInput, Output, SecretStrInput
@@ -34,7 +35,7 @@ class CohereEmbeddingsComponent(LCModelComponent):
     ]
 
     def build_embeddings(self) -> Embeddings:
-        return CohereEmbeddings(  # type: ignore
+        embeddings = CohereEmbeddings(  # type: ignore
             cohere_api_key=self.cohere_api_key,
             model=self.model,
             truncate=self.truncate,
@@ -42,3 +43,4 @@ class CohereEmbeddingsComponent(LCModelComponent):
             user_agent=self.user_agent,
             request_timeout=self.request_timeout or None,
         )
+        return dispatch_embeddings(embeddings)
@@ -1,5 +1,6 @@
 from langchain_community.embeddings.huggingface import HuggingFaceEmbeddings
 
+from langflow.base.embeddings.dispatcher import dispatch_embeddings
 from langflow.base.models.model import LCModelComponent
 from langflow.field_typing import Embeddings
 from langflow.io import BoolInput, DictInput, MessageTextInput, Output
@@ -12,6 +13,7 @@ class HuggingFaceEmbeddingsComponent(LCModelComponent):
         "https://python.langchain.com/docs/modules/data_connection/text_embedding/integrations/sentence_transformers"
     )
     icon = "HuggingFace"
+    execution_class = "thread"
 
     inputs = [
         MessageTextInput(name="cache_folder", display_name="Cache Folder", advanced=True),
@@ -26,10 +28,11 @@ class HuggingFaceEmbeddingsComponent(LCModelComponent):
     ]
 
     def build_embeddings(self) -> Embeddings:
-        return HuggingFaceEmbeddings(
+        embeddings = HuggingFaceEmbeddings(
             cache_folder=self.cache_folder,
             encode_kwargs=self.encode_kwargs,
             model_kwargs=self.model_kwargs,
             model_name=self.model_name,
             multi_process=self.multi_process,
         )
+        return dispatch_embeddings(embeddings)
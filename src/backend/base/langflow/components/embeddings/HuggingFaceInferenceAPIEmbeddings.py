@@ -1,6 +1,7 @@
 from langchain_community.embeddings.huggingface import HuggingFaceInferenceAPIEmbeddings
 from pydantic.v1.types import SecretStr
 
+from langflow.base.embeddings.dispatcher import dispatch_embeddings
 from langflow.base.models.model import LCModelComponent
 from langflow.field_typing import Embeddings
 from langflow.io import MessageTextInput, Output, SecretStrInput
@@ -28,4 +29,7 @@ class HuggingFaceInferenceAPIEmbeddingsComponent(LCModelComponent):
 
         api_key = SecretStr(self.api_key)
 
-        return HuggingFaceInferenceAPIEmbeddings(api_key=api_key, api_url=self.api_url, model_name=self.model_name)
+        embeddings = HuggingFaceInferenceAPIEmbeddings(
+            api_key=api_key, api_url=self.api_url, model_name=self.model_name
+        )
+        return dispatch_embeddings(embeddings)
@@ -1,6 +1,7 @@
 from langchain_mistralai.embeddings import MistralAIEmbeddings
 from pydantic.v1 import SecretStr
 
+from langflow.base.embeddings.dispatcher import dispatch_embeddings
 from langflow.base.models.model import LCModelComponent
 from langflow.field_typing import Embeddings
 from langflow.io import DropdownInput, IntInput, MessageTextInput, Output, SecretStrInput
@@ -46,7 +47,7 @@ class MistralAIEmbeddingsComponent(LCModelComponent):
 
         api_key = SecretStr(self.mistral_api_key)
 
-        return MistralAIEmbeddings(
+        embeddings = MistralAIEmbeddings(
             api_key=api_key,
             model=self.model,
             endpoint=self.endpoint,
@@ -54,3 +55,4 @@ class MistralAIEmbeddingsComponent(LCModelComponent):
             max_retries=self.max_retries,
             timeout=self.timeout,
         )
+        return dispatch_embeddings(embeddings)
@@ -1,5 +1,6 @@
 from langchain_community.embeddings import OllamaEmbeddings
 
+from langflow.base.embeddings.dispatcher import dispatch_embeddings
 from langflow.base.models.model import LCModelComponent
 from langflow.field_typing import Embeddings
 from langflow.io import FloatInput, MessageTextInput, Output
@@ -43,4 +44,4 @@ class OllamaEmbeddingsComponent(LCModelComponent):
             )  # type: ignore
         except Exception as e:
             raise ValueError("Could not connect to Ollama API.") from e
-        return output
+        return dispatch_embeddings(output)
@@ -1,5 +1,6 @@
 from langchain_openai.embeddings.base import OpenAIEmbeddings
 
+from langflow.base.embeddings.dispatcher import dispatch_embeddings
 from langflow.base.embeddings.model import LCEmbeddingsModel
 from langflow.field_typing import Embeddings
 from langflow.io import BoolInput, DictInput, DropdownInput, FloatInput, IntInput, MessageTextInput, SecretStrInput
@@ -67,7 +68,7 @@ class OpenAIEmbeddingsComponent(LCEmbeddingsModel):
     ]
 
     def build_embeddings(self) -> Embeddings:
-        return OpenAIEmbeddings(
+        embeddings = OpenAIEmbeddings(
             tiktoken_enabled=self.tiktoken_enable,
             default_headers=self.default_headers,
             default_query=self.default_query,
@@ -90,3 +91,4 @@ class OpenAIEmbeddingsComponent(LCEmbeddingsModel):
             skip_empty=self.skip_empty,
             tiktoken_model_name=self.tiktoken_model_name,
         )
+        return dispatch_embeddings(embeddings)
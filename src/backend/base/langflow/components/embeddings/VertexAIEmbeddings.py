@@ -1,3 +1,4 @@
+from langflow.base.embeddings.dispatcher import dispatch_embeddings
 from langflow.base.models.model import LCModelComponent
 from langflow.field_typing import Embeddings
 from langflow.io import BoolInput, DictInput, FileInput, FloatInput, IntInput, MessageTextInput, Output
@@ -101,7 +102,7 @@ class VertexAIEmbeddingsComponent(LCModelComponent):
                 "Please install the langchain-google-vertexai package to use the VertexAIEmbeddings component."
             )
 
-        return VertexAIEmbeddings(
+        embeddings = VertexAIEmbeddings(
             instance=self.instance,
             credentials=self.credentials,
             location=self.location,
@@ -117,3 +118,4 @@ class VertexAIEmbeddingsComponent(LCModelComponent):
             top_k=self.top_k,
             top_p=self.top_p,
         )
+        return dispatch_embeddings(embeddings)
@@ -47,7 +47,7 @@ class ChatInput(ChatComponent):
         Output(display_name="Message", name="message", method="message_response"),
     ]
 
-    def message_response(self) -> Message:
+    async def message_response(self) -> Message:
         message = Message(
             text=self.input_value,
             sender=self.sender,
@@ -56,7 +56,7 @@ class ChatInput(ChatComponent):
             files=self.files,
         )
         if self.session_id and isinstance(message, Message) and isinstance(message.text, str):
-            self.store_message(message)
+            await self.async_store_message(message)
             self.message.value = message
 
         self.status = message
@@ -40,7 +40,7 @@ class ChatOutput(ChatComponent):
         Output(display_name="Message", name="message", method="message_response"),
     ]
 
-    def message_response(self) -> Message:
+    async def message_response(self) -> Message:
         message = Message(
             text=self.input_value,
             sender=self.sender,
@@ -48,7 +48,7 @@ class ChatOutput(ChatComponent):
             session_id=self.session_id,
         )
         if self.session_id and isinstance(message, Message) and isinstance(message.text, str):
-            self.store_message(message)
+            await self.async_store_message(message)
             self.message.value = message
 
         self.status = message
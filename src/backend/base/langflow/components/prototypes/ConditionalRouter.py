@@ -42,8 +42,8 @@ class ConditionalRouterComponent(Component):
     ]
 
     outputs = [
-        Output(display_name="True Route", name="true_result", method="true_response"),
-        Output(display_name="False Route", name="false_result", method="false_response"),
+        Output(display_name="True Route", name="true_result", method="true_response", can_stop=True),
+        Output(display_name="False Route", name="false_result", method="false_response", can_stop=True),
     ]
 
     def evaluate_condition(self, input_text: str, match_text: str, operator: str, case_sensitive: bool) -> bool:
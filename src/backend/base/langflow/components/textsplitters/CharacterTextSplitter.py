@@ -1,7 +1,9 @@
+from functools import partial
 from typing import List
 
 from langchain_text_splitters import CharacterTextSplitter
 
+from langflow.base.data.ingestion import DataStream, contains_stream, iter_split_data
 from langflow.custom import CustomComponent
 from langflow.schema import Data
 from langflow.utils.util import unescape_string
@@ -28,17 +30,21 @@ class CharacterTextSplitterComponent(CustomComponent):
     ) -> List[Data]:
         # separator may come escaped from the frontend
         separator = unescape_string(separator)
+        splitter = CharacterTextSplitter(
+            chunk_overlap=chunk_overlap,
+            chunk_size=chunk_size,
+            separator=separator,
+        )
+        if contains_stream(inputs):
+            self.status = "Splitting a data stream."
+            return DataStream(partial(iter_split_data, splitter, inputs), "Split data stream")  # type: ignore
         documents = []
         for _input in inputs:
             if isinstance(_input, Data):
                 documents.append(_input.to_lc_document())
             else:
                 documents.append(_input)
-        docs = CharacterTextSplitter(
-            chunk_overlap=chunk_overlap,
-            chunk_size=chunk_size,
-            separator=separator,
-        ).split_documents(documents)
+        docs = splitter.split_documents(documents)
         data = self.to_data(docs)
         self.status = data
         return data
@@ -1,7 +1,9 @@
+from functools import partial
 from typing import List, Optional
 
 from langchain_text_splitters import Language, RecursiveCharacterTextSplitter
 
+from langflow.base.data.ingestion import DataStream, contains_stream, iter_split_data
 from langflow.custom import CustomComponent
 from langflow.schema import Data
 
@@ -10,6 +12,7 @@ class LanguageRecursiveTextSplitterComponent(CustomComponent):
     display_name: str = "Language Recursive Text Splitter"
     description: str = "Split text into chunks of a specified length based on language."
     documentation: str = "https://docs.langflow.org/components/text-splitters#languagerecursivetextsplitter"
+    execution_class = "thread"
 
     def build_config(self):
         options = [x.value for x in Language]
@@ -73,6 +76,9 @@ class LanguageRecursiveTextSplitterComponent(CustomComponent):
             chunk_size=chunk_size,
             chunk_overlap=chunk_overlap,
         )
+        if contains_stream(inputs):
+            self.status = "Splitting a data stream."
+            return DataStream(partial(iter_split_data, splitter, inputs), "Split data stream")  # type: ignore
         documents = []
         for _input in inputs:
             if isinstance(_input, Data):
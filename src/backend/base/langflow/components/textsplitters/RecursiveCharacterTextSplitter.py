@@ -1,5 +1,8 @@
+from functools import partial
+
 from langchain_text_splitters import RecursiveCharacterTextSplitter
 
+from langflow.base.data.ingestion import DataStream, contains_stream, iter_split_data
 from langflow.custom import Component
 from langflow.inputs.inputs import DataInput, IntInput, MessageTextInput
 from langflow.schema import Data
@@ -11,6 +14,7 @@ class RecursiveCharacterTextSplitterComponent(Component):
     display_name: str = "Recursive Character Text Splitter"
     description: str = "Split text into chunks of a specified length."
     documentation: str = "https://docs.langflow.org/components/text-splitters#recursivecharactertextsplitter"
+    execution_class = "process"
 
     inputs = [
         IntInput(
@@ -72,6 +76,11 @@ class RecursiveCharacterTextSplitterComponent(Component):
             chunk_size=self.chunk_size,
             chunk_overlap=self.chunk_overlap,
         )
+        if contains_stream(self.data_input):
+            # Nothing is split here, the documents are split in the process pool as the stream is consumed
+            data_input = self.data_input
+            self.repr_value = "Splitting a data stream."
+            return DataStream(partial(iter_split_data, splitter, data_input), "Split data stream")  # type: ignore
         documents = []
         if not isinstance(self.data_input, list):
             self.data_input: list[Data] = [self.data_input]
@@ -1,5 +1,6 @@
 from loguru import logger
 
+from langflow.base.data.ingestion import add_documents_in_batches, contains_stream, iter_inputs
 from langflow.base.vectorstores.model import LCVectorStoreComponent
 from langflow.io import (
     BoolInput,
@@ -204,13 +205,21 @@ class AstraVectorStoreComponent(LCVectorStoreComponent):
         return vector_store
 
     def _add_documents_to_vector_store(self, vector_store):
-        documents = []
-        for _input in self.ingest_data or []:
-            if isinstance(_input, Data):
-                documents.append(_input.to_lc_document())
-            else:
-                raise ValueError("Vector Store Inputs must be Data objects.")
+        def iter_documents():
+            for _input in iter_inputs(self.ingest_data):
+                if isinstance(_input, Data):
+                    yield _input.to_lc_document()
+                else:
+                    raise ValueError("Vector Store Inputs must be Data objects.")
+
+        if contains_stream(self.ingest_data) and self.embedding is not None:
+            try:
+                add_documents_in_batches(vector_store.add_documents, iter_documents())
+            except Exception as e:
+                raise ValueError(f"Error adding documents to AstraDBVectorStore: {str(e)}") from e
+            return
 
+        documents = list(iter_documents())
         if documents and self.embedding is not None:
             logger.debug(f"Adding {len(documents)} documents to the Vector Store.")
             try:
@@ -2,6 +2,7 @@ from typing import List, Optional
 
 from langchain_community.vectorstores import Cassandra
 
+from langflow.base.vectorstores.connections import borrow_client, connect_cassio
 from langflow.base.vectorstores.model import LCVectorStoreComponent
 from langflow.helpers.data import docs_to_data
 from langflow.inputs import DictInput
@@ -106,7 +107,7 @@ class CassandraVectorStoreComponent(LCVectorStoreComponent):
 
     def _build_cassandra(self) -> Cassandra:
         try:
-            import cassio
+            import cassio  # noqa: F401
         except ImportError:
             raise ImportError(
                 "Could not import cassio integration package. " "Please install it with `pip install cassio`."
@@ -125,19 +126,32 @@ class CassandraVectorStoreComponent(LCVectorStoreComponent):
                 # use a copy because we can't change the type of the parameter
                 database_ref = self.database_ref.split(",")
 
-        if is_astra:
-            cassio.init(
-                database_id=database_ref,
-                token=self.token,
-                cluster_kwargs=self.cluster_kwargs,
-            )
-        else:
-            cassio.init(
+        def connect():
+            if is_astra:
+                return connect_cassio(database_id=database_ref, token=self.token, cluster_kwargs=self.cluster_kwargs)
+            return connect_cassio(
                 contact_points=database_ref,
                 username=self.username,
                 password=self.token,
                 cluster_kwargs=self.cluster_kwargs,
             )
+
+        # The session is passed to the store explicitly, so runs connected to other clusters
+        # do not change it through the cassio defaults
+        session, default_keyspace = borrow_client(
+            "cassandra",
+            {
+                "database_ref": self.database_ref,
+                "username": self.username,
+                "token": self.token,
+                "cluster_kwargs": self.cluster_kwargs,
+            },
+            connect,
+            health_check=lambda client: client[0].execute("SELECT release_version FROM system.local"),
+            close=lambda client: client[0].cluster.shutdown(),
+            owner=self,
+        )
+        keyspace = self.keyspace or default_keyspace
         ttl_seconds: Optional[int] = self.ttl_seconds
 
         documents = []
@@ -152,8 +166,9 @@ class CassandraVectorStoreComponent(LCVectorStoreComponent):
             table = Cassandra.from_documents(
                 documents=documents,
                 embedding=self.embedding,
+                session=session,
                 table_name=self.table_name,
-                keyspace=self.keyspace,
+                keyspace=keyspace,
                 ttl_seconds=ttl_seconds,
                 batch_size=self.batch_size,
                 body_index_options=self.body_index_options,
@@ -162,8 +177,9 @@ class CassandraVectorStoreComponent(LCVectorStoreComponent):
         else:
             table = Cassandra(
                 embedding=self.embedding,
+                session=session,
                 table_name=self.table_name,
-                keyspace=self.keyspace,
+                keyspace=keyspace,
                 ttl_seconds=ttl_seconds,
                 body_index_options=self.body_index_options,
                 setup_mode=self.setup_mode,
@@ -5,6 +5,7 @@ from chromadb.config import Settings
 from langchain_chroma.vectorstores import Chroma
 from loguru import logger
 
+from langflow.base.data.ingestion import add_documents_in_batches, contains_stream, iter_inputs
 from langflow.base.vectorstores.model import LCVectorStoreComponent
 from langflow.base.vectorstores.utils import chroma_collection_to_data
 from langflow.io import BoolInput, DataInput, DropdownInput, HandleInput, IntInput, StrInput, MultilineInput
@@ -155,14 +156,20 @@ class ChromaVectorStoreComponent(LCVectorStoreComponent):
                 del value.id
                 _stored_documents_without_id.append(value)
 
-        documents = []
-        for _input in self.ingest_data or []:
-            if isinstance(_input, Data):
-                if _input not in _stored_documents_without_id:
-                    documents.append(_input.to_lc_document())
-            else:
-                raise ValueError("Vector Store Inputs must be Data objects.")
+        def iter_new_documents():
+            for _input in iter_inputs(self.ingest_data):
+                if isinstance(_input, Data):
+                    if _input not in _stored_documents_without_id:
+                        yield _input.to_lc_document()
+                else:
+                    raise ValueError("Vector Store Inputs must be Data objects.")
 
+        if contains_stream(self.ingest_data):
+            if self.embedding is not None:
+                add_documents_in_batches(vector_store.add_documents, iter_new_documents())
+            return
+
+        documents = list(iter_new_documents())
         if documents and self.embedding is not None:
             logger.debug(f"Adding {len(documents)} documents to the Vector Store.")
             vector_store.add_documents(documents)
@@ -3,6 +3,7 @@ from typing import List
 from langchain_community.vectorstores import FAISS
 from loguru import logger
 
+from langflow.base.data.ingestion import contains_stream, get_ingestion_batch_size, iter_batches, iter_documents
 from langflow.base.vectorstores.model import LCVectorStoreComponent
 from langflow.helpers.data import docs_to_data
 from langflow.io import BoolInput, DataInput, HandleInput, IntInput, MultilineInput, StrInput
@@ -18,6 +19,7 @@ class FaissVectorStoreComponent(LCVectorStoreComponent):
     description: str = "FAISS Vector Store with search capabilities"
     documentation = "https://python.langchain.com/docs/modules/data_connection/vectorstores/integrations/faiss"
     icon = "FAISS"
+    execution_class = "thread"
 
     inputs = [
         StrInput(
@@ -64,6 +66,18 @@ class FaissVectorStoreComponent(LCVectorStoreComponent):
             raise ValueError("Folder path is required to save the FAISS index.")
         path = self.resolve_path(self.persist_directory)
 
+        if contains_stream(self.ingest_data):
+            faiss = None
+            for batch in iter_batches(iter_documents(self.ingest_data), get_ingestion_batch_size()):
+                if faiss is None:
+                    faiss = FAISS.from_documents(documents=batch, embedding=self.embedding)
+                else:
+                    faiss.add_documents(batch)
+            if faiss is None:
+                raise ValueError("The data stream is empty, there is nothing to index.")
+            faiss.save_local(str(path), self.index_name)
+            return faiss
+
         documents = []
 
         for _input in self.ingest_data or []:
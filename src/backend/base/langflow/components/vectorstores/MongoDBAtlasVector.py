@@ -2,6 +2,7 @@ from typing import List
 
 from langchain_community.vectorstores import MongoDBAtlasVectorSearch
 
+from langflow.base.vectorstores.connections import borrow_client
 from langflow.base.vectorstores.model import LCVectorStoreComponent
 from langflow.helpers.data import docs_to_data
 from langflow.io import HandleInput, IntInput, StrInput, SecretStrInput, DataInput, MultilineInput
@@ -45,7 +46,14 @@ class MongoVectorStoreComponent(LCVectorStoreComponent):
             raise ImportError("Please install pymongo to use MongoDB Atlas Vector Store")
 
         try:
-            mongo_client: MongoClient = MongoClient(self.mongodb_atlas_cluster_uri)
+            mongo_client: MongoClient = borrow_client(
+                "mongodb",
+                {"uri": self.mongodb_atlas_cluster_uri},
+                lambda: MongoClient(self.mongodb_atlas_cluster_uri),
+                health_check=lambda client: client.admin.command("ping"),
+                close=lambda client: client.close(),
+                owner=self,
+            )
             collection = mongo_client[self.db_name][self.collection_name]
         except Exception as e:
             raise ValueError(f"Failed to connect to MongoDB Atlas: {e}")
@@ -2,6 +2,7 @@ from typing import List
 
 from langchain_community.vectorstores import Qdrant
 
+from langflow.base.vectorstores.connections import borrow_client
 from langflow.base.vectorstores.model import LCVectorStoreComponent
 from langflow.helpers.data import docs_to_data
 from langflow.io import (
@@ -94,7 +95,14 @@ class QdrantVectorStoreComponent(LCVectorStoreComponent):
         else:
             from qdrant_client import QdrantClient
 
-            client = QdrantClient(**server_kwargs)
+            client = borrow_client(
+                "qdrant",
+                server_kwargs,
+                lambda: QdrantClient(**server_kwargs),
+                health_check=lambda client: client.get_collections(),
+                close=lambda client: client.close(),
+                owner=self,
+            )
             qdrant = Qdrant(embedding_function=self.embedding.embed_query, client=client, **qdrant_kwargs)
 
         return qdrant
@@ -3,6 +3,7 @@ from typing import List
 from langchain_community.vectorstores import SupabaseVectorStore
 from supabase.client import Client, create_client
 
+from langflow.base.vectorstores.connections import borrow_client
 from langflow.base.vectorstores.model import LCVectorStoreComponent
 from langflow.helpers.data import docs_to_data
 from langflow.io import HandleInput, IntInput, StrInput, SecretStrInput, DataInput, MultilineInput
@@ -40,7 +41,12 @@ class SupabaseVectorStoreComponent(LCVectorStoreComponent):
         return self._build_supabase()
 
     def _build_supabase(self) -> SupabaseVectorStore:
-        supabase: Client = create_client(self.supabase_url, supabase_key=self.supabase_service_key)
+        supabase: Client = borrow_client(
+            "supabase",
+            {"url": self.supabase_url, "key": self.supabase_service_key},
+            lambda: create_client(self.supabase_url, supabase_key=self.supabase_service_key),
+            owner=self,
+        )
 
         documents = []
         for _input in self.ingest_data or []:
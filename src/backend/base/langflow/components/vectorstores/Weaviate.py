@@ -3,6 +3,7 @@ from typing import List
 import weaviate  # type: ignore
 from langchain_community.vectorstores import Weaviate
 
+from langflow.base.vectorstores.connections import borrow_client
 from langflow.base.vectorstores.model import LCVectorStoreComponent
 from langflow.helpers.data import docs_to_data
 from langflow.io import BoolInput, HandleInput, IntInput, StrInput, SecretStrInput, DataInput, MultilineInput
@@ -41,11 +42,19 @@ class WeaviateVectorStoreComponent(LCVectorStoreComponent):
         return self._build_weaviate()
 
     def _build_weaviate(self) -> Weaviate:
-        if self.api_key:
-            auth_config = weaviate.AuthApiKey(api_key=self.api_key)
-            client = weaviate.Client(url=self.url, auth_client_secret=auth_config)
-        else:
-            client = weaviate.Client(url=self.url)
+        def create_client():
+            if self.api_key:
+                auth_config = weaviate.AuthApiKey(api_key=self.api_key)
+                return weaviate.Client(url=self.url, auth_client_secret=auth_config)
+            return weaviate.Client(url=self.url)
+
+        client = borrow_client(
+            "weaviate",
+            {"url": self.url, "api_key": self.api_key},
+            create_client,
+            health_check=lambda client: client.is_ready(),
+            owner=self,
+        )
 
         documents = []
         for _input in self.ingest_data or []:
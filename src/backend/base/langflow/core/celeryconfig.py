@@ -16,3 +16,6 @@ else:
     result_backend = os.environ.get("RESULT_BACKEND", "redis://localhost:6379/0")
 # tasks should be json or pickle
 accept_content = ["json", "pickle"]
+# every worker also consumes its own queue (<hostname>.dq), which is how
+# the graph executor sends a vertex to the worker holding its inputs
+worker_direct = True
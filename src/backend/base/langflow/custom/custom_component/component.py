@@ -1,3 +1,4 @@
+import copy
 import inspect
 from typing import Any, AsyncIterator, Callable, ClassVar, Generator, Iterator, List, Optional, Union
 from uuid import UUID
@@ -12,6 +13,16 @@ from langflow.schema.message import Message
 from langflow.template.field.base import UNDEFINED, Output
 
 from .custom_component import CustomComponent
+from .execution import run_sync_method
+
+
+def copy_input(input_: InputTypes) -> InputTypes:
+    """Copies an input and its list, dict and set fields, the only ones a component changes in place."""
+    copied = input_.model_copy()
+    for name, value in copied.__dict__.items():
+        if isinstance(value, (list, dict, set)):
+            copied.__dict__[name] = copy.copy(value)
+    return copied
 
 
 def recursive_serialize_or_str(obj):
@@ -57,6 +68,9 @@ class Component(CustomComponent):
         raise AttributeError(f"{name} not found in {self.__class__.__name__}")
 
     def map_inputs(self, inputs: List[InputTypes]):
+        # The inputs are declared on the class, which is shared by every instance built from the same code,
+        # so each instance sets the values on its own copies
+        inputs = [copy_input(input_) for input_ in inputs]
         self.inputs = inputs
         for input_ in inputs:
             if input_.name is None:
@@ -142,10 +156,11 @@ class Component(CustomComponent):
                     if output.cache and output.value != UNDEFINED:
                         _results[output.name] = output.value
                     else:
-                        result = method()
                         # If the method is asynchronous, we need to await it
                         if inspect.iscoroutinefunction(method):
-                            result = await result
+                            result = await method()
+                        else:
+                            result = await run_sync_method(self, output.method)
                         if (
                             isinstance(result, Message)
                             and result.flow_id is None
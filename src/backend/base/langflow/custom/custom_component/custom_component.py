@@ -74,6 +74,9 @@ class CustomComponent(BaseComponent):
     vertex: Optional["Vertex"] = None
     """The edge target parameter of the component. Defaults to None."""
     code_class_base_inheritance: ClassVar[str] = "CustomComponent"
+    execution_class: ClassVar[Optional[str]] = None
+    """Where the sync build methods run: 'asyncio', 'thread' or 'process' (see `execution.py`).
+    Defaults to None, which uses the `component_default_execution_class` setting."""
     function_entrypoint_name: ClassVar[str] = "build"
     function: Optional[Callable] = None
     repr_value: Optional[Any] = ""
@@ -0,0 +1,174 @@
+"""
+Where the sync output methods of components run.
+
+Async methods always run on the event loop. A sync method runs according to the execution class
+of its component:
+
+- `asyncio`: called directly on the event loop, which blocks every other request of the worker
+  while it runs. This is the default, for methods that return right away.
+- `thread`: called in a thread pool. Fits methods that wait on IO or release the GIL, such as
+  loading a local embedding model or building a vector index.
+- `process`: called in a process pool. Fits pure Python CPU-bound methods, such as text splitting.
+  The component is rebuilt in the child process from its code and attributes, so methods that use
+  the vertex, the graph or services with local state should not use it. Components whose attributes
+  cannot be pickled fall back to the thread pool.
+
+The size of each pool is the concurrency limit of its class.
+"""
+
+import asyncio
+import contextvars
+import multiprocessing
+import pickle
+import threading
+from concurrent.futures import Future, ProcessPoolExecutor, ThreadPoolExecutor
+from functools import partial
+from typing import TYPE_CHECKING, Any, Callable, Optional, Tuple
+
+from loguru import logger
+
+if TYPE_CHECKING:
+    from langflow.custom.custom_component.custom_component import CustomComponent
+
+EXECUTION_CLASSES = ("asyncio", "thread", "process")
+
+
+class ExecutionPools:
+    """The thread and process pools sync component methods are offloaded to. Both are created on first use."""
+
+    def __init__(self, thread_workers: Optional[int] = None, process_workers: Optional[int] = None):
+        self.thread_workers = thread_workers
+        self.process_workers = process_workers
+        self._threads: Optional[ThreadPoolExecutor] = None
+        self._processes: Optional[ProcessPoolExecutor] = None
+        self._lock = threading.Lock()
+
+    def _get_threads(self) -> ThreadPoolExecutor:
+        with self._lock:
+            if self._threads is None:
+                self._threads = ThreadPoolExecutor(max_workers=self.thread_workers, thread_name_prefix="component")
+            return self._threads
+
+    def _get_processes(self) -> ProcessPoolExecutor:
+        with self._lock:
+            if self._processes is None:
+                # Forking a process that runs threads and an event loop is not safe
+                self._processes = ProcessPoolExecutor(
+                    max_workers=self.process_workers, mp_context=multiprocessing.get_context("spawn")
+                )
+            return self._processes
+
+    async def run_in_thread(self, func: Callable, *args: Any) -> Any:
+        """Runs `func` in the thread pool, with the context variables of the caller."""
+        context = contextvars.copy_context()
+        loop = asyncio.get_running_loop()
+        return await loop.run_in_executor(self._get_threads(), partial(context.run, func, *args))
+
+    async def run_in_process(self, func: Callable, *args: Any) -> Any:
+        """Runs `func` in the process pool. `func` and `args` must be picklable."""
+        loop = asyncio.get_running_loop()
+        return await loop.run_in_executor(self._get_processes(), func, *args)
+
+    def submit_to_thread(self, func: Callable, *args: Any) -> Future:
+        return self._get_threads().submit(func, *args)
+
+    def submit_to_process(self, func: Callable, *args: Any) -> Future:
+        """Submits `func` to the process pool from sync code, such as a stream consumed in a thread."""
+        return self._get_processes().submit(func, *args)
+
+    def shutdown(self) -> None:
+        with self._lock:
+            if self._threads is not None:
+                self._threads.shutdown(wait=False, cancel_futures=True)
+                self._threads = None
+            if self._processes is not None:
+                self._processes.shutdown(wait=False, cancel_futures=True)
+                self._processes = None
+
+
+_pools: Optional[ExecutionPools] = None
+_pools_lock = threading.Lock()
+
+
+def get_execution_pools() -> ExecutionPools:
+    global _pools
+    with _pools_lock:
+        if _pools is None:
+            from langflow.services.deps import get_settings_service
+
+            settings = get_settings_service().settings
+            _pools = ExecutionPools(settings.component_thread_pool_size, settings.component_process_pool_size)
+        return _pools
+
+
+def shutdown_execution_pools() -> None:
+    global _pools
+    with _pools_lock:
+        if _pools is not None:
+            _pools.shutdown()
+            _pools = None
+
+
+def get_execution_class(component: "CustomComponent") -> str:
+    """
+    Returns the execution class of the sync methods of a component.
+
+    The class set for its class name in `component_execution_classes` comes first, then the
+    `execution_class` the component declares, then `component_default_execution_class`.
+    """
+    from langflow.services.deps import get_settings_service
+
+    settings = get_settings_service().settings
+    execution_class = (
+        settings.component_execution_classes.get(type(component).__name__)
+        or getattr(component, "execution_class", None)
+        or settings.component_default_execution_class
+    )
+    if execution_class not in EXECUTION_CLASSES:
+        logger.warning(f"Unknown execution class {execution_class} of {type(component).__name__}, using asyncio")
+        return "asyncio"
+    return execution_class
+
+
+async def run_sync_method(component: "CustomComponent", method_name: str, *args: Any, **kwargs: Any) -> Any:
+    """Calls a sync method of a component according to its execution class."""
+    method = getattr(component, method_name)
+    execution_class = get_execution_class(component)
+    if execution_class == "asyncio":
+        return method(*args, **kwargs)
+    pools = get_execution_pools()
+    if execution_class == "process" and not args and not kwargs:
+        if (payload := _pickle_component(component)) is not None:
+            code, attributes, user_id = payload
+            result, status, repr_value = await pools.run_in_process(
+                _run_component_method, code, attributes, user_id, method_name
+            )
+            component.status = status
+            component.repr_value = repr_value
+            return result
+    return await pools.run_in_thread(partial(method, *args, **kwargs))
+
+
+def _pickle_component(component: "CustomComponent") -> Optional[Tuple[str, bytes, Optional[str]]]:
+    code = component.vertex.params.get("code") if component.vertex is not None else None
+    if not isinstance(code, str):
+        return None
+    try:
+        attributes = pickle.dumps(getattr(component, "_attributes", {}))
+    except Exception as exc:
+        logger.debug(f"Running {type(component).__name__} in a thread, its attributes cannot be pickled: {exc}")
+        return None
+    user_id = str(component.user_id) if component.user_id is not None else None
+    return code, attributes, user_id
+
+
+def _run_component_method(
+    code: str, attributes: bytes, user_id: Optional[str], method_name: str
+) -> Tuple[Any, Any, Any]:
+    # Runs in the child process
+    from langflow.custom.eval import eval_custom_component_code
+
+    component = eval_custom_component_code(code)(user_id=user_id)
+    component._attributes = pickle.loads(attributes)
+    result = getattr(component, method_name)()
+    return result, component.status, component.repr_value
@@ -0,0 +1,173 @@
+import hashlib
+import importlib.metadata
+import os
+import tempfile
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Tuple
+
+import orjson
+from loguru import logger
+
+from langflow.utils.version import get_version_info
+
+SNAPSHOT_SCHEMA_VERSION = 2
+SNAPSHOT_FILE_NAME = "component_registry.json"
+
+
+class ComponentRegistrySnapshot:
+    """
+    An on-disk copy of the component templates built from the component files.
+
+    Each file has its own entry, keyed by its path, with the size, modification time and hash the
+    templates were built from. A file whose size or modification time changed is hashed again and only
+    rebuilt if its content changed. The whole snapshot is discarded when the Langflow version or any
+    installed distribution changes, since the templates also depend on the installed code. Files with
+    a component that failed to build, e.g. on a missing dependency, are not written to disk, so they
+    are built again by the next start.
+    """
+
+    def __init__(self, path: str | Path):
+        self.path = Path(path)
+        self.version = get_version_info()["version"]
+        self.distributions = get_distributions_fingerprint()
+        self._entries: Dict[str, Dict[str, Any]] = {}
+        self._dirty = False
+
+    @classmethod
+    def load(cls, path: str | Path) -> "ComponentRegistrySnapshot":
+        """Loads the snapshot at `path`. Missing, unreadable or outdated snapshots are loaded empty."""
+        snapshot = cls(path)
+        if not snapshot.path.exists():
+            return snapshot
+        try:
+            data = orjson.loads(snapshot.path.read_bytes())
+        except (OSError, orjson.JSONDecodeError) as exc:
+            logger.warning(f"Could not read the component registry snapshot {snapshot.path}: {exc}")
+            return snapshot
+        if (
+            data.get("schema_version") != SNAPSHOT_SCHEMA_VERSION
+            or data.get("langflow_version") != snapshot.version
+            or data.get("distributions") != snapshot.distributions
+        ):
+            logger.debug("The component registry snapshot was written with other installed packages, rebuilding it")
+            return snapshot
+        snapshot._entries = data.get("entries", {})
+        return snapshot
+
+    def save(self) -> None:
+        """Writes the snapshot if it changed since it was loaded."""
+        if not self._dirty:
+            return
+        data = {
+            "schema_version": SNAPSHOT_SCHEMA_VERSION,
+            "langflow_version": self.version,
+            "distributions": self.distributions,
+            "entries": {
+                file_path: entry
+                for file_path, entry in self._entries.items()
+                if all(component["valid"] for component in entry["components"])
+            },
+        }
+        try:
+            content = orjson.dumps(data, option=orjson.OPT_NON_STR_KEYS)
+            self.path.parent.mkdir(parents=True, exist_ok=True)
+            # Written next to the snapshot and renamed so concurrent workers never read a partial file
+            with tempfile.NamedTemporaryFile(dir=self.path.parent, delete=False, suffix=".tmp") as file:
+                file.write(content)
+            os.replace(file.name, self.path)
+            self._dirty = False
+        except (OSError, TypeError) as exc:
+            logger.warning(f"Could not write the component registry snapshot {self.path}: {exc}")
+
+    def split_files(self, file_paths: List[str]) -> Tuple[List[str], List[str]]:
+        """
+        Splits the files into the ones the snapshot is up to date for and the ones that have to be built.
+
+        Returns:
+            Tuple[List[str], List[str]]: The fresh files and the stale ones.
+        """
+        fresh, stale = [], []
+        for file_path in file_paths:
+            (fresh if self._is_fresh(file_path) else stale).append(file_path)
+        return fresh, stale
+
+    def _is_fresh(self, file_path: str) -> bool:
+        entry = self._entries.get(file_path)
+        if entry is None:
+            return False
+        try:
+            stat = os.stat(file_path)
+        except OSError:
+            return False
+        if entry["mtime_ns"] == stat.st_mtime_ns and entry["size"] == stat.st_size:
+            return True
+        # Touched but maybe not changed, e.g. by a checkout or a copy into a container image
+        if entry["sha256"] != _hash_file(file_path):
+            return False
+        entry["mtime_ns"] = stat.st_mtime_ns
+        entry["size"] = stat.st_size
+        self._dirty = True
+        return True
+
+    def set_components(self, file_path: str, components: List[Dict[str, Any]]) -> None:
+        """
+        Stores the components built from a file.
+
+        Args:
+            file_path (str): The path of the file.
+            components (List[Dict[str, Any]]): One dict per component with its `menu`, `name`, `template`
+                and whether it is `valid`.
+        """
+        try:
+            stat = os.stat(file_path)
+        except OSError:
+            self._entries.pop(file_path, None)
+            return
+        self._entries[file_path] = {
+            "mtime_ns": stat.st_mtime_ns,
+            "size": stat.st_size,
+            "sha256": _hash_file(file_path),
+            "components": components,
+        }
+        self._dirty = True
+
+    def build_menu(self, file_paths: List[str]) -> Dict[str, Dict[str, Any]]:
+        """
+        Builds the menu of the given files from the snapshot, in the shape `build_valid_menu` returns.
+
+        Invalid components are added after the valid ones so they take precedence over them,
+        like `merge_nested_dicts_with_renaming` does when building from the files.
+        """
+        components = [
+            component
+            for file_path in file_paths
+            if file_path in self._entries
+            for component in self._entries[file_path]["components"]
+        ]
+        menu: Dict[str, Dict[str, Any]] = {}
+        for component in sorted(components, key=lambda component: not component["valid"]):
+            menu.setdefault(component["menu"], {})[component["name"]] = component["template"]
+        return menu
+
+
+def get_distributions_fingerprint() -> str:
+    """Hashes the names and versions of the installed distributions."""
+    distributions = sorted(
+        f"{distribution.metadata['Name']}=={distribution.version}"
+        for distribution in importlib.metadata.distributions()
+    )
+    return hashlib.sha256("\n".join(distributions).encode("utf-8")).hexdigest()
+
+
+def _hash_file(file_path: str) -> str:
+    with open(file_path, "rb") as file:
+        return hashlib.sha256(file.read()).hexdigest()
+
+
+def get_snapshot_path(config_dir: Optional[str], snapshot_path: Optional[str] = None) -> Optional[Path]:
+    """Returns where the snapshot is stored, which defaults to the config directory."""
+    if snapshot_path:
+        return Path(snapshot_path)
+    if config_dir:
+        return Path(config_dir) / SNAPSHOT_FILE_NAME
+    return None
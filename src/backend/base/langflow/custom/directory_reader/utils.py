@@ -1,6 +1,10 @@
+import os
+from typing import Dict, List, Optional
+
 from loguru import logger
 
 from langflow.custom.directory_reader import DirectoryReader
+from langflow.custom.directory_reader.snapshot import ComponentRegistrySnapshot
 from langflow.template.frontend_node.custom_components import CustomComponentFrontendNode
 
 
@@ -81,17 +85,54 @@ def build_custom_component_list_from_path(path: str):
     return merge_nested_dicts_with_renaming(valid_menu, invalid_menu)
 
 
-async def abuild_custom_component_list_from_path(path: str):
-    """Build a list of custom components for the langchain from a given path"""
+async def abuild_custom_component_list_from_path(path: str, snapshot: Optional[ComponentRegistrySnapshot] = None):
+    """
+    Build a list of custom components for the langchain from a given path
+
+    If a snapshot is given, only the files it is not up to date for are built, and their components
+    are stored in it.
+    """
     file_list = load_files_from_path(path)
     reader = DirectoryReader(path, False)
+    if snapshot is None:
+        valid_components, invalid_components = await abuild_and_validate_all_files(reader, file_list)
 
-    valid_components, invalid_components = await abuild_and_validate_all_files(reader, file_list)
+        valid_menu = build_valid_menu(valid_components)
+        invalid_menu = build_invalid_menu(invalid_components)
 
-    valid_menu = build_valid_menu(valid_components)
-    invalid_menu = build_invalid_menu(invalid_components)
+        return merge_nested_dicts_with_renaming(valid_menu, invalid_menu)
 
-    return merge_nested_dicts_with_renaming(valid_menu, invalid_menu)
+    _, stale_files = snapshot.split_files(file_list)
+    if stale_files:
+        logger.debug(f"Building {len(stale_files)} of {len(file_list)} component files from {path}")
+        valid_components, invalid_components = await abuild_and_validate_all_files(reader, stale_files)
+        built_components = group_components_by_file(valid_components, invalid_components)
+        for file_path in stale_files:
+            snapshot.set_components(file_path, built_components.get(file_path, []))
+    return snapshot.build_menu(file_list)
+
+
+def group_components_by_file(valid_components, invalid_components) -> Dict[str, List[dict]]:
+    """Group the built valid and invalid components by the file they were built from."""
+    components_by_file: Dict[str, List[dict]] = {}
+    for menu_item in valid_components["menu"]:
+        for component_name, component_template, component in menu_item["components"]:
+            file_path = os.path.join(menu_item["path"], component["file"])
+            components_by_file.setdefault(file_path, []).append(
+                {"menu": menu_item["name"], "name": component_name, "template": component_template, "valid": True}
+            )
+    for menu_item in invalid_components["menu"]:
+        for _, _, component in menu_item["components"]:
+            try:
+                component_name, component_template = build_invalid_component(component)
+            except Exception as exc:
+                logger.exception(f"Error while creating custom component [{component['name']}]: {str(exc)}")
+                continue
+            file_path = os.path.join(menu_item["path"], component["file"])
+            components_by_file.setdefault(file_path, []).append(
+                {"menu": menu_item["name"], "name": component_name, "template": component_template, "valid": False}
+            )
+    return components_by_file
 
 
 def create_invalid_component_template(component, component_name):
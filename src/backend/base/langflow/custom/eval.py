@@ -1,3 +1,6 @@
+import hashlib
+import threading
+from collections import OrderedDict
 from typing import TYPE_CHECKING, Type
 
 from langflow.utils import validate
@@ -5,8 +8,34 @@ from langflow.utils import validate
 if TYPE_CHECKING:
     from langflow.custom import CustomComponent
 
+# Classes compiled by this process, keyed by the hash of their code
+CLASS_CACHE_SIZE = 512
+_class_cache: OrderedDict[str, Type["CustomComponent"]] = OrderedDict()
+_class_cache_lock = threading.Lock()
+
 
 def eval_custom_component_code(code: str) -> Type["CustomComponent"]:
-    """Evaluate custom component code"""
+    """
+    Evaluate custom component code
+
+    The result is cached by the hash of the code, so every build of the same component reuses
+    the same class instead of executing its code again.
+    """
+    code_hash = hashlib.sha256(code.encode("utf-8")).hexdigest()
+    with _class_cache_lock:
+        if (cached_class := _class_cache.get(code_hash)) is not None:
+            _class_cache.move_to_end(code_hash)
+            return cached_class
+
     class_name = validate.extract_class_name(code)
-    return validate.create_class(code, class_name)
+    custom_class = validate.create_class(code, class_name)
+    with _class_cache_lock:
+        _class_cache[code_hash] = custom_class
+        if len(_class_cache) > CLASS_CACHE_SIZE:
+            _class_cache.popitem(last=False)
+    return custom_class
+
+
+def clear_class_cache() -> None:
+    with _class_cache_lock:
+        _class_cache.clear()
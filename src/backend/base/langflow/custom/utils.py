@@ -12,6 +12,7 @@ from pydantic import BaseModel
 
 from langflow.custom import CustomComponent
 from langflow.custom.custom_component.component import Component
+from langflow.custom.directory_reader.snapshot import ComponentRegistrySnapshot
 from langflow.custom.directory_reader.utils import (
     abuild_custom_component_list_from_path,
     build_custom_component_list_from_path,
@@ -460,8 +461,8 @@ def build_custom_components(components_paths: List[str]):
     return custom_components_from_file
 
 
-async def abuild_custom_components(components_paths: List[str]):
-    """Build custom components from the specified paths."""
+async def abuild_custom_components(components_paths: List[str], snapshot: Optional[ComponentRegistrySnapshot] = None):
+    """Build custom components from the specified paths, reusing the up to date ones of the snapshot if given."""
     if not components_paths:
         return {}
 
@@ -473,7 +474,7 @@ async def abuild_custom_components(components_paths: List[str]):
         if path_str in processed_paths:
             continue
 
-        custom_component_dict = await abuild_custom_component_list_from_path(path_str)
+        custom_component_dict = await abuild_custom_component_list_from_path(path_str, snapshot=snapshot)
         if custom_component_dict:
             category = next(iter(custom_component_dict))
             logger.info(f"Loading {len(custom_component_dict[category])} component(s) from category {category}")
@@ -1,4 +1,4 @@
-from typing import TYPE_CHECKING, Any, List, Optional
+from typing import TYPE_CHECKING, Any, List, Optional, Tuple
 
 from loguru import logger
 from pydantic import BaseModel, Field, field_validator
@@ -37,17 +37,29 @@ class TargetHandle(BaseModel):
 
 
 class Edge:
-    def __init__(self, source: "Vertex", target: "Vertex", edge: dict):
+    def __init__(
+        self,
+        source: "Vertex",
+        target: "Vertex",
+        edge: dict,
+        handles: Optional[Tuple[SourceHandle, TargetHandle]] = None,
+    ):
         self.source_id: str = source.id if source else ""
         self.target_id: str = target.id if target else ""
         if data := edge.get("data", {}):
             self._source_handle = data.get("sourceHandle", {})
             self._target_handle = data.get("targetHandle", {})
-            self.source_handle: SourceHandle = SourceHandle(**self._source_handle)
-            self.target_handle: TargetHandle = TargetHandle(**self._target_handle)
-            self.target_param = self.target_handle.fieldName
-            # validate handles
-            self.validate_handles(source, target)
+            if handles is not None:
+                # The handles were already parsed and validated when the flow plan was compiled
+                self.source_handle, self.target_handle = handles
+                self.target_param = self.target_handle.fieldName
+                self.valid_handles = True
+            else:
+                self.source_handle: SourceHandle = SourceHandle(**self._source_handle)
+                self.target_handle: TargetHandle = TargetHandle(**self._target_handle)
+                self.target_param = self.target_handle.fieldName
+                # validate handles
+                self.validate_handles(source, target)
         else:
             # Logging here because this is a breaking change
             logger.error("Edge data is empty")
@@ -183,8 +195,14 @@ class Edge:
 
 
 class ContractEdge(Edge):
-    def __init__(self, source: "Vertex", target: "Vertex", raw_edge: dict):
-        super().__init__(source, target, raw_edge)
+    def __init__(
+        self,
+        source: "Vertex",
+        target: "Vertex",
+        raw_edge: dict,
+        handles: Optional[Tuple[SourceHandle, TargetHandle]] = None,
+    ):
+        super().__init__(source, target, raw_edge, handles=handles)
         self.is_fulfilled = False  # Whether the contract has been fulfilled.
         self.result: Any = None
 
@@ -1,31 +1,40 @@
 import asyncio
+import contextlib
+import time
 import traceback
 import uuid
 from collections import defaultdict, deque
 from datetime import datetime, timezone
 from functools import partial
 from itertools import chain
-from typing import TYPE_CHECKING, Any, Dict, Generator, List, Optional, Tuple, Type, Union
+from typing import TYPE_CHECKING, Any, Callable, Coroutine, Dict, Generator, List, Optional, Set, Tuple, Type, Union
 
 from loguru import logger
 
 from langflow.exceptions.component import ComponentBuildException
 from langflow.graph.edge.base import ContractEdge
+from langflow.graph.graph.cancellation import CancellationToken, RunCancelledException
 from langflow.graph.graph.constants import lazy_load_vertex_dict
+from langflow.graph.graph.distributed import CeleryVertexExecutor
+from langflow.graph.graph.profiling import RunProfile
+from langflow.graph.graph.run_context import RunContext
 from langflow.graph.graph.runnable_vertices_manager import RunnableVerticesManager
 from langflow.graph.graph.state_manager import GraphStateManager
+from langflow.graph.graph.token_channel import TokenChannel
 from langflow.graph.graph.utils import process_flow
 from langflow.graph.schema import InterfaceComponentTypes, RunOutputs
-from langflow.graph.vertex.base import Vertex
+from langflow.graph.vertex.base import Vertex, VertexStates
 from langflow.graph.vertex.types import InterfaceVertex, StateVertex
 from langflow.schema import Data
 from langflow.schema.schema import INPUT_FIELD_NAME, InputType
 from langflow.services.cache.utils import CacheMiss
 from langflow.services.chat.service import ChatService
-from langflow.services.deps import get_chat_service, get_tracing_service
+from langflow.services.deps import get_chat_service, get_settings_service, get_tracing_service
+from langflow.services.monitor.metrics import get_metrics, observe_vertex_build, observe_vertex_wait
 from langflow.services.monitor.utils import log_transaction
 
 if TYPE_CHECKING:
+    from langflow.graph.graph.plan import FlowPlan
     from langflow.graph.schema import ResultData
     from langflow.services.tracing.service import TracingService
 
@@ -40,6 +49,7 @@ class Graph:
         flow_id: Optional[str] = None,
         flow_name: Optional[str] = None,
         user_id: Optional[str] = None,
+        plan: Optional["FlowPlan"] = None,
     ) -> None:
         """
         Initializes a new instance of the Graph class.
@@ -48,10 +58,12 @@ class Graph:
             nodes (List[Dict]): A list of dictionaries representing the vertices of the graph.
             edges (List[Dict[str, str]]): A list of dictionaries representing the edges of the graph.
             flow_id (Optional[str], optional): The ID of the flow. Defaults to None.
+            plan (Optional[FlowPlan], optional): A compiled plan to reuse the topology from. Defaults to None.
         """
+        self._plan = plan
         self._vertices = nodes
         self._edges = edges
-        self.raw_graph_data = {"nodes": nodes, "edges": edges}
+        self.raw_graph_data = plan.raw_graph_data if plan else {"nodes": nodes, "edges": edges}
         self._runs = 0
         self._updates = 0
         self.flow_id = flow_id
@@ -61,28 +73,26 @@ class Graph:
         self._is_output_vertices: List[str] = []
         self._is_state_vertices: List[str] = []
         self._has_session_id_vertices: List[str] = []
-        self._sorted_vertices_layers: List[List[str]] = []
-        self._run_id = ""
         self._start_time = datetime.now(timezone.utc)
 
-        self.top_level_vertices = []
-        for vertex in self._vertices:
-            if vertex_id := vertex.get("id"):
-                self.top_level_vertices.append(vertex_id)
-        self._graph_data = process_flow(self.raw_graph_data)
+        if plan is not None:
+            # The plan already holds the ungrouped nodes and edges
+            self.top_level_vertices = list(plan.top_level_vertices)
+            self._graph_data = {"nodes": plan.nodes, "edges": plan.edges}
+        else:
+            self.top_level_vertices = []
+            for vertex in self._vertices:
+                if vertex_id := vertex.get("id"):
+                    self.top_level_vertices.append(vertex_id)
+            self._graph_data = process_flow(self.raw_graph_data)
 
         self._vertices = self._graph_data["nodes"]
         self._edges = self._graph_data["edges"]
-        self.inactivated_vertices: set = set()
-        self.activated_vertices: List[str] = []
-        self.vertices_layers: List[List[str]] = []
-        self.vertices_to_run: set[str] = set()
-        self.stop_vertex: Optional[str] = None
+        self.run_context = RunContext()
 
         self.inactive_vertices: set = set()
         self.edges: List[ContractEdge] = []
         self.vertices: List[Vertex] = []
-        self.run_manager = RunnableVerticesManager()
         self._build_graph()
         self.build_graph_maps(self.edges)
         self.define_vertices_lists()
@@ -103,7 +113,7 @@ class Graph:
         Returns:
             Optional[Data]: The state record, or None if the state does not exist.
         """
-        return self.state_manager.get_state(name, run_id=self._run_id)
+        return self.state_manager.get_state(name, run_id=self.run_context.run_id)
 
     def update_state(self, name: str, record: Union[str, Data], caller: Optional[str] = None) -> None:
         """
@@ -114,6 +124,19 @@ class Graph:
             record (Union[str, Data]): The new state record.
             caller (Optional[str], optional): The ID of the vertex that is updating the state. Defaults to None.
         """
+        # The state vertices are activated by `on_state_changed`, here and in the other graphs of the run
+        self.state_manager.update_state(name, record, run_id=self.run_context.run_id, caller=caller)
+
+    def on_state_changed(self, name: str, record, append: bool = False, caller: Optional[str] = None) -> None:
+        """
+        Observes the states of the run, in this worker and, with the Redis state service, in the others.
+
+        Args:
+            name (str): The name of the state that changed.
+            record: The new state record, or the record appended to it.
+            append (bool): Whether the record was appended.
+            caller (Optional[str], optional): The ID of the vertex that changed the state. Defaults to None.
+        """
         if caller:
             # If there is a caller which is a vertex_id, I want to activate
             # all StateVertex in self.vertices that are not the caller
@@ -121,8 +144,6 @@ class Graph:
             # This also has to activate their successors
             self.activate_state_vertices(name, caller)
 
-        self.state_manager.update_state(name, record, run_id=self._run_id)
-
     def activate_state_vertices(self, name: str, caller: str):
         """
         Activates the state vertices in the graph with the given name and caller.
@@ -175,10 +196,7 @@ class Graph:
             record (Union[str, Data]): The state record to append.
             caller (Optional[str], optional): The ID of the vertex that is updating the state. Defaults to None.
         """
-        if caller:
-            self.activate_state_vertices(name, caller)
-
-        self.state_manager.append_state(name, record, run_id=self._run_id)
+        self.state_manager.append_state(name, record, run_id=self.run_context.run_id, caller=caller)
 
     def validate_stream(self):
         """
@@ -199,6 +217,78 @@ class Graph:
                             f"Components {vertex.display_name} and {successor.display_name} are connected and both have stream or streaming set to True"
                         )
 
+    @property
+    def run_manager(self) -> RunnableVerticesManager:
+        return self.run_context.run_manager
+
+    @run_manager.setter
+    def run_manager(self, run_manager: RunnableVerticesManager):
+        self.run_context.run_manager = run_manager
+
+    @property
+    def cancellation(self) -> CancellationToken:
+        return self.run_context.cancellation
+
+    @cancellation.setter
+    def cancellation(self, cancellation: CancellationToken):
+        self.run_context.cancellation = cancellation
+
+    @property
+    def token_channel(self) -> Optional[TokenChannel]:
+        return self.run_context.token_channel
+
+    @token_channel.setter
+    def token_channel(self, token_channel: Optional[TokenChannel]):
+        self.run_context.token_channel = token_channel
+
+    @property
+    def profile(self) -> Optional[RunProfile]:
+        return self.run_context.profile
+
+    @profile.setter
+    def profile(self, profile: Optional[RunProfile]):
+        self.run_context.profile = profile
+
+    @property
+    def inactivated_vertices(self) -> set:
+        return self.run_context.inactivated_vertices
+
+    @inactivated_vertices.setter
+    def inactivated_vertices(self, vertices_ids: set):
+        self.run_context.inactivated_vertices = vertices_ids
+
+    @property
+    def activated_vertices(self) -> List[str]:
+        return self.run_context.activated_vertices
+
+    @activated_vertices.setter
+    def activated_vertices(self, vertices_ids: List[str]):
+        self.run_context.activated_vertices = vertices_ids
+
+    @property
+    def vertices_layers(self) -> List[List[str]]:
+        return self.run_context.vertices_layers
+
+    @vertices_layers.setter
+    def vertices_layers(self, vertices_layers: List[List[str]]):
+        self.run_context.vertices_layers = vertices_layers
+
+    @property
+    def vertices_to_run(self) -> set[str]:
+        return self.run_context.vertices_to_run
+
+    @vertices_to_run.setter
+    def vertices_to_run(self, vertices_ids: set[str]):
+        self.run_context.vertices_to_run = vertices_ids
+
+    @property
+    def stop_vertex(self) -> Optional[str]:
+        return self.run_context.stop_vertex
+
+    @stop_vertex.setter
+    def stop_vertex(self, vertex_id: Optional[str]):
+        self.run_context.stop_vertex = vertex_id
+
     @property
     def run_id(self):
         """
@@ -210,9 +300,9 @@ class Graph:
         Raises:
             ValueError: If the run ID is not set.
         """
-        if not self._run_id:
+        if not self.run_context.run_id:
             raise ValueError("Run ID not set")
-        return self._run_id
+        return self.run_context.run_id
 
     def set_run_id(self, run_id: uuid.UUID | None = None):
         """
@@ -225,9 +315,10 @@ class Graph:
             run_id = uuid.uuid4()
 
         run_id_str = str(run_id)
-        for vertex in self.vertices:
-            self.state_manager.subscribe(run_id_str, vertex.update_graph_state)
-        self._run_id = run_id_str
+        if self.run_context.run_id and self.run_context.run_id != run_id_str:
+            self.state_manager.unsubscribe(self.run_context.run_id, self.on_state_changed)
+        self.state_manager.subscribe(run_id_str, self.on_state_changed)
+        self.run_context.run_id = run_id_str
         if self.tracing_service:
             self.tracing_service.set_run_id(run_id)
 
@@ -237,7 +328,8 @@ class Graph:
             return
         name = f"{self.flow_name} - {self.flow_id}"
 
-        self.set_run_id()
+        # Keep the current run ID so the run can still be found by it after being restored from the cache
+        self.set_run_id(self.run_context.run_id or None)
         self.tracing_service.set_run_name(name)
 
     async def initialize_run(self):
@@ -260,9 +352,9 @@ class Graph:
         Returns:
             List[List[str]]: The sorted layers of vertices.
         """
-        if not self._sorted_vertices_layers:
+        if not self.run_context.sorted_vertices_layers:
             self.sort_vertices()
-        return self._sorted_vertices_layers
+        return self.run_context.sorted_vertices_layers
 
     def define_vertices_lists(self):
         """
@@ -335,11 +427,12 @@ class Graph:
             logger.exception(exc)
 
         try:
-            start_component_id = next(
-                (vertex_id for vertex_id in self._is_input_vertices if "chat" in vertex_id.lower()), None
-            )
+            start_component_id = self.get_start_component_id()
             await self.process(start_component_id=start_component_id, fallback_to_env_vars=fallback_to_env_vars)
             self.increment_run_count()
+        except RunCancelledException as exc:
+            asyncio.create_task(self.end_all_traces(error=exc.reason))
+            raise
         except Exception as exc:
             logger.exception(exc)
             tb = traceback.format_exc()
@@ -347,13 +440,20 @@ class Graph:
             raise ValueError(f"Error running graph: {exc}") from exc
         finally:
             asyncio.create_task(self.end_all_traces())
+        if self.cancellation.deadline_exceeded:
+            logger.warning(f"Run {self.run_id} exceeded its deadline, returning the outputs built so far")
         # Get the outputs
         vertex_outputs = []
         for vertex in self.vertices:
             if vertex is None:
                 raise ValueError(f"Vertex {vertex_id} not found")
 
-            if not vertex.result and not stream and hasattr(vertex, "consume_async_generator"):
+            if (
+                not vertex.result
+                and not stream
+                and not self.cancellation.deadline_exceeded
+                and hasattr(vertex, "consume_async_generator")
+            ):
                 await vertex.consume_async_generator()
             if (not outputs and vertex.is_output) or (vertex.display_name in outputs or vertex.id in outputs):
                 vertex_outputs.append(vertex.result)
@@ -466,6 +566,135 @@ class Graph:
             vertex_outputs.append(run_output_object)
         return vertex_outputs
 
+    def get_start_component_id(self) -> Optional[str]:
+        """
+        Returns the ID of the input vertex a run starts from, which is the first chat input if any.
+        """
+        return next((vertex_id for vertex_id in self._is_input_vertices if "chat" in vertex_id.lower()), None)
+
+    def get_input_independent_vertices(self) -> List[str]:
+        """
+        Returns the IDs of the vertices whose result does not depend on the inputs of a run, in build order.
+
+        A vertex depends on the run if it is an input, an interface or a state component, if it
+        receives the session ID, or if any of its predecessors depends on the run.
+        """
+        dependent = set(self._is_input_vertices) | set(self._has_session_id_vertices)
+        dependent.update(vertex.id for vertex in self.vertices if vertex.is_state or vertex.is_interface_component)
+        to_visit = list(dependent)
+        while to_visit:
+            for successor_id in self.successor_map.get(to_visit.pop(), []):
+                if successor_id not in dependent:
+                    dependent.add(successor_id)
+                    to_visit.append(successor_id)
+
+        independent = [vertex.id for vertex in self.vertices if vertex.id not in dependent]
+        ordered: List[str] = []
+        remaining = set(independent)
+        while remaining:
+            ready = [
+                vertex_id
+                for vertex_id in independent
+                if vertex_id in remaining
+                and not any(predecessor in remaining for predecessor in self.predecessor_map.get(vertex_id, []))
+            ]
+            if not ready:
+                # A cycle, whose vertices are left to the run
+                break
+            ordered.extend(ready)
+            remaining.difference_update(ready)
+        return ordered
+
+    async def build_shared_vertices(self, vertex_ids: List[str], fallback_to_env_vars: bool = False) -> None:
+        """
+        Builds the given vertices once so other graphs of the same flow can reuse them.
+
+        Args:
+            vertex_ids (List[str]): The vertices to build, in build order (see `get_input_independent_vertices`).
+            fallback_to_env_vars (bool): Whether to fall back to environment variables for global variables.
+        """
+        self.set_run_id()
+        self.set_run_name()
+        await self.initialize_run()
+        try:
+            for vertex_id in vertex_ids:
+                await self.get_vertex(vertex_id).build(user_id=self.user_id, fallback_to_env_vars=fallback_to_env_vars)
+        finally:
+            await self.end_all_traces()
+
+    def share_built_vertices(self, source: "Graph", vertex_ids: List[str]) -> None:
+        """Reuses the vertices built by `source.build_shared_vertices` instead of building them in this graph."""
+        for vertex_id in vertex_ids:
+            source_vertex = source.get_vertex(vertex_id)
+            if source_vertex._built:
+                self.get_vertex(vertex_id).share_built_state(source_vertex)
+
+    def get_dirty_vertices(
+        self,
+        previous: "Graph",
+        force_vertex_ids: Optional[List[str]] = None,
+        variables_hashes: Optional[Dict[str, Optional[str]]] = None,
+    ) -> set[str]:
+        """
+        Returns the vertices that have to be rebuilt because the flow changed since `previous` was built.
+
+        A vertex is changed if it is new, its data or its edges differ from `previous`, it was not built
+        (or was inactive) in `previous`, it takes the inputs of a run, or it is in `force_vertex_ids`.
+        With `variables_hashes`, the current `hash_load_from_db_fields` of each vertex, a vertex whose
+        global variables have other values than when it was built is changed too.
+        The dirty vertices are the changed ones and all their successors.
+        """
+        changed = {vertex_id for vertex_id in force_vertex_ids or [] if vertex_id in self.vertex_map}
+        for vertex in self.vertices:
+            previous_vertex = previous.vertex_map.get(vertex.id)
+            if (
+                previous_vertex is None
+                or not previous_vertex._built
+                or previous_vertex.state == VertexStates.INACTIVE
+                or vertex.is_interface_component
+                or vertex.is_state
+                or not self.vertex_data_is_identical(vertex, previous_vertex)
+                or (
+                    variables_hashes is not None
+                    and variables_hashes.get(vertex.id) != previous_vertex.variables_hash
+                )
+            ):
+                changed.add(vertex.id)
+
+        # The same set as `get_all_successors`, without walking shared branches more than once
+        dirty = set(changed)
+        to_visit = list(changed)
+        while to_visit:
+            for successor_id in self.successor_map.get(to_visit.pop(), []):
+                if successor_id not in dirty:
+                    dirty.add(successor_id)
+                    to_visit.append(successor_id)
+        return dirty
+
+    def reuse_unchanged_vertices(
+        self,
+        previous: "Graph",
+        force_vertex_ids: Optional[List[str]] = None,
+        variables_hashes: Optional[Dict[str, Optional[str]]] = None,
+    ) -> set[str]:
+        """
+        Carries the results of the vertices that did not change over from `previous`, a built graph of the same flow.
+
+        The reused vertices are left out of the next `sort_vertices`, so only the dirty vertices
+        (see `get_dirty_vertices`) are run.
+
+        Returns:
+            set[str]: The IDs of the reused vertices.
+        """
+        dirty = self.get_dirty_vertices(previous, force_vertex_ids, variables_hashes)
+        reused = {vertex.id for vertex in self.vertices if vertex.id not in dirty}
+        for vertex_id in reused:
+            self.get_vertex(vertex_id).share_built_state(previous.get_vertex(vertex_id))
+        self.run_context.reused_vertices = reused
+        if reused:
+            logger.debug(f"Reusing {len(reused)} unchanged vertices, rebuilding {len(dirty)}")
+        return reused
+
     def next_vertex_to_build(self):
         """
         Returns the next vertex to be built.
@@ -502,9 +731,11 @@ class Graph:
         if vertices is None:
             vertices = self.vertices
 
-        self.predecessor_map, self.successor_map = self.build_adjacency_maps(edges)
-
-        self.in_degree_map = self.build_in_degree(edges)
+        if self._plan is not None:
+            self.predecessor_map, self.successor_map, self.in_degree_map = self._plan.build_adjacency_maps()
+        else:
+            self.predecessor_map, self.successor_map = self.build_adjacency_maps(edges)
+            self.in_degree_map = self.build_in_degree(edges)
         self.parent_child_map = self.build_parent_child_map(vertices)
 
     def reset_inactivated_vertices(self):
@@ -545,6 +776,99 @@ class Graph:
                     continue
             self.mark_branch(child_id, state)
 
+    def get_branch_feeders(self, router_id: str) -> List[str]:
+        """
+        Returns the vertices whose results are only used by one branch of a router.
+
+        A branch is what an output of the router leads to. Vertices both branches lead to, like the
+        one they merge into, are in no branch. Feeders are not successors of the router, but all their
+        successors are in the same branch, or are feeders of it themselves, e.g. the LLM and the retriever
+        of a branch. They come closest to the branches first.
+        """
+        branches_of: Dict[str, Set[str]] = defaultdict(set)
+        for successor_id in self.successor_map.get(router_id, []):
+            edge = self.get_edge(router_id, successor_id)
+            branch = getattr(getattr(edge, "source_handle", None), "name", None) or successor_id
+            visited = set()
+            to_visit = [successor_id]
+            while to_visit:
+                vertex_id = to_visit.pop()
+                if vertex_id == router_id or vertex_id in visited:
+                    continue
+                visited.add(vertex_id)
+                branches_of[vertex_id].add(branch)
+                to_visit.extend(self.successor_map.get(vertex_id, []))
+        branch_of = {
+            vertex_id: next(iter(branches)) for vertex_id, branches in branches_of.items() if len(branches) == 1
+        }
+
+        feeders: Dict[str, str] = {}
+        found = True
+        while found:
+            found = False
+            for vertex in self.vertices:
+                if vertex.id == router_id or vertex.id in branches_of or vertex.id in feeders:
+                    continue
+                successors = self.successor_map.get(vertex.id, [])
+                fed = {branch_of.get(s) or feeders.get(s) for s in successors}
+                if successors and len(fed) == 1 and None not in fed:
+                    feeders[vertex.id] = fed.pop()
+                    found = True
+        return list(feeders)
+
+    def gate_branch_feeders(self, first_layer: List[str]) -> List[str]:
+        """
+        Makes the feeders of each router of the run (see `get_branch_feeders`) wait for it.
+
+        The feeders of the branches a router does not take are then pruned before they are built
+        (see `prune_branch_feeders`).
+
+        Returns:
+            List[str]: The first layer of the run without the gated feeders.
+        """
+        gated = set()
+        for router_id in sorted(self.vertices_to_run):
+            if not self.get_vertex(router_id).can_stop_branches:
+                continue
+            for feeder_id in self.get_branch_feeders(router_id):
+                if feeder_id in self.vertices_to_run:
+                    self.run_manager.add_run_predecessor(feeder_id, router_id)
+                    gated.add(feeder_id)
+        if gated:
+            logger.debug(f"Building {len(gated)} vertices after the routers they feed")
+        return [vertex_id for vertex_id in first_layer if vertex_id not in gated]
+
+    def prune_branch_feeders(self, router_id: str) -> List[str]:
+        """
+        Inactivates the feeders of a router that was just built whose successors are all inactive.
+
+        The vertices inactivated by the router and the pruned feeders are taken out of the vertices
+        to run, so they are never instantiated.
+
+        Returns:
+            List[str]: The IDs of the pruned feeders.
+        """
+        successors_ids = self.successor_map.get(router_id, [])
+        feeders = [v_id for v_id in self.run_manager.run_map.get(router_id, []) if v_id not in successors_ids]
+        if not feeders:
+            return []
+        pruned: List[str] = []
+        for feeder_id in dict.fromkeys(feeders):
+            # Feeders come closest to the branches first, so their successors are already pruned
+            if all(
+                self.get_vertex(successor_id).state == VertexStates.INACTIVE
+                for successor_id in self.successor_map.get(feeder_id, [])
+            ):
+                self.mark_vertex(feeder_id, "INACTIVE")
+                self.inactivated_vertices.add(feeder_id)
+                self.run_manager.remove_vertex_from_runnables(feeder_id)
+                pruned.append(feeder_id)
+        for vertex_id in self.inactivated_vertices:
+            self.run_manager.update_vertex_run_state(vertex_id, is_runnable=False)
+        if pruned:
+            logger.debug(f"Pruned {len(pruned)} vertices of the branches not taken by {router_id}")
+        return pruned
+
     def get_edge(self, source_id: str, target_id: str) -> Optional[ContractEdge]:
         """Returns the edge between two vertices."""
         for edge in self.edges:
@@ -576,30 +900,36 @@ class Graph:
             "user_id": self.user_id,
             "raw_graph_data": self.raw_graph_data,
             "top_level_vertices": self.top_level_vertices,
-            "inactivated_vertices": self.inactivated_vertices,
-            "run_manager": self.run_manager.to_dict(),
-            "_run_id": self._run_id,
+            "run_context": self.run_context.to_dict(),
             "in_degree_map": self.in_degree_map,
             "parent_child_map": self.parent_child_map,
             "predecessor_map": self.predecessor_map,
             "successor_map": self.successor_map,
-            "activated_vertices": self.activated_vertices,
-            "vertices_layers": self.vertices_layers,
-            "vertices_to_run": self.vertices_to_run,
-            "stop_vertex": self.stop_vertex,
             "vertex_map": self.vertex_map,
         }
 
     def __setstate__(self, state):
-        run_manager = state["run_manager"]
-        if isinstance(run_manager, RunnableVerticesManager):
-            state["run_manager"] = run_manager
-        else:
-            state["run_manager"] = RunnableVerticesManager.from_dict(run_manager)
+        self._plan = None
+        run_context = state.pop("run_context", None)
+        if not isinstance(run_context, RunContext):
+            # Graphs pickled before the run context existed kept the run state at the top level
+            run_context = RunContext.from_dict(
+                run_context
+                or {
+                    "run_id": state.pop("_run_id", ""),
+                    "run_manager": state.pop("run_manager", None),
+                    "inactivated_vertices": state.pop("inactivated_vertices", set()),
+                    "activated_vertices": state.pop("activated_vertices", []),
+                    "vertices_layers": state.pop("vertices_layers", []),
+                    "vertices_to_run": state.pop("vertices_to_run", set()),
+                    "stop_vertex": state.pop("stop_vertex", None),
+                }
+            )
         self.__dict__.update(state)
+        self.run_context = run_context
         self.state_manager = GraphStateManager()
         self.tracing_service = get_tracing_service()
-        self.set_run_id(self._run_id)
+        self.set_run_id(self.run_context.run_id)
         self.set_run_name()
 
     @classmethod
@@ -635,6 +965,28 @@ class Graph:
 
             raise ValueError(f"Error while creating graph from payload: {exc}") from exc
 
+    @classmethod
+    def from_plan(
+        cls,
+        plan: "FlowPlan",
+        flow_id: Optional[str] = None,
+        flow_name: Optional[str] = None,
+        user_id: Optional[str] = None,
+    ) -> "Graph":
+        """
+        Creates a graph from a compiled plan.
+
+        Only the per-run state (vertices, their params and the run maps) is built,
+        the ungrouping, handle validation and layered sort are reused from the plan.
+
+        Args:
+            plan (FlowPlan): The plan to create the graph from.
+
+        Returns:
+            Graph: The created graph.
+        """
+        return cls(plan.nodes, plan.edges, flow_id, flow_name, user_id, plan=plan)
+
     def __eq__(self, other: object) -> bool:
         if not isinstance(other, Graph):
             return False
@@ -672,6 +1024,8 @@ class Graph:
         return True
 
     def update(self, other: "Graph") -> "Graph":
+        # The topology is about to change so the compiled plan no longer applies
+        self._plan = None
         # Existing vertices in self graph
         existing_vertex_ids = set(vertex.id for vertex in self.vertices)
         # Vertex IDs in the other graph
@@ -761,6 +1115,7 @@ class Graph:
 
     def add_vertex(self, vertex: Vertex) -> None:
         """Adds a new vertex to the graph."""
+        self._plan = None
         self._add_vertex(vertex)
         self._update_edges(vertex)
 
@@ -787,6 +1142,7 @@ class Graph:
 
     def remove_vertex(self, vertex_id: str) -> None:
         """Removes a vertex from the graph."""
+        self._plan = None
         vertex = self.get_vertex(vertex_id)
         if vertex is None:
             return
@@ -852,6 +1208,7 @@ class Graph:
             ValueError: If no result is found for the vertex.
         """
         vertex = self.get_vertex(vertex_id)
+        build_started_at = time.perf_counter()
         try:
             params = ""
             if vertex.frozen:
@@ -871,8 +1228,10 @@ class Graph:
                     vertex.artifacts = cached_vertex.artifacts
                     vertex._built_object = cached_vertex._built_object
                     vertex._custom_component = cached_vertex._custom_component
+                    vertex._lazy_restore = False
                     if vertex.result is not None:
                         vertex.result.used_frozen_result = True
+                    vertex._mark_changed()
 
             else:
                 await vertex.build(
@@ -880,6 +1239,10 @@ class Graph:
                 )
                 await chat_service.set_cache(key=vertex.id, data=vertex)
 
+            if self.token_channel is not None and vertex.will_stream:
+                # The message reaches the client while it is generated, and the successors get it complete
+                await vertex.stream_to(self.token_channel)
+
             if vertex.result is not None:
                 params = f"{vertex._built_object_repr()}{params}"
                 valid = True
@@ -887,11 +1250,12 @@ class Graph:
                 artifacts = vertex.artifacts
             else:
                 raise ValueError(f"No result found for vertex {vertex_id}")
+            observe_vertex_build(vertex, time.perf_counter() - build_started_at)
             flow_id = self.flow_id
             log_transaction(flow_id, vertex, status="success")
             return result_dict, params, valid, artifacts, vertex
         except Exception as exc:
-            if not isinstance(exc, ComponentBuildException):
+            if not isinstance(exc, (ComponentBuildException, RunCancelledException)):
                 logger.exception(f"Error building Component:\n\n{exc}")
             flow_id = self.flow_id
             log_transaction(flow_id, vertex, status="failure", error=str(exc))
@@ -928,23 +1292,64 @@ class Graph:
         """Processes the graph with vertices in each layer run in parallel."""
 
         first_layer = self.sort_vertices(start_component_id=start_component_id)
-        vertex_task_run_count: Dict[str, int] = {}
-        to_process = deque(first_layer)
-        layer_index = 0
         chat_service = get_chat_service()
         run_id = uuid.uuid4()
         self.set_run_id(run_id)
         self.set_run_name()
         await self.initialize_run()
         lock = chat_service._cache_locks[self.run_id]
-        while to_process:
+        executor = CeleryVertexExecutor.from_settings(self)
+        if executor is None:
+            await self._process(first_layer, chat_service, lock, fallback_to_env_vars, self.build_vertex)
+        else:
+            executor.prepare()
+            try:
+                await self._process(first_layer, chat_service, lock, fallback_to_env_vars, executor.build_vertex)
+            finally:
+                executor.finish()
+        logger.debug("Graph processing complete")
+        return self
+
+    async def _process(
+        self,
+        first_layer: List[str],
+        chat_service: ChatService,
+        lock: asyncio.Lock,
+        fallback_to_env_vars: bool,
+        build_vertex: Callable[..., Coroutine],
+    ) -> None:
+        """Runs the scheduler set by `graph_scheduler`, building each vertex with `build_vertex`."""
+        settings = get_settings_service().settings
+        semaphore = None
+        if settings.graph_max_concurrent_builds > 0:
+            # The tasks of a wide layer are still created together, only this many build at once
+            semaphore = asyncio.Semaphore(settings.graph_max_concurrent_builds)
+        if semaphore is not None or self.profile is not None or get_metrics() is not None:
+            unscheduled_build_vertex = build_vertex
+
+            def build_vertex(**kwargs):
+                # Called when the task is created, which is when the vertex became runnable
+                return self._build_scheduled_vertex(unscheduled_build_vertex, semaphore, time.perf_counter(), **kwargs)
+
+        if settings.graph_scheduler == "ready_queue":
+            await self._process_ready_queue(
+                first_layer,
+                chat_service=chat_service,
+                fallback_to_env_vars=fallback_to_env_vars,
+                build_vertex=build_vertex,
+            )
+            return
+        vertex_task_run_count: Dict[str, int] = {}
+        to_process = deque(first_layer)
+        layer_index = 0
+        while to_process and not self.cancellation.cancelled:
             current_batch = list(to_process)  # Copy current deque items to a list
             to_process.clear()  # Clear the deque for new items
             tasks = []
             for vertex_id in current_batch:
                 vertex = self.get_vertex(vertex_id)
                 task = asyncio.create_task(
-                    self.build_vertex(
+                    build_vertex(
                         chat_service=chat_service,
                         vertex_id=vertex_id,
                         user_id=self.user_id,
@@ -953,6 +1358,7 @@ class Graph:
                     ),
                     name=f"{vertex.display_name} Run {vertex_task_run_count.get(vertex_id, 0)}",
                 )
+                self.cancellation.track(task)
                 tasks.append(task)
                 vertex_task_run_count[vertex_id] = vertex_task_run_count.get(vertex_id, 0) + 1
 
@@ -966,28 +1372,61 @@ class Graph:
                 break
             to_process.extend(next_runnable_vertices)
             layer_index += 1
+        # A run that hit its deadline ends with what it built, a cancelled one fails
+        self.cancellation.raise_if_cancelled(include_deadline=False)
 
-        logger.debug("Graph processing complete")
-        return self
+    async def _build_scheduled_vertex(
+        self,
+        build_vertex: Callable[..., Coroutine],
+        semaphore: Optional[asyncio.Semaphore],
+        ready_at: float,
+        **kwargs,
+    ):
+        """Builds a vertex once a build slot is free, recording how long it waited and took."""
+        async with semaphore if semaphore is not None else contextlib.nullcontext():
+            started_at = time.perf_counter()
+            vertex = self.get_vertex(kwargs["vertex_id"])
+            observe_vertex_wait(vertex, started_at - ready_at)
+            try:
+                return await build_vertex(**kwargs)
+            finally:
+                if self.profile is not None:
+                    self.profile.record(vertex.id, vertex.vertex_type, ready_at, started_at, time.perf_counter())
 
     async def _execute_tasks(self, tasks: List[asyncio.Task], lock: asyncio.Lock) -> List[str]:
-        """Executes tasks in parallel, handling exceptions for each task."""
+        """
+        Executes tasks in parallel, handling exceptions for each task.
+
+        When a task fails, the run is cancelled or it reaches its deadline, all the tasks that are
+        still running are cancelled. After a deadline no vertex is returned, so the run stops.
+        """
         results = []
-        completed_tasks = await asyncio.gather(*tasks, return_exceptions=True)
+        done, pending = await asyncio.wait(
+            tasks, timeout=self.cancellation.remaining(), return_when=asyncio.FIRST_EXCEPTION
+        )
+        if pending:
+            for task in pending:
+                task.cancel()
+            await asyncio.gather(*pending, return_exceptions=True)
+        self.cancellation.raise_if_cancelled(include_deadline=False)
         vertices: List[Vertex] = []
 
-        for i, result in enumerate(completed_tasks):
-            task_name = tasks[i].get_name()
+        for task in tasks:
+            task_name = task.get_name()
+            if task.cancelled():
+                continue
+            result = task.exception() or task.result()
+            if isinstance(result, RunCancelledException):
+                continue
             if isinstance(result, Exception):
                 logger.error(f"Task {task_name} failed with exception: {result}")
-                # Cancel all remaining tasks
-                for t in tasks[i + 1 :]:
-                    t.cancel()
                 raise result
             elif isinstance(result, tuple) and len(result) == 5:
                 vertices.append(result[4])
             else:
                 raise ValueError(f"Invalid result from task {task_name}: {result}")
+        if self.cancellation.deadline_exceeded:
+            return []
 
         for v in vertices:
             # set all executed vertices as non-runnable to not run them again.
@@ -1003,6 +1442,94 @@ class Graph:
             results.extend(next_runnable_vertices)
         return results
 
+    async def _process_ready_queue(
+        self,
+        first_layer: List[str],
+        chat_service: ChatService,
+        fallback_to_env_vars: bool,
+        build_vertex: Optional[Callable[..., Coroutine]] = None,
+    ) -> None:
+        """
+        Processes the graph starting each vertex as soon as all of its predecessors are built.
+
+        Unlike the layered loop in `process`, a slow vertex only holds back its own successors,
+        so independent branches run concurrently up to the length of the critical path.
+
+        Args:
+            first_layer (List[str]): The IDs of the vertices returned by `sort_vertices`.
+            chat_service (ChatService): The chat service used to build the vertices.
+            fallback_to_env_vars (bool): Whether to fallback to environment variables.
+            build_vertex (Optional[Callable]): Builds a vertex, `self.build_vertex` by default.
+        """
+        build_vertex = build_vertex or self.build_vertex
+        vertex_task_run_count: Dict[str, int] = {}
+        tasks: Dict[asyncio.Task, str] = {}
+
+        def schedule(vertices_ids: List[str]) -> None:
+            for vertex_id in vertices_ids:
+                if vertex_id in tasks.values():
+                    continue
+                vertex = self.get_vertex(vertex_id)
+                # Only the in-flight flag is cleared here. The vertex is removed from
+                # the predecessors of its successors once it is actually built.
+                self.run_manager.update_vertex_run_state(vertex_id, is_runnable=False)
+                task = asyncio.create_task(
+                    build_vertex(
+                        chat_service=chat_service,
+                        vertex_id=vertex_id,
+                        user_id=self.user_id,
+                        inputs_dict={},
+                        fallback_to_env_vars=fallback_to_env_vars,
+                    ),
+                    name=f"{vertex.display_name} Run {vertex_task_run_count.get(vertex_id, 0)}",
+                )
+                self.cancellation.track(task)
+                tasks[task] = vertex_id
+                vertex_task_run_count[vertex_id] = vertex_task_run_count.get(vertex_id, 0) + 1
+
+        # Vertices with no pending predecessors can start right away, even if
+        # refine_layers placed them in a later layer.
+        ready = list(first_layer)
+        ready.extend(vertex_id for vertex_id in sorted(self.vertices_to_run) if self.is_vertex_runnable(vertex_id))
+        schedule(ready)
+
+        async def cancel_all() -> None:
+            for t in tasks:
+                t.cancel()
+            await asyncio.gather(*tasks, return_exceptions=True)
+
+        pending = set(tasks)
+        while pending:
+            done, pending = await asyncio.wait(
+                pending, timeout=self.cancellation.remaining(), return_when=asyncio.FIRST_COMPLETED
+            )
+            if self.cancellation.cancelled:
+                # The builds in flight are dropped. After a deadline the run ends with what it built.
+                await cancel_all()
+                self.cancellation.raise_if_cancelled(include_deadline=False)
+                return
+            for task in done:
+                task_name = task.get_name()
+                vertex_id = tasks.pop(task)
+                if (exc := task.exception()) is not None:
+                    logger.error(f"Task {task_name} failed with exception: {exc}")
+                    await cancel_all()
+                    raise exc
+                result = task.result()
+                if not (isinstance(result, tuple) and len(result) == 5):
+                    raise ValueError(f"Invalid result from task {task_name}: {result}")
+
+                self.prune_branch_feeders(vertex_id)
+                self.run_manager.remove_from_predecessors(vertex_id)
+                next_runnable_vertices = [
+                    v_id
+                    for v_id in self.run_manager.get_run_successors(self.get_vertex(vertex_id))
+                    if self.is_vertex_runnable(v_id)
+                ]
+                next_runnable_vertices.extend(self.find_runnable_predecessors_for_successors(vertex_id))
+                schedule(next_runnable_vertices)
+            pending = set(tasks)
+
     def topological_sort(self) -> List[Vertex]:
         """
         Performs a topological sort of the vertices in the graph.
@@ -1114,7 +1641,7 @@ class Graph:
         # if we can't find a vertex, we raise an error
 
         edges: set[ContractEdge] = set()
-        for edge in self._edges:
+        for index, edge in enumerate(self._edges):
             source = self.get_vertex(edge["source"])
             target = self.get_vertex(edge["target"])
 
@@ -1122,7 +1649,8 @@ class Graph:
                 raise ValueError(f"Source vertex {edge['source']} not found")
             if target is None:
                 raise ValueError(f"Target vertex {edge['target']} not found")
-            new_edge = ContractEdge(source, target, edge)
+            handles = self._plan.handles.get(index) if self._plan is not None else None
+            new_edge = ContractEdge(source, target, edge, handles=handles)
 
             edges.add(new_edge)
 
@@ -1159,7 +1687,10 @@ class Graph:
             if "id" not in vertex_data:
                 raise ValueError(f"Vertex data for {vertex_data['display_name']} does not contain an id")
 
-            VertexClass = self._get_vertex_class(vertex_type, vertex_base_type, vertex_data["id"])
+            if self._plan is not None and vertex_data["id"] in self._plan.vertex_classes:
+                VertexClass = self._plan.vertex_classes[vertex_data["id"]]
+            else:
+                VertexClass = self._get_vertex_class(vertex_type, vertex_base_type, vertex_data["id"])
 
             vertex_instance = VertexClass(vertex, graph=self)
             vertex_instance.set_top_level(self.top_level_vertices)
@@ -1387,28 +1918,48 @@ class Graph:
         self.mark_all_vertices("ACTIVE")
         if stop_component_id is not None:
             self.stop_vertex = stop_component_id
-            vertices = self.sort_up_to_vertex(stop_component_id)
-        elif start_component_id:
-            vertices = self.sort_up_to_vertex(start_component_id, is_start=True)
-        else:
-            vertices = self.vertices
-            # without component_id we are probably running in the chat
-            # so we want to pick only graphs that start with ChatInput or
-            # TextInput
 
-        vertices_layers = self.layered_topological_sort(vertices)
+        vertices_layers = None
+        if self._plan is not None:
+            vertices_layers = self._plan.get_sorted_layers(stop_component_id, start_component_id)
+        if vertices_layers is None:
+            if stop_component_id is not None:
+                vertices = self.sort_up_to_vertex(stop_component_id)
+            elif start_component_id:
+                vertices = self.sort_up_to_vertex(start_component_id, is_start=True)
+            else:
+                vertices = self.vertices
+                # without component_id we are probably running in the chat
+                # so we want to pick only graphs that start with ChatInput or
+                # TextInput
+
+            vertices_layers = self.layered_topological_sort(vertices)
+        reused_vertices = self.run_context.reused_vertices
+        if reused_vertices:
+            # Reused vertices are already built, so only the others are run.
+            # If nothing is left, the reused vertices are run and return their results right away.
+            dirty_layers = [
+                [vertex_id for vertex_id in layer if vertex_id not in reused_vertices] for layer in vertices_layers
+            ]
+            dirty_layers = [layer for layer in dirty_layers if layer]
+            if dirty_layers:
+                vertices_layers = dirty_layers
         vertices_layers = self.sort_by_avg_build_time(vertices_layers)
         # vertices_layers = self.sort_chat_inputs_first(vertices_layers)
         # Now we should sort each layer in a way that we make sure
         # vertex V does not depend on vertex V+1
         vertices_layers = self.sort_layer_by_dependency(vertices_layers)
         self.increment_run_count()
-        self._sorted_vertices_layers = vertices_layers
+        self.run_context.sorted_vertices_layers = vertices_layers
         first_layer = vertices_layers[0]
         # save the only the rest
         self.vertices_layers = vertices_layers[1:]
         self.vertices_to_run = {vertex_id for vertex_id in chain.from_iterable(vertices_layers)}
         self.build_run_map()
+        for vertex_id in reused_vertices - self.vertices_to_run:
+            self.remove_from_predecessors(vertex_id)
+        if get_settings_service().settings.branch_pruning:
+            first_layer = self.gate_branch_feeders(first_layer)
         # Return just the first layer
         return first_layer
 
@@ -0,0 +1,70 @@
+"""
+Cooperative cancellation of graph runs.
+
+Each run has a `CancellationToken` in its `RunContext`. The token is cancelled when the client of the run
+goes away, and it expires when the run reaches its deadline. Either way the schedulers stop starting
+vertices and cancel the builds in flight, `Vertex.build` refuses to start, and streams stop between chunks.
+
+A cancelled run fails with `RunCancelledException`. A run that hits its deadline ends normally
+with the results built so far.
+"""
+
+import asyncio
+import time
+from typing import Optional
+
+
+class RunCancelledException(Exception):
+    def __init__(self, reason: str):
+        self.reason = reason
+        super().__init__(reason)
+
+
+class RunDeadlineExceededException(RunCancelledException):
+    def __init__(self):
+        super().__init__("The run exceeded its deadline")
+
+
+class CancellationToken:
+    def __init__(self, timeout: Optional[float] = None):
+        self._deadline: Optional[float] = None
+        self.reason: Optional[str] = None
+        self._tasks: set[asyncio.Task] = set()
+        self.set_timeout(timeout)
+
+    def set_timeout(self, timeout: Optional[float]) -> None:
+        """Sets the deadline of the run `timeout` seconds from now. None or 0 means no deadline."""
+        self._deadline = time.monotonic() + timeout if timeout else None
+
+    def remaining(self) -> Optional[float]:
+        """The seconds left until the deadline, or None if there is no deadline."""
+        if self._deadline is None:
+            return None
+        return max(0.0, self._deadline - time.monotonic())
+
+    @property
+    def deadline_exceeded(self) -> bool:
+        return self._deadline is not None and time.monotonic() >= self._deadline
+
+    @property
+    def cancelled(self) -> bool:
+        """Whether the run should stop, because it was cancelled or reached its deadline."""
+        return self.reason is not None or self.deadline_exceeded
+
+    def cancel(self, reason: str = "The run was cancelled") -> None:
+        """Cancels the run and the builds in flight."""
+        if self.reason is None:
+            self.reason = reason
+        for task in list(self._tasks):
+            task.cancel()
+
+    def track(self, task: asyncio.Task) -> None:
+        """Registers a build of the run, so it is cancelled with it."""
+        self._tasks.add(task)
+        task.add_done_callback(self._tasks.discard)
+
+    def raise_if_cancelled(self, include_deadline: bool = True) -> None:
+        if self.reason is not None:
+            raise RunCancelledException(self.reason)
+        if include_deadline and self.deadline_exceeded:
+            raise RunDeadlineExceededException()
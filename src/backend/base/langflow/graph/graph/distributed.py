@@ -0,0 +1,372 @@
+"""
+Runs the vertices of a graph on Celery workers.
+
+The API process keeps scheduling the graph (`Graph.process`) and sends each vertex to a worker
+with the `run_vertex` task. Workers rebuild the graph from the payload written by `prepare`, keep
+it for the rest of the run and store the built objects of every vertex in the Redis cache, so a
+successor running on another worker reads them from there instead of building them again.
+
+Results that cannot be pickled only live in the worker that built them, so their successors are
+sent to that worker. If that worker no longer has them, a successor that needs them fails unless
+the vertex is pure (see `is_pure`) and can be built again. Vertices of a linear chain (one
+successor, which has no other predecessor) are also sent to the worker that ran the first vertex
+of the chain, which saves the round trip to Redis in the common case.
+
+Interface, state and frozen vertices read the chat service and the event manager of the API
+process, so they are still built locally. Their built objects are stored in the cache like the
+ones built by the workers, and the successors of a local vertex whose result cannot be pickled
+are built locally too.
+
+The API process waits for each task without holding a thread, and revokes it when the run is
+cancelled or the task takes longer than `graph_executor_timeout`. It then does what
+`Graph.build_vertex` does after a build: it caches the vertex for freezing, records its build
+time and logs its transaction. The workers do not log transactions, because the monitor database
+is local to each process.
+"""
+
+import asyncio
+import pickle
+import time
+from typing import TYPE_CHECKING, Any, Dict, List, Optional, Set, Tuple
+
+from loguru import logger
+
+from langflow.graph.schema import ResultData
+from langflow.graph.vertex.memoization import MEMOIZED_ATTRIBUTES
+from langflow.services.cache.service import RedisCache
+from langflow.services.deps import get_cache_service, get_settings_service
+from langflow.services.monitor.metrics import observe_vertex_build
+from langflow.services.monitor.utils import log_transaction
+
+if TYPE_CHECKING:
+    from langflow.graph.graph.base import Graph
+    from langflow.graph.vertex.base import Vertex
+    from langflow.services.chat.service import ChatService
+
+DISTRIBUTED_GRAPH_PREFIX = "distributed_graph"
+VERTEX_RESULT_PREFIX = "vertex_result"
+# Seconds between the first two checks of a task, doubled after each check up to the maximum
+POLL_INTERVAL = 0.05
+MAX_POLL_INTERVAL = 1.0
+
+
+def get_graph_key(run_id: str) -> str:
+    return f"{DISTRIBUTED_GRAPH_PREFIX}:{run_id}"
+
+
+def get_vertex_result_key(run_id: str, vertex_id: str) -> str:
+    return f"{VERTEX_RESULT_PREFIX}:{run_id}:{vertex_id}"
+
+
+def get_affinity_groups(graph: "Graph") -> Dict[str, str]:
+    """
+    Groups the vertices that form linear chains.
+
+    Returns:
+        Dict[str, str]: The ID of the first vertex of its chain for every vertex.
+    """
+    previous: Dict[str, str] = {}
+    for vertex_id in graph.vertex_map:
+        predecessors = graph.predecessor_map.get(vertex_id, [])
+        if len(predecessors) == 1 and len(graph.successor_map.get(predecessors[0], [])) == 1:
+            previous[vertex_id] = predecessors[0]
+    groups: Dict[str, str] = {}
+    for vertex_id in graph.vertex_map:
+        first, visited = vertex_id, {vertex_id}
+        # A chain that loops back to itself is grouped under the vertex it was reached from
+        while first in previous and previous[first] not in visited:
+            first = previous[first]
+            visited.add(first)
+        groups[vertex_id] = first
+    return groups
+
+
+def runs_locally(vertex: "Vertex") -> bool:
+    return vertex.is_interface_component or vertex.is_state or vertex.frozen
+
+
+def get_vertex_states(graph: "Graph") -> Dict[str, str]:
+    return {vertex.id: vertex.state.name for vertex in graph.vertices}
+
+
+def summarize_vertex(
+    vertex: "Vertex", by_reference: bool, worker: Optional[str], states_before: Dict[str, str]
+) -> Dict[str, Any]:
+    """
+    Builds the JSON-safe summary of a built vertex the worker returns.
+
+    Only the states the build changed are sent back, so the builds running at the same time
+    do not undo each other's changes.
+    """
+    import orjson
+
+    result = vertex.result.model_dump() if vertex.result is not None else None
+    return {
+        "result": orjson.loads(orjson.dumps(result, default=str)),
+        "params": vertex._built_object_repr(),
+        "by_reference": by_reference,
+        "worker": worker,
+        "states": {
+            vertex_id: state
+            for vertex_id, state in get_vertex_states(vertex.graph).items()
+            if states_before.get(vertex_id) != state
+        },
+    }
+
+
+def store_vertex_result(cache_service: RedisCache, run_id: str, vertex: "Vertex") -> bool:
+    """Stores the built objects of a vertex for the other workers. Returns False if they cannot be pickled."""
+    try:
+        value = pickle.dumps({attribute: getattr(vertex, attribute) for attribute in MEMOIZED_ATTRIBUTES})
+    except Exception as exc:
+        logger.debug(f"The result of {vertex.display_name} stays on this worker: {exc}")
+        return False
+    cache_service._client.setex(get_vertex_result_key(run_id, vertex.id), cache_service.expiration_time, value)
+    return True
+
+
+def restore_vertex_result(cache_service: RedisCache, run_id: str, vertex: "Vertex") -> bool:
+    """Loads the built objects of a vertex built elsewhere. Returns False if they are not in the cache."""
+    value = cache_service._client.get(get_vertex_result_key(run_id, vertex.id))
+    if value is None:
+        return False
+    try:
+        attributes = pickle.loads(value)
+    except Exception as exc:
+        logger.debug(f"Discarding the stored result of {vertex.display_name}: {exc}")
+        return False
+    for attribute, attribute_value in attributes.items():
+        setattr(vertex, attribute, attribute_value)
+    vertex._built = True
+    vertex._lazy_restore = False
+    return True
+
+
+def restore_predecessors(cache_service: RedisCache, run_id: str, vertex: "Vertex", missing: Set[str]) -> None:
+    """
+    Makes the results of the predecessors of a vertex available before it is built.
+
+    `missing` holds the vertices whose built objects are not in this process. They are loaded from the
+    cache and, when it does not have them, the vertex is rebuilt the first time its result is read if
+    it is pure, or fails otherwise. Restored vertices are removed from `missing`.
+    """
+    graph = vertex.graph
+    stack = list(graph.predecessor_map.get(vertex.id, []))
+    while stack:
+        predecessor = graph.get_vertex(stack.pop())
+        if predecessor.id not in missing:
+            continue
+        missing.discard(predecessor.id)
+        if restore_vertex_result(cache_service, run_id, predecessor):
+            continue
+        # Rebuilt lazily if pure, which also needs its own predecessors
+        predecessor._built = False
+        predecessor._lazy_restore = True
+        stack.extend(graph.predecessor_map.get(predecessor.id, []))
+
+
+class CeleryVertexExecutor:
+    """Builds the vertices of a graph on Celery workers, see the module docstring."""
+
+    def __init__(self, graph: "Graph", cache_service: RedisCache, timeout: float):
+        self.graph = graph
+        self.cache_service = cache_service
+        self.timeout = timeout
+        self.groups = get_affinity_groups(graph)
+        # Where each vertex built remotely ran, and whether its result is in the cache
+        self._locations: Dict[str, Tuple[Optional[str], bool]] = {}
+        self._group_workers: Dict[str, str] = {}
+        # Vertices built remotely whose built objects were not loaded here yet
+        self._remote: Set[str] = set()
+        # Vertices built here whose built objects could not be stored for the workers
+        self._local_only: Set[str] = set()
+
+    @classmethod
+    def from_settings(cls, graph: "Graph") -> Optional["CeleryVertexExecutor"]:
+        """Returns an executor if `graph_executor` is set to 'celery', else None."""
+        settings = get_settings_service().settings
+        if settings.graph_executor != "celery":
+            return None
+        cache_service = get_cache_service()
+        if not isinstance(cache_service, RedisCache):
+            logger.warning("Running the graph locally: the celery graph executor requires the redis cache")
+            return None
+        return cls(graph, cache_service, settings.graph_executor_timeout)
+
+    @property
+    def run_id(self) -> str:
+        return self.graph.run_id
+
+    def prepare(self) -> None:
+        """Writes what the workers need to rebuild the graph of this run."""
+        payload = {
+            "raw_graph_data": self.graph.raw_graph_data,
+            "flow_id": self.graph.flow_id,
+            "flow_name": self.graph.flow_name,
+            "user_id": self.graph.user_id,
+            "run_id": self.run_id,
+            "overrides": {
+                vertex.id: vertex._raw_params_overrides for vertex in self.graph.vertices if vertex._raw_params_overrides
+            },
+        }
+        self.cache_service._client.setex(
+            get_graph_key(self.run_id), self.cache_service.expiration_time, pickle.dumps(payload)
+        )
+
+    def finish(self) -> None:
+        """Deletes what the run stored in the cache."""
+        keys = [get_graph_key(self.run_id)]
+        keys.extend(
+            get_vertex_result_key(self.run_id, vertex_id)
+            for vertex_id, (_, by_reference) in self._locations.items()
+            if by_reference
+        )
+        try:
+            self.cache_service._client.delete(*keys)
+        except Exception as exc:
+            logger.debug(f"Could not delete the distributed run {self.run_id}: {exc}")
+
+    def select_worker(self, vertex_id: str) -> Optional[str]:
+        """
+        Picks the worker a vertex should run on, or None to let any worker of the queue take it.
+
+        A predecessor whose result is not in the cache decides, then the worker of the chain of
+        the vertex, then the worker that built most of its predecessors.
+        """
+        predecessors = self.graph.predecessor_map.get(vertex_id, [])
+        for predecessor_id in predecessors:
+            worker, by_reference = self._locations.get(predecessor_id, (None, True))
+            if worker and not by_reference:
+                return worker
+        if worker := self._group_workers.get(self.groups.get(vertex_id, vertex_id)):
+            return worker
+        counts: Dict[str, int] = {}
+        for predecessor_id in predecessors:
+            if worker := self._locations.get(predecessor_id, (None, True))[0]:
+                counts[worker] = counts.get(worker, 0) + 1
+        return max(counts, key=counts.__getitem__) if counts else None
+
+    async def build_vertex(
+        self,
+        chat_service: "ChatService",
+        vertex_id: str,
+        inputs_dict: Optional[Dict[str, str]] = None,
+        files: Optional[list[str]] = None,
+        user_id: Optional[str] = None,
+        fallback_to_env_vars: bool = False,
+    ):
+        """Builds a vertex like `Graph.build_vertex` does, on a worker when it can run on one."""
+        vertex = self.graph.get_vertex(vertex_id)
+        predecessors = self.graph.predecessor_map.get(vertex_id, [])
+        if runs_locally(vertex) or inputs_dict or files or self._local_only.intersection(predecessors):
+            restore_predecessors(self.cache_service, self.run_id, vertex, self._remote)
+            result = await self.graph.build_vertex(
+                chat_service=chat_service,
+                vertex_id=vertex_id,
+                inputs_dict=inputs_dict,
+                files=files,
+                user_id=user_id,
+                fallback_to_env_vars=fallback_to_env_vars,
+            )
+            self._store_local_result(vertex)
+            return result
+        return await self._build_remote(chat_service, vertex, user_id, fallback_to_env_vars)
+
+    def _store_local_result(self, vertex: "Vertex") -> None:
+        """Stores the built objects of a vertex built here, so the workers that build its successors read them."""
+        by_reference = store_vertex_result(self.cache_service, self.run_id, vertex)
+        self._locations[vertex.id] = (None, by_reference)
+        if not by_reference:
+            self._local_only.add(vertex.id)
+
+    async def _build_remote(
+        self, chat_service: "ChatService", vertex: "Vertex", user_id: Optional[str], fallback_to_env_vars: bool
+    ):
+        from celery.utils.nodenames import worker_direct  # type: ignore
+
+        from langflow.worker import run_vertex
+
+        build_started_at = time.perf_counter()
+        worker = self.select_worker(vertex.id)
+        inactive = [v.id for v in self.graph.vertices if v.state.name == "INACTIVE"]
+        try:
+            async_result = run_vertex.apply_async(
+                args=(self.run_id, vertex.id, user_id, fallback_to_env_vars, inactive),
+                queue=worker_direct(worker).name if worker else None,
+            )
+            summary = await self.wait_for_task(async_result, vertex)
+            self._apply_summary(vertex, summary)
+        except Exception as exc:
+            log_transaction(self.graph.flow_id, vertex, status="failure", error=str(exc))
+            raise
+        # Graph.build_vertex caches every vertex it builds, so it can be frozen afterwards
+        if summary["by_reference"] and restore_vertex_result(self.cache_service, self.run_id, vertex):
+            self._remote.discard(vertex.id)
+            await chat_service.set_cache(key=vertex.id, data=vertex)
+        observe_vertex_build(vertex, time.perf_counter() - build_started_at)
+        log_transaction(self.graph.flow_id, vertex, status="success")
+        return vertex.result, summary["params"], True, vertex.artifacts, vertex
+
+    async def wait_for_task(self, async_result: Any, vertex: "Vertex") -> Dict[str, Any]:
+        """
+        Returns the summary of the task building `vertex`, polling its state so no thread is held.
+
+        Raises:
+            TimeoutError: If the task does not finish within the timeout of the executor.
+        """
+        deadline = time.monotonic() + self.timeout
+        interval = POLL_INTERVAL
+        try:
+            while not await asyncio.to_thread(async_result.ready):
+                if time.monotonic() >= deadline:
+                    raise TimeoutError(f"No worker built {vertex.display_name} within {self.timeout} seconds")
+                await asyncio.sleep(interval)
+                interval = min(interval * 2, MAX_POLL_INTERVAL)
+        except BaseException:
+            # The run was cancelled or gave up on the vertex, so the worker stops building it
+            async_result.revoke(terminate=True)
+            raise
+        return await asyncio.to_thread(async_result.get, propagate=True)
+
+    def _apply_summary(self, vertex: "Vertex", summary: Dict[str, Any]) -> None:
+        if summary["result"] is None:
+            raise ValueError(f"No result found for vertex {vertex.id}")
+        vertex.result = ResultData(**summary["result"])
+        vertex.artifacts = vertex.result.artifacts
+        vertex._built = True
+        worker = summary["worker"]
+        self._locations[vertex.id] = (worker, summary["by_reference"])
+        self._remote.add(vertex.id)
+        if worker:
+            self._group_workers.setdefault(self.groups.get(vertex.id, vertex.id), worker)
+        # Branches the vertex activated or deactivated, e.g. a conditional router
+        for vertex_id, state in summary["states"].items():
+            other = self.graph.vertex_map.get(vertex_id)
+            if other is not None and other.state.name != state:
+                self.graph.mark_vertex(vertex_id, state)
+
+
+def load_worker_graph(cache_service: RedisCache, run_id: str) -> "Graph":
+    """Rebuilds the graph of a run from the payload written by `CeleryVertexExecutor.prepare`."""
+    from langflow.graph.graph.base import Graph
+
+    value = cache_service._client.get(get_graph_key(run_id))
+    if value is None:
+        raise ValueError(f"The distributed run {run_id} was not found in the cache")
+    payload = pickle.loads(value)
+    graph = Graph.from_payload(
+        payload["raw_graph_data"], payload["flow_id"], payload["flow_name"], payload["user_id"]
+    )
+    for vertex_id, overrides in payload["overrides"].items():
+        graph.get_vertex(vertex_id).update_raw_params(overrides, overwrite=True)
+    graph.set_run_id(payload["run_id"])
+    return graph
+
+
+def sync_vertex_states(graph: "Graph", inactive: List[str]) -> None:
+    """Sets the states of the vertices of a worker graph to the ones the API process has."""
+    inactive_ids = set(inactive)
+    for vertex in graph.vertices:
+        state = "INACTIVE" if vertex.id in inactive_ids else "ACTIVE"
+        if vertex.state.name != state:
+            graph.mark_vertex(vertex.id, state)
@@ -0,0 +1,113 @@
+from collections import defaultdict
+from dataclasses import dataclass, field
+from typing import TYPE_CHECKING, Any, Dict, List, Optional, Tuple, Type
+
+from langflow.graph.edge.base import SourceHandle, TargetHandle
+from langflow.services.session.utils import compute_dict_hash
+
+if TYPE_CHECKING:
+    from langflow.graph.graph.base import Graph
+    from langflow.graph.vertex.base import Vertex
+
+FLOW_PLAN_CACHE_PREFIX = "flow_plan"
+
+
+@dataclass(frozen=True)
+class FlowPlan:
+    """
+    A compiled, immutable snapshot of the topology of a flow.
+
+    Building a Graph from a payload ungroups the nodes, validates the handles of every edge and
+    computes the adjacency maps and the layered sort. None of that depends on the inputs of a run,
+    so the plan keeps it and `Graph.from_plan` only has to build the per-run state.
+
+    The node and edge dicts are shared by every graph created from the plan and must not be mutated.
+    """
+
+    raw_graph_data: Dict[str, Any]
+    nodes: List[Dict]
+    edges: List[Dict]
+    top_level_vertices: List[str]
+    vertex_classes: Dict[str, Type["Vertex"]]
+    handles: Dict[int, Tuple[SourceHandle, TargetHandle]]
+    predecessor_map: Dict[str, List[str]]
+    successor_map: Dict[str, List[str]]
+    in_degree_map: Dict[str, int]
+    start_component_id: Optional[str] = None
+    sorted_layers: List[List[str]] = field(default_factory=list)
+
+    @classmethod
+    def from_graph(cls, graph: "Graph") -> "FlowPlan":
+        """
+        Compiles a plan from a freshly built graph.
+
+        Args:
+            graph (Graph): A graph that has not been run yet.
+
+        Returns:
+            FlowPlan: The compiled plan.
+        """
+        handles = {}
+        for index, edge in enumerate(graph._edges):
+            if data := edge.get("data", {}):
+                handles[index] = (
+                    SourceHandle(**data.get("sourceHandle", {})),
+                    TargetHandle(**data.get("targetHandle", {})),
+                )
+
+        # layered_topological_sort consumes the in-degree map, so it is restored afterwards
+        in_degree_map = dict(graph.in_degree_map)
+        start_component_id = graph.get_start_component_id()
+        if start_component_id:
+            vertices = graph.sort_up_to_vertex(start_component_id, is_start=True)
+        else:
+            vertices = graph.vertices
+        sorted_layers = graph.layered_topological_sort(vertices)
+        graph.in_degree_map = defaultdict(int, in_degree_map)
+
+        return cls(
+            raw_graph_data=graph.raw_graph_data,
+            nodes=graph._vertices,
+            edges=graph._edges,
+            top_level_vertices=list(graph.top_level_vertices),
+            vertex_classes={vertex.id: type(vertex) for vertex in graph.vertices},
+            handles=handles,
+            predecessor_map={key: list(value) for key, value in graph.predecessor_map.items()},
+            successor_map={key: list(value) for key, value in graph.successor_map.items()},
+            in_degree_map=in_degree_map,
+            start_component_id=start_component_id,
+            sorted_layers=sorted_layers,
+        )
+
+    def build_adjacency_maps(self) -> Tuple[Dict[str, List[str]], Dict[str, List[str]], Dict[str, int]]:
+        """Returns fresh copies of the predecessor, successor and in-degree maps."""
+        predecessor_map = defaultdict(list, {key: list(value) for key, value in self.predecessor_map.items()})
+        successor_map = defaultdict(list, {key: list(value) for key, value in self.successor_map.items()})
+        in_degree_map = defaultdict(int, self.in_degree_map)
+        return predecessor_map, successor_map, in_degree_map
+
+    def get_sorted_layers(
+        self, stop_component_id: Optional[str] = None, start_component_id: Optional[str] = None
+    ) -> Optional[List[List[str]]]:
+        """
+        Returns a copy of the precomputed layered sort if it matches the requested start and stop components.
+        """
+        if stop_component_id is not None or start_component_id != self.start_component_id:
+            return None
+        return [list(layer) for layer in self.sorted_layers]
+
+
+def build_flow_plan_key(flow_id: str, version: Optional[str], tweaks: Optional[dict] = None) -> str:
+    """
+    Builds the cache key of a flow plan.
+
+    Args:
+        flow_id (str): The ID of the flow.
+        version (Optional[str]): The version of the flow, usually its `updated_at`.
+        tweaks (Optional[dict]): The tweaks applied to the flow data before compiling it.
+
+    Returns:
+        str: The cache key.
+    """
+    tweaks_hash = compute_dict_hash(tweaks) if tweaks else ""
+    return f"{FLOW_PLAN_CACHE_PREFIX}:{flow_id}:{version or ''}:{tweaks_hash}"
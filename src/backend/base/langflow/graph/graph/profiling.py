@@ -0,0 +1,34 @@
+"""
+Timing waterfall of a run.
+
+A run with a `RunProfile` records, for every build of a component, when it became runnable, when it
+started and when it finished, as seconds since the start of the run. The time between the first two is
+what the component waited (for its scheduler, for a build slot or for the event loop), the time between
+the last two is what it took to build.
+"""
+
+import time
+from typing import Dict, List, Optional
+
+
+class RunProfile:
+    def __init__(self):
+        self.started_at = time.perf_counter()
+        self.builds: List[Dict] = []
+
+    def record(self, vertex_id: str, component: Optional[str], ready_at: float, started_at: float, finished_at: float):
+        self.builds.append(
+            {
+                "vertex_id": vertex_id,
+                "component": component,
+                "ready": round(ready_at - self.started_at, 6),
+                "started": round(started_at - self.started_at, 6),
+                "finished": round(finished_at - self.started_at, 6),
+                "wait": round(started_at - ready_at, 6),
+                "execute": round(finished_at - started_at, 6),
+            }
+        )
+
+    def to_list(self) -> List[Dict]:
+        """The builds of the run, in the order they started."""
+        return sorted(self.builds, key=lambda build: build["started"])
@@ -0,0 +1,78 @@
+from typing import List, Optional
+
+from langflow.graph.graph.cancellation import CancellationToken
+from langflow.graph.graph.profiling import RunProfile
+from langflow.graph.graph.runnable_vertices_manager import RunnableVerticesManager
+from langflow.graph.graph.token_channel import TokenChannel
+
+
+class RunContext:
+    """
+    Holds the state of a single execution of a graph.
+
+    Everything a run mutates at the graph level (the run ID, the runnable vertices bookkeeping,
+    the vertices activated or inactivated by conditional components and the sorted layers) lives
+    here instead of on the Graph, so a run can be cached, restored or replaced on its own.
+
+    The build state of the vertices (whether they were built, and their results) still lives on the
+    vertices, so a graph is not shareable between concurrent runs: each run builds its own graph.
+    """
+
+    def __init__(self, run_id: str = ""):
+        self.run_id = run_id
+        self.run_manager = RunnableVerticesManager()
+        self.inactivated_vertices: set = set()
+        self.activated_vertices: List[str] = []
+        self.vertices_layers: List[List[str]] = []
+        self.vertices_to_run: set[str] = set()
+        self.stop_vertex: Optional[str] = None
+        self.sorted_vertices_layers: List[List[str]] = []
+        # The vertices that kept their results from a previous build of the flow (see `Graph.reuse_unchanged_vertices`)
+        self.reused_vertices: set[str] = set()
+        # The vertices whose state changed since the graph was last serialized, and the key it was written to
+        self.changed_vertices: set[str] = set()
+        self.serialized_to: Optional[str] = None
+        # Cancellation is local to the process running the graph, so the token is not serialized
+        self.cancellation = CancellationToken()
+        # Where the chat outputs stream their messages when the client reads the run as a stream
+        self.token_channel: Optional[TokenChannel] = None
+        # Set when the timings of the run are returned with its results
+        self.profile: Optional[RunProfile] = None
+
+    def to_dict(self) -> dict:
+        return {
+            "run_id": self.run_id,
+            "run_manager": self.run_manager.to_dict(),
+            "inactivated_vertices": self.inactivated_vertices,
+            "activated_vertices": self.activated_vertices,
+            "vertices_layers": self.vertices_layers,
+            "vertices_to_run": self.vertices_to_run,
+            "stop_vertex": self.stop_vertex,
+            "sorted_vertices_layers": self.sorted_vertices_layers,
+            "reused_vertices": self.reused_vertices,
+        }
+
+    @classmethod
+    def from_dict(cls, data: dict) -> "RunContext":
+        instance = cls(run_id=data.get("run_id", ""))
+        run_manager = data.get("run_manager")
+        if isinstance(run_manager, RunnableVerticesManager):
+            instance.run_manager = run_manager
+        elif run_manager:
+            instance.run_manager = RunnableVerticesManager.from_dict(run_manager)
+        instance.inactivated_vertices = set(data.get("inactivated_vertices", set()))
+        instance.activated_vertices = list(data.get("activated_vertices", []))
+        instance.vertices_layers = list(data.get("vertices_layers", []))
+        instance.vertices_to_run = set(data.get("vertices_to_run", set()))
+        instance.stop_vertex = data.get("stop_vertex")
+        instance.sorted_vertices_layers = list(data.get("sorted_vertices_layers", []))
+        instance.reused_vertices = set(data.get("reused_vertices", set()))
+        # The run manager shares the vertices to run with the context
+        instance.run_manager.vertices_to_run = instance.vertices_to_run
+        return instance
+
+    def __getstate__(self) -> object:
+        return self.to_dict()
+
+    def __setstate__(self, state: dict) -> None:
+        self.__dict__.update(RunContext.from_dict(state).__dict__)
@@ -10,7 +10,7 @@ if TYPE_CHECKING:
 class RunnableVerticesManager:
     def __init__(self):
         self.run_map = defaultdict(list)  # Tracks successors of each vertex
-        self.run_predecessors = defaultdict(set)  # Tracks predecessors for each vertex
+        self.run_predecessors = defaultdict(list)  # Tracks predecessors for each vertex
         self.vertices_to_run = set()  # Set of vertices that are ready to run
 
     def to_dict(self) -> dict:
@@ -68,13 +68,25 @@ class RunnableVerticesManager:
             if vertex_id in self.run_predecessors[predecessor]:
                 self.run_predecessors[predecessor].remove(vertex_id)
 
+    def add_run_predecessor(self, vertex_id: str, predecessor_id: str):
+        """Makes a vertex wait for another one it has no edge from."""
+        if vertex_id not in self.run_map[predecessor_id]:
+            self.run_map[predecessor_id].append(vertex_id)
+        if predecessor_id not in self.run_predecessors[vertex_id]:
+            self.run_predecessors[vertex_id].append(predecessor_id)
+
+    def get_run_successors(self, vertex: "Vertex") -> List[str]:
+        """Returns the successors of a vertex and the vertices that wait for it without an edge."""
+        return list(dict.fromkeys(vertex.successors_ids + self.run_map.get(vertex.id, [])))
+
     def build_run_map(self, graph):
         """Builds a map of vertices and their runnable successors."""
         self.run_map = defaultdict(list)
         for vertex_id, predecessors in graph.predecessor_map.items():
             for predecessor in predecessors:
                 self.run_map[predecessor].append(vertex_id)
-        self.run_predecessors = graph.predecessor_map.copy()
+        # Copy the lists so running the graph does not consume the graph's predecessor map
+        self.run_predecessors = defaultdict(list, {key: list(value) for key, value in graph.predecessor_map.items()})
         self.vertices_to_run = graph.vertices_to_run
 
     def update_vertex_run_state(self, vertex_id: str, is_runnable: bool):
@@ -107,9 +119,10 @@ class RunnableVerticesManager:
 
         """
         async with lock:
+            graph.prune_branch_feeders(vertex.id)
             self.remove_from_predecessors(vertex.id)
             direct_successors_ready = [
-                v for v in vertex.successors_ids if self.is_vertex_runnable(v, graph.inactivated_vertices)
+                v for v in self.get_run_successors(vertex) if self.is_vertex_runnable(v, graph.inactivated_vertices)
             ]
             if not direct_successors_ready:
                 # No direct successors ready, look for runnable predecessors of successors
@@ -0,0 +1,270 @@
+"""
+A compact, schema-versioned encoding of the state of a Graph.
+
+The state is split in fields so it can be stored in a hash and updated one vertex at a time:
+
+- `topology`: the raw flow data the graph is rebuilt from.
+- `run_context`: the per-run bookkeeping (see `RunContext`).
+- `vertex:<id>`: the build state of each vertex.
+
+Every field is encoded with orjson. Built objects that have no JSON representation
+(LLMs, vector stores, ...) are left out. When a successor asks for the result of such a
+vertex, it is built again if it is pure (see `is_pure`), and the build fails otherwise.
+"""
+
+import hashlib
+from collections import OrderedDict, defaultdict
+from typing import TYPE_CHECKING, Any, Dict, Optional
+
+import orjson
+from loguru import logger
+
+from langflow.graph.graph.run_context import RunContext
+from langflow.graph.graph.runnable_vertices_manager import RunnableVerticesManager
+from langflow.graph.schema import ResultData
+from langflow.graph.utils import UnbuiltObject, UnbuiltResult
+from langflow.schema import Data
+from langflow.schema.message import Message
+
+if TYPE_CHECKING:
+    from langflow.graph.graph.base import Graph
+    from langflow.graph.graph.plan import FlowPlan
+    from langflow.graph.vertex.base import Vertex
+
+GRAPH_SCHEMA_VERSION = 1
+SCHEMA_VERSION_FIELD = "schema_version"
+TOPOLOGY_FIELD = "topology"
+RUN_CONTEXT_FIELD = "run_context"
+VERTEX_FIELD_PREFIX = "vertex:"
+
+# Compiled plans of the topologies this process has decoded, keyed by their hash
+_PLANS_CACHE_SIZE = 32
+_plans: OrderedDict[str, "FlowPlan"] = OrderedDict()
+
+
+class GraphSchemaError(ValueError):
+    """Raised when the encoded state was written by an incompatible schema version."""
+
+
+def encode_value(value: Any) -> Any:
+    """
+    Converts a value into a JSON serializable structure that `decode_value` can revert.
+
+    Raises:
+        TypeError: If the value (or any value it contains) has no JSON representation.
+    """
+    if value is None or isinstance(value, (str, int, float, bool)):
+        return value
+    if isinstance(value, list):
+        return [encode_value(item) for item in value]
+    if isinstance(value, tuple):
+        return {"$t": "tuple", "v": [encode_value(item) for item in value]}
+    if isinstance(value, dict):
+        if not all(isinstance(key, str) for key in value):
+            raise TypeError("Only dicts with string keys can be encoded")
+        return {"$t": "dict", "v": {key: encode_value(item) for key, item in value.items()}}
+    if isinstance(value, Data):
+        if isinstance(value, Message) and not isinstance(value.text, str):
+            raise TypeError("Streaming messages cannot be encoded")
+        try:
+            dumped = value.model_dump(mode="json")
+        except Exception as exc:
+            raise TypeError(f"{type(value).__name__} holds values that cannot be encoded") from exc
+        return {"$t": "Message" if isinstance(value, Message) else "Data", "v": encode_value(dumped)}
+    raise TypeError(f"Values of type {type(value).__name__} cannot be encoded")
+
+
+def decode_value(value: Any) -> Any:
+    """Reverts `encode_value`."""
+    if isinstance(value, list):
+        return [decode_value(item) for item in value]
+    if not isinstance(value, dict):
+        return value
+    type_ = value.get("$t")
+    if type_ is None:
+        return {key: decode_value(item) for key, item in value.items()}
+    if type_ == "dict":
+        return {key: decode_value(item) for key, item in value["v"].items()}
+    decoded = decode_value(value["v"])
+    if type_ == "tuple":
+        return tuple(decoded)
+    if type_ == "Message":
+        return Message(**decoded)
+    if type_ == "Data":
+        return Data(**decoded)
+    raise TypeError(f"Unknown encoded type: {type_}")
+
+
+def _dumps(value: Any) -> bytes:
+    return orjson.dumps(value)
+
+
+def _encode_run_context(run_context: RunContext) -> bytes:
+    run_manager = run_context.run_manager
+    return _dumps(
+        {
+            "run_id": run_context.run_id,
+            "run_manager": {
+                "run_map": dict(run_manager.run_map),
+                "run_predecessors": {key: list(value) for key, value in run_manager.run_predecessors.items()},
+                "vertices_to_run": sorted(run_manager.vertices_to_run),
+            },
+            "inactivated_vertices": sorted(run_context.inactivated_vertices),
+            "activated_vertices": run_context.activated_vertices,
+            "vertices_layers": run_context.vertices_layers,
+            "vertices_to_run": sorted(run_context.vertices_to_run),
+            "stop_vertex": run_context.stop_vertex,
+            "sorted_vertices_layers": run_context.sorted_vertices_layers,
+        }
+    )
+
+
+def _decode_run_context(data: bytes) -> RunContext:
+    state = orjson.loads(data)
+    run_manager = state["run_manager"]
+    state["run_manager"] = RunnableVerticesManager.from_dict(
+        {
+            "run_map": defaultdict(list, run_manager["run_map"]),
+            "run_predecessors": defaultdict(list, run_manager["run_predecessors"]),
+            "vertices_to_run": set(run_manager["vertices_to_run"]),
+        }
+    )
+    return RunContext.from_dict(state)
+
+
+def _encode_vertex(vertex: "Vertex") -> bytes:
+    state: Dict[str, Any] = {
+        "state": vertex.state.name,
+        "built": vertex._built,
+        "build_times": vertex.build_times,
+        "task_id": vertex.task_id,
+        "raw_params": {},
+        "result": None,
+    }
+    for key, value in vertex._raw_params_overrides.items():
+        try:
+            state["raw_params"][key] = encode_value(value)
+        except TypeError:
+            continue
+    if vertex.result is not None:
+        # The result is only displayed, so values without a JSON representation are kept as strings
+        try:
+            state["result"] = orjson.loads(orjson.dumps(vertex.result.model_dump(), default=str))
+        except Exception as exc:
+            logger.debug(f"Could not encode the result of {vertex.id}: {exc}")
+
+    if vertex._built:
+        try:
+            built_object = vertex._built_object
+            built_result = vertex._built_result
+            state["built_object"] = None if isinstance(built_object, UnbuiltObject) else encode_value(built_object)
+            state["built_result"] = None if isinstance(built_result, UnbuiltResult) else encode_value(built_result)
+            state["results"] = encode_value(vertex.results)
+            state["artifacts"] = encode_value(vertex.artifacts)
+        except TypeError:
+            # Pure vertices are rebuilt the first time a successor asks for their objects
+            state["built"] = False
+            state["lazy"] = True
+            for key in ["built_object", "built_result", "results", "artifacts"]:
+                state.pop(key, None)
+    return _dumps(state)
+
+
+def _restore_vertex(vertex: "Vertex", data: bytes) -> None:
+    from langflow.graph.vertex.base import VertexStates
+
+    state = orjson.loads(data)
+    vertex.state = VertexStates[state["state"]]
+    vertex.build_times = state["build_times"]
+    vertex.task_id = state["task_id"]
+    if raw_params := {key: decode_value(value) for key, value in state["raw_params"].items()}:
+        vertex.update_raw_params(raw_params, overwrite=True)
+    if state["result"] is not None:
+        vertex.result = ResultData(**state["result"])
+    vertex._lazy_restore = state.get("lazy", False)
+    if state["built"]:
+        built_object = state["built_object"]
+        built_result = state["built_result"]
+        vertex._built_object = UnbuiltObject() if built_object is None else decode_value(built_object)
+        vertex._built_result = UnbuiltResult() if built_result is None else decode_value(built_result)
+        vertex.results = decode_value(state["results"])
+        vertex.artifacts = decode_value(state["artifacts"])
+        vertex._built = True
+
+
+def serialize_graph(graph: "Graph", full: bool = True) -> Dict[str, bytes]:
+    """
+    Encodes the state of a graph.
+
+    Args:
+        graph (Graph): The graph to encode.
+        full (bool): Whether to encode every field or only the ones changed since the last call.
+
+    Returns:
+        Dict[str, bytes]: The encoded fields.
+    """
+    run_context = graph.run_context
+    fields = {RUN_CONTEXT_FIELD: _encode_run_context(run_context)}
+    if full:
+        fields[SCHEMA_VERSION_FIELD] = str(GRAPH_SCHEMA_VERSION).encode()
+        fields[TOPOLOGY_FIELD] = _dumps(
+            {
+                "flow_id": graph.flow_id,
+                "flow_name": graph.flow_name,
+                "user_id": graph.user_id,
+                "raw_graph_data": graph.raw_graph_data,
+            }
+        )
+        vertices = graph.vertices
+    else:
+        vertices = [vertex for vertex in graph.vertices if vertex.id in run_context.changed_vertices]
+    for vertex in vertices:
+        fields[f"{VERTEX_FIELD_PREFIX}{vertex.id}"] = _encode_vertex(vertex)
+    run_context.changed_vertices.clear()
+    return fields
+
+
+def _get_plan(topology: bytes, raw_graph_data: dict, flow_id: Optional[str]) -> "FlowPlan":
+    from langflow.graph.graph.base import Graph
+    from langflow.graph.graph.plan import FlowPlan
+
+    topology_hash = hashlib.sha256(topology).hexdigest()
+    if plan := _plans.get(topology_hash):
+        _plans.move_to_end(topology_hash)
+        return plan
+    plan = FlowPlan.from_graph(Graph.from_payload(raw_graph_data, flow_id))
+    _plans[topology_hash] = plan
+    if len(_plans) > _PLANS_CACHE_SIZE:
+        _plans.popitem(last=False)
+    return plan
+
+
+def deserialize_graph(fields: Dict[str, bytes]) -> "Graph":
+    """
+    Rebuilds a graph from the fields written by `serialize_graph`.
+
+    Raises:
+        GraphSchemaError: If the fields were written by another schema version.
+    """
+    from langflow.graph.graph.base import Graph
+
+    version = fields.get(SCHEMA_VERSION_FIELD)
+    if version is None or int(version) != GRAPH_SCHEMA_VERSION:
+        raise GraphSchemaError(f"Unsupported graph schema version: {version!r}")
+    topology = orjson.loads(fields[TOPOLOGY_FIELD])
+    plan = _get_plan(fields[TOPOLOGY_FIELD], topology["raw_graph_data"], topology["flow_id"])
+    graph = Graph.from_plan(
+        plan, flow_id=topology["flow_id"], flow_name=topology["flow_name"], user_id=topology["user_id"]
+    )
+    graph.run_context = _decode_run_context(fields[RUN_CONTEXT_FIELD])
+    for vertex in graph.vertices:
+        if data := fields.get(f"{VERTEX_FIELD_PREFIX}{vertex.id}"):
+            try:
+                _restore_vertex(vertex, data)
+            except (KeyError, TypeError, ValueError) as exc:
+                logger.debug(f"Could not restore the state of {vertex.id}, it will be rebuilt: {exc}")
+                vertex._lazy_restore = True
+    graph.run_context.changed_vertices.clear()
+    graph.set_run_id(graph.run_context.run_id or None)
+    graph.set_run_name()
+    return graph
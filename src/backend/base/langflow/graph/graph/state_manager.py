@@ -1,4 +1,4 @@
-from typing import TYPE_CHECKING, Callable
+from typing import TYPE_CHECKING, Callable, Optional
 
 from loguru import logger
 
@@ -18,26 +18,17 @@ class GraphStateManager:
 
             self.state_service = InMemoryStateService(get_settings_service())
 
-    def append_state(self, key, new_state, run_id: str):
-        self.state_service.append_state(key, new_state, run_id)
+    def append_state(self, key, new_state, run_id: str, caller: Optional[str] = None):
+        self.state_service.append_state(key, new_state, run_id, caller=caller)
 
-    def update_state(self, key, new_state, run_id: str):
-        self.state_service.update_state(key, new_state, run_id)
+    def update_state(self, key, new_state, run_id: str, caller: Optional[str] = None):
+        self.state_service.update_state(key, new_state, run_id, caller=caller)
 
     def get_state(self, key, run_id: str):
         return self.state_service.get_state(key, run_id)
 
-    def subscribe(self, key, observer: Callable):
-        self.state_service.subscribe(key, observer)
+    def subscribe(self, run_id: str, observer: Callable):
+        self.state_service.subscribe(run_id, observer)
 
-    def notify_observers(self, key, new_state):
-        for callback in self.observers[key]:
-            callback(key, new_state, append=False)
-
-    def notify_append_observers(self, key, new_state):
-        for callback in self.observers[key]:
-            try:
-                callback(key, new_state, append=True)
-            except Exception as e:
-                logger.error(f"Error in observer {callback} for key {key}: {e}")
-                logger.warning("Callbacks not implemented yet")
+    def unsubscribe(self, run_id: str, observer: Callable):
+        self.state_service.unsubscribe(run_id, observer)
@@ -0,0 +1,65 @@
+"""
+Streaming of the messages of a run to its client.
+
+When a run has a `TokenChannel`, every chat output that receives a stream sends its chunks to the channel
+as the model generates them, from the task that builds it, instead of leaving the stream to be read by a
+second request. The channel is bounded: when the client reads slower than the model writes, the build
+waits for room, so the model is not read ahead of the client.
+"""
+
+import asyncio
+from collections import deque
+from typing import Deque, Tuple
+
+
+class TokenChannelClosedError(RuntimeError):
+    """Raised when a chunk is sent to a channel that was closed, e.g. because its client went away."""
+
+
+class TokenChannel:
+    def __init__(self, max_size: int = 64):
+        self.max_size = max(1, max_size)
+        self._chunks: Deque[Tuple[str, str]] = deque()
+        self._readable = asyncio.Event()
+        self._writable = asyncio.Event()
+        self._writable.set()
+        self.closed = False
+
+    async def send(self, vertex_id: str, chunk: str) -> None:
+        """
+        Sends a chunk of the message of a vertex, waiting while the channel is full.
+
+        Raises:
+            TokenChannelClosedError: If the channel is closed, including while waiting for room.
+        """
+        while True:
+            if self.closed:
+                raise TokenChannelClosedError("Cannot send to a closed token channel")
+            if len(self._chunks) < self.max_size:
+                break
+            self._writable.clear()
+            await self._writable.wait()
+        self._chunks.append((vertex_id, chunk))
+        self._readable.set()
+
+    def close(self) -> None:
+        """
+        Ends the stream once the chunks already sent are read. Nothing can be sent after, and the
+        senders waiting for room fail.
+        """
+        self.closed = True
+        self._readable.set()
+        self._writable.set()
+
+    def __aiter__(self) -> "TokenChannel":
+        return self
+
+    async def __anext__(self) -> Tuple[str, str]:
+        while not self._chunks:
+            if self.closed:
+                raise StopAsyncIteration
+            self._readable.clear()
+            await self._readable.wait()
+        chunk = self._chunks.popleft()
+        self._writable.set()
+        return chunk
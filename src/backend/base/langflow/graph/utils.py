@@ -4,6 +4,7 @@ from typing import Any, Generator, Union
 from langchain_core.documents import Document
 from pydantic import BaseModel
 
+from langflow.base.data.ingestion import DataStream
 from langflow.interface.utils import extract_input_variables_from_prompt
 from langflow.schema.data import Data
 from langflow.schema.message import Message
@@ -57,6 +58,9 @@ def serialize_field(value):
 
     if isinstance(value, (list, tuple)):
         return [serialize_field(v) for v in value]
+    elif isinstance(value, DataStream):
+        # Reading the stream to serialize it would consume it
+        return {"result": repr(value)}
     elif isinstance(value, Document):
         return value.to_json()
     elif isinstance(value, BaseModel):
@@ -12,6 +12,15 @@ from loguru import logger
 from langflow.exceptions.component import ComponentBuildException
 from langflow.graph.schema import INPUT_COMPONENTS, OUTPUT_COMPONENTS, InterfaceComponentTypes, ResultData
 from langflow.graph.utils import UnbuiltObject, UnbuiltResult
+from langflow.graph.vertex.memoization import (
+    MEMOIZED_ATTRIBUTES,
+    build_memo_key,
+    get_memoized_result,
+    is_memoizable,
+    is_pure,
+    set_memoized_result,
+)
+from langflow.graph.vertex.utils import can_stop_branches
 from langflow.interface.initialize import loading
 from langflow.interface.listing import lazy_load_dict
 from langflow.schema.artifact import ArtifactType
@@ -87,6 +96,15 @@ class Vertex:
             self.is_interface_component = False
 
         self.use_result = False
+        self._memo_key: Optional[str] = None
+        # The hash of the values its global variables had when it was built (see `hash_load_from_db_fields`)
+        self.variables_hash: Optional[str] = None
+        # Params set at runtime with update_raw_params, kept so they survive serialization
+        self._raw_params_overrides: Dict[str, Any] = {}
+        # Set when the vertex was restored without its built objects and has to be rebuilt on demand
+        self._lazy_restore = False
+        # Set when the built state was copied from a vertex built once for many runs (see `share_built_state`)
+        self._shared_build = False
         self.build_times: List[float] = []
         self.state = VertexStates.ACTIVE
 
@@ -101,6 +119,7 @@ class Vertex:
 
     def set_state(self, state: str):
         self.state = VertexStates[state]
+        self._mark_changed()
         if self.state == VertexStates.INACTIVE and self.graph.in_degree_map[self.id] < 2:
             # If the vertex is inactive and has only one in degree
             # it means that it is not a merge point in the graph
@@ -114,6 +133,12 @@ class Vertex:
 
     def add_build_time(self, time):
         self.build_times.append(time)
+        self._mark_changed()
+
+    def _mark_changed(self):
+        # Lets the graph serializer only write the vertices that changed
+        if self.graph is not None:
+            self.graph.run_context.changed_vertices.add(self.id)
 
     def set_result(self, result: ResultData) -> None:
         self.result = result
@@ -175,6 +200,12 @@ class Vertex:
         return state
 
     def __setstate__(self, state):
+        state.setdefault("_memo_key", None)
+        state.setdefault("variables_hash", None)
+        state.setdefault("_raw_params_overrides", {})
+        state.setdefault("_lazy_restore", False)
+        state.setdefault("_shared_build", False)
+        state.setdefault("can_stop_branches", False)
         self.__dict__.update(state)
         self._lock = asyncio.Lock()  # Reinitialize the lock
         self._built_object = state.get("_built_object") or UnbuiltObject()
@@ -203,6 +234,9 @@ class Vertex:
         template_dicts = {key: value for key, value in self.data["node"]["template"].items() if isinstance(value, dict)}
 
         self.has_session_id = "session_id" in template_dicts
+        # Components that call `stop` can inactivate some of their successors, like routers
+        code = template_dicts.get("code", {}).get("value")
+        self.can_stop_branches = can_stop_branches(self.data["node"].get("outputs") or [], code)
 
         self.required_inputs: list[str] = []
         self.optional_inputs: list[str] = []
@@ -398,8 +432,10 @@ class Vertex:
                 if key not in self._raw_params:
                     new_params.pop(key)  # type: ignore
         self._raw_params.update(new_params)
+        self._raw_params_overrides.update(new_params)
         self.params = self._raw_params.copy()
         self.updated_raw_params = True
+        self._mark_changed()
 
     async def _build(
         self,
@@ -411,8 +447,18 @@ class Vertex:
         """
         logger.debug(f"Building {self.display_name}")
         await self._build_each_vertex_in_params_dict(user_id)
-        await self._get_and_instantiate_class(user_id, fallback_to_env_vars)
-        self._validate_built_object()
+        memo_key = build_memo_key(self, user_id) if is_memoizable(self) else None
+        if memo_key and (attributes := await get_memoized_result(memo_key)):
+            logger.debug(f"Using memoized result for {self.display_name}")
+            for attribute, value in attributes.items():
+                setattr(self, attribute, value)
+            self._custom_component = None
+        else:
+            await self._get_and_instantiate_class(user_id, fallback_to_env_vars)
+            self._validate_built_object()
+            if memo_key:
+                await set_memoized_result(memo_key, self)
+        self._memo_key = memo_key
 
         self._built = True
 
@@ -523,6 +569,15 @@ class Vertex:
         Returns:
             The result of the vertex.
         """
+        if self._lazy_restore and not self._built:
+            # The built objects were not part of the cached state. Only a pure vertex is built again
+            # for them, the others would repeat their side effects.
+            if not is_pure(self):
+                raise ValueError(
+                    f"The result of {self.display_name} was not kept with the cached flow and it cannot be"
+                    " built again without repeating its side effects. Please build the flow again."
+                )
+            await self.build(user_id=self.graph.user_id)
         async with self._lock:
             return await self._get_result(requester)
 
@@ -664,16 +719,34 @@ class Vertex:
         self._built_result = UnbuiltResult()
         self.artifacts = {}
         self.steps_ran = []
+        self._memo_key = None
+        self.variables_hash = None
         self._build_params()
 
     def _is_chat_input(self):
         return False
 
+    def share_built_state(self, source: "Vertex") -> None:
+        """
+        Copies the built state of the same vertex in another graph.
+
+        The built objects are shared by reference, so this is only meant for vertices whose
+        result does not depend on the inputs of a run, like LLM clients or vector store connections.
+        """
+        for attribute in MEMOIZED_ATTRIBUTES:
+            setattr(self, attribute, getattr(source, attribute))
+        self.result = source.result
+        self._memo_key = source._memo_key
+        self.variables_hash = source.variables_hash
+        self._built = source._built
+        self._shared_build = True
+
     def build_inactive(self):
         # Just set the results to None
         self._built = True
         self._built_object = None
         self._built_result = None
+        self._mark_changed()
 
     async def build(
         self,
@@ -691,10 +764,14 @@ class Vertex:
 
             if self.frozen and self._built:
                 return self.get_requester_result(requester)
+            elif self._shared_build and self._built:
+                return await self.get_requester_result(requester)
             elif self._built and requester is not None:
                 # This means that the vertex has already been built
                 # and we are just getting the result for the requester
                 return await self.get_requester_result(requester)
+            # Builds of a cancelled run, or of one past its deadline, do not start
+            self.graph.cancellation.raise_if_cancelled()
             self._reset()
 
             if self._is_chat_input() and (inputs or files):
@@ -716,6 +793,8 @@ class Vertex:
                     self.steps_ran.append(step)
 
             self._finalize_build()
+            self._lazy_restore = False
+            self._mark_changed()
 
         result = await self.get_requester_result(requester)
         return result
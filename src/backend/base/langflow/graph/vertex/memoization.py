@@ -0,0 +1,231 @@
+import hashlib
+import pickle
+import threading
+import time
+from collections import OrderedDict
+from typing import TYPE_CHECKING, Any, Coroutine, Dict, Optional
+
+import orjson
+from loguru import logger
+from pydantic import BaseModel
+
+from langflow.schema import Data
+from langflow.schema.message import Message
+from langflow.services.cache.service import RedisCache
+from langflow.services.cache.utils import estimate_size
+from langflow.services.deps import get_cache_service, get_settings_service
+
+if TYPE_CHECKING:
+    from langflow.graph.vertex.base import Vertex
+
+MEMO_CACHE_PREFIX = "vertex_memo"
+
+# The attributes a build sets on the vertex. They are what a memoized result restores.
+MEMOIZED_ATTRIBUTES = [
+    "_built_object",
+    "_built_result",
+    "artifacts",
+    "artifacts_raw",
+    "artifacts_type",
+    "results",
+    "outputs_logs",
+]
+
+
+class MemoIndex:
+    """
+    Tracks the memoized results stored in the cache service by this process.
+
+    The cache service has no notion of per-entry expiration or size, so the index
+    keeps the size and the creation time of every entry and evicts the least recently
+    used ones once the size budget is exceeded.
+    """
+
+    def __init__(self):
+        self._entries: OrderedDict[str, tuple[int, float]] = OrderedDict()
+        self._lock = threading.Lock()
+        self.total_size = 0
+
+    def add(self, key: str, size: int, max_size: int) -> list[str]:
+        """Adds an entry and returns the keys that have to be evicted to respect `max_size`."""
+        evicted = []
+        with self._lock:
+            self._discard(key)
+            self._entries[key] = (size, time.time())
+            self.total_size += size
+            while self.total_size > max_size and len(self._entries) > 1:
+                oldest_key = next(iter(self._entries))
+                self._discard(oldest_key)
+                evicted.append(oldest_key)
+        return evicted
+
+    def touch(self, key: str, ttl: int) -> bool:
+        """Marks an entry as used. Returns False if it is unknown or older than `ttl` seconds."""
+        with self._lock:
+            if key not in self._entries:
+                return False
+            _, created_at = self._entries[key]
+            if time.time() - created_at >= ttl:
+                self._discard(key)
+                return False
+            self._entries.move_to_end(key)
+            return True
+
+    def remove(self, key: str) -> None:
+        with self._lock:
+            self._discard(key)
+
+    def _discard(self, key: str) -> None:
+        if key in self._entries:
+            size, _ = self._entries.pop(key)
+            self.total_size -= size
+
+
+memo_index = MemoIndex()
+
+
+def is_pure(vertex: "Vertex") -> bool:
+    """Whether building the vertex again gives the same result and has no side effects."""
+    if vertex.is_state or vertex.is_interface_component or vertex.frozen:
+        return False
+    return vertex.vertex_type in get_settings_service().settings.memoizable_components
+
+
+def is_memoizable(vertex: "Vertex") -> bool:
+    """Whether the results of the vertex can be memoized across runs."""
+    return get_settings_service().settings.vertex_memoization and is_pure(vertex)
+
+
+def _canonicalize(value: Any) -> Any:
+    """
+    Converts a resolved param into a JSON serializable value that only depends on its content.
+
+    Raises:
+        TypeError: If the value has no stable representation.
+    """
+    if value is None or isinstance(value, (str, int, float, bool)):
+        return value
+    if isinstance(value, (list, tuple)):
+        return [_canonicalize(item) for item in value]
+    if isinstance(value, (set, frozenset)):
+        return sorted((_canonicalize(item) for item in value), key=repr)
+    if isinstance(value, dict):
+        return {str(key): _canonicalize(item) for key, item in value.items()}
+    if isinstance(value, Message):
+        # The timestamp and the IDs change every run but do not change the content
+        if not isinstance(value.text, str):
+            raise TypeError("Streaming messages cannot be memoized")
+        return {"text": value.text, "files": _canonicalize(value.files), "data": _canonicalize(value.data)}
+    if isinstance(value, Data):
+        return {"data": _canonicalize(value.data)}
+    if isinstance(value, BaseModel):
+        return _canonicalize(value.model_dump())
+    raise TypeError(f"Values of type {type(value).__name__} cannot be memoized")
+
+
+def build_memo_key(vertex: "Vertex", user_id: Optional[str] = None) -> Optional[str]:
+    """
+    Builds the content address of the result of a vertex.
+
+    The key is a hash of the vertex code and its resolved params. Params that come from another
+    memoized vertex are represented by that vertex's key, so the objects they hold do not need
+    to be serializable.
+
+    Returns:
+        Optional[str]: The key, or None if a param has no stable representation.
+    """
+    from langflow.graph.vertex.base import Vertex
+
+    params: Dict[str, Any] = {}
+    for key, value in vertex.params.items():
+        if key == "code":
+            continue
+        raw_value = vertex._raw_params.get(key)
+        raw_vertices = raw_value if isinstance(raw_value, list) else [raw_value]
+        if raw_vertices and all(isinstance(item, Vertex) for item in raw_vertices):
+            upstream_keys = [item._memo_key for item in raw_vertices]
+            if all(upstream_keys):
+                params[key] = {"memo_keys": upstream_keys}
+                continue
+        try:
+            params[key] = _canonicalize(value)
+        except TypeError as exc:
+            logger.debug(f"Not memoizing {vertex.display_name}: {exc}")
+            return None
+
+    code = vertex.params.get("code") or ""
+    payload = {
+        "vertex_type": vertex.vertex_type,
+        "code_hash": hashlib.sha256(str(code).encode("utf-8")).hexdigest(),
+        "outputs": [output.get("name") for output in vertex.outputs],
+        "user_id": str(user_id) if user_id else None,
+        "params": params,
+    }
+    try:
+        serialized = orjson.dumps(payload, option=orjson.OPT_SORT_KEYS)
+    except TypeError as exc:
+        logger.debug(f"Not memoizing {vertex.display_name}: {exc}")
+        return None
+    return f"{MEMO_CACHE_PREFIX}:{hashlib.sha256(serialized).hexdigest()}"
+
+
+async def get_memoized_result(key: str) -> Optional[Dict[str, Any]]:
+    """Returns the memoized attributes stored under `key`, if any and not expired."""
+    settings = get_settings_service().settings
+    cache_service = get_cache_service()
+    # Entries this process does not know about may have been stored by another worker
+    if not memo_index.touch(key, settings.vertex_memoization_ttl) and not isinstance(cache_service, RedisCache):
+        return None
+    result = cache_service.get(key)
+    if isinstance(result, Coroutine):
+        result = await result
+    if isinstance(result, bytes):
+        result = pickle.loads(result)
+    if not isinstance(result, dict) or "attributes" not in result:
+        return None
+    if time.time() - result["created_at"] >= settings.vertex_memoization_ttl:
+        await _delete(key)
+        return None
+    return result["attributes"]
+
+
+async def set_memoized_result(key: str, vertex: "Vertex") -> bool:
+    """
+    Stores the result of a freshly built vertex under `key`.
+
+    The entry is pickled so every run gets its own copy. Results that cannot be pickled
+    are kept by reference, which only the in-memory caches support.
+    """
+    settings = get_settings_service().settings
+    cache_service = get_cache_service()
+    entry = {
+        "created_at": time.time(),
+        "attributes": {attribute: getattr(vertex, attribute) for attribute in MEMOIZED_ATTRIBUTES},
+    }
+    value: Any
+    try:
+        value = pickle.dumps(entry)
+        size = len(value)
+    except Exception as exc:
+        if isinstance(cache_service, RedisCache):
+            logger.debug(f"Not memoizing {vertex.display_name}: {exc}")
+            return False
+        value = entry
+        size = estimate_size(entry)
+    if size > settings.vertex_memoization_max_size:
+        logger.debug(f"Not memoizing {vertex.display_name}: {size} bytes exceed the memoization budget")
+        return False
+
+    result = cache_service.set(key, value)
+    if isinstance(result, Coroutine):
+        await result
+    for evicted_key in memo_index.add(key, size, settings.vertex_memoization_max_size):
+        await _delete(evicted_key)
+    return True
+
+
+async def _delete(key: str) -> None:
+    memo_index.remove(key)
+    result = get_cache_service().delete(key)
+    if isinstance(result, Coroutine):
+        await result
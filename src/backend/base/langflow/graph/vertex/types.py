@@ -1,4 +1,6 @@
 import json
+import time
+from contextlib import aclosing
 from typing import TYPE_CHECKING, Any, AsyncIterator, Dict, Generator, Iterator, List
 
 import yaml
@@ -12,6 +14,7 @@ from langflow.schema import Data
 from langflow.schema.artifact import ArtifactType
 from langflow.schema.message import Message
 from langflow.schema.schema import INPUT_FIELD_NAME
+from langflow.services.monitor.metrics import observe_time_to_first_token
 from langflow.services.monitor.utils import log_transaction, log_vertex_build
 from langflow.template.field.base import UNDEFINED
 from langflow.utils.schemas import ChatOutputResponse, DataOutputResponse
@@ -19,6 +22,7 @@ from langflow.utils.util import unescape_string
 
 if TYPE_CHECKING:
     from langflow.graph.edge.base import ContractEdge
+    from langflow.graph.graph.token_channel import TokenChannel
 
 
 class CustomComponentVertex(Vertex):
@@ -162,7 +166,10 @@ class InterfaceVertex(ComponentVertex):
         self.steps = [self._build, self._run]
 
     def build_stream_url(self):
-        return f"/api/v1/build/{self.graph.flow_id}/{self.id}/stream"
+        stream_url = f"/api/v1/build/{self.graph.flow_id}/{self.id}/stream"
+        if run_id := self.graph.run_context.run_id:
+            stream_url += f"?run_id={run_id}"
+        return stream_url
 
     def _built_object_repr(self):
         if self.task_id and self.is_task:
@@ -323,18 +330,44 @@ class InterfaceVertex(ComponentVertex):
             raise ValueError("The message must be an iterator or an async iterator.")
         is_async = isinstance(iterator, AsyncIterator)
         complete_message = ""
-        if is_async:
-            async for message in iterator:
-                message = message.content if hasattr(message, "content") else message
-                message = message.text if hasattr(message, "text") else message
-                yield message
-                complete_message += message
-        else:
-            for message in iterator:
-                message = message.content if hasattr(message, "content") else message
-                message = message.text if hasattr(message, "text") else message
-                yield message
-                complete_message += message
+        cancellation = self.graph.cancellation
+        completed = False
+        started_at = time.perf_counter()
+        first_chunk = True
+        try:
+            if is_async:
+                async for message in iterator:
+                    if cancellation.cancelled:
+                        break
+                    if first_chunk:
+                        observe_time_to_first_token(self, time.perf_counter() - started_at)
+                        first_chunk = False
+                    message = message.content if hasattr(message, "content") else message
+                    message = message.text if hasattr(message, "text") else message
+                    yield message
+                    complete_message += message
+            else:
+                for message in iterator:
+                    if cancellation.cancelled:
+                        break
+                    if first_chunk:
+                        observe_time_to_first_token(self, time.perf_counter() - started_at)
+                        first_chunk = False
+                    message = message.content if hasattr(message, "content") else message
+                    message = message.text if hasattr(message, "text") else message
+                    yield message
+                    complete_message += message
+            completed = not cancellation.cancelled
+        finally:
+            # When the run is cancelled or the client stops reading, closing the iterator
+            # stops the model from generating the rest of the message
+            if not completed:
+                if hasattr(iterator, "aclose"):
+                    await iterator.aclose()
+                elif hasattr(iterator, "close"):
+                    iterator.close()
+        # A run past its deadline keeps the partial message, a cancelled one does not
+        cancellation.raise_if_cancelled(include_deadline=False)
         self.artifacts = ChatOutputResponse(
             message=complete_message,
             sender=self.params.get("sender", ""),
@@ -388,6 +421,14 @@ class InterfaceVertex(ComponentVertex):
         async for _ in self.stream():
             pass
 
+    async def stream_to(self, channel: "TokenChannel"):
+        """Sends the chunks of the message to the channel of the run as they are generated."""
+        # Closes the stream of the model right away if the run is cancelled while sending
+        async with aclosing(self.stream()) as chunks:
+            async for chunk in chunks:
+                await channel.send(self.id, chunk)
+        self.will_stream = False
+
     def _is_chat_input(self):
         return self.vertex_type == InterfaceComponentTypes.ChatInput and self.is_input
 
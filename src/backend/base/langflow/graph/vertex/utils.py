@@ -1,9 +1,39 @@
-from typing import TYPE_CHECKING
+import ast
+from functools import lru_cache
+from typing import TYPE_CHECKING, Any, Dict, List
 
 if TYPE_CHECKING:
     from langflow.graph.vertex.base import Vertex
 
 
+def can_stop_branches(outputs: List[Dict[str, Any]], code: Any) -> bool:
+    """
+    Whether a component can inactivate some of its successors, like a router.
+
+    Its outputs declare it with `can_stop`. The outputs of flows saved before they did have no such
+    field, so the code of the component is also checked for a call to `self.stop`.
+    """
+    if any(output.get("can_stop") for output in outputs):
+        return True
+    return isinstance(code, str) and "stop" in code and calls_stop(code)
+
+
+@lru_cache(maxsize=512)
+def calls_stop(code: str) -> bool:
+    try:
+        tree = ast.parse(code)
+    except SyntaxError:
+        return False
+    return any(
+        isinstance(node, ast.Call)
+        and isinstance(node.func, ast.Attribute)
+        and node.func.attr == "stop"
+        and isinstance(node.func.value, ast.Name)
+        and node.func.value.id == "self"
+        for node in ast.walk(tree)
+    )
+
+
 def build_clean_params(target: "Vertex") -> dict:
     """
     Cleans the parameters of the target vertex.
@@ -3,13 +3,15 @@ from uuid import UUID
 
 from fastapi import Depends, HTTPException
 from pydantic.v1 import BaseModel, Field, create_model
-from sqlmodel import Session, select
+from sqlmodel import select
+from sqlmodel.ext.asyncio.session import AsyncSession
 
 from langflow.graph.schema import RunOutputs
 from langflow.schema import Data
 from langflow.schema.schema import INPUT_FIELD_NAME
+from langflow.services.cache.lookups import FlowRef, build_flow_ref_cache_key, get_flow_ref_cache
 from langflow.services.database.models.flow import Flow
-from langflow.services.deps import get_session, get_settings_service, session_scope
+from langflow.services.deps import get_async_session, get_settings_service, session_scope
 
 if TYPE_CHECKING:
     from langflow.graph.graph.base import Graph
@@ -243,25 +245,57 @@ def get_arg_names(inputs: List["Vertex"]) -> List[dict[str, str]]:
     ]
 
 
-def get_flow_by_id_or_endpoint_name(
-    flow_id_or_name: str, db: Session = Depends(get_session), user_id: Optional[UUID] = None
+async def get_flow_by_id_or_endpoint_name(
+    flow_id_or_name: str, db: AsyncSession = Depends(get_async_session), user_id: Optional[UUID] = None
 ) -> Flow:
     endpoint_name = None
     try:
         flow_id = UUID(flow_id_or_name)
-        flow = db.get(Flow, flow_id)
+        flow = await db.get(Flow, flow_id)
     except ValueError:
         endpoint_name = flow_id_or_name
         stmt = select(Flow).where(Flow.endpoint_name == endpoint_name)
         if user_id:
             stmt = stmt.where(Flow.user_id == user_id)
-        flow = db.exec(stmt).first()
+        flow = (await db.exec(stmt)).first()
     if flow is None:
         raise HTTPException(status_code=404, detail=f"Flow identifier {flow_id_or_name} not found")
 
+    # Detached, so the endpoints can use it with their own session
+    db.expunge(flow)
     return flow
 
 
+async def get_flow_ref_by_id_or_endpoint_name(
+    flow_id_or_name: str, db: AsyncSession = Depends(get_async_session), user_id: Optional[UUID] = None
+) -> FlowRef:
+    """
+    Resolves a flow like `get_flow_by_id_or_endpoint_name`, without loading its data.
+
+    The answer is cached for `lookup_cache_ttl` seconds, see `langflow.services.cache.lookups`.
+    """
+    cache = get_flow_ref_cache()
+    cache_key = build_flow_ref_cache_key(flow_id_or_name, user_id)
+    if cache is not None and (flow_ref := cache.get(cache_key)) is not None:
+        return flow_ref
+
+    stmt = select(Flow.id, Flow.name, Flow.user_id, Flow.endpoint_name, Flow.updated_at)
+    try:
+        stmt = stmt.where(Flow.id == UUID(flow_id_or_name))
+    except ValueError:
+        stmt = stmt.where(Flow.endpoint_name == flow_id_or_name)
+        if user_id:
+            stmt = stmt.where(Flow.user_id == user_id)
+    row = (await db.exec(stmt)).first()  # type: ignore
+    if row is None:
+        raise HTTPException(status_code=404, detail=f"Flow identifier {flow_id_or_name} not found")
+
+    flow_ref = FlowRef(*row)
+    if cache is not None:
+        cache.set(cache_key, flow_ref)
+    return flow_ref
+
+
 def generate_unique_flow_name(flow_name, user_id, session):
     original_name = flow_name
     n = 1
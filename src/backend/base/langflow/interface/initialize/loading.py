@@ -1,14 +1,16 @@
+import hashlib
 import inspect
 import json
 import os
 import warnings
-from typing import TYPE_CHECKING, Any, Type
+from typing import TYPE_CHECKING, Any, Callable, List, Optional, Type
 
 import orjson
 from loguru import logger
 from pydantic import PydanticDeprecatedSince20
 
 from langflow.custom import Component, CustomComponent
+from langflow.custom.custom_component.execution import run_sync_method
 from langflow.custom.eval import eval_custom_component_code
 from langflow.schema import Data
 from langflow.schema.artifact import get_artifact_type, post_process_raw
@@ -64,6 +66,7 @@ async def build_component_and_get_results(
     params_copy = update_params_with_load_from_db_fields(
         custom_component, params_copy, vertex.load_from_db_fields, fallback_to_env_vars
     )
+    vertex.variables_hash = hash_load_from_db_fields(params_copy, vertex.load_from_db_fields)
     with warnings.catch_warnings():
         warnings.filterwarnings("ignore", category=PydanticDeprecatedSince20)
         if base_type == "custom_components" and isinstance(custom_component, CustomComponent):
@@ -100,16 +103,22 @@ def convert_kwargs(params):
 
 def update_params_with_load_from_db_fields(
     custom_component: "CustomComponent", params, load_from_db_fields, fallback_to_env_vars=False
+):
+    return resolve_load_from_db_fields(custom_component.variables, params, load_from_db_fields, fallback_to_env_vars)
+
+
+def resolve_load_from_db_fields(
+    get_variable: Callable[[str, str], Any], params, load_from_db_fields, fallback_to_env_vars=False
 ):
     # For each field in load_from_db_fields, we will check if it's in the params
-    # and if it is, we will get the value from the custom_component.keys(name)
+    # and if it is, we will get the value from get_variable(name, field)
     # and update the params with the value
     for field in load_from_db_fields:
         if field in params:
             try:
                 key = None
                 try:
-                    key = custom_component.variables(params[field], field)
+                    key = get_variable(params[field], field)
                 except ValueError as e:
                     # check if "User id is not set" is in the error message
                     if "User id is not set" in str(e) and not fallback_to_env_vars:
@@ -137,6 +146,18 @@ def update_params_with_load_from_db_fields(
     return params
 
 
+def hash_load_from_db_fields(params: dict, load_from_db_fields: List[str]) -> Optional[str]:
+    """
+    Hashes the resolved values of the global variables of a vertex, so a change of a value can be
+    told without keeping it. Returns None if the vertex has no global variables.
+    """
+    fields = sorted(field for field in load_from_db_fields if field in params)
+    if not fields:
+        return None
+    payload = [[field, None if params[field] is None else str(params[field])] for field in fields]
+    return hashlib.sha256(orjson.dumps(payload)).hexdigest()
+
+
 async def build_component(
     params: dict,
     custom_component: "Component",
@@ -165,8 +186,8 @@ async def build_custom_component(params: dict, custom_component: "CustomComponen
         # Await the build method directly if it's async
         build_result = await custom_component.build(**params)
     else:
-        # Call the build method directly if it's sync
-        build_result = custom_component.build(**params)
+        # Call the build method according to the execution class of the component if it's sync
+        build_result = await run_sync_method(custom_component, "build", **params)
     custom_repr = custom_component.custom_repr()
     if custom_repr is None and isinstance(build_result, (dict, Data, str)):
         custom_repr = build_result
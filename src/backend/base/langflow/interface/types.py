@@ -1,9 +1,10 @@
 import asyncio
 import json
+from typing import TYPE_CHECKING, Optional
 
-from typing import TYPE_CHECKING
 from loguru import logger
 
+from langflow.custom.directory_reader.snapshot import ComponentRegistrySnapshot, get_snapshot_path
 from langflow.custom.utils import abuild_custom_components, build_custom_components
 
 if TYPE_CHECKING:
@@ -11,9 +12,9 @@ if TYPE_CHECKING:
     from langflow.services.settings.service import SettingsService
 
 
-async def aget_all_types_dict(components_paths):
+async def aget_all_types_dict(components_paths, snapshot: Optional[ComponentRegistrySnapshot] = None):
     """Get all types dictionary combining native and custom components."""
-    custom_components_from_file = await abuild_custom_components(components_paths=components_paths)
+    custom_components_from_file = await abuild_custom_components(components_paths=components_paths, snapshot=snapshot)
     return custom_components_from_file
 
 
@@ -57,6 +58,16 @@ def get_all_components(components_paths, as_dict=False):
     return components
 
 
+def load_components_snapshot(settings_service: "SettingsService") -> Optional[ComponentRegistrySnapshot]:
+    """Loads the component registry snapshot if it is enabled."""
+    settings = settings_service.settings
+    if not settings.components_snapshot:
+        return None
+    if path := get_snapshot_path(settings.config_dir, settings.components_snapshot_path):
+        return ComponentRegistrySnapshot.load(path)
+    return None
+
+
 async def get_and_cache_all_types_dict(
     settings_service: "SettingsService",
     cache_service: "CacheService",
@@ -66,6 +77,9 @@ async def get_and_cache_all_types_dict(
     all_types_dict = await cache_service.get(key="all_types_dict", lock=lock)
     if not all_types_dict or force_refresh:
         logger.debug("Building langchain types dict")
-        all_types_dict = await aget_all_types_dict(settings_service.settings.components_path)
+        snapshot = load_components_snapshot(settings_service)
+        all_types_dict = await aget_all_types_dict(settings_service.settings.components_path, snapshot=snapshot)
+        if snapshot is not None:
+            snapshot.save()
     await cache_service.set(key="all_types_dict", value=all_types_dict, lock=lock)
     return all_types_dict
@@ -8,7 +8,7 @@ from urllib.parse import urlencode
 import nest_asyncio  # type: ignore
 from fastapi import FastAPI, Request, Response
 from fastapi.middleware.cors import CORSMiddleware
-from fastapi.responses import FileResponse
+from fastapi.responses import FileResponse, JSONResponse
 from fastapi.staticfiles import StaticFiles
 from loguru import logger
 from pydantic import PydanticDeprecatedSince20
@@ -16,6 +16,8 @@ from rich import print as rprint
 from starlette.middleware.base import BaseHTTPMiddleware
 
 from langflow.api import router
+from langflow.base.vectorstores.connections import close_connections
+from langflow.custom.custom_component.execution import shutdown_execution_pools
 from langflow.initial_setup.setup import (
     create_or_update_starter_projects,
     initialize_super_user_if_needed,
@@ -23,8 +25,11 @@ from langflow.initial_setup.setup import (
 )
 from langflow.interface.types import get_and_cache_all_types_dict
 from langflow.interface.utils import setup_llm_caching
+from langflow.services.database.utils import migrate_messages_in_background
 from langflow.services.deps import get_cache_service, get_settings_service, get_telemetry_service
+from langflow.services.monitor.metrics import get_metrics
 from langflow.services.plugins.langfuse_plugin import LangfuseInstance
+from langflow.services.task.admission import AdmissionRejectedException
 from langflow.services.utils import initialize_services, teardown_services
 from langflow.utils.logger import configure
 
@@ -88,6 +93,7 @@ def get_lifespan(fix_migration=False, socketio_server=None, version=None):
             task = asyncio.create_task(get_and_cache_all_types_dict(get_settings_service(), get_cache_service()))
             await create_or_update_starter_projects(task)
             asyncio.create_task(get_telemetry_service().start())
+            asyncio.create_task(asyncio.to_thread(migrate_messages_in_background))
             load_flows_from_directory()
             yield
         except Exception as exc:
@@ -97,6 +103,8 @@ def get_lifespan(fix_migration=False, socketio_server=None, version=None):
         # Shutdown message
         rprint("[bold red]Shutting down Langflow...[/bold red]")
         teardown_services()
+        shutdown_execution_pools()
+        close_connections()
 
     return lifespan
 
@@ -141,6 +149,20 @@ def create_app():
     def health():
         return {"status": "ok"}
 
+    @app.get("/metrics")
+    def metrics():
+        if (process_metrics := get_metrics()) is None:
+            return Response(status_code=404)
+        return Response(process_metrics.export(), media_type="text/plain; version=0.0.4; charset=utf-8")
+
+    @app.exception_handler(AdmissionRejectedException)
+    async def admission_rejected_handler(request: Request, exc: AdmissionRejectedException):
+        return JSONResponse(
+            status_code=429,
+            content={"detail": str(exc)},
+            headers={"Retry-After": str(exc.retry_after)},
+        )
+
     app.include_router(router)
 
     return app
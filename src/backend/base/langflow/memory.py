@@ -6,9 +6,9 @@ from sqlalchemy import delete
 from sqlmodel import Session, col, select
 
 from langflow.schema.message import Message
+from langflow.services.chat.message_window import get_message_windows, invalidate_message_windows
 from langflow.services.database.models.message.model import MessageRead, MessageTable
-from langflow.services.database.utils import migrate_messages_from_monitor_service_to_database
-from langflow.services.deps import session_scope
+from langflow.services.deps import async_session_scope, session_scope
 
 
 def get_messages(
@@ -33,8 +33,13 @@ def get_messages(
     Returns:
         List[Data]: A list of Data objects representing the retrieved messages.
     """
-    with session_scope() as session:
-        migrate_messages_from_monitor_service_to_database(session)
+    windows = get_message_windows() if session_id and order_by == "timestamp" else None
+    if windows is not None and session_id:
+        window = windows.get(session_id)
+        if window is not None:
+            cached = _get_messages_from_window(*window, sender, sender_name, order, flow_id, limit)
+            if cached is not None:
+                return cached
     messages_read: list[Message] = []
     with session_scope() as session:
         stmt = select(MessageTable)
@@ -57,9 +62,105 @@ def get_messages(
         messages = session.exec(stmt)
         messages_read = [Message(**d.model_dump()) for d in messages]
 
+    if windows is not None and session_id and not sender and not sender_name and not flow_id:
+        _load_window(windows, session_id, messages_read, order, limit)
     return messages_read
 
 
+def _matches(message: Message, sender: str | None, sender_name: str | None, flow_id: UUID | None) -> bool:
+    return (
+        (not sender or message.sender == sender)
+        and (not sender_name or message.sender_name == sender_name)
+        and (not flow_id or str(message.flow_id) == str(flow_id))
+    )
+
+
+def _get_messages_from_window(
+    window_messages: list[Message],
+    complete: bool,
+    sender: str | None,
+    sender_name: str | None,
+    order: str | None,
+    flow_id: UUID | None,
+    limit: int | None,
+) -> list[Message] | None:
+    """Answers a query from the window of a session, or returns None if the window does not hold the answer."""
+    matching = [message for message in window_messages if _matches(message, sender, sender_name, flow_id)]
+    if order == "DESC":
+        # The window holds the latest messages, so it holds the latest `limit` matching ones if it has enough
+        if not complete and (not limit or len(matching) < limit):
+            return None
+        matching.reverse()
+    elif not complete:
+        # The oldest messages may not be in the window
+        return None
+    if limit:
+        matching = matching[:limit]
+    # Callers may change the messages they get
+    return [message.model_copy(deep=True) for message in matching]
+
+
+def _load_window(windows, session_id: str, messages: list[Message], order: str | None, limit: int | None):
+    """Fills the window of a session from the result of an unfiltered query, if it holds its latest messages."""
+    complete = not limit or len(messages) < limit
+    if not complete and order != "DESC":
+        # These are the oldest messages of the session, not the latest
+        return
+    oldest_first = list(reversed(messages)) if order == "DESC" else list(messages)
+    windows.load(session_id, [message.model_copy(deep=True) for message in oldest_first], complete)
+
+
+def get_messages_since(session_id: str, cursor: str | None = None, limit: int | None = None):
+    """
+    Returns the messages of a session stored after the message whose ID is `cursor`, oldest first.
+
+    It lets a caller that already holds the history of a session fetch only what was added since.
+    The answer comes from the message window of the session when it holds the cursor.
+
+    Args:
+        session_id (str): The session ID.
+        cursor (Optional[str]): The ID of the last message the caller has. If None, the latest messages are returned.
+        limit (Optional[int]): The maximum number of messages to return, the latest ones are kept.
+
+    Returns:
+        tuple[list[Message], Optional[str]]: The messages and the cursor to pass to the next call.
+    """
+    windows = get_message_windows()
+    window = windows.get(session_id) if windows is not None else None
+    messages: list[Message] | None = None
+    if window is not None:
+        window_messages, complete = window
+        ids = [str(message.data.get("id")) for message in window_messages]
+        if cursor is None and (complete or (limit and len(window_messages) >= limit)):
+            messages = window_messages
+        elif cursor is not None and cursor in ids:
+            messages = window_messages[ids.index(cursor) + 1 :]
+        if messages is not None:
+            messages = [message.model_copy(deep=True) for message in messages]
+    if messages is None:
+        messages = _get_messages_after(session_id, cursor)
+    if limit:
+        messages = messages[-limit:]
+    next_cursor = str(messages[-1].data.get("id")) if messages else cursor
+    return messages, next_cursor
+
+
+def _get_messages_after(session_id: str, cursor: str | None) -> list[Message]:
+    with session_scope() as session:
+        stmt = select(MessageTable).where(MessageTable.session_id == session_id)
+        if cursor is not None:
+            cursor_message = session.get(MessageTable, UUID(cursor))
+            if cursor_message is not None:
+                stmt = stmt.where(MessageTable.timestamp >= cursor_message.timestamp)
+        rows = list(session.exec(stmt.order_by(col(MessageTable.timestamp).asc())))
+        messages = [Message(**row.model_dump()) for row in rows]
+    if cursor is not None:
+        ids = [str(message.data.get("id")) for message in messages]
+        if cursor in ids:
+            messages = messages[ids.index(cursor) + 1 :]
+    return messages
+
+
 def add_messages(messages: Message | list[Message], flow_id: str | None = None):
     """
     Add a message to the monitor service.
@@ -83,6 +184,32 @@ def add_messages(messages: Message | list[Message], flow_id: str | None = None):
         raise e
 
 
+async def async_add_messages(messages: Message | list[Message], flow_id: str | None = None):
+    """
+    Add a message to the monitor service, without blocking the event loop.
+    """
+    if not isinstance(messages, list):
+        messages = [messages]
+
+    if not all(isinstance(message, Message) for message in messages):
+        types = ", ".join([str(type(message)) for message in messages])
+        raise ValueError(f"The messages must be instances of Message. Found: {types}")
+
+    messages_models = [MessageTable.from_message(msg, flow_id=flow_id) for msg in messages]
+    try:
+        async with async_session_scope() as session:
+            session.add_all(messages_models)
+            # All the messages are written with one commit, and read back with their defaults
+            await session.commit()
+            for message in messages_models:
+                await session.refresh(message)
+    except Exception as e:
+        logger.exception(e)
+        raise e
+    messages_read = _update_windows(messages_models)
+    return [Message(**message.model_dump()) for message in messages_read]
+
+
 def add_messagetables(messages: list[MessageTable], session: Session):
     for message in messages:
         try:
@@ -92,7 +219,19 @@ def add_messagetables(messages: list[MessageTable], session: Session):
         except Exception as e:
             logger.exception(e)
             raise e
-    return [MessageRead.model_validate(message, from_attributes=True) for message in messages]
+    return _update_windows(messages)
+
+
+def _update_windows(messages: list[MessageTable]) -> list[MessageRead]:
+    messages_read = [MessageRead.model_validate(message, from_attributes=True) for message in messages]
+    if (windows := get_message_windows()) is not None:
+        # Keep the windows of the sessions up to date instead of dropping them
+        messages_by_session: dict[str, list[Message]] = {}
+        for message_read in messages_read:
+            messages_by_session.setdefault(message_read.session_id, []).append(Message(**message_read.model_dump()))
+        for session_id, session_messages in messages_by_session.items():
+            windows.append(session_id, session_messages)
+    return messages_read
 
 
 def delete_messages(session_id: str):
@@ -109,6 +248,7 @@ def delete_messages(session_id: str):
             .execution_options(synchronize_session="fetch")
         )
         session.commit()
+    invalidate_message_windows([session_id])
 
 
 def store_message(
@@ -136,3 +276,20 @@ def store_message(
         raise ValueError("All of session_id, sender, and sender_name must be provided.")
 
     return add_messages([message], flow_id=flow_id)
+
+
+async def async_store_message(
+    message: Message,
+    flow_id: str | None = None,
+) -> list[Message]:
+    """
+    Stores a message in the memory, like `store_message`, without blocking the event loop.
+    """
+    if not message:
+        warnings.warn("No message provided.")
+        return []
+
+    if not message.session_id or not message.sender or not message.sender_name:
+        raise ValueError("All of session_id, sender, and sender_name must be provided.")
+
+    return await async_add_messages([message], flow_id=flow_id)
@@ -6,6 +6,7 @@ from gunicorn import glogging  # type: ignore
 from gunicorn.app.base import BaseApplication  # type: ignore
 from uvicorn.workers import UvicornWorker
 
+from langflow.services.monitor.metrics import mark_worker_dead
 from langflow.utils.logger import InterceptHandler  # type: ignore
 
 
@@ -48,6 +49,7 @@ class LangflowApplication(BaseApplication):
 
         self.options["worker_class"] = "langflow.server.LangflowUvicornWorker"
         self.options["logger_class"] = Logger
+        self.options.setdefault("child_exit", mark_worker_dead)
         self.application = app
         super().__init__()
 
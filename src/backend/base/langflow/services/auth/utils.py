@@ -11,13 +11,20 @@ from fastapi.security import APIKeyHeader, APIKeyQuery, OAuth2PasswordBearer
 from jose import JWTError, jwt
 from loguru import logger
 from sqlmodel import Session
+from sqlmodel.ext.asyncio.session import AsyncSession
 from starlette.websockets import WebSocket
 
-from langflow.services.database.models.api_key.crud import check_key
+from langflow.services.cache.lookups import ApiKeyEntry, build_api_key_cache_key, get_api_key_cache
+from langflow.services.database.models.api_key.crud import async_check_key, schedule_usage_update
 from langflow.services.database.models.api_key.model import ApiKey
-from langflow.services.database.models.user.crud import get_user_by_id, get_user_by_username, update_user_last_login_at
+from langflow.services.database.models.user.crud import (
+    async_get_user_by_username,
+    get_user_by_id,
+    get_user_by_username,
+    update_user_last_login_at,
+)
 from langflow.services.database.models.user.model import User
-from langflow.services.deps import get_session, get_settings_service
+from langflow.services.deps import get_async_session, get_session, get_settings_service
 
 oauth2_login = OAuth2PasswordBearer(tokenUrl="api/v1/login", auto_error=False)
 
@@ -31,7 +38,7 @@ api_key_header = APIKeyHeader(name=API_KEY_NAME, scheme_name="API key header", a
 async def api_key_security(
     query_param: str = Security(api_key_query),
     header_param: str = Security(api_key_header),
-    db: Session = Depends(get_session),
+    db: AsyncSession = Depends(get_async_session),
 ) -> Optional[User]:
     settings_service = get_settings_service()
     result: Optional[Union[ApiKey, User]] = None
@@ -42,8 +49,8 @@ async def api_key_security(
                 status_code=status.HTTP_400_BAD_REQUEST,
                 detail="Missing first superuser credentials",
             )
-
-        result = get_user_by_username(db, settings_service.auth_settings.SUPERUSER)
+        api_key = None
+        cache_key = f"superuser:{settings_service.auth_settings.SUPERUSER}"
 
     elif not query_param and not header_param:
         raise HTTPException(
@@ -51,21 +58,34 @@ async def api_key_security(
             detail="An API key must be passed as query or header",
         )
 
-    elif query_param:
-        result = check_key(db, query_param)
-
     else:
-        result = check_key(db, header_param)
+        api_key = query_param or header_param
+        cache_key = build_api_key_cache_key(api_key)
+
+    cache = get_api_key_cache()
+    if cache is not None and (entry := cache.get(cache_key)) is not None:
+        if entry.api_key_id is not None:
+            schedule_usage_update(entry.api_key_id)
+        # A new instance per request, so endpoints can attach it to their session
+        return User.model_validate(entry.user)
+
+    if api_key is None:
+        result = await async_get_user_by_username(db, settings_service.auth_settings.SUPERUSER)
+    else:
+        result = await async_check_key(db, api_key)
 
     if not result:
         raise HTTPException(
             status_code=status.HTTP_403_FORBIDDEN,
             detail="Invalid or missing API key",
         )
-    if isinstance(result, ApiKey):
-        return result.user
-    elif isinstance(result, User):
-        return result
+    user = result.user if isinstance(result, ApiKey) else result
+    # Detached, so the endpoints can use it with their own session
+    db.expunge(user)
+    if cache is not None:
+        api_key_id = result.id if isinstance(result, ApiKey) else None
+        cache.set(cache_key, ApiKeyEntry(api_key_id=api_key_id, user_id=user.id, user=user.model_dump()))
+    return user
 
 
 async def get_current_user(
@@ -73,11 +93,12 @@ async def get_current_user(
     query_param: str = Security(api_key_query),
     header_param: str = Security(api_key_header),
     db: Session = Depends(get_session),
+    async_db: AsyncSession = Depends(get_async_session),
 ) -> User:
     if token:
         return await get_current_user_by_jwt(token, db)
     else:
-        user = await api_key_security(query_param, header_param, db)
+        user = await api_key_security(query_param, header_param, async_db)
         if user:
             return user
 
@@ -153,18 +174,19 @@ async def get_current_user_for_websocket(
     websocket: WebSocket,
     db: Session = Depends(get_session),
     query_param: str = Security(api_key_query),
+    async_db: AsyncSession = Depends(get_async_session),
 ) -> Optional[User]:
     token = websocket.query_params.get("token")
     api_key = websocket.query_params.get("x-api-key")
     if token:
         return await get_current_user_by_jwt(token, db)
     elif api_key:
-        return await api_key_security(api_key, query_param, db)
+        return await api_key_security(api_key, query_param, async_db)
     else:
         return None
 
 
-def get_current_active_user(current_user: Annotated[User, Depends(get_current_user)]):
+async def get_current_active_user(current_user: Annotated[User, Depends(get_current_user)]):
     if not current_user.is_active:
         raise HTTPException(status_code=status.HTTP_401_UNAUTHORIZED, detail="Inactive user")
     return current_user
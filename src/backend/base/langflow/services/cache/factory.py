@@ -16,6 +16,10 @@ class CacheServiceFactory(ServiceFactory):
         # Here you would have logic to create and configure a CacheService
         # based on the settings_service
 
+        memory_cache_kwargs = {
+            "max_memory": settings_service.settings.cache_max_memory,
+            "eviction_policy": settings_service.settings.cache_eviction_policy,
+        }
         if settings_service.settings.cache_type == "redis":
             logger.debug("Creating Redis cache")
             redis_cache: RedisCache = RedisCache(
@@ -29,9 +33,9 @@ class CacheServiceFactory(ServiceFactory):
                 logger.debug("Redis cache is connected")
                 return redis_cache
             logger.warning("Redis cache is not connected, falling back to in-memory cache")
-            return AsyncInMemoryCache()
+            return AsyncInMemoryCache(**memory_cache_kwargs)
 
         elif settings_service.settings.cache_type == "memory":
-            return ThreadingInMemoryCache()
+            return ThreadingInMemoryCache(**memory_cache_kwargs)
         elif settings_service.settings.cache_type == "async":
-            return AsyncInMemoryCache()
+            return AsyncInMemoryCache(**memory_cache_kwargs)
@@ -0,0 +1,130 @@
+"""
+Short-lived caches of the lookups every API run does before it starts.
+
+`/run/{flow_id_or_name}` checks the API key and resolves the flow on every call. Both answers change
+rarely, so they are cached for `lookup_cache_ttl` seconds:
+
+- API keys map to the ID of the key and a snapshot of its user.
+- Flow IDs and endpoint names map to a `FlowRef`, the ID, name, owner and version of the flow
+  without its data. The version is enough to find the compiled plan of the flow, so its data is
+  only read from the database when the plan is not cached.
+
+The routes that update or delete flows, API keys and users invalidate the entries they affect.
+Other workers of a deployment only see those changes when their entries expire.
+"""
+
+import hashlib
+import threading
+from dataclasses import dataclass
+from datetime import datetime
+from typing import Any, Callable, Dict, Optional, Tuple
+from uuid import UUID
+
+from cachetools import TTLCache
+
+
+@dataclass(frozen=True)
+class FlowRef:
+    """What a run needs to know about a flow before it compiles it."""
+
+    id: UUID
+    name: str
+    user_id: Optional[UUID]
+    endpoint_name: Optional[str]
+    updated_at: Optional[datetime]
+
+    @property
+    def version(self) -> Optional[str]:
+        return self.updated_at.isoformat() if self.updated_at else None
+
+
+@dataclass(frozen=True)
+class ApiKeyEntry:
+    api_key_id: Optional[UUID]
+    user_id: UUID
+    user: Dict[str, Any]
+
+
+class LookupCache:
+    """A thread-safe TTL cache that can be invalidated by the values it holds."""
+
+    def __init__(self, ttl: float, max_size: int):
+        self._entries: TTLCache = TTLCache(maxsize=max_size, ttl=ttl)
+        self._lock = threading.Lock()
+
+    def get(self, key: Any) -> Any:
+        with self._lock:
+            return self._entries.get(key)
+
+    def set(self, key: Any, value: Any) -> None:
+        with self._lock:
+            self._entries[key] = value
+
+    def invalidate(self, predicate: Callable[[Any], bool]) -> None:
+        with self._lock:
+            for key in [key for key, value in self._entries.items() if predicate(value)]:
+                del self._entries[key]
+
+    def clear(self) -> None:
+        with self._lock:
+            self._entries.clear()
+
+    def __len__(self):
+        return len(self._entries)
+
+
+_caches: Dict[str, LookupCache] = {}
+_caches_lock = threading.Lock()
+
+
+def _get_cache(name: str) -> Optional[LookupCache]:
+    from langflow.services.deps import get_settings_service
+
+    settings = get_settings_service().settings
+    if settings.lookup_cache_ttl <= 0:
+        return None
+    with _caches_lock:
+        if name not in _caches:
+            _caches[name] = LookupCache(settings.lookup_cache_ttl, settings.lookup_cache_size)
+        return _caches[name]
+
+
+def get_api_key_cache() -> Optional[LookupCache]:
+    return _get_cache("api_keys")
+
+
+def get_flow_ref_cache() -> Optional[LookupCache]:
+    return _get_cache("flows")
+
+
+def clear_lookup_caches() -> None:
+    """Drops every cached lookup, e.g. when the database the lookups were read from changes."""
+    with _caches_lock:
+        for cache in _caches.values():
+            cache.clear()
+
+
+def build_api_key_cache_key(api_key: str) -> str:
+    # The keys are credentials, so only their hash is kept
+    return hashlib.sha256(api_key.encode("utf-8")).hexdigest()
+
+
+def build_flow_ref_cache_key(flow_id_or_name: str, user_id: Optional[UUID] = None) -> Tuple[str, Optional[str]]:
+    return flow_id_or_name, str(user_id) if user_id else None
+
+
+def invalidate_flow(flow_id: UUID) -> None:
+    """Drops the cached lookups of a flow, by ID and by endpoint name."""
+    if (cache := get_flow_ref_cache()) is not None:
+        cache.invalidate(lambda flow_ref: flow_ref.id == flow_id)
+
+
+def invalidate_api_key(api_key_id: UUID) -> None:
+    if (cache := get_api_key_cache()) is not None:
+        cache.invalidate(lambda entry: entry.api_key_id == api_key_id)
+
+
+def invalidate_user(user_id: UUID) -> None:
+    """Drops the cached API keys of a user, e.g. when it is deactivated."""
+    if (cache := get_api_key_cache()) is not None:
+        cache.invalidate(lambda entry: entry.user_id == user_id)
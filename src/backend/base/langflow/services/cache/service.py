@@ -8,22 +8,99 @@ from typing import Generic, Optional
 from loguru import logger
 
 from langflow.services.cache.base import AsyncBaseCacheService, AsyncLockType, CacheService, LockType
-from langflow.services.cache.utils import CacheMiss
+from langflow.services.cache.utils import CacheMiss, estimate_size
+from langflow.services.monitor.metrics import instrument_redis_client
 
 CACHE_MISS = CacheMiss()
 
+EVICTION_POLICIES = ("lru", "lfu")
 
-class ThreadingInMemoryCache(CacheService, Generic[LockType]):
+
+class InMemoryCacheAccounting:
+    """
+    Size accounting, eviction and counters shared by the in-memory caches.
+
+    Entries are dicts with the value, the time they were set, their estimated size in bytes
+    and the number of hits. Sizes are only estimated when a memory budget is set.
+    """
+
+    def _init_accounting(self, max_memory: Optional[int], eviction_policy: str):
+        if eviction_policy not in EVICTION_POLICIES:
+            raise ValueError(f"Invalid eviction policy: {eviction_policy}. Expected one of {EVICTION_POLICIES}")
+        self.max_memory = max_memory
+        self.eviction_policy = eviction_policy
+        self.size_bytes = 0
+        self.hits = 0
+        self.misses = 0
+        self.evictions = 0
+        self.expirations = 0
+
+    def _new_entry(self, value) -> dict:
+        size = estimate_size(value) if self.max_memory else 0
+        return {"value": value, "time": time.time(), "size": size, "hits": 0}
+
+    def _remove_entry(self, entries: OrderedDict, key) -> None:
+        if (item := entries.pop(key, None)) is not None:
+            self.size_bytes -= item.get("size", 0)
+
+    def _evict(self, entries: OrderedDict) -> None:
+        if self.eviction_policy == "lfu":
+            # min keeps the first of the least used entries, which is also the least recently used one
+            key = min(entries, key=lambda entry_key: entries[entry_key]["hits"])
+        else:
+            key = next(iter(entries))
+        self._remove_entry(entries, key)
+        self.evictions += 1
+
+    def _insert_entry(self, entries: OrderedDict, key, entry: dict, max_size: Optional[int]) -> None:
+        if max_size and len(entries) >= max_size:
+            self._evict(entries)
+        while self.max_memory and entries and self.size_bytes + entry["size"] > self.max_memory:
+            self._evict(entries)
+        if self.max_memory and entry["size"] > self.max_memory:
+            logger.warning(
+                f"Cache entry {key} is {entry['size']} bytes, more than the cache memory budget of {self.max_memory}"
+            )
+        entries[key] = entry
+        entries.move_to_end(key)
+        self.size_bytes += entry["size"]
+
+    def get_stats(self) -> dict:
+        """
+        Returns the counters of the cache.
+
+        Returns:
+            dict: The number of entries, their estimated size, the budget and the hit, miss, eviction
+            and expiration counters.
+        """
+        lookups = self.hits + self.misses
+        return {
+            "type": type(self).__name__,
+            "entries": len(self),  # type: ignore
+            "size_bytes": self.size_bytes if self.max_memory else None,
+            "max_memory": self.max_memory,
+            "eviction_policy": self.eviction_policy,
+            "hits": self.hits,
+            "misses": self.misses,
+            "evictions": self.evictions,
+            "expirations": self.expirations,
+            "hit_rate": self.hits / lookups if lookups else None,
+        }
+
+
+class ThreadingInMemoryCache(InMemoryCacheAccounting, CacheService, Generic[LockType]):
     """
     A simple in-memory cache using an OrderedDict.
 
-    This cache supports setting a maximum size and expiration time for cached items.
-    When the cache is full, it uses a Least Recently Used (LRU) eviction policy.
+    This cache supports setting a maximum size, a memory budget and expiration time for cached items.
+    When the cache is full, it evicts the Least Recently Used (LRU) or Least Frequently Used (LFU) item.
     Thread-safe using a threading Lock.
 
     Attributes:
         max_size (int, optional): Maximum number of items to store in the cache.
         expiration_time (int, optional): Time in seconds after which a cached item expires. Default is 1 hour.
+        max_memory (int, optional): Maximum estimated size of the cached items, in bytes.
+        eviction_policy (str, optional): Either 'lru' or 'lfu'. Default is 'lru'.
 
     Example:
 
@@ -39,18 +116,21 @@ class ThreadingInMemoryCache(CacheService, Generic[LockType]):
         b = cache["b"]
     """
 
-    def __init__(self, max_size=None, expiration_time=60 * 60):
+    def __init__(self, max_size=None, expiration_time=60 * 60, max_memory=None, eviction_policy="lru"):
         """
         Initialize a new InMemoryCache instance.
 
         Args:
             max_size (int, optional): Maximum number of items to store in the cache.
             expiration_time (int, optional): Time in seconds after which a cached item expires. Default is 1 hour.
+            max_memory (int, optional): Maximum estimated size of the cached items, in bytes.
+            eviction_policy (str, optional): Either 'lru' or 'lfu'. Default is 'lru'.
         """
         self._cache = OrderedDict()
         self._lock = threading.RLock()
         self.max_size = max_size
         self.expiration_time = expiration_time
+        self._init_accounting(max_memory, eviction_policy)
 
     def get(self, key, lock: Optional[threading.Lock] = None):
         """
@@ -73,6 +153,8 @@ class ThreadingInMemoryCache(CacheService, Generic[LockType]):
             if self.expiration_time is None or time.time() - item["time"] < self.expiration_time:
                 # Move the key to the end to make it recently used
                 self._cache.move_to_end(key)
+                self.hits += 1
+                item["hits"] += 1
                 # Check if the value is pickled
                 if isinstance(item["value"], bytes):
                     value = pickle.loads(item["value"])
@@ -80,7 +162,9 @@ class ThreadingInMemoryCache(CacheService, Generic[LockType]):
                     value = item["value"]
                 return value
             else:
+                self.expirations += 1
                 self.delete(key)
+        self.misses += 1
         return None
 
     def set(self, key, value, lock: Optional[threading.Lock] = None):
@@ -94,15 +178,11 @@ class ThreadingInMemoryCache(CacheService, Generic[LockType]):
             value: The value to cache.
         """
         with lock or self._lock:
+            entry = self._new_entry(value)
             if key in self._cache:
                 # Remove existing key before re-inserting to update order
                 self.delete(key)
-            elif self.max_size and len(self._cache) >= self.max_size:
-                # Remove least recently used item
-                self._cache.popitem(last=False)
-            # pickle locally to mimic Redis
-
-            self._cache[key] = {"value": value, "time": time.time()}
+            self._insert_entry(self._cache, key, entry, self.max_size)
 
     def upsert(self, key, value, lock: Optional[threading.Lock] = None):
         """
@@ -147,7 +227,7 @@ class ThreadingInMemoryCache(CacheService, Generic[LockType]):
             key: The key of the item to remove.
         """
         with lock or self._lock:
-            self._cache.pop(key, None)
+            self._remove_entry(self._cache, key)
 
     def clear(self, lock: Optional[threading.Lock] = None):
         """
@@ -155,6 +235,7 @@ class ThreadingInMemoryCache(CacheService, Generic[LockType]):
         """
         with lock or self._lock:
             self._cache.clear()
+            self.size_bytes = 0
 
     def __contains__(self, key):
         """Check if the key is in the cache."""
@@ -181,6 +262,9 @@ class ThreadingInMemoryCache(CacheService, Generic[LockType]):
         return f"InMemoryCache(max_size={self.max_size}, expiration_time={self.expiration_time})"
 
 
+HASH_VERSION_FIELD = "version"
+
+
 class RedisCache(CacheService, Generic[LockType]):
     """
     A Redis-based cache implementation.
@@ -227,9 +311,10 @@ class RedisCache(CacheService, Generic[LockType]):
             " Please report any issues to our GitHub repository."
         )
         if url:
-            self._client = redis.StrictRedis.from_url(url)
+            client = redis.StrictRedis.from_url(url)
         else:
-            self._client = redis.StrictRedis(host=host, port=port, db=db)
+            client = redis.StrictRedis(host=host, port=port, db=db)
+        self._client = instrument_redis_client(client)
         self.expiration_time = expiration_time
 
     # check connection
@@ -246,6 +331,30 @@ class RedisCache(CacheService, Generic[LockType]):
             logger.error(f"RedisCache could not connect to the Redis server: {exc}")
             return False
 
+    def get_stats(self) -> dict:
+        """
+        Returns the counters Redis keeps for the whole server.
+
+        Redis does its own memory accounting and eviction (see `maxmemory` and
+        `maxmemory-policy`), so these are read from `INFO` instead of being tracked here.
+        """
+        info = self._client.info()
+        hits = info.get("keyspace_hits", 0)
+        misses = info.get("keyspace_misses", 0)
+        lookups = hits + misses
+        return {
+            "type": type(self).__name__,
+            "entries": self._client.dbsize(),
+            "size_bytes": info.get("used_memory"),
+            "max_memory": info.get("maxmemory") or None,
+            "eviction_policy": info.get("maxmemory_policy"),
+            "hits": hits,
+            "misses": misses,
+            "evictions": info.get("evicted_keys", 0),
+            "expirations": info.get("expired_keys", 0),
+            "hit_rate": hits / lookups if lookups else None,
+        }
+
     async def get(self, key, lock=None):
         """
         Retrieve an item from the cache.
@@ -277,6 +386,44 @@ class RedisCache(CacheService, Generic[LockType]):
         except TypeError as exc:
             raise TypeError("RedisCache only accepts values that can be pickled. ") from exc
 
+    async def set_hash(self, key, mapping: dict, replace: bool = False) -> int:
+        """
+        Write fields of a hash and bump its version.
+
+        Only the given fields are sent, so callers can update one part of a large value.
+
+        Args:
+            key: The key of the hash.
+            mapping: The fields to write, with bytes values.
+            replace: Whether to drop the fields that are not in `mapping`.
+
+        Returns:
+            int: The new version of the hash.
+        """
+        pipeline = self._client.pipeline()
+        if replace:
+            pipeline.delete(str(key))
+        pipeline.hset(str(key), mapping=mapping)
+        pipeline.hincrby(str(key), HASH_VERSION_FIELD, 1)
+        pipeline.expire(str(key), self.expiration_time)
+        results = pipeline.execute()
+        return int(results[-2])
+
+    async def get_hash(self, key) -> dict:
+        """
+        Retrieve every field of a hash.
+
+        Returns:
+            dict: The fields with str keys and bytes values. Empty if the key is not found.
+        """
+        fields = self._client.hgetall(str(key))
+        return {field.decode() if isinstance(field, bytes) else field: value for field, value in fields.items()}
+
+    async def get_hash_version(self, key) -> Optional[int]:
+        """Retrieve the version written by `set_hash`, or None if the key is not found."""
+        version = self._client.hget(str(key), HASH_VERSION_FIELD)
+        return int(version) if version is not None else None
+
     async def upsert(self, key, value, lock=None):
         """
         Inserts or updates a value in the cache.
@@ -331,13 +478,14 @@ class RedisCache(CacheService, Generic[LockType]):
         return f"RedisCache(expiration_time={self.expiration_time})"
 
 
-class AsyncInMemoryCache(AsyncBaseCacheService, Generic[AsyncLockType]):
-    def __init__(self, max_size=None, expiration_time=3600):
+class AsyncInMemoryCache(InMemoryCacheAccounting, AsyncBaseCacheService, Generic[AsyncLockType]):
+    def __init__(self, max_size=None, expiration_time=3600, max_memory=None, eviction_policy="lru"):
         self.cache = OrderedDict()
 
         self.lock = asyncio.Lock()
         self.max_size = max_size
         self.expiration_time = expiration_time
+        self._init_accounting(max_memory, eviction_policy)
 
     async def get(self, key, lock: Optional[asyncio.Lock] = None):
         if not lock:
@@ -351,10 +499,14 @@ class AsyncInMemoryCache(AsyncBaseCacheService, Generic[AsyncLockType]):
         if item:
             if time.time() - item["time"] < self.expiration_time:
                 self.cache.move_to_end(key)
+                self.hits += 1
+                item["hits"] += 1
                 return pickle.loads(item["value"]) if isinstance(item["value"], bytes) else item["value"]
             else:
                 logger.info(f"Cache item for key '{key}' has expired and will be deleted.")
+                self.expirations += 1
                 await self._delete(key)  # Log before deleting the expired item
+        self.misses += 1
         return CACHE_MISS
 
     async def set(self, key, value, lock: Optional[asyncio.Lock] = None):
@@ -371,10 +523,10 @@ class AsyncInMemoryCache(AsyncBaseCacheService, Generic[AsyncLockType]):
             )
 
     async def _set(self, key, value):
-        if self.max_size and len(self.cache) >= self.max_size:
-            self.cache.popitem(last=False)
-        self.cache[key] = {"value": value, "time": time.time()}
-        self.cache.move_to_end(key)
+        entry = self._new_entry(value)
+        # Replacing an entry must not evict another one
+        self._remove_entry(self.cache, key)
+        self._insert_entry(self.cache, key, entry, self.max_size)
 
     async def delete(self, key, lock: Optional[asyncio.Lock] = None):
         if not lock:
@@ -384,8 +536,7 @@ class AsyncInMemoryCache(AsyncBaseCacheService, Generic[AsyncLockType]):
             await self._delete(key)
 
     async def _delete(self, key):
-        if key in self.cache:
-            del self.cache[key]
+        self._remove_entry(self.cache, key)
 
     async def clear(self, lock: Optional[asyncio.Lock] = None):
         if not lock:
@@ -396,6 +547,7 @@ class AsyncInMemoryCache(AsyncBaseCacheService, Generic[AsyncLockType]):
 
     async def _clear(self):
         self.cache.clear()
+        self.size_bytes = 0
 
     async def upsert(self, key, value, lock: Optional[asyncio.Lock] = None):
         if not lock:
@@ -413,3 +565,6 @@ class AsyncInMemoryCache(AsyncBaseCacheService, Generic[AsyncLockType]):
 
     def __contains__(self, key):
         return key in self.cache
+
+    def __len__(self):
+        return len(self.cache)
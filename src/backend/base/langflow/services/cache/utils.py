@@ -2,7 +2,10 @@ import base64
 import contextlib
 import hashlib
 import os
+import sys
 import tempfile
+import types
+from collections import deque
 from pathlib import Path
 from typing import TYPE_CHECKING, Any, Dict
 
@@ -17,6 +20,8 @@ CACHE: Dict[str, Any] = {}
 CACHE_DIR = user_cache_dir("langflow", "langflow")
 
 PREFIX = "langflow_cache"
+# Uploads are hashed and copied in chunks of this size
+UPLOAD_CHUNK_SIZE = 1024 * 1024
 
 
 class CacheMiss:
@@ -27,6 +32,63 @@ class CacheMiss:
         return False
 
 
+# Objects that are shared by every value and should not be counted in their size
+_SHARED_TYPES = (type, types.ModuleType, types.FunctionType, types.BuiltinFunctionType, types.MethodType)
+
+
+def estimate_size(value: Any, max_objects: int = 100_000) -> int:
+    """
+    Estimate the memory used by a value and everything it references, in bytes.
+
+    The objects reachable through containers and instance attributes are visited once.
+    Buffers that `sys.getsizeof` does not see (numpy arrays, tensors) are counted through
+    their `nbytes`. The walk stops after `max_objects` objects, so the result is a lower bound
+    for very large values.
+
+    Args:
+        value: The value to measure.
+        max_objects (int): The maximum number of objects to visit.
+
+    Returns:
+        int: The estimated size in bytes.
+    """
+    if isinstance(value, (bytes, bytearray, memoryview)):
+        return len(value)
+    seen: set[int] = set()
+    stack = [value]
+    size = 0
+    while stack and len(seen) < max_objects:
+        obj = stack.pop()
+        if id(obj) in seen or isinstance(obj, _SHARED_TYPES):
+            continue
+        seen.add(id(obj))
+        size += sys.getsizeof(obj, 0)
+        if isinstance(obj, (str, bytes, bytearray, int, float, bool)) or obj is None:
+            continue
+        if isinstance(obj, dict):
+            stack.extend(obj.keys())
+            stack.extend(obj.values())
+            continue
+        if isinstance(obj, (list, tuple, set, frozenset, deque)):
+            stack.extend(obj)
+            continue
+        try:
+            nbytes = getattr(obj, "nbytes", None)
+        except Exception:
+            nbytes = None
+        if isinstance(nbytes, int):
+            size += nbytes
+            continue
+        attributes = getattr(obj, "__dict__", None)
+        if isinstance(attributes, dict):
+            stack.append(attributes)
+        slots = getattr(type(obj), "__slots__", ())
+        for slot in (slots,) if isinstance(slots, str) else slots:
+            if isinstance(slot, str) and hasattr(obj, slot):
+                stack.append(getattr(obj, slot))
+    return size
+
+
 def create_cache_folder(func):
     def wrapper(*args, **kwargs):
         # Get the destination folder
@@ -139,7 +201,7 @@ def save_uploaded_file(file: UploadFile, folder_name):
     # Reset the file cursor to the beginning of the file
     file_object.seek(0)
     # Iterate over the uploaded file in small chunks to conserve memory
-    while chunk := file_object.read(8192):  # Read 8KB at a time (adjust as needed)
+    while chunk := file_object.read(UPLOAD_CHUNK_SIZE):
         sha256_hash.update(chunk)
 
     # Use the hex digest of the hash as the file name
@@ -152,7 +214,7 @@ def save_uploaded_file(file: UploadFile, folder_name):
     # Save the file with the hash as its name
     file_path = folder_path / file_name
     with open(file_path, "wb") as new_file:
-        while chunk := file_object.read(8192):
+        while chunk := file_object.read(UPLOAD_CHUNK_SIZE):
             new_file.write(chunk)
 
     return file_path
@@ -0,0 +1,167 @@
+"""
+Per-session windows of the latest chat messages.
+
+Memory components read the history of a session on every turn. The windows keep the latest
+messages of the sessions that were read recently, so those reads do not go to the database,
+and `add_messages` appends to them in place.
+
+A window holds the latest messages of a session in timestamp order and knows whether it holds
+all of them (`complete`), which is what decides if a query can be answered from it.
+
+The windows are kept in Redis when the cache is Redis, so every worker sees the messages stored
+by the others. Otherwise they are only kept, in process, with `message_window_in_memory`.
+Every path that changes or deletes stored messages drops the windows of their sessions.
+"""
+
+import pickle
+import threading
+from collections import OrderedDict, deque
+from typing import TYPE_CHECKING, Deque, Dict, Iterable, List, Optional, Tuple
+
+from loguru import logger
+
+if TYPE_CHECKING:
+    from langflow.schema.message import Message
+
+MESSAGE_WINDOW_PREFIX = "message_window"
+
+
+class MessageWindows:
+    """Keeps the windows in process, for the sessions read most recently."""
+
+    def __init__(self, size: int, max_sessions: int = 1000):
+        self.size = size
+        self.max_sessions = max_sessions
+        self._windows: OrderedDict[str, Tuple[Deque["Message"], bool]] = OrderedDict()
+        self._lock = threading.Lock()
+
+    def get(self, session_id: str) -> Optional[Tuple[List["Message"], bool]]:
+        """Returns the messages of the window of a session, oldest first, and whether they are all of them."""
+        with self._lock:
+            if (window := self._windows.get(session_id)) is None:
+                return None
+            self._windows.move_to_end(session_id)
+            messages, complete = window
+            return list(messages), complete
+
+    def load(self, session_id: str, messages: List["Message"], complete: bool) -> None:
+        """Replaces the window of a session with its latest messages, oldest first."""
+        with self._lock:
+            complete = complete and len(messages) <= self.size
+            self._windows[session_id] = (deque(messages[-self.size :], maxlen=self.size), complete)
+            self._windows.move_to_end(session_id)
+            while len(self._windows) > self.max_sessions:
+                self._windows.popitem(last=False)
+
+    def append(self, session_id: str, messages: List["Message"]) -> None:
+        """Appends new messages to the window of a session, if it has one."""
+        with self._lock:
+            if (window := self._windows.get(session_id)) is None:
+                return
+            window_messages, complete = window
+            if len(window_messages) + len(messages) > self.size:
+                # The oldest messages leave the window
+                complete = False
+            window_messages.extend(messages)
+            self._windows[session_id] = (window_messages, complete)
+
+    def invalidate(self, session_id: str) -> None:
+        with self._lock:
+            self._windows.pop(session_id, None)
+
+
+class RedisMessageWindows:
+    """
+    Keeps the windows in Redis, so every worker reads and updates the same ones.
+
+    Each window is a list of pickled messages capped with LTRIM, next to a key that records
+    whether it is complete. Both expire after `expiration_time` seconds without writes.
+    """
+
+    def __init__(self, client, size: int, expiration_time: int = 3600):
+        self._client = client
+        self.size = size
+        self.expiration_time = expiration_time
+
+    def _keys(self, session_id: str) -> Tuple[str, str]:
+        key = f"{MESSAGE_WINDOW_PREFIX}:{session_id}"
+        return key, f"{key}:complete"
+
+    def get(self, session_id: str) -> Optional[Tuple[List["Message"], bool]]:
+        key, complete_key = self._keys(session_id)
+        pipeline = self._client.pipeline()
+        pipeline.lrange(key, 0, -1)
+        pipeline.get(complete_key)
+        items, complete = pipeline.execute()
+        if complete is None:
+            return None
+        try:
+            return [pickle.loads(item) for item in items], complete == b"1"
+        except Exception as exc:
+            logger.debug(f"Discarding the message window of {session_id}: {exc}")
+            self.invalidate(session_id)
+            return None
+
+    def load(self, session_id: str, messages: List["Message"], complete: bool) -> None:
+        key, complete_key = self._keys(session_id)
+        complete = complete and len(messages) <= self.size
+        pipeline = self._client.pipeline()
+        pipeline.delete(key)
+        if window := messages[-self.size :]:
+            pipeline.rpush(key, *[pickle.dumps(message) for message in window])
+            pipeline.expire(key, self.expiration_time)
+        pipeline.set(complete_key, b"1" if complete else b"0", ex=self.expiration_time)
+        pipeline.execute()
+
+    def append(self, session_id: str, messages: List["Message"]) -> None:
+        key, complete_key = self._keys(session_id)
+        if not messages or not self._client.exists(complete_key):
+            return
+        pipeline = self._client.pipeline()
+        pipeline.rpush(key, *[pickle.dumps(message) for message in messages])
+        pipeline.expire(key, self.expiration_time)
+        pipeline.expire(complete_key, self.expiration_time)
+        length = pipeline.execute()[0]
+        if length > self.size:
+            pipeline = self._client.pipeline()
+            pipeline.ltrim(key, -self.size, -1)
+            pipeline.set(complete_key, b"0", ex=self.expiration_time)
+            pipeline.execute()
+
+    def invalidate(self, session_id: str) -> None:
+        self._client.delete(*self._keys(session_id))
+
+
+_windows: Dict[str, Optional[MessageWindows | RedisMessageWindows]] = {}
+_windows_lock = threading.Lock()
+
+
+def get_message_windows() -> Optional[MessageWindows | RedisMessageWindows]:
+    """Returns the message windows, or None if they are disabled."""
+    from langflow.services.cache.service import RedisCache
+    from langflow.services.deps import get_cache_service, get_settings_service
+
+    settings = get_settings_service().settings
+    if settings.message_window_size <= 0:
+        return None
+    with _windows_lock:
+        if "windows" not in _windows:
+            cache_service = get_cache_service()
+            if isinstance(cache_service, RedisCache):
+                _windows["windows"] = RedisMessageWindows(
+                    cache_service._client, settings.message_window_size, cache_service.expiration_time
+                )
+            elif settings.message_window_in_memory:
+                _windows["windows"] = MessageWindows(settings.message_window_size, settings.message_window_max_sessions)
+            else:
+                # Windows kept in each worker would miss the messages stored by the other workers
+                _windows["windows"] = None
+        return _windows["windows"]
+
+
+def invalidate_message_windows(session_ids: Iterable[str]) -> None:
+    """Drops the windows of sessions whose stored messages were changed or deleted."""
+    if (windows := get_message_windows()) is not None:
+        for session_id in set(session_ids):
+            if session_id:
+                windows.invalidate(session_id)
@@ -1,22 +1,57 @@
 import asyncio
-from collections import defaultdict
-from typing import Any, Optional
+import weakref
+from collections import OrderedDict
+from typing import TYPE_CHECKING, Any, Optional, Tuple
+
+from loguru import logger
 
 from langflow.services.base import Service
+from langflow.services.cache.service import RedisCache
 from langflow.services.deps import get_cache_service
 
+if TYPE_CHECKING:
+    from langflow.graph.graph.base import Graph
+
+GRAPH_CACHE_PREFIX = "graph"
+# Number of graphs a worker keeps alive so it does not have to decode the ones it wrote itself
+LIVE_GRAPHS_SIZE = 64
+
+
+class CacheLocks:
+    """
+    The cache locks, by key. The keys include run IDs and vertex IDs, so a lock is only kept while
+    something holds or waits on it, and the locks of the runs that ended are dropped.
+    """
+
+    def __init__(self):
+        self._locks: weakref.WeakValueDictionary[str, asyncio.Lock] = weakref.WeakValueDictionary()
+
+    def __getitem__(self, key) -> asyncio.Lock:
+        lock = self._locks.get(key)
+        if lock is None:
+            lock = asyncio.Lock()
+            self._locks[key] = lock
+        return lock
+
+    def __len__(self) -> int:
+        return len(self._locks)
+
 
 class ChatService(Service):
     name = "chat_service"
 
     def __init__(self):
-        self._cache_locks = defaultdict(asyncio.Lock)
+        self._cache_locks = CacheLocks()
         self.cache_service = get_cache_service()
+        self._live_graphs: OrderedDict[str, Tuple[int, "Graph"]] = OrderedDict()
 
     async def set_cache(self, key: str, data: Any, lock: Optional[asyncio.Lock] = None) -> bool:
         """
         Set the cache for a client.
         """
+        if self._stores_graphs_as_hashes(data):
+            await self._set_graph(str(key), data)
+            return True
         # client_id is the flow id but that already exists in the cache
         # so we need to change it to something else
         result_dict = {
@@ -30,10 +65,64 @@ class ChatService(Service):
         """
         Get the cache for a client.
         """
+        if isinstance(self.cache_service, RedisCache):
+            if graph := await self._get_graph(str(key)):
+                return {"result": graph, "type": type(graph)}
         return await self.cache_service.get(key, lock=lock or self._cache_locks[key])
 
     async def clear_cache(self, key: str, lock: Optional[asyncio.Lock] = None):
         """
         Clear the cache for a client.
         """
+        if isinstance(self.cache_service, RedisCache):
+            self._live_graphs.pop(str(key), None)
+            await self.cache_service.delete(f"{GRAPH_CACHE_PREFIX}:{key}")
         await self.cache_service.delete(key, lock=lock or self._cache_locks[key])
+
+    def _stores_graphs_as_hashes(self, data: Any) -> bool:
+        if not isinstance(self.cache_service, RedisCache):
+            return False
+        from langflow.graph.graph.base import Graph
+
+        return isinstance(data, Graph)
+
+    async def _set_graph(self, key: str, graph: "Graph"):
+        """
+        Writes a graph as a hash with one field per vertex.
+
+        The first write of a graph under a key sends everything, the following ones
+        only send the run state and the vertices that changed.
+        """
+        from langflow.graph.graph.serialization import serialize_graph
+
+        full = graph.run_context.serialized_to != key
+        fields = serialize_graph(graph, full=full)
+        version = await self.cache_service.set_hash(f"{GRAPH_CACHE_PREFIX}:{key}", fields, replace=full)
+        graph.run_context.serialized_to = key
+        self._live_graphs[key] = (version, graph)
+        self._live_graphs.move_to_end(key)
+        if len(self._live_graphs) > LIVE_GRAPHS_SIZE:
+            self._live_graphs.popitem(last=False)
+
+    async def _get_graph(self, key: str) -> Optional["Graph"]:
+        from langflow.graph.graph.serialization import GraphSchemaError, deserialize_graph
+
+        graph_key = f"{GRAPH_CACHE_PREFIX}:{key}"
+        version = await self.cache_service.get_hash_version(graph_key)
+        if version is None:
+            return None
+        # If this worker wrote the last version it still has the graph with its built objects
+        if (live := self._live_graphs.get(key)) and live[0] == version:
+            self._live_graphs.move_to_end(key)
+            return live[1]
+        try:
+            graph = deserialize_graph(await self.cache_service.get_hash(graph_key))
+        except (GraphSchemaError, KeyError) as exc:
+            logger.warning(f"Discarding the cached graph {key}: {exc}")
+            await self.cache_service.delete(graph_key)
+            return None
+        graph.run_context.serialized_to = key
+        self._live_graphs[key] = (version, graph)
+        if len(self._live_graphs) > LIVE_GRAPHS_SIZE:
+            self._live_graphs.popitem(last=False)
+        return graph
@@ -1,10 +1,15 @@
+import asyncio
 import datetime
 import secrets
 import threading
 from typing import List, Optional
 from uuid import UUID
 
-from sqlmodel import Session, select
+from loguru import logger
+from sqlalchemy import update
+from sqlalchemy.orm import selectinload
+from sqlmodel import Session, col, select
+from sqlmodel.ext.asyncio.session import AsyncSession
 from sqlmodel.sql.expression import SelectOfScalar
 
 from langflow.services.database.models.api_key import ApiKey, ApiKeyCreate, ApiKeyRead, UnmaskedApiKeyRead
@@ -72,3 +77,43 @@ def update_total_uses(session, api_key: ApiKey):
         new_session.add(new_api_key)
         new_session.commit()
     return new_api_key
+
+
+# Keeps the usage updates scheduled by async_check_key alive until they are done
+_usage_tasks: set[asyncio.Task] = set()
+
+
+async def async_check_key(session: AsyncSession, api_key: str) -> Optional[ApiKey]:
+    """Check if the API key is valid, without blocking the event loop. The user of the key is loaded with it."""
+    query: SelectOfScalar = (
+        select(ApiKey).options(selectinload(ApiKey.user)).where(ApiKey.api_key == api_key)  # type: ignore
+    )
+    api_key_object: Optional[ApiKey] = (await session.exec(query)).first()
+    if api_key_object is not None:
+        schedule_usage_update(api_key_object.id)
+    return api_key_object
+
+
+def schedule_usage_update(api_key_id: UUID):
+    """Counts a use of an API key in the background, so the request does not wait for the update."""
+    task = asyncio.create_task(async_update_total_uses(api_key_id))
+    _usage_tasks.add(task)
+    task.add_done_callback(_usage_tasks.discard)
+
+
+async def async_update_total_uses(api_key_id: UUID):
+    """Update the total uses and last used at, in a single statement so concurrent uses are all counted."""
+    from langflow.services.deps import async_session_scope
+
+    try:
+        async with async_session_scope() as session:
+            await session.exec(
+                update(ApiKey)  # type: ignore
+                .where(col(ApiKey.id) == api_key_id)
+                .values(
+                    total_uses=col(ApiKey.total_uses) + 1,
+                    last_used_at=datetime.datetime.now(datetime.timezone.utc),
+                )
+            )
+    except Exception as exc:
+        logger.error(f"Error updating the uses of API key {api_key_id}: {exc}")
@@ -6,6 +6,7 @@ from fastapi import Depends, HTTPException, status
 from sqlalchemy.exc import IntegrityError
 from sqlalchemy.orm.attributes import flag_modified
 from sqlmodel import Session, select
+from sqlmodel.ext.asyncio.session import AsyncSession
 
 from langflow.services.database.models.user.model import User, UserUpdate
 from langflow.services.deps import get_session
@@ -15,6 +16,10 @@ def get_user_by_username(db: Session, username: str) -> Union[User, None]:
     return db.exec(select(User).where(User.username == username)).first()
 
 
+async def async_get_user_by_username(db: AsyncSession, username: str) -> Union[User, None]:
+    return (await db.exec(select(User).where(User.username == username))).first()
+
+
 def get_user_by_id(db: Session, id: UUID) -> Union[User, None]:
     return db.exec(select(User).where(User.id == id)).first()
 
@@ -1,7 +1,8 @@
+import asyncio
 import time
 from datetime import datetime
 from pathlib import Path
-from typing import TYPE_CHECKING
+from typing import TYPE_CHECKING, Any, Optional, Union
 
 import sqlalchemy as sa
 from alembic import command, util
@@ -10,13 +11,22 @@ from loguru import logger
 from sqlalchemy import event, inspect
 from sqlalchemy.engine import Engine
 from sqlalchemy.exc import OperationalError
+from sqlalchemy.ext.asyncio import AsyncEngine, create_async_engine
 from sqlmodel import Session, SQLModel, create_engine, select, text
+from sqlmodel.ext.asyncio.session import AsyncSession
 
 from langflow.services.base import Service
+from langflow.services.cache.lookups import clear_lookup_caches
 from langflow.services.database import models  # noqa
 from langflow.services.database.models.user.crud import get_user_by_username
-from langflow.services.database.utils import Result, TableResults, migrate_messages_from_monitor_service_to_database
+from langflow.services.database.utils import (
+    Result,
+    TableResults,
+    get_async_database_url,
+    migrate_messages_from_monitor_service_to_database,
+)
 from langflow.services.deps import get_settings_service
+from langflow.services.monitor.metrics import instrument_engine
 from langflow.services.utils import teardown_superuser
 
 if TYPE_CHECKING:
@@ -25,6 +35,35 @@ if TYPE_CHECKING:
     from langflow.services.settings.service import SettingsService
 
 
+class ThreadedAsyncSession:
+    """
+    A sync session behind the AsyncSession API, with its calls run in threads.
+
+    Used on the request hot path when the async driver of the dialect is not installed.
+    """
+
+    SYNC_METHODS = ("add", "add_all", "expunge", "expunge_all")
+
+    def __init__(self, engine: "Engine"):
+        self._session = Session(engine, expire_on_commit=False)
+
+    def __getattr__(self, name: str) -> Any:
+        attribute = getattr(self._session, name)
+        if not callable(attribute) or name in self.SYNC_METHODS:
+            return attribute
+
+        async def call(*args, **kwargs):
+            return await asyncio.to_thread(attribute, *args, **kwargs)
+
+        return call
+
+    async def __aenter__(self) -> "ThreadedAsyncSession":
+        return self
+
+    async def __aexit__(self, exc_type, exc_value, traceback) -> None:
+        await asyncio.to_thread(self._session.close)
+
+
 class DatabaseService(Service):
     name = "database_service"
 
@@ -39,6 +78,15 @@ class DatabaseService(Service):
         self.script_location = langflow_dir / "alembic"
         self.alembic_cfg_path = langflow_dir / "alembic.ini"
         self.engine = self._create_engine()
+        # Used by the request hot path, the sync engine is kept for migrations and the other endpoints.
+        # With SQLite both engines open the same file: on_connection puts it in WAL mode, so readers of one
+        # engine do not block on the writes of the other, and sets a busy timeout so writers wait in turn.
+        self.async_engine = self._create_async_engine()
+        instrument_engine(self.engine)
+        if self.async_engine is not None:
+            instrument_engine(self.async_engine.sync_engine)
+        # The cached API key and flow lookups were read from the previous database, if any
+        clear_lookup_caches()
 
     def _create_engine(self) -> "Engine":
         """Create the engine for the database."""
@@ -65,16 +113,44 @@ class DatabaseService(Service):
                 return self._create_engine()
             raise RuntimeError("Error creating database engine") from exc
 
+    def _create_async_engine(self) -> Optional["AsyncEngine"]:
+        """
+        Create the async engine for the database, with the async driver of its dialect. Returns None
+        if the driver is not installed, the async sessions then run the sync engine in threads.
+        """
+        database_url = get_async_database_url(self.database_url)
+        if database_url.startswith("sqlite"):
+            connect_args = {"check_same_thread": False}
+        else:
+            connect_args = {}
+        try:
+            return create_async_engine(
+                database_url,
+                connect_args=connect_args,
+                pool_size=self.settings_service.settings.pool_size,
+                max_overflow=self.settings_service.settings.max_overflow,
+            )
+        except (sa.exc.NoSuchModuleError, sa.exc.InvalidRequestError, ImportError) as exc:
+            logger.warning(
+                f"Could not create an async database engine for {database_url.split(':')[0]} ({exc}). "
+                "The request hot path will run the sync engine in threads, install the async driver to avoid it."
+            )
+            return None
+
     @event.listens_for(Engine, "connect")
     def on_connection(dbapi_connection, connection_record):
         from sqlite3 import Connection as sqliteConnection
 
-        if isinstance(dbapi_connection, sqliteConnection):
+        # The async engine wraps aiosqlite connections, which take the same pragmas
+        is_aiosqlite = type(dbapi_connection).__name__.startswith("AsyncAdapt_aiosqlite")
+        if isinstance(dbapi_connection, sqliteConnection) or is_aiosqlite:
             logger.info("sqlite connect listener, setting pragmas")
             cursor = dbapi_connection.cursor()
             try:
                 cursor.execute("PRAGMA synchronous = NORMAL")
                 cursor.execute("PRAGMA journal_mode = WAL")
+                busy_timeout = int(get_settings_service().settings.sqlite_busy_timeout)
+                cursor.execute(f"PRAGMA busy_timeout = {busy_timeout}")
                 cursor.close()
             except OperationalError as oe:
                 logger.warning("Failed to set PRAGMA: ", {oe})
@@ -95,6 +171,16 @@ class DatabaseService(Service):
         with Session(self.engine) as session:
             yield session
 
+    async def get_async_session(self):
+        async with self.get_async_session_context() as session:
+            yield session
+
+    def get_async_session_context(self) -> Union[AsyncSession, ThreadedAsyncSession]:
+        if self.async_engine is None:
+            return ThreadedAsyncSession(self.engine)
+        # Objects are kept loaded after commit, since they cannot be refreshed lazily outside of the session
+        return AsyncSession(self.async_engine, expire_on_commit=False)
+
     def migrate_flows_if_auto_login(self):
         # if auto_login is enabled, we need to migrate the flows
         # to the default superuser if they don't have a user id
@@ -307,4 +393,6 @@ class DatabaseService(Service):
             logger.error(f"Error tearing down database: {exc}")
 
         self.engine.dispose()
-        self.engine.dispose()
+        # The pooled async connections belong to the event loop that is shutting down, they are not awaited
+        if self.async_engine is not None:
+            self.async_engine.sync_engine.dispose(close=False)
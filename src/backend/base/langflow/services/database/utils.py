@@ -14,8 +14,25 @@ if TYPE_CHECKING:
 from typing import Dict, List
 
 
+def migrate_messages_in_background() -> bool:
+    """
+    Moves the messages left in the monitor service to the database, once per process.
+
+    It runs at startup, off the request path, instead of before every read of the chat history.
+    """
+    from langflow.services.deps import session_scope
+
+    try:
+        with session_scope() as session:
+            return migrate_messages_from_monitor_service_to_database(session)
+    except Exception as e:
+        logger.error(f"Error migrating messages from the monitor service: {e}")
+        return False
+
+
 def migrate_messages_from_monitor_service_to_database(session: Session) -> bool:
     from langflow.schema.message import Message
+    from langflow.services.chat.message_window import invalidate_message_windows
     from langflow.services.database.models.message import MessageTable
 
     try:
@@ -54,6 +71,7 @@ def migrate_messages_from_monitor_service_to_database(session: Session) -> bool:
         logger.error(f"Error during message insertion: {str(e)}")
         session.rollback()
         return False
+    invalidate_message_windows(message["session_id"] for message in original_messages_filtered)
 
     # Create a dictionary for faster lookup
 
@@ -137,6 +155,27 @@ def session_getter(db_service: "DatabaseService"):
         session.close()
 
 
+# The async driver used for each dialect when the URL names a sync one or none
+ASYNC_DRIVERS = {
+    "sqlite": "aiosqlite",
+    "postgresql": "psycopg",
+    "postgres": "psycopg",
+    "mysql": "aiomysql",
+}
+SYNC_DRIVERS = {"pysqlite", "psycopg2", "pymysql", "mysqldb"}
+
+
+def get_async_database_url(database_url: str) -> str:
+    """Returns the URL of the database with the async driver of its dialect, e.g. sqlite+aiosqlite."""
+    scheme, separator, rest = database_url.partition("://")
+    dialect, _, driver = scheme.partition("+")
+    if dialect not in ASYNC_DRIVERS or (driver and driver not in SYNC_DRIVERS):
+        return database_url
+    if dialect == "postgres":
+        dialect = "postgresql"
+    return f"{dialect}+{ASYNC_DRIVERS[dialect]}{separator}{rest}"
+
+
 @dataclass
 class Result:
     name: str
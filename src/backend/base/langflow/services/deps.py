@@ -1,10 +1,11 @@
-from contextlib import contextmanager
-from typing import TYPE_CHECKING, Generator
+from contextlib import asynccontextmanager, contextmanager
+from typing import TYPE_CHECKING, AsyncGenerator, Generator
 
 from langflow.services.schema import ServiceType
 
 if TYPE_CHECKING:
     from sqlmodel import Session
+    from sqlmodel.ext.asyncio.session import AsyncSession
 
     from langflow.services.cache.service import CacheService
     from langflow.services.chat.service import ChatService
@@ -205,6 +206,41 @@ def get_cache_service() -> "CacheService":
     return get_service(ServiceType.CACHE_SERVICE, CacheServiceFactory())  # type: ignore
 
 
+async def get_async_session() -> AsyncGenerator["AsyncSession", None]:
+    """
+    Retrieves an async session from the database service.
+
+    Used by the endpoints of the request hot path, so their queries do not block the event loop
+    or take a slot of the threadpool.
+
+    Yields:
+        AsyncSession: An async session object.
+
+    """
+    db_service = get_db_service()
+    async for session in db_service.get_async_session():
+        yield session
+
+
+@asynccontextmanager
+async def async_session_scope():
+    """
+    Async context manager for managing a session scope, like `session_scope`.
+
+    Yields:
+        session: The async session object.
+
+    """
+    db_service = get_db_service()
+    async with db_service.get_async_session_context() as session:
+        try:
+            yield session
+            await session.commit()
+        except:
+            await session.rollback()
+            raise
+
+
 def get_session_service() -> "SessionService":
     """
     Retrieves the session service from the service manager.
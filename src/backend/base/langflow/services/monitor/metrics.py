@@ -0,0 +1,244 @@
+"""
+Prometheus metrics, served by `/metrics` when `prometheus_metrics` is on.
+
+- `langflow_vertex_build_seconds`, `langflow_vertex_wait_seconds` and `langflow_time_to_first_token_seconds`,
+  histograms by component type, of the time a component takes to build, waits to start once it is
+  runnable, and takes to stream its first chunk. With `prometheus_metrics_flow_label` they are also
+  labelled by flow, which adds series for every flow that runs.
+- `langflow_execution_queue_wait_seconds`, by priority, the time executions wait for a slot (see `admission`).
+- `langflow_db_query_seconds` by statement and `langflow_redis_command_seconds` by command.
+- `langflow_cache_*`, the hit, miss, eviction and expiration counters of the cache service. They are read
+  from its `get_stats` at each scrape, so they cost nothing on the request path.
+
+The metrics need the `prometheus_client` package. Without it, or with the setting off, the helpers below
+do nothing. When several worker processes serve the app, point `PROMETHEUS_MULTIPROC_DIR` to an empty
+directory before they start: each worker then writes its samples there and `/metrics` sums those of all
+the workers, whichever answers the scrape.
+"""
+
+import os
+import threading
+import time
+from typing import TYPE_CHECKING, Any, Optional
+
+from loguru import logger
+
+if TYPE_CHECKING:
+    from langflow.graph.vertex.base import Vertex
+
+LATENCY_BUCKETS = (0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0, 60.0, 120.0)
+
+
+class CacheStatsCollector:
+    def collect(self):
+        from prometheus_client.core import CounterMetricFamily, GaugeMetricFamily  # type: ignore
+
+        from langflow.services.deps import get_cache_service
+
+        cache_service = get_cache_service()
+        if not hasattr(cache_service, "get_stats"):
+            return
+        try:
+            stats = cache_service.get_stats()
+        except Exception as exc:
+            logger.debug(f"Could not read the cache statistics: {exc}")
+            return
+        cache_type = stats.get("type", type(cache_service).__name__)
+        for name in ["hits", "misses", "evictions", "expirations"]:
+            counter = CounterMetricFamily(f"langflow_cache_{name}", f"Cache {name}.", labels=["cache"])
+            counter.add_metric([cache_type], stats.get(name) or 0)
+            yield counter
+        entries = GaugeMetricFamily("langflow_cache_entries", "Entries in the cache.", labels=["cache"])
+        entries.add_metric([cache_type], stats.get("entries") or 0)
+        yield entries
+
+
+class Metrics:
+    def __init__(self, flow_label: bool = False):
+        from prometheus_client import CollectorRegistry, Histogram  # type: ignore
+
+        self.registry = CollectorRegistry()
+        self.flow_label = flow_label
+        component_labels = ["component", "flow_id"] if flow_label else ["component"]
+        self.vertex_build_seconds = Histogram(
+            "langflow_vertex_build_seconds",
+            "Time a component takes to build.",
+            component_labels,
+            buckets=LATENCY_BUCKETS,
+            registry=self.registry,
+        )
+        self.vertex_wait_seconds = Histogram(
+            "langflow_vertex_wait_seconds",
+            "Time a runnable component waits before it starts building.",
+            component_labels,
+            buckets=LATENCY_BUCKETS,
+            registry=self.registry,
+        )
+        self.time_to_first_token_seconds = Histogram(
+            "langflow_time_to_first_token_seconds",
+            "Time a streaming component takes to send its first chunk.",
+            component_labels,
+            buckets=LATENCY_BUCKETS,
+            registry=self.registry,
+        )
+        self.execution_queue_wait_seconds = Histogram(
+            "langflow_execution_queue_wait_seconds",
+            "Time a flow execution waits for a slot.",
+            ["priority"],
+            buckets=LATENCY_BUCKETS,
+            registry=self.registry,
+        )
+        self.db_query_seconds = Histogram(
+            "langflow_db_query_seconds",
+            "Latency of the database queries.",
+            ["statement"],
+            buckets=LATENCY_BUCKETS,
+            registry=self.registry,
+        )
+        self.redis_command_seconds = Histogram(
+            "langflow_redis_command_seconds",
+            "Latency of the Redis commands.",
+            ["command"],
+            buckets=LATENCY_BUCKETS,
+            registry=self.registry,
+        )
+        self.registry.register(CacheStatsCollector())
+
+    def export(self) -> bytes:
+        from prometheus_client import CollectorRegistry, generate_latest  # type: ignore
+
+        if not is_multiprocess():
+            return generate_latest(self.registry)
+        from prometheus_client import multiprocess  # type: ignore
+
+        # The histograms of every worker are read from their files, the cache stats are those of this worker
+        registry = CollectorRegistry()
+        multiprocess.MultiProcessCollector(registry)
+        registry.register(CacheStatsCollector())
+        return generate_latest(registry)
+
+
+def is_multiprocess() -> bool:
+    return bool(os.environ.get("PROMETHEUS_MULTIPROC_DIR"))
+
+
+def mark_worker_dead(server: Any, worker: Any) -> None:
+    """The `child_exit` hook of gunicorn, drops the live samples of a worker that exited."""
+    if not is_multiprocess():
+        return
+    try:
+        from prometheus_client import multiprocess  # type: ignore
+    except ImportError:
+        return
+    multiprocess.mark_process_dead(worker.pid)
+
+
+_metrics: Optional[Metrics] = None
+_metrics_loaded = False
+_metrics_lock = threading.Lock()
+
+
+def get_metrics() -> Optional[Metrics]:
+    """Returns the metrics of the process, or None when they are off."""
+    global _metrics, _metrics_loaded
+    if _metrics_loaded:
+        return _metrics
+    from langflow.services.deps import get_settings_service
+
+    with _metrics_lock:
+        if not _metrics_loaded:
+            settings = get_settings_service().settings
+            if settings.prometheus_metrics:
+                try:
+                    _metrics = Metrics(flow_label=settings.prometheus_metrics_flow_label)
+                except ImportError:
+                    logger.error(
+                        "Could not import prometheus_client. Please install it with `pip install prometheus-client`."
+                    )
+            _metrics_loaded = True
+    return _metrics
+
+
+def _component_labels(metrics: Metrics, vertex: "Vertex") -> tuple:
+    if not metrics.flow_label:
+        return (vertex.vertex_type,)
+    flow_id = vertex.graph.flow_id if vertex.graph is not None else None
+    return vertex.vertex_type, flow_id or ""
+
+
+def observe_vertex_build(vertex: "Vertex", seconds: float) -> None:
+    if (metrics := get_metrics()) is not None:
+        metrics.vertex_build_seconds.labels(*_component_labels(metrics, vertex)).observe(seconds)
+
+
+def observe_vertex_wait(vertex: "Vertex", seconds: float) -> None:
+    if (metrics := get_metrics()) is not None:
+        metrics.vertex_wait_seconds.labels(*_component_labels(metrics, vertex)).observe(seconds)
+
+
+def observe_time_to_first_token(vertex: "Vertex", seconds: float) -> None:
+    if (metrics := get_metrics()) is not None:
+        metrics.time_to_first_token_seconds.labels(*_component_labels(metrics, vertex)).observe(seconds)
+
+
+def observe_execution_queue_wait(priority: str, seconds: float) -> None:
+    if (metrics := get_metrics()) is not None:
+        metrics.execution_queue_wait_seconds.labels(priority).observe(seconds)
+
+
+def instrument_engine(engine: Any) -> None:
+    """Times the queries of a (sync) SQLAlchemy engine. Pass `async_engine.sync_engine` for an async one."""
+    if (metrics := get_metrics()) is None:
+        return
+    from sqlalchemy import event
+
+    @event.listens_for(engine, "before_cursor_execute")
+    def before_cursor_execute(conn, cursor, statement, parameters, context, executemany):
+        conn.info.setdefault("query_start_times", []).append(time.perf_counter())
+
+    @event.listens_for(engine, "after_cursor_execute")
+    def after_cursor_execute(conn, cursor, statement, parameters, context, executemany):
+        start_times = conn.info.get("query_start_times")
+        if start_times:
+            kind = statement.split(None, 1)[0].upper() if statement and statement.strip() else ""
+            metrics.db_query_seconds.labels(kind).observe(time.perf_counter() - start_times.pop())
+
+
+def instrument_redis_client(client: Any) -> Any:
+    """
+    Times the commands of a redis-py client, in place, and returns it.
+
+    Only `execute_command`, which sends every command, and the `execute` of its pipelines are wrapped, so
+    the client keeps its type and its context managers, locks and iterators work as before.
+    """
+    if (metrics := get_metrics()) is None:
+        return client
+    histogram = metrics.redis_command_seconds
+    execute_command = client.execute_command
+    pipeline = client.pipeline
+
+    def timed_execute_command(*args, **options):
+        start = time.perf_counter()
+        try:
+            return execute_command(*args, **options)
+        finally:
+            histogram.labels(str(args[0]).upper() if args else "").observe(time.perf_counter() - start)
+
+    def timed_pipeline(*args, **kwargs):
+        # The commands of a pipeline are only buffered, they are sent by `execute`
+        pipe = pipeline(*args, **kwargs)
+        execute = pipe.execute
+
+        def timed_execute(*execute_args, **execute_kwargs):
+            start = time.perf_counter()
+            try:
+                return execute(*execute_args, **execute_kwargs)
+            finally:
+                histogram.labels("PIPELINE").observe(time.perf_counter() - start)
+
+        pipe.execute = timed_execute
+        return pipe
+
+    client.execute_command = timed_execute_command
+    client.pipeline = timed_pipeline
+    return client
@@ -1,6 +1,6 @@
 import json
 from datetime import datetime, timezone
-from typing import Any
+from typing import Any, Optional
 from uuid import UUID
 
 from pydantic import BaseModel, Field, field_serializer, field_validator
@@ -262,3 +262,16 @@ class VertexBuildMapModel(BaseModel):
                 vertex_build_map[vertex_build.id] = []
             vertex_build_map[vertex_build.id].append(vertex_build)
         return cls(vertex_builds=vertex_build_map)
+
+
+class CacheStatsResponse(BaseModel):
+    type: str
+    entries: int
+    size_bytes: Optional[int] = None
+    max_memory: Optional[int] = None
+    eviction_policy: Optional[str] = None
+    hits: int
+    misses: int
+    evictions: int
+    expirations: int
+    hit_rate: Optional[float] = None
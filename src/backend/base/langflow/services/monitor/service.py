@@ -1,13 +1,20 @@
+import threading
+from contextlib import contextmanager
 from datetime import datetime
 from pathlib import Path
-from typing import TYPE_CHECKING, Union
+from typing import TYPE_CHECKING, Any, Dict, Iterator, List, Optional, Union
 
 import duckdb
 from loguru import logger
 from platformdirs import user_cache_dir
 
 from langflow.services.base import Service
-from langflow.services.monitor.utils import add_row_to_table, drop_and_create_table_if_schema_mismatch
+from langflow.services.monitor.utils import (
+    add_row_to_table,
+    add_rows_to_table,
+    drop_and_create_table_if_schema_mismatch,
+)
+from langflow.services.monitor.writer import BatchWriter
 
 if TYPE_CHECKING:
     from langflow.services.monitor.schema import DuckDbMessageModel, TransactionModel, VertexBuildModel
@@ -34,8 +41,50 @@ class MonitorService(Service):
         except Exception as e:
             logger.exception(f"Error initializing monitor service: {e}")
 
+        self._connect_lock = threading.Lock()
+        settings = settings_service.settings
+        self.writer: Optional[BatchWriter] = None
+        if settings.monitor_batch_writes:
+            self.writer = BatchWriter(
+                self._write_batch,
+                batch_size=settings.monitor_batch_size,
+                flush_interval=settings.monitor_flush_interval,
+                max_queue_size=settings.monitor_queue_size,
+                overflow_policy=settings.monitor_overflow_policy,
+            )
+            self.writer.start()
+
+    @contextmanager
+    def _connect(self, read_only: bool = False, flush: bool = True) -> Iterator[duckdb.DuckDBPyConnection]:
+        """
+        Opens a connection for one operation or one batch, so the file lock is not held between them
+        and the workers of a deployment can share the database.
+
+        Unless `flush` is False, the rows waiting in the writer are written first so reads see them.
+        Both block, so the async endpoints call the methods that connect from a thread.
+        """
+        if flush and self.writer is not None:
+            self.writer.flush()
+        # DuckDB refuses to open the file read-only while the writer thread has it open read-write
+        with self._connect_lock, duckdb.connect(str(self.db_path), read_only=read_only) as conn:
+            yield conn
+
+    def _write_batch(self, rows_by_table: Dict[str, List[Any]]):
+        with self._connect(flush=False) as conn:
+            for table_name, rows in rows_by_table.items():
+                add_rows_to_table(conn, table_name, self.table_map[table_name], rows)
+
+    def flush(self):
+        """Writes the rows waiting in the writer."""
+        if self.writer is not None:
+            self.writer.flush()
+
+    def teardown(self):
+        if self.writer is not None:
+            self.writer.stop()
+
     def exec_query(self, query: str, read_only: bool = False):
-        with duckdb.connect(str(self.db_path), read_only=read_only) as conn:
+        with self._connect(read_only=read_only) as conn:
             return conn.execute(query).df()
 
     def to_df(self, table_name):
@@ -56,12 +105,15 @@ class MonitorService(Service):
         if model is None:
             raise ValueError(f"Unknown table name: {table_name}")
 
-        # Connect to DuckDB and add the row
-        with duckdb.connect(str(self.db_path), read_only=False) as conn:
+        if self.writer is not None:
+            # Validated now so invalid rows still fail on the caller's side
+            self.writer.put(table_name, data if isinstance(data, model) else model(**data))
+            return
+        with self._connect(flush=False) as conn:
             add_row_to_table(conn, table_name, model, data)
 
     def load_table_as_dataframe(self, table_name):
-        with duckdb.connect(str(self.db_path)) as conn:
+        with self._connect() as conn:
             return conn.table(table_name).df()
 
     @staticmethod
@@ -99,7 +151,7 @@ class MonitorService(Service):
         if limit is not None:
             query += f" LIMIT {limit}"
 
-        with duckdb.connect(str(self.db_path), read_only=True) as conn:
+        with self._connect(read_only=True) as conn:
             df = conn.execute(query).df()
 
         return df
@@ -127,7 +179,7 @@ class MonitorService(Service):
         if order_by:
             query += f" ORDER BY {order_by}"
 
-        with duckdb.connect(str(self.db_path), read_only=True) as conn:
+        with self._connect(read_only=True) as conn:
             df = conn.execute(query).df()
 
         return df.to_dict(orient="records")
@@ -137,7 +189,7 @@ class MonitorService(Service):
         if flow_id:
             query += f" WHERE flow_id = '{flow_id}'"
 
-        with duckdb.connect(str(self.db_path), read_only=False) as conn:
+        with self._connect() as conn:
             conn.execute(query)
 
     def delete_messages_session(self, session_id: str):
@@ -192,7 +244,7 @@ class MonitorService(Service):
 
         if order_by:
             query += f" ORDER BY {order_by} DESC"
-        with duckdb.connect(str(self.db_path), read_only=True) as conn:
+        with self._connect(read_only=True) as conn:
             df = conn.execute(query).df()
 
         return df.to_dict(orient="records")
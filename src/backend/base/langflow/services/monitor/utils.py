@@ -1,4 +1,4 @@
-from typing import TYPE_CHECKING, Any, Dict, Optional, Type, Union
+from typing import TYPE_CHECKING, Any, Dict, List, Optional, Type, Union
 
 import duckdb
 import threading
@@ -119,6 +119,42 @@ def add_row_to_table(
             logger.error(f"Error adding row to {table_name}: {e}")
 
 
+def add_rows_to_table(
+    conn: duckdb.DuckDBPyConnection,
+    table_name: str,
+    model: Type,
+    rows: List[Union[Dict[str, Any], BaseModel]],
+):
+    """
+    Inserts several rows with a single statement.
+
+    If the batch fails, the rows are inserted one by one so a single bad row only loses itself.
+    """
+    validated_rows = []
+    for row in rows:
+        try:
+            validated_rows.append(row if isinstance(row, model) else model(**row))
+        except Exception as e:
+            logger.error(f"Error validating row for {table_name}: {e}")
+    if not validated_rows:
+        return
+    dumped_rows = [row.model_dump() for row in validated_rows]
+    keys = [key for key in dumped_rows[0].keys() if key != INDEX_KEY]
+    columns = ", ".join(keys)
+    values_placeholders = ", ".join(["?" for _ in keys])
+    insert_sql = f"INSERT INTO {table_name} ({columns}) VALUES ({values_placeholders})"
+    try:
+        # In a transaction so a failed batch does not leave some of its rows behind
+        conn.begin()
+        conn.executemany(insert_sql, [[row[key] for key in keys] for row in dumped_rows])
+        conn.commit()
+    except Exception as e:
+        conn.rollback()
+        logger.warning(f"Error adding {len(validated_rows)} rows to {table_name}, retrying one by one: {e}")
+        for row in validated_rows:
+            add_row_to_table(conn, table_name, model, row)
+
+
 async def log_message(
     sender: str,
     sender_name: str,
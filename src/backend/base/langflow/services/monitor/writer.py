@@ -0,0 +1,160 @@
+import queue
+import threading
+import time
+from collections import defaultdict
+from typing import Any, Callable, Dict, List, Optional, Tuple
+
+from loguru import logger
+
+OVERFLOW_POLICIES = ("block", "drop_newest", "drop_oldest")
+
+# A row waiting to be written: the table name and the validated row
+PendingRow = Tuple[str, Any]
+
+
+class BatchWriter:
+    """
+    Buffers rows in memory and writes them in batches from a background thread.
+
+    A batch is written once `batch_size` rows are waiting or `flush_interval` seconds after its
+    first row, whichever comes first. The queue holds at most `max_queue_size` rows. When it is
+    full, `overflow_policy` decides what happens to a new row:
+
+    - `drop_oldest`: the oldest waiting row is dropped to make room for the new one.
+    - `drop_newest`: the new row is dropped.
+    - `block`: the caller waits up to `block_timeout` seconds for room, then the row is dropped. The
+      rows of the graph runs are added from the event loop, which blocks with them.
+    """
+
+    def __init__(
+        self,
+        write_batch: Callable[[Dict[str, List[Any]]], None],
+        batch_size: int = 100,
+        flush_interval: float = 1.0,
+        max_queue_size: int = 10_000,
+        overflow_policy: str = "drop_oldest",
+        block_timeout: float = 1.0,
+    ):
+        if overflow_policy not in OVERFLOW_POLICIES:
+            raise ValueError(f"Invalid overflow policy: {overflow_policy}. Expected one of {OVERFLOW_POLICIES}")
+        self._write_batch = write_batch
+        self.batch_size = batch_size
+        self.flush_interval = flush_interval
+        self.overflow_policy = overflow_policy
+        self.block_timeout = block_timeout
+        self._queue: queue.Queue[PendingRow] = queue.Queue(maxsize=max_queue_size)
+        # Rows taken from the queue by the writer thread but not written yet
+        self._pending: List[PendingRow] = []
+        self._lock = threading.Lock()
+        self._stopped = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+        self.dropped = 0
+        self.written = 0
+
+    def start(self) -> None:
+        if self._thread is not None:
+            return
+        self._stopped.clear()
+        self._thread = threading.Thread(target=self._run, name="monitor-batch-writer", daemon=True)
+        self._thread.start()
+
+    def stop(self) -> None:
+        """Stops the writer thread and writes the rows still waiting."""
+        self._stopped.set()
+        if self._thread is not None:
+            self._thread.join(timeout=self.flush_interval + 5)
+            self._thread = None
+        self.flush()
+
+    def put(self, table_name: str, row: Any) -> bool:
+        """
+        Queues a row. Returns False if it was dropped because the queue is full.
+        """
+        item = (table_name, row)
+        if self.overflow_policy == "block":
+            try:
+                self._queue.put(item, timeout=self.block_timeout)
+                return True
+            except queue.Full:
+                return self._drop(table_name)
+        try:
+            self._queue.put_nowait(item)
+            return True
+        except queue.Full:
+            if self.overflow_policy == "drop_newest":
+                return self._drop(table_name)
+        # drop_oldest
+        try:
+            dropped_table, _ = self._queue.get_nowait()
+            self._drop(dropped_table)
+        except queue.Empty:
+            pass
+        try:
+            self._queue.put_nowait(item)
+            return True
+        except queue.Full:
+            return self._drop(table_name)
+
+    def _drop(self, table_name: str) -> bool:
+        self.dropped += 1
+        if self.dropped == 1 or self.dropped % 1000 == 0:
+            logger.warning(f"The monitor queue is full, dropped a row of {table_name} ({self.dropped} in total)")
+        return False
+
+    def flush(self) -> None:
+        """Writes every waiting row now, from the calling thread."""
+        with self._lock:
+            while True:
+                try:
+                    self._pending.append(self._queue.get_nowait())
+                except queue.Empty:
+                    break
+            self._write_pending()
+
+    def _run(self) -> None:
+        while not self._stopped.is_set():
+            try:
+                first = self._queue.get(timeout=self.flush_interval)
+            except queue.Empty:
+                continue
+            deadline = time.monotonic() + self.flush_interval
+            with self._lock:
+                self._pending.append(first)
+            while not self._stopped.is_set():
+                with self._lock:
+                    if not self._pending or len(self._pending) >= self.batch_size:
+                        # Either flushed by another thread or full
+                        break
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    break
+                try:
+                    item = self._queue.get(timeout=remaining)
+                except queue.Empty:
+                    break
+                with self._lock:
+                    self._pending.append(item)
+            with self._lock:
+                self._write_pending()
+
+    def _write_pending(self) -> None:
+        # Must be called with the lock held
+        if not self._pending:
+            return
+        rows_by_table: Dict[str, List[Any]] = defaultdict(list)
+        for table_name, row in self._pending:
+            rows_by_table[table_name].append(row)
+        count = len(self._pending)
+        self._pending = []
+        try:
+            self._write_batch(rows_by_table)
+            self.written += count
+        except Exception as exc:
+            logger.exception(f"Error writing {count} monitor rows: {exc}")
+
+    def get_stats(self) -> dict:
+        return {
+            "queued": self._queue.qsize() + len(self._pending),
+            "written": self.written,
+            "dropped": self.dropped,
+        }
@@ -3,7 +3,7 @@ import json
 import os
 from pathlib import Path
 from shutil import copy2
-from typing import Any, List, Optional, Tuple, Type
+from typing import Any, Dict, List, Optional, Tuple, Type
 
 import orjson
 import yaml
@@ -72,16 +72,52 @@ class Settings(BaseSettings):
     """The number of connections to keep open in the connection pool. If not provided, the default is 10."""
     max_overflow: int = 20
     """The number of connections to allow that can be opened beyond the pool size. If not provided, the default is 10."""
+    sqlite_busy_timeout: int = 30_000
+    """The milliseconds a SQLite connection waits for another one to finish writing before failing with "database is
+    locked". The sync and the async engines open the same file, so their writes wait for each other."""
     cache_type: str = "async"
     """The cache type can be 'async' or 'redis'."""
+    cache_max_memory: Optional[int] = None
+    """Maximum estimated size in bytes of the items held by the in-memory caches. No limit if not set."""
+    cache_eviction_policy: str = "lru"
+    """The policy the in-memory caches use to evict items once full. Can be 'lru' or 'lfu'."""
     variable_store: str = "db"
     """The store can be 'db' or 'kubernetes'."""
 
     remove_api_keys: bool = False
     components_path: List[str] = []
+    components_snapshot: bool = False
+    """If set to True, the component templates built from the components path are kept in a snapshot on disk,
+    so a restart only rebuilds the files that changed."""
+    components_snapshot_path: Optional[str] = None
+    """Where the component templates snapshot is stored. Defaults to a file in the config directory."""
     langchain_cache: str = "InMemoryCache"
     load_flows_path: Optional[str] = None
 
+    message_window_size: int = 200
+    """The number of latest messages of a session kept in Redis, when the cache is Redis, to answer chat history
+    reads. Set to 0 to always read from the database."""
+    message_window_in_memory: bool = False
+    """If set to True and the cache is not Redis, the windows are kept in the memory of each worker instead. Only
+    enable it with a single worker, the windows of a worker miss the messages stored by the others."""
+    message_window_max_sessions: int = 1000
+    """The maximum number of sessions whose latest messages are kept in memory."""
+
+    # Monitor
+    monitor_batch_writes: bool = True
+    """If set to True, the monitor rows (transactions, messages and vertex builds) are written in batches
+    by a background thread instead of one by one on the request path."""
+    monitor_batch_size: int = 100
+    """The number of rows that triggers a write of the monitor rows."""
+    monitor_flush_interval: float = 1.0
+    """The maximum time in seconds a monitor row waits before being written."""
+    monitor_queue_size: int = 10_000
+    """The maximum number of monitor rows waiting to be written."""
+    monitor_overflow_policy: str = "drop_oldest"
+    """What happens to a new monitor row when the queue is full. Can be 'drop_oldest', 'drop_newest' or 'block'
+    (wait up to a second, then drop it). Rows are added from the event loop, so 'block' stalls every request
+    while the queue is full."""
+
     # Redis
     redis_host: str = "localhost"
     redis_port: int = 6379
@@ -89,6 +125,13 @@ class Settings(BaseSettings):
     redis_url: Optional[str] = None
     redis_cache_expire: int = 3600
 
+    state_service_type: str = "memory"
+    """Where the states of the runs are kept. Can be 'memory' (in each worker) or 'redis' (shared by the
+    workers, with the changes sent to the other workers through pub/sub). Uses the redis_* settings, with
+    `redis_cache_expire` as the lifetime of a state."""
+    state_service_shards: int = 16
+    """Number of locks the runs of a worker are spread over by the state service."""
+
     # Sentry
     sentry_dsn: Optional[str] = None
     sentry_traces_sample_rate: Optional[float] = 1.0
@@ -108,9 +151,167 @@ class Settings(BaseSettings):
     like_webhook_url: Optional[str] = "https://api.langflow.store/flows/trigger/64275852-ec00-45c1-984e-3bff814732da"
 
     storage_type: str = "local"
+    storage_dedup: bool = True
+    """Whether the local storage keeps one copy of each unique uploaded file, hard linked to every flow
+    that uploads it. The copy is deleted with the last flow file linked to it."""
+    parsed_document_cache: bool = True
+    """Whether the file loaders cache the documents parsed from the files of the local storage, per content
+    hash, so the same file uploaded to many flows is parsed once."""
 
     celery_enabled: bool = False
 
+    graph_scheduler: str = "layered"
+    """The scheduler used by Graph.process. Can be 'layered' (run the graph one layer at a time)
+    or 'ready_queue' (start each vertex as soon as all of its predecessors are built)."""
+
+    component_default_execution_class: str = "asyncio"
+    """Where the sync output methods of components that do not declare an execution class run.
+    Can be 'asyncio' (on the event loop), 'thread' (in a thread pool) or 'process' (in a process pool)."""
+    component_execution_classes: Dict[str, str] = {}
+    """Execution classes by component class name, e.g. {"RecursiveCharacterTextSplitterComponent": "thread"}.
+    They take precedence over the ones the components declare."""
+    component_thread_pool_size: Optional[int] = None
+    """Number of sync component methods that can run at the same time in threads. Defaults to the
+    ThreadPoolExecutor default."""
+    component_process_pool_size: Optional[int] = None
+    """Number of sync component methods that can run at the same time in child processes. Defaults to
+    the number of CPUs."""
+
+    embedding_dispatcher: bool = True
+    """If set to True, the embedding components send their requests through a shared dispatcher that
+    batches them, limits the requests in flight per provider, retries rate limited ones and caches
+    the embedding of each text. See `langflow.base.embeddings.dispatcher`."""
+    embedding_batch_size: int = 64
+    """Maximum number of texts sent in one embedding request."""
+    embedding_max_batch_tokens: int = 50_000
+    """Maximum number of tokens, estimated from the length of the texts, sent in one embedding request."""
+    embedding_max_concurrency: int = 4
+    """Maximum number of embedding requests in flight per provider, shared by every flow of the process."""
+    embedding_max_retries: int = 5
+    """Number of times a rate limited embedding request is retried, with exponential backoff."""
+    embedding_cache_max_bytes: int = 64 * 1024 * 1024
+    """Bytes of embeddings kept in memory, keyed by model and text, at 8 bytes per dimension. 0 disables the
+    cache."""
+
+    ingestion_batch_size: int = 256
+    """Number of chunks a vector store adds at a time when its input is a stream (see
+    `langflow.base.data.ingestion`)."""
+    ingestion_max_in_flight: int = 16
+    """Number of documents of a stream being split at the same time."""
+
+    vector_store_connection_pooling: bool = True
+    """If set to True, the vector store components share one client per set of connection params
+    instead of connecting on every run."""
+    vector_store_connection_max_idle: float = 300
+    """Seconds after which a pooled vector store client that was not used is closed."""
+    vector_store_connection_health_check_interval: float = 30
+    """Seconds after which a pooled vector store client is checked again before being reused."""
+
+    tracing_queue_size: int = 10_000
+    """Number of trace events buffered before new traces are dropped, when the tracers cannot keep up."""
+    tracing_batch_size: int = 100
+    """Number of trace events that makes the tracing service export its buffer before the flush interval."""
+    tracing_flush_interval: float = 1.0
+    """Seconds between two exports of the trace events."""
+    opentelemetry_tracing: bool = False
+    """If set to True, the traces are also sent to the OpenTelemetry collector configured with the
+    OTEL_EXPORTER_OTLP_* environment variables."""
+    prometheus_metrics: bool = False
+    """If set to True, /metrics serves Prometheus metrics of the component builds, the execution queue, the time to
+    first token, the caches, the database and Redis. Requires the prometheus-client package. With several worker
+    processes, also set PROMETHEUS_MULTIPROC_DIR to an empty directory so /metrics reports all of them."""
+    prometheus_metrics_flow_label: bool = False
+    """If set to True, the component histograms are also labelled by flow ID. Each flow then adds its own series,
+    so only turn it on for a small, fixed set of flows."""
+
+    graph_executor: str = "local"
+    """Where Graph.process builds the vertices. Can be 'local' (in the API process) or 'celery' (on the
+    Celery workers, with the results passed between them through the redis cache). Interface, state
+    and frozen components are always built locally."""
+    graph_executor_timeout: float = 600
+    """Seconds to wait for a worker to build a vertex when `graph_executor` is 'celery'."""
+
+    lookup_cache_ttl: float = 10
+    """Seconds the API key checks and flow lookups of the run endpoints are cached for. Set to 0 to disable
+    the cache. Changes made through another worker are seen once the entries expire."""
+    lookup_cache_size: int = 10_000
+    """Number of API keys and of flows kept in the lookup caches."""
+
+    vertex_memoization: bool = False
+    """If set to True, the results of the components in `memoizable_components` are stored in the cache service,
+    keyed by a hash of their code and resolved params, and reused by later runs with the same inputs."""
+    memoizable_components: List[str] = [
+        "Prompt",
+        "ParseData",
+        "SplitText",
+        "RecursiveCharacterTextSplitter",
+        "CharacterTextSplitter",
+        "LanguageRecursiveTextSplitter",
+    ]
+    """The component types whose results are memoized. They must be deterministic for a given set of params.
+    The key only hashes the params, so components that read files, like Directory and File, or call a service,
+    like the embeddings, would keep returning their first result and are not listed."""
+    vertex_memoization_ttl: int = 3600
+    """Time in seconds after which a memoized result expires."""
+    vertex_memoization_max_size: int = 256 * 1024 * 1024
+    """The maximum size in bytes of the memoized results kept by each worker."""
+    branch_pruning: bool = True
+    """If set to True, the components that only feed the branches of a router (a component that calls `stop`) are
+    built after it, and the ones that feed the branches it does not take are never built."""
+    incremental_builds: bool = False
+    """If set to True, building a flow in the playground only rebuilds the components that changed since its last
+    build, and their successors. The other components keep the results of the last build. A component is changed
+    when its data, its edges or the values of its global variables change, but not when what it reads from outside
+    the flow does (the content of a file, a web page, a database), so those are only read again when the component
+    or one of its predecessors changes."""
+    run_timeout: float = 0
+    """The default deadline in seconds of the runs of the /run endpoints. When a run reaches it, the components still
+    building are cancelled and the outputs built so far are returned. Set to 0 for no deadline."""
+    run_stream_buffer_size: int = 64
+    """The number of chunks of a streamed run held for a client that reads slower than the model writes. When the
+    buffer is full, the model is not read until the client catches up."""
+    batch_run_max_concurrency: int = 8
+    """The maximum number of runs of a batch run executed at once."""
+    batch_run_max_inputs: int = 50_000
+    """The maximum number of inputs a batch run accepts."""
+    execution_max_concurrency: int = 64
+    """The maximum number of flow executions (playground builds, API runs, webhooks and background tasks) running at
+    once in a worker. The others wait in the execution queue. Set to 0 for no limit."""
+    execution_max_concurrency_per_user: int = 0
+    """The maximum number of flow executions of a single user running at once. With AUTO_LOGIN every execution
+    belongs to the superuser, so leave it at 0, no limit, unless users log in."""
+    execution_max_concurrency_per_flow: int = 0
+    """The maximum number of executions of a single flow running at once. Set to 0 for no limit."""
+    execution_max_background_concurrency: int = 32
+    """The maximum number of webhook, batch and background executions running at once, so they leave room for the
+    playground and the API. Set to 0 for no limit."""
+    execution_max_queue_size: int = 256
+    """The maximum number of flow executions waiting for a slot. Executions beyond it are rejected with a 429
+    response. Set to 0 for no limit."""
+    execution_max_background_queue_size: int = 128
+    """The maximum number of webhook, batch and background executions waiting for a slot, so they leave room in
+    the queue for the playground and the API. Set to 0 for no limit."""
+    execution_queue_timeout: float = 30.0
+    """The seconds an execution waits for a slot before it is rejected with a 429 response. Set to 0 to wait
+    forever. Batch runs, webhooks and background tasks always wait for a slot."""
+    graph_max_concurrent_builds: int = 0
+    """The maximum number of components of a single run built at once. Set to 0 for no limit."""
+    task_result_ttl: float = 3600
+    """The seconds the results of finished background tasks are kept before they are dropped."""
+    webhook_execution_mode: str = "background"
+    """How the runs of the /webhook endpoint are executed. Can be 'background' (a background task of the API process)
+    or 'queue' (enqueued on the celery queue `webhook_queue_name`, run by the workers that consume it and retried on
+    failure). The 'queue' mode requires celery."""
+    webhook_queue_name: str = "langflow.webhooks"
+    """The celery queue webhook runs are enqueued on when `webhook_execution_mode` is 'queue'."""
+    webhook_max_retries: int = 3
+    """The number of times a queued webhook run is retried after it fails."""
+    webhook_retry_backoff: float = 2.0
+    """The seconds before the first retry of a queued webhook run. Each next retry waits twice as long."""
+    webhook_idempotency_ttl: int = 86400
+    """The seconds a webhook request with an `Idempotency-Key` header is remembered, so duplicates are not run.
+    Duplicates are always detected with the redis result backend, and on a best-effort basis with the others."""
+
     fallback_to_env_var: bool = True
     """If set to True, Global Variables set in the UI will fallback to a environment variable
     with the same name in case Langflow fails to retrieve the variable value."""
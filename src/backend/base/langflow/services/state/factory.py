@@ -1,13 +1,31 @@
+from loguru import logger
+
 from langflow.services.factory import ServiceFactory
 from langflow.services.settings.service import SettingsService
-from langflow.services.state.service import InMemoryStateService
+from langflow.services.state.service import InMemoryStateService, RedisStateService, StateService
 
 
 class StateServiceFactory(ServiceFactory):
     def __init__(self):
-        super().__init__(InMemoryStateService)
+        super().__init__(StateService)
 
     def create(self, settings_service: SettingsService):
+        settings = settings_service.settings
+        if settings.state_service_type == "redis":
+            logger.debug("Creating Redis state service")
+            redis_state_service = RedisStateService(
+                settings_service,
+                host=settings.redis_host,
+                port=settings.redis_port,
+                db=settings.redis_db,
+                url=settings.redis_url,
+                expiration_time=settings.redis_cache_expire,
+                num_shards=settings.state_service_shards,
+            )
+            if redis_state_service.is_connected():
+                return redis_state_service
+            logger.warning("Redis state service is not connected, falling back to the in-memory state service")
         return InMemoryStateService(
             settings_service,
+            num_shards=settings.state_service_shards,
         )
@@ -1,6 +1,12 @@
-from collections import defaultdict
+import asyncio
+import inspect
+import pickle
+import threading
+import uuid
+import weakref
+import zlib
 from threading import Lock
-from typing import Callable
+from typing import Any, Callable, Dict, List, Optional, Tuple
 
 from loguru import logger
 
@@ -9,66 +15,306 @@ from langflow.services.settings.service import SettingsService
 
 
 class StateService(Service):
+    """
+    Keeps the states of the runs. The observers of a run are called with
+    `observer(key, new_state, append=..., caller=...)` whenever one of its states changes, `caller`
+    being the ID of the vertex that changed it. Observers must not change the state they are
+    notified of, the change has already been made.
+    """
+
     name = "state_service"
 
-    def append_state(self, key, new_state, run_id: str):
+    def append_state(self, key, new_state, run_id: str, caller: Optional[str] = None):
         raise NotImplementedError
 
-    def update_state(self, key, new_state, run_id: str):
+    def update_state(self, key, new_state, run_id: str, caller: Optional[str] = None):
         raise NotImplementedError
 
     def get_state(self, key, run_id: str):
         raise NotImplementedError
 
-    def subscribe(self, key, observer: Callable):
+    def subscribe(self, run_id: str, observer: Callable):
+        raise NotImplementedError
+
+    def unsubscribe(self, run_id: str, observer: Callable):
         raise NotImplementedError
 
-    def notify_observers(self, key, new_state):
+    def notify_observers(self, key, new_state, run_id: str, caller: Optional[str] = None):
         raise NotImplementedError
 
 
+class _Shard:
+    def __init__(self):
+        self.lock = Lock()
+        self.data: dict = {}
+
+
+class _Observer:
+    """An observer and the event loop it was subscribed from. Bound methods are held weakly."""
+
+    def __init__(self, callback: Callable, loop: Optional[asyncio.AbstractEventLoop]):
+        self._ref: Callable[[], Optional[Callable]]
+        if inspect.ismethod(callback):
+            self._ref = weakref.WeakMethod(callback)  # type: ignore[arg-type]
+        else:
+            self._ref = lambda: callback
+        self.loop = loop
+
+    @property
+    def callback(self) -> Optional[Callable]:
+        return self._ref()
+
+
+class ObserverRegistry:
+    """The observers of each run, behind one lock per shard of runs. Callbacks are called without holding it."""
+
+    def __init__(self, num_shards: int):
+        self._shards = [_Shard() for _ in range(max(num_shards, 1))]
+
+    def _shard(self, run_id) -> _Shard:
+        return self._shards[zlib.crc32(str(run_id).encode()) % len(self._shards)]
+
+    def add(self, run_id, observer: Callable) -> None:
+        try:
+            loop: Optional[asyncio.AbstractEventLoop] = asyncio.get_running_loop()
+        except RuntimeError:
+            loop = None
+        shard = self._shard(run_id)
+        with shard.lock:
+            observers = shard.data.setdefault(run_id, [])
+            if all(entry.callback != observer for entry in observers):
+                observers.append(_Observer(observer, loop))
+
+    def remove(self, run_id, observer: Callable) -> None:
+        shard = self._shard(run_id)
+        with shard.lock:
+            observers = [entry for entry in shard.data.get(run_id, []) if entry.callback not in (None, observer)]
+            if observers:
+                shard.data[run_id] = observers
+            else:
+                shard.data.pop(run_id, None)
+
+    def get(self, run_id) -> List[Tuple[Callable, Optional[asyncio.AbstractEventLoop]]]:
+        shard = self._shard(run_id)
+        with shard.lock:
+            entries = shard.data.get(run_id, [])
+            alive = [entry for entry in entries if entry.callback is not None]
+            if len(alive) != len(entries):
+                # The graphs of the dead observers were garbage collected
+                if alive:
+                    shard.data[run_id] = alive
+                else:
+                    shard.data.pop(run_id, None)
+            return [(callback, entry.loop) for entry in alive if (callback := entry.callback) is not None]
+
+    def notify(self, key, new_state, run_id, append: bool, caller: Optional[str] = None, threadsafe=False) -> None:
+        """
+        Calls the observers of `run_id`. With `threadsafe`, as from the listener thread of the Redis
+        service, an observer subscribed from an event loop is called in that loop.
+        """
+        for callback, loop in self.get(run_id):
+            if threadsafe and loop is not None:
+                if loop.is_closed():
+                    continue
+                loop.call_soon_threadsafe(self._call, callback, key, new_state, append, caller)
+            else:
+                self._call(callback, key, new_state, append, caller)
+
+    @staticmethod
+    def _call(callback: Callable, key, new_state, append: bool, caller: Optional[str]) -> None:
+        try:
+            callback(key, new_state, append=append, caller=caller)
+        except Exception as e:
+            logger.error(f"Error in observer {callback} for key {key}: {e}")
+
+
 class InMemoryStateService(StateService):
-    def __init__(self, settings_service: SettingsService):
+    """
+    Keeps the states of the runs in the process. The runs are spread over `state_service_shards` shards,
+    each with its own lock, so runs only contend with the runs of the same shard.
+    """
+
+    def __init__(self, settings_service: SettingsService, num_shards: int = 16):
         self.settings_service = settings_service
-        self.states: dict = {}
-        self.observers: dict = defaultdict(list)
-        self.lock = Lock()
+        self._shards = [_Shard() for _ in range(max(num_shards, 1))]
+        self._observers = ObserverRegistry(num_shards)
+
+    def _shard(self, run_id: str) -> _Shard:
+        return self._shards[zlib.crc32(str(run_id).encode()) % len(self._shards)]
+
+    def append_state(self, key, new_state, run_id: str, caller: Optional[str] = None):
+        shard = self._shard(run_id)
+        with shard.lock:
+            run_states = shard.data.setdefault(run_id, {})
+            if key not in run_states:
+                run_states[key] = []
+            elif not isinstance(run_states[key], list):
+                run_states[key] = [run_states[key]]
+            run_states[key].append(new_state)
+        # Outside of the lock, an observer may update the state of the run again
+        self.notify_append_observers(key, new_state, run_id, caller)
 
-    def append_state(self, key, new_state, run_id: str):
-        with self.lock:
-            if run_id not in self.states:
-                self.states[run_id] = {}
-            if key not in self.states[run_id]:
-                self.states[run_id][key] = []
-            elif not isinstance(self.states[run_id][key], list):
-                self.states[run_id][key] = [self.states[run_id][key]]
-            self.states[run_id][key].append(new_state)
-            self.notify_append_observers(key, new_state)
-
-    def update_state(self, key, new_state, run_id: str):
-        with self.lock:
-            if run_id not in self.states:
-                self.states[run_id] = {}
-            self.states[run_id][key] = new_state
-            self.notify_observers(key, new_state)
+    def update_state(self, key, new_state, run_id: str, caller: Optional[str] = None):
+        shard = self._shard(run_id)
+        with shard.lock:
+            shard.data.setdefault(run_id, {})[key] = new_state
+        self.notify_observers(key, new_state, run_id, caller)
 
     def get_state(self, key, run_id: str):
-        with self.lock:
-            return self.states.get(run_id, {}).get(key, "")
-
-    def subscribe(self, key, observer: Callable):
-        with self.lock:
-            if observer not in self.observers[key]:
-                self.observers[key].append(observer)
-
-    def notify_observers(self, key, new_state):
-        for callback in self.observers[key]:
-            callback(key, new_state, append=False)
-
-    def notify_append_observers(self, key, new_state):
-        for callback in self.observers[key]:
-            try:
-                callback(key, new_state, append=True)
-            except Exception as e:
-                logger.error(f"Error in observer {callback} for key {key}: {e}")
-                logger.warning("Callbacks not implemented yet")
+        shard = self._shard(run_id)
+        with shard.lock:
+            return shard.data.get(run_id, {}).get(key, "")
+
+    def subscribe(self, run_id: str, observer: Callable):
+        self._observers.add(run_id, observer)
+
+    def unsubscribe(self, run_id: str, observer: Callable):
+        self._observers.remove(run_id, observer)
+
+    def notify_observers(self, key, new_state, run_id: str, caller: Optional[str] = None):
+        self._observers.notify(key, new_state, run_id, append=False, caller=caller)
+
+    def notify_append_observers(self, key, new_state, run_id: str, caller: Optional[str] = None):
+        self._observers.notify(key, new_state, run_id, append=True, caller=caller)
+
+
+class RedisStateService(StateService):
+    """
+    Keeps the states of the runs in Redis, so the workers that build the vertices of a run share them.
+
+    Each state is a Redis key, `langflow:state:<run_id>:<key>`, that expires `expiration_time` seconds
+    after its last change. Appends are transactions on that key, so concurrent appends from different
+    workers are not lost. A change is passed to the observers of the worker that made it right away,
+    and published on `langflow:state:notify:<run_id>` for the observers of the other workers. A
+    listener thread receives it, skips the changes this worker published, and hands it to each
+    observer in the event loop the observer was subscribed from.
+    """
+
+    KEY_PREFIX = "langflow:state:"
+    CHANNEL_PREFIX = "langflow:state:notify:"
+
+    def __init__(
+        self,
+        settings_service: SettingsService,
+        host="localhost",
+        port=6379,
+        db=0,
+        url=None,
+        expiration_time=60 * 60,
+        num_shards: int = 16,
+    ):
+        try:
+            import redis
+        except ImportError as exc:
+            raise ImportError(
+                "RedisStateService requires the redis-py package."
+                " Please install Langflow with the deploy extra: pip install langflow[deploy]"
+            ) from exc
+        from langflow.services.monitor.metrics import instrument_redis_client
+
+        self.settings_service = settings_service
+        self._redis = redis.StrictRedis.from_url(url) if url else redis.StrictRedis(host=host, port=port, db=db)
+        self._client = instrument_redis_client(self._redis)
+        self.expiration_time = expiration_time
+        self.instance_id = uuid.uuid4().hex
+        self._observers = ObserverRegistry(num_shards)
+        self._listener: Any = None
+        self._listener_lock = threading.Lock()
+
+    def is_connected(self) -> bool:
+        import redis
+
+        try:
+            self._client.ping()
+            return True
+        except redis.exceptions.ConnectionError:
+            return False
+
+    def _state_key(self, key, run_id: str) -> str:
+        return f"{self.KEY_PREFIX}{run_id}:{key}"
+
+    def append_state(self, key, new_state, run_id: str, caller: Optional[str] = None):
+        state_key = self._state_key(key, run_id)
+
+        def append(pipe):
+            value = pipe.get(state_key)
+            states = pickle.loads(value) if value else []
+            if not isinstance(states, list):
+                states = [states]
+            states.append(new_state)
+            pipe.multi()
+            pipe.set(state_key, pickle.dumps(states), ex=self.expiration_time)
+
+        self._redis.transaction(append, state_key)
+        self.notify_append_observers(key, new_state, run_id, caller)
+
+    def update_state(self, key, new_state, run_id: str, caller: Optional[str] = None):
+        self._client.set(self._state_key(key, run_id), pickle.dumps(new_state), ex=self.expiration_time)
+        self.notify_observers(key, new_state, run_id, caller)
+
+    def get_state(self, key, run_id: str):
+        value = self._client.get(self._state_key(key, run_id))
+        return pickle.loads(value) if value else ""
+
+    def subscribe(self, run_id: str, observer: Callable):
+        self._start_listener()
+        self._observers.add(run_id, observer)
+
+    def unsubscribe(self, run_id: str, observer: Callable):
+        self._observers.remove(run_id, observer)
+
+    def notify_observers(self, key, new_state, run_id: str, caller: Optional[str] = None):
+        self._observers.notify(key, new_state, run_id, append=False, caller=caller)
+        self._publish(key, new_state, run_id, append=False, caller=caller)
+
+    def notify_append_observers(self, key, new_state, run_id: str, caller: Optional[str] = None):
+        self._observers.notify(key, new_state, run_id, append=True, caller=caller)
+        self._publish(key, new_state, run_id, append=True, caller=caller)
+
+    def _publish(self, key, new_state, run_id: str, append: bool, caller: Optional[str]) -> None:
+        message = pickle.dumps(
+            {
+                "origin": self.instance_id,
+                "run_id": run_id,
+                "key": key,
+                "state": new_state,
+                "append": append,
+                "caller": caller,
+            }
+        )
+        self._client.publish(f"{self.CHANNEL_PREFIX}{run_id}", message)
+
+    def _start_listener(self) -> None:
+        with self._listener_lock:
+            if self._listener is not None:
+                return
+            pubsub = self._redis.pubsub(ignore_subscribe_messages=True)
+            pubsub.psubscribe(**{f"{self.CHANNEL_PREFIX}*": self._handle_message})
+            self._listener = pubsub.run_in_thread(sleep_time=1.0, daemon=True)
+
+    def _handle_message(self, message: Dict[str, Any]) -> None:
+        try:
+            payload = pickle.loads(message["data"])
+        except Exception as exc:
+            logger.debug(f"Ignoring a state notification that could not be read: {exc}")
+            return
+        # The observers of this worker were notified when the state changed
+        if payload["origin"] == self.instance_id:
+            return
+        try:
+            self._observers.notify(
+                payload["key"],
+                payload["state"],
+                payload["run_id"],
+                append=payload["append"],
+                caller=payload["caller"],
+                threadsafe=True,
+            )
+        except Exception as exc:
+            logger.error(f"Error notifying the observers of {payload['key']}: {exc}")
+
+    def teardown(self) -> None:
+        with self._listener_lock:
+            if self._listener is not None:
+                self._listener.stop()
+                self._listener = None
@@ -0,0 +1,219 @@
+"""
+Content-addressed storage of the uploaded files on the local disk.
+
+Each unique file is stored once, as a blob named by the sha256 of its content, and every file
+uploaded to a flow is a hard link to its blob. The flow paths keep working for everything that
+reads them, and the link count of a blob is its reference count: when the last flow file linked
+to it is deleted, the blob and the documents parsed from it are deleted too.
+
+File systems without hard links get a copy of the blob instead, which keeps the flows working
+without deduplicating them.
+"""
+
+import hashlib
+import os
+import shutil
+import tempfile
+import threading
+from collections import OrderedDict
+from pathlib import Path
+from typing import Any, Optional, Tuple
+
+import orjson
+from loguru import logger
+
+BLOBS_DIR = "blobs"
+PARSED_DIR = "parsed"
+# Number of file hashes kept in memory, keyed by inode, so files linked to the same blob are hashed once
+HASH_CACHE_SIZE = 10_000
+# Times a file is linked again when another worker deletes its blob meanwhile
+ADD_ATTEMPTS = 3
+
+
+class BlobStore:
+    def __init__(self, data_dir: Path):
+        self.blobs_dir = data_dir / BLOBS_DIR
+        self.parsed_dir = data_dir / PARSED_DIR
+        self._lock = threading.Lock()
+        self._hashes: OrderedDict[Tuple[int, int, int, int], str] = OrderedDict()
+
+    def blob_path(self, digest: str) -> Path:
+        return self.blobs_dir / digest[:2] / digest
+
+    def new_temp_file(self):
+        """Returns a temporary file in the blob directory, so it can be moved into it without copying."""
+        self.blobs_dir.mkdir(parents=True, exist_ok=True)
+        return tempfile.NamedTemporaryFile(dir=self.blobs_dir, delete=False, suffix=".part")
+
+    def add(self, temp_path: Path, digest: str, file_path: Path) -> None:
+        """
+        Stores the content of `temp_path`, whose sha256 is `digest`, and links `file_path` to it.
+
+        The temporary file is consumed: it becomes the blob or is deleted if the blob already exists.
+
+        `_lock` only covers the threads of this process. Another worker may delete the blob while the
+        file is linked to it, so the blob is created again from the temporary file until the file is
+        linked to the blob that is on disk.
+        """
+        blob_path = self.blob_path(digest)
+        temp_path = Path(temp_path)
+        try:
+            with self._lock:
+                for _ in range(ADD_ATTEMPTS):
+                    self._create_blob(temp_path, blob_path)
+                    try:
+                        if not self._link(blob_path, file_path) or os.path.samefile(blob_path, file_path):
+                            return
+                    except FileNotFoundError:
+                        pass
+                    logger.debug(f"The blob {digest} was deleted by another worker while it was linked, retrying")
+                raise OSError(f"Could not link {file_path.name} to the blob {digest}")
+        finally:
+            temp_path.unlink(missing_ok=True)
+
+    def _create_blob(self, temp_path: Path, blob_path: Path) -> None:
+        """Creates the blob from the temporary file, which is kept, unless a worker already created it."""
+        blob_path.parent.mkdir(parents=True, exist_ok=True)
+        try:
+            # Fails if the blob exists, so a blob another worker uses is never replaced
+            os.link(temp_path, blob_path)
+        except FileExistsError:
+            pass
+        except OSError as exc:
+            if blob_path.exists():
+                return
+            logger.debug(f"Copying {blob_path.name} instead of linking it: {exc}")
+            copy_path = blob_path.with_name(f".{blob_path.name}.{os.getpid()}.part")
+            shutil.copyfile(temp_path, copy_path)
+            os.replace(copy_path, blob_path)
+
+    def _link(self, blob_path: Path, file_path: Path) -> bool:
+        """
+        Links `file_path` to the blob. Returns False if the file system has no hard links and the blob was copied.
+
+        Raises:
+            FileNotFoundError: If the blob was deleted.
+        """
+        if file_path.exists() and os.path.samefile(blob_path, file_path):
+            return True
+        # Linked next to the destination and renamed over it, so replacing a file is atomic
+        link_path = file_path.with_name(f".{file_path.name}.{os.getpid()}.link")
+        link_path.unlink(missing_ok=True)
+        linked = True
+        try:
+            os.link(blob_path, link_path)
+        except FileNotFoundError:
+            raise
+        except OSError as exc:
+            logger.debug(f"Copying {blob_path.name} instead of linking it: {exc}")
+            shutil.copyfile(blob_path, link_path)
+            linked = False
+        previous_stat = file_path.stat() if file_path.exists() else None
+        previous_digest = self._last_link_digest(file_path, previous_stat) if previous_stat else None
+        os.replace(link_path, file_path)
+        if previous_stat is not None:
+            self._collect(previous_stat, previous_digest)
+        return linked
+
+    def release(self, file_path: Path) -> None:
+        """Deletes a flow file and its blob if no other flow file links to it."""
+        with self._lock:
+            stat = file_path.stat()
+            digest = self._last_link_digest(file_path, stat)
+            file_path.unlink()
+            self._collect(stat, digest)
+
+    def _last_link_digest(self, file_path: Path, stat: os.stat_result) -> Optional[str]:
+        """
+        Returns the hash of a file if it is the last flow file linked to its blob. A file that is not
+        in the hash cache, as after a restart, is hashed, so the blob is found without listing them all.
+        """
+        # Its blob is the only other link to the file
+        if stat.st_nlink != 2:
+            return None
+        return self._hashes.get(_inode_key(stat)) or _hash_file(file_path)
+
+    def _collect(self, stat: os.stat_result, digest: Optional[str]) -> None:
+        if digest is None:
+            return
+        blob_path = self.blob_path(digest)
+        try:
+            blob_stat = blob_path.stat()
+        except FileNotFoundError:
+            return
+        if (blob_stat.st_dev, blob_stat.st_ino) == (stat.st_dev, stat.st_ino) and blob_stat.st_nlink == 1:
+            blob_path.unlink()
+            self.delete_parsed(blob_path.name)
+            logger.debug(f"Deleted the blob {blob_path.name}, no flow uses it anymore")
+
+    def content_hash(self, file_path: Path) -> str:
+        """Returns the sha256 of a file, computed once per inode."""
+        stat = file_path.stat()
+        key = _inode_key(stat)
+        with self._lock:
+            if (digest := self._hashes.get(key)) is not None:
+                self._hashes.move_to_end(key)
+                return digest
+        digest = _hash_file(file_path)
+        self._remember_hash(key, digest)
+        return digest
+
+    def _remember_hash(self, key: Tuple[int, int, int, int], digest: str) -> None:
+        with self._lock:
+            self._hashes[key] = digest
+            if len(self._hashes) > HASH_CACHE_SIZE:
+                self._hashes.popitem(last=False)
+
+    def remember_hash(self, file_path: Path, digest: str) -> None:
+        self._remember_hash(_inode_key(file_path.stat()), digest)
+
+    def get_blob_digest(self, file_path: Path) -> Optional[str]:
+        """Returns the hash of the blob a file is linked to, or None if it is not stored as a blob."""
+        try:
+            stat = file_path.stat()
+        except OSError:
+            return None
+        if stat.st_nlink < 2:
+            return None
+        digest = self.content_hash(file_path)
+        try:
+            return digest if os.path.samefile(self.blob_path(digest), file_path) else None
+        except OSError:
+            return None
+
+    def _parsed_path(self, digest: str, kind: str) -> Path:
+        return self.parsed_dir / digest[:2] / f"{digest}.{kind}.json"
+
+    def get_parsed(self, digest: str, kind: str) -> Optional[Any]:
+        """Returns what was parsed from a blob with the parser `kind`, or None."""
+        try:
+            return orjson.loads(self._parsed_path(digest, kind).read_bytes())["value"]
+        except (OSError, orjson.JSONDecodeError, KeyError):
+            return None
+
+    def set_parsed(self, digest: str, kind: str, value: Any) -> None:
+        path = self._parsed_path(digest, kind)
+        try:
+            content = orjson.dumps({"value": value})
+            path.parent.mkdir(parents=True, exist_ok=True)
+            with tempfile.NamedTemporaryFile(dir=path.parent, delete=False, suffix=".tmp") as file:
+                file.write(content)
+            os.replace(file.name, path)
+        except (OSError, TypeError) as exc:
+            logger.debug(f"Could not cache the parsed content of {digest}: {exc}")
+
+    def delete_parsed(self, digest: str) -> None:
+        for path in (self.parsed_dir / digest[:2]).glob(f"{digest}.*.json"):
+            path.unlink(missing_ok=True)
+
+
+def _hash_file(file_path: Path) -> str:
+    sha256_hash = hashlib.sha256()
+    with open(file_path, "rb") as f:
+        while chunk := f.read(1024 * 1024):
+            sha256_hash.update(chunk)
+    return sha256_hash.hexdigest()
+
+
+def _inode_key(stat: os.stat_result) -> Tuple[int, int, int, int]:
+    return stat.st_dev, stat.st_ino, stat.st_size, stat.st_mtime_ns
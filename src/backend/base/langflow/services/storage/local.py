@@ -1,8 +1,14 @@
+import asyncio
+import hashlib
+import os
+import tempfile
 from pathlib import Path
+from typing import AsyncIterator, Optional
 
 from loguru import logger
 
-from .service import StorageService
+from .blobs import BlobStore
+from .service import CHUNK_SIZE, StorageService
 
 
 class LocalStorageService(StorageService):
@@ -12,6 +18,8 @@ class LocalStorageService(StorageService):
         """Initialize the local storage service with session and settings services."""
         super().__init__(session_service, settings_service)
         self.data_dir = Path(settings_service.settings.config_dir)
+        # Files are stored once per content and linked to the flows that upload them
+        self.blob_store = BlobStore(self.data_dir) if settings_service.settings.storage_dedup else None
         self.set_ready()
 
     def build_full_path(self, flow_id: str, file_name: str) -> str:
@@ -33,14 +41,66 @@ class LocalStorageService(StorageService):
         folder_path.mkdir(parents=True, exist_ok=True)
         file_path = folder_path / file_name
 
-        try:
-            with open(file_path, "wb") as f:
+        def write():
+            if self.blob_store is None:
+                with open(file_path, "wb") as f:
+                    f.write(data)
+                return
+            with self.blob_store.new_temp_file() as f:
                 f.write(data)
+            digest = hashlib.sha256(data).hexdigest()
+            self.blob_store.add(Path(f.name), digest, file_path)
+            self.blob_store.remember_hash(file_path, digest)
+
+        try:
+            await asyncio.to_thread(write)
             logger.info(f"File {file_name} saved successfully in flow {flow_id}.")
         except Exception as e:
             logger.error(f"Error saving file {file_name} in flow {flow_id}: {e}")
             raise e
 
+    async def save_file_stream(self, flow_id: str, file_name: str, chunks: AsyncIterator[bytes]) -> int:
+        """
+        Save a file in the local storage from an async iterator of chunks.
+
+        The chunks are written to a temporary file next to the destination, off the event loop,
+        and the file is renamed once complete, so readers never see a partial file. With
+        `storage_dedup`, the content is hashed while it is written and the file is linked to its blob.
+
+        :param flow_id: The identifier for the flow.
+        :param file_name: The name of the file to be saved.
+        :param chunks: The content of the file.
+        :return: The size of the file.
+        """
+        folder_path = self.data_dir / flow_id
+        folder_path.mkdir(parents=True, exist_ok=True)
+        file_path = folder_path / file_name
+        if self.blob_store is not None:
+            file = await asyncio.to_thread(self.blob_store.new_temp_file)
+        else:
+            file = await asyncio.to_thread(tempfile.NamedTemporaryFile, dir=folder_path, delete=False, suffix=".part")
+        sha256_hash = hashlib.sha256()
+        size = 0
+        try:
+            async for chunk in chunks:
+                await asyncio.to_thread(file.write, chunk)
+                sha256_hash.update(chunk)
+                size += len(chunk)
+            await asyncio.to_thread(file.close)
+            if self.blob_store is not None:
+                digest = sha256_hash.hexdigest()
+                await asyncio.to_thread(self.blob_store.add, Path(file.name), digest, file_path)
+                self.blob_store.remember_hash(file_path, digest)
+            else:
+                os.replace(file.name, file_path)
+        except BaseException as e:
+            file.close()
+            Path(file.name).unlink(missing_ok=True)
+            logger.error(f"Error saving file {file_name} in flow {flow_id}: {e}")
+            raise
+        logger.info(f"File {file_name} saved successfully in flow {flow_id}.")
+        return size
+
     async def get_file(self, flow_id: str, file_name: str) -> bytes:
         """
         Retrieve a file from the local storage.
@@ -55,9 +115,45 @@ class LocalStorageService(StorageService):
             logger.warning(f"File {file_name} not found in flow {flow_id}.")
             raise FileNotFoundError(f"File {file_name} not found in flow {flow_id}")
 
-        with open(file_path, "rb") as f:
-            logger.info(f"File {file_name} retrieved successfully from flow {flow_id}.")
-            return f.read()
+        content = await asyncio.to_thread(file_path.read_bytes)
+        logger.info(f"File {file_name} retrieved successfully from flow {flow_id}.")
+        return content
+
+    async def iter_file(
+        self, flow_id: str, file_name: str, start: int = 0, end: Optional[int] = None, chunk_size: int = CHUNK_SIZE
+    ) -> AsyncIterator[bytes]:
+        """
+        Read a file from the local storage in chunks, from `start` up to `end` (exclusive).
+
+        :raises FileNotFoundError: If the file does not exist.
+        """
+        file_path = self.data_dir / flow_id / file_name
+        if not file_path.exists():
+            raise FileNotFoundError(f"File {file_name} not found in flow {flow_id}")
+        f = await asyncio.to_thread(open, file_path, "rb")
+        try:
+            await asyncio.to_thread(f.seek, start)
+            remaining = None if end is None else end - start
+            while remaining is None or remaining > 0:
+                size = chunk_size if remaining is None else min(chunk_size, remaining)
+                chunk = await asyncio.to_thread(f.read, size)
+                if not chunk:
+                    break
+                if remaining is not None:
+                    remaining -= len(chunk)
+                yield chunk
+        finally:
+            f.close()
+
+    async def get_file_size(self, flow_id: str, file_name: str) -> int:
+        file_path = self.data_dir / flow_id / file_name
+        if not file_path.exists():
+            raise FileNotFoundError(f"File {file_name} not found in flow {flow_id}")
+        return file_path.stat().st_size
+
+    def get_local_path(self, flow_id: str, file_name: str) -> Optional[Path]:
+        file_path = self.data_dir / flow_id / file_name
+        return file_path if file_path.is_file() else None
 
     async def list_files(self, flow_id: str):
         """
@@ -85,7 +181,10 @@ class LocalStorageService(StorageService):
         """
         file_path = self.data_dir / flow_id / file_name
         if file_path.exists():
-            file_path.unlink()
+            if self.blob_store is not None:
+                await asyncio.to_thread(self.blob_store.release, file_path)
+            else:
+                file_path.unlink()
             logger.info(f"File {file_name} deleted successfully from flow {flow_id}.")
         else:
             logger.warning(f"Attempted to delete non-existent file {file_name} in flow {flow_id}.")
@@ -1,14 +1,20 @@
+import asyncio
+from typing import AsyncIterator, Optional
+
 import boto3  # type: ignore
 from botocore.exceptions import ClientError, NoCredentialsError  # type: ignore
 from loguru import logger
 
-from .service import StorageService
+from .service import CHUNK_SIZE, StorageService
+
+# S3 parts must be at least 5 MiB, except the last one
+MULTIPART_CHUNK_SIZE = 8 * 1024 * 1024
 
 
 class S3StorageService(StorageService):
     """A service class for handling operations with AWS S3 storage."""
 
-    async def __init__(self, session_service, settings_service):
+    def __init__(self, session_service, settings_service):
         """Initialize the S3 storage service with session and settings services."""
         super().__init__(session_service, settings_service)
         self.bucket = "langflow"
@@ -34,6 +40,96 @@ class S3StorageService(StorageService):
             logger.error(f"Error saving file {file_name} in folder {folder}: {e}")
             raise
 
+    async def save_file_stream(self, folder: str, file_name: str, chunks: AsyncIterator[bytes]) -> int:
+        """
+        Save a file to the S3 bucket from an async iterator of chunks, with a multipart upload.
+
+        Files smaller than one part are sent with a single `put_object`. The upload is aborted if
+        anything fails, so no incomplete parts are left in the bucket.
+
+        :param folder: The folder in the bucket to save the file.
+        :param file_name: The name of the file to be saved.
+        :param chunks: The content of the file.
+        :return: The size of the file.
+        """
+        key = f"{folder}/{file_name}"
+        buffer = bytearray()
+        upload_id: Optional[str] = None
+        parts: list[dict] = []
+        size = 0
+        try:
+            async for chunk in chunks:
+                buffer.extend(chunk)
+                size += len(chunk)
+                if len(buffer) >= MULTIPART_CHUNK_SIZE:
+                    if upload_id is None:
+                        upload = await asyncio.to_thread(
+                            self.s3_client.create_multipart_upload, Bucket=self.bucket, Key=key
+                        )
+                        upload_id = upload["UploadId"]
+                    parts.append(await self._upload_part(key, upload_id, len(parts) + 1, bytes(buffer)))
+                    buffer.clear()
+            if upload_id is None:
+                await asyncio.to_thread(self.s3_client.put_object, Bucket=self.bucket, Key=key, Body=bytes(buffer))
+            else:
+                if buffer:
+                    parts.append(await self._upload_part(key, upload_id, len(parts) + 1, bytes(buffer)))
+                await asyncio.to_thread(
+                    self.s3_client.complete_multipart_upload,
+                    Bucket=self.bucket,
+                    Key=key,
+                    UploadId=upload_id,
+                    MultipartUpload={"Parts": parts},
+                )
+            logger.info(f"File {file_name} saved successfully in folder {folder}.")
+            return size
+        except BaseException as e:
+            if upload_id is not None:
+                await asyncio.to_thread(
+                    self.s3_client.abort_multipart_upload, Bucket=self.bucket, Key=key, UploadId=upload_id
+                )
+            if isinstance(e, NoCredentialsError):
+                logger.error("Credentials not available for AWS S3.")
+            elif isinstance(e, ClientError):
+                logger.error(f"Error saving file {file_name} in folder {folder}: {e}")
+            raise
+
+    async def _upload_part(self, key: str, upload_id: str, part_number: int, data: bytes) -> dict:
+        response = await asyncio.to_thread(
+            self.s3_client.upload_part,
+            Bucket=self.bucket,
+            Key=key,
+            UploadId=upload_id,
+            PartNumber=part_number,
+            Body=data,
+        )
+        return {"ETag": response["ETag"], "PartNumber": part_number}
+
+    async def iter_file(
+        self, folder: str, file_name: str, start: int = 0, end: Optional[int] = None, chunk_size: int = CHUNK_SIZE
+    ) -> AsyncIterator[bytes]:
+        """
+        Read a file from the S3 bucket in chunks, from `start` up to `end` (exclusive), with a range request.
+        """
+        kwargs = {"Bucket": self.bucket, "Key": f"{folder}/{file_name}"}
+        if start or end is not None:
+            kwargs["Range"] = f"bytes={start}-{'' if end is None else end - 1}"
+        try:
+            response = await asyncio.to_thread(self.s3_client.get_object, **kwargs)
+        except ClientError as e:
+            logger.error(f"Error retrieving file {file_name} from folder {folder}: {e}")
+            raise
+        body = response["Body"]
+        try:
+            while chunk := await asyncio.to_thread(body.read, chunk_size):
+                yield chunk
+        finally:
+            body.close()
+
+    async def get_file_size(self, folder: str, file_name: str) -> int:
+        response = await asyncio.to_thread(self.s3_client.head_object, Bucket=self.bucket, Key=f"{folder}/{file_name}")
+        return response["ContentLength"]
+
     async def get_file(self, folder: str, file_name: str):
         """
         Retrieve a file from the S3 bucket.
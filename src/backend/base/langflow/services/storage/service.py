@@ -1,5 +1,6 @@
 from abc import abstractmethod
-from typing import TYPE_CHECKING
+from pathlib import Path
+from typing import TYPE_CHECKING, AsyncIterator, Optional
 
 from langflow.services.base import Service
 
@@ -8,6 +9,10 @@ if TYPE_CHECKING:
     from langflow.services.settings.service import SettingsService
 
 
+# Size of the chunks files are written and read in
+CHUNK_SIZE = 1024 * 1024
+
+
 class StorageService(Service):
     name = "storage_service"
 
@@ -30,6 +35,36 @@ class StorageService(Service):
     async def get_file(self, flow_id: str, file_name: str) -> bytes:
         raise NotImplementedError
 
+    async def save_file_stream(self, flow_id: str, file_name: str, chunks: AsyncIterator[bytes]) -> int:
+        """
+        Saves a file from an async iterator of chunks and returns its size.
+
+        Services that can write in chunks override this. The default joins the chunks and calls `save_file`.
+        """
+        data = b"".join([chunk async for chunk in chunks])
+        await self.save_file(flow_id=flow_id, file_name=file_name, data=data)
+        return len(data)
+
+    async def iter_file(
+        self, flow_id: str, file_name: str, start: int = 0, end: Optional[int] = None, chunk_size: int = CHUNK_SIZE
+    ) -> AsyncIterator[bytes]:
+        """
+        Yields the bytes of a file from `start` up to `end` (exclusive) in chunks.
+
+        Services that can read in chunks override this. The default slices the result of `get_file`.
+        """
+        data = await self.get_file(flow_id=flow_id, file_name=file_name)
+        data = data[start:end]
+        for offset in range(0, len(data), chunk_size):
+            yield data[offset : offset + chunk_size]
+
+    async def get_file_size(self, flow_id: str, file_name: str) -> int:
+        return len(await self.get_file(flow_id=flow_id, file_name=file_name))
+
+    def get_local_path(self, flow_id: str, file_name: str) -> Optional[Path]:
+        """Returns the path of the file if it is stored on the local disk, so it can be served without copying it."""
+        return None
+
     @abstractmethod
     async def list_files(self, flow_id: str) -> list[str]:
         raise NotImplementedError
@@ -1,5 +1,68 @@
+import hashlib
+from typing import TYPE_CHECKING, AsyncIterator, Optional, Tuple
+
 from langflow.services.storage.constants import EXTENSION_TO_CONTENT_TYPE
+from langflow.services.storage.service import CHUNK_SIZE
+
+if TYPE_CHECKING:
+    from fastapi import UploadFile
 
 
 def build_content_type_from_extension(extension: str):
     return EXTENSION_TO_CONTENT_TYPE.get(extension.lower(), "application/octet-stream")
+
+
+async def iter_upload_file(file: "UploadFile", chunk_size: int = CHUNK_SIZE) -> AsyncIterator[bytes]:
+    """Yields the content of an uploaded file in chunks, without reading it whole."""
+    while chunk := await file.read(chunk_size):
+        yield chunk
+
+
+async def hash_upload_file(file: "UploadFile", chunk_size: int = CHUNK_SIZE) -> str:
+    """Returns the sha256 of an uploaded file and rewinds it."""
+    sha256_hash = hashlib.sha256()
+    async for chunk in iter_upload_file(file, chunk_size):
+        sha256_hash.update(chunk)
+    await file.seek(0)
+    return sha256_hash.hexdigest()
+
+
+class RangeNotSatisfiableError(ValueError):
+    """Raised for a `Range` header whose range is past the end of the file."""
+
+
+def parse_range_header(range_header: Optional[str], size: int) -> Optional[Tuple[int, int]]:
+    """
+    Parses a `Range: bytes=...` header with a single range.
+
+    Headers with several ranges, another unit or an invalid syntax are ignored, so the whole file is sent,
+    which HTTP allows instead of serving each of the ranges.
+
+    Returns:
+        Optional[Tuple[int, int]]: The start and the exclusive end of the range, or None if the
+            header is missing or ignored.
+
+    Raises:
+        RangeNotSatisfiableError: If the range is past the end of the file.
+    """
+    if not range_header or not range_header.startswith("bytes=") or "," in range_header:
+        return None
+    start_text, _, end_text = range_header[len("bytes=") :].strip().partition("-")
+    try:
+        first = int(start_text) if start_text else None
+        last = int(end_text) if end_text else None
+    except ValueError:
+        return None
+    if first is None:
+        if last is None:
+            return None
+        # A suffix range: the last N bytes
+        start, end = max(size - last, 0), size
+    elif last is not None and last < first:
+        return None
+    else:
+        start = first
+        end = min(last + 1, size) if last is not None else size
+    if start >= end:
+        raise RangeNotSatisfiableError(f"{range_header} is not satisfiable for a file of {size} bytes")
+    return start, end
@@ -0,0 +1,267 @@
+"""
+Admission control of flow executions.
+
+Every run of a flow (playground builds, `/run`, `/run/batch`, webhooks and background tasks) asks
+the execution scheduler for a slot first. The scheduler caps
+
+- the executions running at once in the process,
+- the executions of each user and of each flow,
+- the slots background executions (webhooks and batch runs) can take, so they cannot starve the playground.
+
+Executions over a cap wait in a bounded queue, served by priority and then in arrival order. An
+execution whose caps are reached does not hold back the ones behind it. Background executions only
+take part of the queue, so a flood of webhooks leaves room to queue the playground and the API. When
+the queue is full, or an execution waits longer than its queue timeout, `execution_queue_timeout` unless
+the caller sets its own, it is rejected and the API answers 429. Batch runs and background tasks wait
+without a timeout, nobody is holding a connection open for them.
+"""
+
+import asyncio
+import heapq
+import itertools
+import threading
+import time
+from collections import Counter
+from enum import IntEnum
+from typing import List, Optional, Tuple
+
+from loguru import logger
+
+
+class Priority(IntEnum):
+    INTERACTIVE = 0
+    """Playground builds, someone is waiting for each vertex."""
+    API = 1
+    """Runs of the /run endpoints."""
+    BACKGROUND = 2
+    """Webhooks, batch runs and background tasks."""
+
+
+class AdmissionRejectedException(Exception):
+    def __init__(self, message: str, retry_after: int = 1):
+        self.retry_after = retry_after
+        super().__init__(message)
+
+
+class Admission:
+    """A slot requested from the scheduler, held while the execution runs (`async with admission:`)."""
+
+    def __init__(
+        self,
+        scheduler: "ExecutionScheduler",
+        priority: Priority,
+        user_id: Optional[str],
+        flow_id: Optional[str],
+        queue_timeout: Optional[float] = None,
+    ):
+        self.scheduler = scheduler
+        self.priority = priority
+        self.user_id = user_id
+        self.flow_id = flow_id
+        # None is the timeout of the scheduler, 0 waits forever
+        self.queue_timeout = scheduler.queue_timeout if queue_timeout is None else queue_timeout
+        self.granted = False
+        self._waiter: Optional[asyncio.Future] = None
+        self._requested_at = time.perf_counter()
+
+    async def __aenter__(self) -> "Admission":
+        if not self.granted:
+            await self._wait()
+        from langflow.services.monitor.metrics import observe_execution_queue_wait
+
+        observe_execution_queue_wait(self.priority.name.lower(), time.perf_counter() - self._requested_at)
+        return self
+
+    async def _wait(self) -> None:
+        assert self._waiter is not None
+        try:
+            await asyncio.wait_for(asyncio.shield(self._waiter), timeout=self.queue_timeout or None)
+        except asyncio.TimeoutError:
+            if not self.scheduler._withdraw(self):
+                return
+            raise AdmissionRejectedException("Timed out waiting for an execution slot, try again later")
+        except asyncio.CancelledError:
+            # The slot may have been granted while the request was cancelled
+            if not self.scheduler._withdraw(self):
+                self.scheduler._release(self)
+            raise
+
+    async def __aexit__(self, *exc_info) -> None:
+        self.release()
+
+    def release(self) -> None:
+        """Gives the slot back. Does nothing if it was not granted or was already released."""
+        self.scheduler._release(self)
+
+
+class ExecutionScheduler:
+    def __init__(
+        self,
+        max_concurrency: int = 0,
+        max_per_user: int = 0,
+        max_per_flow: int = 0,
+        max_background: int = 0,
+        max_queue_size: int = 0,
+        max_background_queue_size: int = 0,
+        queue_timeout: float = 0,
+    ):
+        # 0 means no cap
+        self.max_concurrency = max_concurrency
+        self.max_per_user = max_per_user
+        self.max_per_flow = max_per_flow
+        self.max_background = max_background
+        self.max_queue_size = max_queue_size
+        self.max_background_queue_size = max_background_queue_size
+        self.queue_timeout = queue_timeout
+        self.running = 0
+        self._running_background = 0
+        self._running_by_user: Counter = Counter()
+        self._running_by_flow: Counter = Counter()
+        self._queue: List[Tuple[int, int, Admission]] = []
+        self._counter = itertools.count()
+        self._lock = threading.Lock()
+
+    @property
+    def queued(self) -> int:
+        return len(self._queue)
+
+    def admit(
+        self,
+        priority: Priority,
+        user_id: Optional[object] = None,
+        flow_id: Optional[object] = None,
+        queue_timeout: Optional[float] = None,
+    ) -> Admission:
+        """
+        Requests a slot, granted right away if the caps allow it. `queue_timeout` overrides the
+        timeout of the scheduler for this execution, 0 waits for a slot as long as it takes.
+
+        Raises:
+            AdmissionRejectedException: If the execution would have to wait and the queue is full.
+        """
+        admission = Admission(
+            self, priority, str(user_id) if user_id else None, str(flow_id) if flow_id else None, queue_timeout
+        )
+        with self._lock:
+            # The queued executions are all over a cap, so one that is not can start right away
+            if self._can_run(admission):
+                self._grant(admission)
+                return admission
+            if self._queue_is_full(priority):
+                logger.warning(f"Rejected a {priority.name.lower()} execution, {len(self._queue)} are already queued")
+                raise AdmissionRejectedException("Too many executions in progress, try again later")
+            admission._waiter = asyncio.get_running_loop().create_future()
+            heapq.heappush(self._queue, (priority, next(self._counter), admission))
+        return admission
+
+    def raise_if_full(self, priority: Priority) -> None:
+        """Rejects a request up front when its execution, started later, could not even be queued."""
+        with self._lock:
+            if self._queue_is_full(priority):
+                raise AdmissionRejectedException("Too many executions in progress, try again later")
+
+    def _queue_is_full(self, priority: Priority) -> bool:
+        if self.max_queue_size and len(self._queue) >= self.max_queue_size:
+            return True
+        if priority == Priority.BACKGROUND and self.max_background_queue_size:
+            queued_background = sum(1 for entry in self._queue if entry[0] == Priority.BACKGROUND)
+            return queued_background >= self.max_background_queue_size
+        return False
+
+    def _can_run(self, admission: Admission) -> bool:
+        if self.max_concurrency and self.running >= self.max_concurrency:
+            return False
+        if (
+            admission.priority == Priority.BACKGROUND
+            and self.max_background
+            and self._running_background >= self.max_background
+        ):
+            return False
+        if admission.user_id and self.max_per_user and self._running_by_user[admission.user_id] >= self.max_per_user:
+            return False
+        if admission.flow_id and self.max_per_flow and self._running_by_flow[admission.flow_id] >= self.max_per_flow:
+            return False
+        return True
+
+    def _grant(self, admission: Admission) -> None:
+        admission.granted = True
+        self.running += 1
+        if admission.priority == Priority.BACKGROUND:
+            self._running_background += 1
+        if admission.user_id:
+            self._running_by_user[admission.user_id] += 1
+        if admission.flow_id:
+            self._running_by_flow[admission.flow_id] += 1
+
+    def _release(self, admission: Admission) -> None:
+        with self._lock:
+            if not admission.granted:
+                return
+            admission.granted = False
+            self.running -= 1
+            if admission.priority == Priority.BACKGROUND:
+                self._running_background -= 1
+            if admission.user_id:
+                self._running_by_user[admission.user_id] -= 1
+                if self._running_by_user[admission.user_id] <= 0:
+                    del self._running_by_user[admission.user_id]
+            if admission.flow_id:
+                self._running_by_flow[admission.flow_id] -= 1
+                if self._running_by_flow[admission.flow_id] <= 0:
+                    del self._running_by_flow[admission.flow_id]
+        self._dispatch()
+
+    def _withdraw(self, admission: Admission) -> bool:
+        """Removes a waiting execution from the queue. Returns False if it was granted in the meantime."""
+        with self._lock:
+            if admission.granted:
+                return False
+            self._queue = [entry for entry in self._queue if entry[2] is not admission]
+            heapq.heapify(self._queue)
+            return True
+
+    def _dispatch(self) -> None:
+        """Grants the slots that freed up to the first queued executions that fit in their caps."""
+        with self._lock:
+            if not self._queue:
+                return
+            remaining = []
+            for entry in sorted(self._queue):
+                admission = entry[2]
+                if self._can_run(admission):
+                    self._grant(admission)
+                    if admission._waiter is not None and not admission._waiter.done():
+                        admission._waiter.get_loop().call_soon_threadsafe(_set_granted, admission._waiter)
+                else:
+                    remaining.append(entry)
+            self._queue = remaining
+            heapq.heapify(self._queue)
+
+
+def _set_granted(waiter: asyncio.Future) -> None:
+    if not waiter.done():
+        waiter.set_result(True)
+
+
+_scheduler: Optional[ExecutionScheduler] = None
+_scheduler_lock = threading.Lock()
+
+
+def get_execution_scheduler() -> ExecutionScheduler:
+    """Returns the execution scheduler of the process, configured by the `execution_*` settings."""
+    global _scheduler
+    from langflow.services.deps import get_settings_service
+
+    with _scheduler_lock:
+        if _scheduler is None:
+            settings = get_settings_service().settings
+            _scheduler = ExecutionScheduler(
+                max_concurrency=settings.execution_max_concurrency,
+                max_per_user=settings.execution_max_concurrency_per_user,
+                max_per_flow=settings.execution_max_concurrency_per_flow,
+                max_background=settings.execution_max_background_concurrency,
+                max_queue_size=settings.execution_max_queue_size,
+                max_background_queue_size=settings.execution_max_background_queue_size,
+                queue_timeout=settings.execution_queue_timeout,
+            )
+        return _scheduler
@@ -1,9 +1,12 @@
+import time
 import traceback
-from typing import Any, Callable, Optional, Tuple
+import uuid
+from typing import Any, Callable, Dict, Optional, Tuple
 
 import anyio
 from loguru import logger
 
+from langflow.services.task.admission import Priority, get_execution_scheduler
 from langflow.services.task.backends.base import TaskBackend
 
 
@@ -13,6 +16,8 @@ class AnyIOTaskResult:
         self._status = "PENDING"
         self._result = None
         self._exception = None
+        self._traceback = None
+        self.finished_at: Optional[float] = None
 
     @property
     def status(self) -> str:
@@ -35,19 +40,33 @@ class AnyIOTaskResult:
 
     async def run(self, func, *args, **kwargs):
         try:
-            self._result = await func(*args, **kwargs)
+            async with get_execution_scheduler().admit(Priority.BACKGROUND, queue_timeout=0):
+                self._result = await func(*args, **kwargs)
         except Exception as e:
             self._exception = e
             self._traceback = e.__traceback__
         finally:
             self._status = "DONE"
+            self.finished_at = time.monotonic()
 
 
 class AnyIOBackend(TaskBackend):
     name = "anyio"
 
-    def __init__(self):
-        self.tasks = {}
+    def __init__(self, result_ttl: float = 3600):
+        self.tasks: Dict[str, AnyIOTaskResult] = {}
+        # Finished tasks are kept this many seconds for their results to be read
+        self.result_ttl = result_ttl
+
+    def prune_finished_tasks(self) -> None:
+        now = time.monotonic()
+        expired = [
+            task_id
+            for task_id, task_result in self.tasks.items()
+            if task_result.finished_at is not None and now - task_result.finished_at >= self.result_ttl
+        ]
+        for task_id in expired:
+            del self.tasks[task_id]
 
     async def launch_task(
         self, task_func: Callable[..., Any], *args: Any, **kwargs: Any
@@ -63,11 +82,13 @@ class AnyIOBackend(TaskBackend):
         Returns:
             A tuple containing a unique task ID and the task result object.
         """
+        self.prune_finished_tasks()
         async with anyio.create_task_group() as tg:
             try:
                 task_result = AnyIOTaskResult(tg)
                 tg.start_soon(task_result.run, task_func, *args, **kwargs)
-                task_id = str(id(task_result))
+                # Not id(task_result): the IDs of pruned tasks would be reused
+                task_id = str(uuid.uuid4())
                 self.tasks[task_id] = task_result
                 logger.info(f"Task {task_id} started.")
                 return task_id, task_result
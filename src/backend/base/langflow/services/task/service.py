@@ -53,7 +53,7 @@ class TaskService(Service):
             logger.debug("Using Celery backend")
             return CeleryBackend()
         logger.debug("Using AnyIO backend")
-        return AnyIOBackend()
+        return AnyIOBackend(result_ttl=self.settings_service.settings.task_result_ttl)
 
     # In your TaskService class
     async def launch_and_await_task(
@@ -0,0 +1,86 @@
+"""
+Durable execution of webhook requests.
+
+With `webhook_execution_mode` set to 'queue', `/webhook/{flow_id_or_name}` enqueues the run on the celery
+queue `webhook_queue_name` instead of running it in the API process. The runs survive API restarts, are
+retried with exponential backoff, and are executed by the workers consuming that queue, e.g.
+
+    celery -A langflow.worker worker -Q langflow.webhooks --concurrency 8
+
+so webhook floods are absorbed by the queue and scaled with workers apart from the interactive traffic.
+The status of a run is read with `GET /task/{task_id}`.
+
+A request sent with an `Idempotency-Key` header is run once per flow and key: the task ID is derived from
+both, and a duplicate received within `webhook_idempotency_ttl` seconds returns the task of the first one.
+This is guaranteed with the Redis result backend only. Other backends only know a task once a worker has
+started it, so duplicates received while the first one waits in the queue are enqueued again, and the
+deduplication is best-effort.
+"""
+
+import uuid
+from typing import Any, Dict, Optional, Tuple
+
+from loguru import logger
+
+# Task IDs of idempotent requests are UUIDs in this namespace, named by flow and key
+WEBHOOK_TASK_NAMESPACE = uuid.UUID("9b8ef6e6-4bd2-4f4e-9d35-0e8f4d7f83c1")
+
+
+def get_webhook_task_id(flow_id: Any, idempotency_key: Optional[str] = None) -> str:
+    if not idempotency_key:
+        return str(uuid.uuid4())
+    return str(uuid.uuid5(WEBHOOK_TASK_NAMESPACE, f"{flow_id}:{idempotency_key}"))
+
+
+def get_claim_key(task_id: str) -> str:
+    return f"langflow:webhook:{task_id}"
+
+
+def claim_webhook_task(celery_app, task_id: str, ttl: int) -> bool:
+    """Returns False if a task with this ID was already enqueued."""
+    client = getattr(celery_app.backend, "client", None)
+    if client is not None:
+        # Redis result backend: an atomic claim, so concurrent duplicates are enqueued once
+        return bool(client.set(get_claim_key(task_id), 1, nx=True, ex=ttl))
+    from celery.result import AsyncResult  # type: ignore
+
+    # Other backends only know the tasks a worker has started, so this is best-effort
+    return AsyncResult(task_id, app=celery_app).state == "PENDING"
+
+
+def release_webhook_task(celery_app, task_id: str) -> None:
+    """Drops the claim of a task that could not be enqueued, so the request can be sent again."""
+    if (client := getattr(celery_app.backend, "client", None)) is not None:
+        client.delete(get_claim_key(task_id))
+
+
+def enqueue_webhook_run(
+    flow_id: Any,
+    input_request: Dict[str, Any],
+    idempotency_key: Optional[str] = None,
+) -> Tuple[str, bool]:
+    """
+    Enqueues the run of a webhook request on the webhook queue.
+
+    Returns:
+        The ID of the task and whether it was enqueued, False when the request is a duplicate.
+    """
+    from langflow.services.deps import get_settings_service
+    from langflow.worker import celery_app, run_webhook_flow
+
+    settings = get_settings_service().settings
+    task_id = get_webhook_task_id(flow_id, idempotency_key)
+    if idempotency_key and not claim_webhook_task(celery_app, task_id, settings.webhook_idempotency_ttl):
+        logger.debug(f"Webhook request {idempotency_key} of flow {flow_id} was already received")
+        return task_id, False
+    try:
+        run_webhook_flow.apply_async(
+            args=(str(flow_id), input_request),
+            task_id=task_id,
+            queue=settings.webhook_queue_name,
+        )
+    except Exception:
+        if idempotency_key:
+            release_webhook_task(celery_app, task_id)
+        raise
+    return task_id, True
@@ -1,9 +1,19 @@
 from abc import ABC, abstractmethod
+from datetime import datetime
 from typing import Any, Dict
 from uuid import UUID
 
+from langflow.services.tracing.schema import Log
+
 
 class BaseTracer(ABC):
+    """
+    A destination of the traces of the runs.
+
+    The tracing service calls tracers from a worker thread, after the events happened, so the
+    methods receive the time each event happened at.
+    """
+
     @abstractmethod
     def __init__(self, trace_name: str, trace_type: str, project_name: str, trace_id: UUID):
         raise NotImplementedError
@@ -14,14 +24,32 @@ class BaseTracer(ABC):
 
     @abstractmethod
     def add_trace(
-        self, trace_name: str, trace_type: str, inputs: Dict[str, Any], metadata: Dict[str, Any] | None = None
+        self,
+        trace_name: str,
+        trace_type: str,
+        inputs: Dict[str, Any],
+        metadata: Dict[str, Any] | None = None,
+        start_time: datetime | None = None,
     ):
         raise NotImplementedError
 
     @abstractmethod
-    def end_trace(self, trace_name: str, outputs: Dict[str, Any] | None = None, error: str | None = None):
+    def end_trace(
+        self,
+        trace_name: str,
+        outputs: Dict[str, Any] | None = None,
+        error: str | None = None,
+        end_time: datetime | None = None,
+    ):
         raise NotImplementedError
 
+    def add_log(self, trace_name: str, log: Log, time: datetime | None = None):
+        pass
+
+    def flush(self):
+        """Sends what the events of the last batch produced. Called once per batch of events."""
+        pass
+
     @abstractmethod
     def end(
         self,
@@ -29,5 +57,6 @@ class BaseTracer(ABC):
         outputs: Dict[str, Any],
         error: str | None = None,
         metadata: dict[str, Any] | None = None,
+        end_time: datetime | None = None,
     ):
         raise NotImplementedError
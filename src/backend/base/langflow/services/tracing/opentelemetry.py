@@ -0,0 +1,153 @@
+"""
+Sends the traces of the runs to an OpenTelemetry collector.
+
+Each run is a root span with a child span per component. The spans go through a batch span
+processor and the OTLP exporter, configured with the standard `OTEL_EXPORTER_OTLP_*` environment
+variables, and the service name is set by `OTEL_SERVICE_NAME` (langflow by default).
+"""
+
+import os
+import threading
+from datetime import datetime
+from typing import Any, Dict
+from uuid import UUID
+
+import orjson
+from loguru import logger
+
+from langflow.services.tracing.base import BaseTracer
+from langflow.services.tracing.schema import Log
+
+# Inputs and outputs are recorded as JSON attributes, cut to this many characters
+MAX_ATTRIBUTE_LENGTH = 4096
+
+_tracer_provider = None
+_tracer_provider_lock = threading.Lock()
+
+
+def get_tracer_provider():
+    """Returns the tracer provider shared by the runs, created with its exporter on first use."""
+    global _tracer_provider
+    from opentelemetry.sdk.resources import Resource  # type: ignore
+    from opentelemetry.sdk.trace import TracerProvider  # type: ignore
+    from opentelemetry.sdk.trace.export import BatchSpanProcessor  # type: ignore
+
+    with _tracer_provider_lock:
+        if _tracer_provider is None:
+            try:
+                from opentelemetry.exporter.otlp.proto.http.trace_exporter import OTLPSpanExporter  # type: ignore
+            except ImportError:
+                from opentelemetry.exporter.otlp.proto.grpc.trace_exporter import OTLPSpanExporter  # type: ignore
+            resource = Resource.create({"service.name": os.getenv("OTEL_SERVICE_NAME", "langflow")})
+            provider = TracerProvider(resource=resource)
+            provider.add_span_processor(BatchSpanProcessor(OTLPSpanExporter()))
+            _tracer_provider = provider
+        return _tracer_provider
+
+
+def to_attribute(value: Any) -> str:
+    text = orjson.dumps(value, default=str).decode("utf-8")
+    return text if len(text) <= MAX_ATTRIBUTE_LENGTH else text[:MAX_ATTRIBUTE_LENGTH] + "..."
+
+
+def to_nanoseconds(time: datetime | None) -> int | None:
+    return int(time.timestamp() * 1e9) if time is not None else None
+
+
+class OpenTelemetryTracer(BaseTracer):
+    def __init__(self, trace_name: str, trace_type: str, project_name: str, trace_id: UUID):
+        self.trace_name = trace_name
+        self.trace_type = trace_type
+        self.project_name = project_name
+        self.trace_id = trace_id
+        try:
+            self._tracer = get_tracer_provider().get_tracer("langflow")
+            self._root = self._tracer.start_span(
+                trace_name or "Langflow",
+                attributes={
+                    "langflow.run_id": str(trace_id),
+                    "langflow.project": project_name or "",
+                    "langflow.trace_type": trace_type,
+                },
+            )
+            self._spans: Dict[str, Any] = {}
+            self._ready = True
+        except ImportError:
+            logger.error(
+                "Could not import opentelemetry. Please install it with "
+                "`pip install opentelemetry-sdk opentelemetry-exporter-otlp`."
+            )
+            self._ready = False
+        except Exception as e:
+            logger.debug(f"Error setting up OpenTelemetry tracer: {e}")
+            self._ready = False
+
+    @property
+    def ready(self):
+        return self._ready
+
+    def add_trace(
+        self,
+        trace_name: str,
+        trace_type: str,
+        inputs: Dict[str, Any],
+        metadata: Dict[str, Any] | None = None,
+        start_time: datetime | None = None,
+    ):
+        from opentelemetry.trace import set_span_in_context  # type: ignore
+
+        attributes = {"langflow.trace_type": trace_type, "langflow.inputs": to_attribute(inputs or {})}
+        if metadata:
+            attributes["langflow.metadata"] = to_attribute(metadata)
+        self._spans[trace_name] = self._tracer.start_span(
+            trace_name,
+            context=set_span_in_context(self._root),
+            attributes=attributes,
+            start_time=to_nanoseconds(start_time),
+        )
+
+    def end_trace(
+        self,
+        trace_name: str,
+        outputs: Dict[str, Any] | None = None,
+        error: str | None = None,
+        end_time: datetime | None = None,
+    ):
+        span = self._spans.pop(trace_name, None)
+        if span is None:
+            return
+        self._end_span(span, outputs, error, end_time)
+
+    def add_log(self, trace_name: str, log: Log, time: datetime | None = None):
+        span = self._spans.get(trace_name, self._root)
+        span.add_event(
+            str(log.get("name") or "log"),
+            attributes={"message": to_attribute(log.get("message")), "type": str(log.get("type") or "")},
+            timestamp=to_nanoseconds(time),
+        )
+
+    def end(
+        self,
+        inputs: dict[str, Any],
+        outputs: Dict[str, Any],
+        error: str | None = None,
+        metadata: dict[str, Any] | None = None,
+        end_time: datetime | None = None,
+    ):
+        # Spans that were never ended, e.g. because the run failed, are closed with it
+        for span in self._spans.values():
+            span.end(end_time=to_nanoseconds(end_time))
+        self._spans = {}
+        if metadata:
+            self._root.set_attribute("langflow.metadata", to_attribute(metadata))
+        self._end_span(self._root, outputs, error, end_time)
+
+    @staticmethod
+    def _end_span(span, outputs: Dict[str, Any] | None, error: str | None, end_time: datetime | None):
+        from opentelemetry.trace import Status, StatusCode  # type: ignore
+
+        if outputs:
+            span.set_attribute("langflow.outputs", to_attribute(outputs))
+        if error:
+            span.set_status(Status(StatusCode.ERROR, error))
+        span.end(end_time=to_nanoseconds(end_time))
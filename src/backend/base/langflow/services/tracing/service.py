@@ -1,10 +1,11 @@
 import asyncio
 import os
+import threading
 import traceback
-from collections import defaultdict
+from collections import defaultdict, deque
 from contextlib import asynccontextmanager
 from datetime import datetime, timezone
-from typing import TYPE_CHECKING, Any, Dict, Optional
+from typing import TYPE_CHECKING, Any, Dict, List, Optional, Tuple
 from uuid import UUID
 
 from langchain.callbacks.tracers.langchain import wait_for_all_tracers
@@ -21,6 +22,16 @@ if TYPE_CHECKING:
 
 
 class TracingService(Service):
+    """
+    Sends the traces of the runs to the tracers.
+
+    The run path only records what happened and when: the tracers are called by a worker task, in
+    a thread, with the events buffered since its last export. The buffer is exported when it holds
+    `tracing_batch_size` events or every `tracing_flush_interval` seconds, and each tracer flushes
+    what a batch produced at once. When the buffer holds `tracing_queue_size` events, new traces are
+    dropped with their logs, instead of slowing the runs down when a tracer cannot keep up.
+    """
+
     name = "tracing_service"
 
     def __init__(self, settings_service: "SettingsService", monitor_service: "MonitorService"):
@@ -33,49 +44,135 @@ class TracingService(Service):
         self.run_name: str | None = None
         self.run_id: UUID | None = None
         self.project_name = None
-        self._tracers: dict[str, LangSmithTracer] = {}
-        self.logs_queue: asyncio.Queue = asyncio.Queue()
+        self._tracers: dict[str, BaseTracer] = {}
+        settings = settings_service.settings
+        self.queue_size = settings.tracing_queue_size
+        self.batch_size = settings.tracing_batch_size
+        self.flush_interval = settings.tracing_flush_interval
+        # Events are added from the event loop and from the threads components run in
+        self._events: deque[Tuple[BaseTracer, str, tuple, dict]] = deque()
+        self._events_lock = threading.Lock()
+        self._dropped_traces: set[str] = set()
+        self.dropped_events = 0
+        self._export_lock = asyncio.Lock()
+        self._wakeup: asyncio.Event | None = None
+        self._loop: asyncio.AbstractEventLoop | None = None
         self.running = False
         self.worker_task = None
 
     async def log_worker(self):
-        while self.running or not self.logs_queue.empty():
-            log_func, args = await self.logs_queue.get()
+        while self.running:
+            try:
+                await asyncio.wait_for(self._wakeup.wait(), timeout=self.flush_interval)
+            except asyncio.TimeoutError:
+                pass
+            self._wakeup.clear()
+            await self.export_pending()
+
+    async def export_pending(self):
+        async with self._export_lock:
+            while batch := self._take_batch():
+                await asyncio.to_thread(self._export_batch, batch)
+
+    def _take_batch(self) -> List[Tuple[BaseTracer, str, tuple, dict]]:
+        with self._events_lock:
+            count = min(len(self._events), self.batch_size)
+            return [self._events.popleft() for _ in range(count)]
+
+    @staticmethod
+    def _export_batch(batch: List[Tuple[BaseTracer, str, tuple, dict]]):
+        tracers: dict[int, BaseTracer] = {}
+        for tracer, method, args, kwargs in batch:
+            tracers[id(tracer)] = tracer
+            try:
+                getattr(tracer, method)(*args, **kwargs)
+            except Exception as e:
+                logger.error(f"Error processing trace event {method}: {e}")
+        for tracer in tracers.values():
             try:
-                await log_func(*args)
+                tracer.flush()
             except Exception as e:
-                logger.error(f"Error processing log: {e}")
-            finally:
-                self.logs_queue.task_done()
+                logger.error(f"Error flushing traces: {e}")
+
+    def _enqueue(self, trace_name: str | None, method: str, *args, **kwargs):
+        tracers = [tracer for tracer in self._tracers.values() if tracer.ready]
+        if not tracers:
+            return
+        with self._events_lock:
+            if self._should_drop(trace_name, method):
+                self.dropped_events += 1
+                if self.dropped_events % 1000 == 1:
+                    logger.warning(f"Dropped {self.dropped_events} trace events, the tracers cannot keep up")
+                return
+            for tracer in tracers:
+                self._events.append((tracer, method, args, kwargs))
+            full = len(self._events) >= self.batch_size
+        if full:
+            self._wake_worker()
+
+    def _should_drop(self, trace_name: str | None, method: str) -> bool:
+        # Ends are always kept, so every trace that was started is ended and the run is sent
+        if method == "end_trace":
+            return trace_name in self._dropped_traces
+        if method not in ("add_trace", "add_log"):
+            return False
+        if trace_name in self._dropped_traces:
+            return True
+        if len(self._events) < self.queue_size:
+            return False
+        if method == "add_trace":
+            self._dropped_traces.add(trace_name)
+        return True
+
+    def _wake_worker(self):
+        if self._loop is None or self._wakeup is None:
+            return
+        try:
+            running_loop = asyncio.get_running_loop()
+        except RuntimeError:
+            running_loop = None
+        if running_loop is self._loop:
+            self._wakeup.set()
+        else:
+            self._loop.call_soon_threadsafe(self._wakeup.set)
 
     async def start(self):
         if self.running:
             return
         try:
             self.running = True
+            self._loop = asyncio.get_running_loop()
+            self._wakeup = asyncio.Event()
             self.worker_task = asyncio.create_task(self.log_worker())
         except Exception as e:
             logger.error(f"Error starting tracing service: {e}")
 
     async def flush(self):
         try:
-            await self.logs_queue.join()
+            await self.export_pending()
         except Exception as e:
             logger.error(f"Error flushing logs: {e}")
 
     async def stop(self):
         try:
             self.running = False
+            if self.worker_task is not None:
+                self._wakeup.set()
+                await self.worker_task
+                self.worker_task = None
             await self.flush()
-            # check the qeue is empty
-            if not self.logs_queue.empty():
-                await self.logs_queue.join()
-            self.worker_task.cancel()
-            self.worker_task = None
-
         except Exception as e:
             logger.error(f"Error stopping tracing service: {e}")
 
+    def teardown(self):
+        self.running = False
+        if self.worker_task is not None:
+            self.worker_task.cancel()
+            self.worker_task = None
+        # Whatever the worker did not export yet is exported before the process exits
+        while batch := self._take_batch():
+            self._export_batch(batch)
+
     def _reset_io(self):
         self.inputs = defaultdict(dict)
         self.inputs_metadata = defaultdict(dict)
@@ -85,7 +182,10 @@ class TracingService(Service):
     async def initialize_tracers(self):
         try:
             await self.start()
+            with self._events_lock:
+                self._dropped_traces = set()
             self._initialize_langsmith_tracer()
+            self._initialize_opentelemetry_tracer()
         except Exception as e:
             logger.debug(f"Error initializing tracers: {e}")
 
@@ -99,6 +199,18 @@ class TracingService(Service):
             trace_id=self.run_id,
         )
 
+    def _initialize_opentelemetry_tracer(self):
+        if not self.settings_service.settings.opentelemetry_tracing:
+            return
+        from langflow.services.tracing.opentelemetry import OpenTelemetryTracer
+
+        self._tracers["opentelemetry"] = OpenTelemetryTracer(
+            trace_name=self.run_name,
+            trace_type="chain",
+            project_name=self.project_name,
+            trace_id=self.run_id,
+        )
+
     def set_run_name(self, name: str):
         self.run_name = name
 
@@ -110,50 +222,22 @@ class TracingService(Service):
     ):
         self.inputs[trace_name] = inputs
         self.inputs_metadata[trace_name] = metadata or {}
-        for tracer in self._tracers.values():
-            if not tracer.ready:
-                continue
-            try:
-                tracer.add_trace(trace_name, trace_type, inputs, metadata)
-            except Exception as e:
-                logger.error(f"Error starting trace {trace_name}: {e}")
+        self._enqueue(trace_name, "add_trace", trace_name, trace_type, inputs, metadata, start_time=_now())
 
     def _end_traces(self, trace_name: str, error: str | None = None):
-        for tracer in self._tracers.values():
-            if not tracer.ready:
-                continue
-            try:
-                tracer.end_trace(trace_name=trace_name, outputs=self.outputs[trace_name], error=error)
-            except Exception as e:
-                logger.error(f"Error ending trace {trace_name}: {e}")
+        self._enqueue(trace_name, "end_trace", trace_name, self.outputs[trace_name], error, end_time=_now())
 
     def _end_all_traces(self, outputs: dict, error: str | None = None):
-        for tracer in self._tracers.values():
-            if not tracer.ready:
-                continue
-            try:
-                tracer.end(self.inputs, outputs=self.outputs, error=error, metadata=outputs)
-            except Exception as e:
-                logger.error(f"Error ending all traces: {e}")
+        self._enqueue(None, "end", self.inputs, outputs=self.outputs, error=error, metadata=outputs, end_time=_now())
 
     async def end(self, outputs: dict, error: str | None = None):
         self._end_all_traces(outputs, error)
         self._reset_io()
-        await self.stop()
-
-    async def _add_log(self, trace_name: str, log: Log):
-        for tracer in self._tracers.values():
-            if not tracer.ready:
-                continue
-            try:
-                tracer.add_log(trace_name, log)
-            except Exception as e:
-                logger.error(f"Error adding log to trace {trace_name}: {e}")
+        # The worker keeps running for the next runs, the end of this one is exported with its batch
+        self._wake_worker()
 
     def add_log(self, trace_name: str, log: Log):
-        if not self.running:
-            asyncio.run(self.start())
-        self.logs_queue.put_nowait((self._add_log, (trace_name, log)))
+        self._enqueue(trace_name, "add_log", trace_name, log, time=_now())
 
     @asynccontextmanager
     async def trace_context(
@@ -181,6 +265,25 @@ class TracingService(Service):
         self.outputs_metadata[trace_name] |= output_metadata or {}
 
 
+def _now() -> datetime:
+    return datetime.now(timezone.utc)
+
+
+_langsmith_client = None
+_langsmith_client_lock = threading.Lock()
+
+
+def get_langsmith_client():
+    """Returns the LangSmith client shared by the runs, which batches what it sends in the background."""
+    global _langsmith_client
+    from langsmith import Client
+
+    with _langsmith_client_lock:
+        if _langsmith_client is None:
+            _langsmith_client = Client()
+        return _langsmith_client
+
+
 class LangSmithTracer(BaseTracer):
     def __init__(self, trace_name: str, trace_type: str, project_name: str, trace_id: UUID):
         from langsmith.run_trees import RunTree
@@ -190,15 +293,21 @@ class LangSmithTracer(BaseTracer):
         self.project_name = project_name
         self.trace_id = trace_id
         try:
+            self._ready = self.setup_langsmith()
+            if not self._ready:
+                return
             self._run_tree = RunTree(
                 project_name=self.project_name,
                 name=self.trace_name,
                 run_type=self.trace_type,
                 id=self.trace_id,
+                client=self._client,
             )
             self._run_tree.add_event({"name": "Start", "time": datetime.now(timezone.utc).isoformat()})
             self._children: dict[str, RunTree] = {}
-            self._ready = self.setup_langsmith()
+            self._child_link: dict[str, str] = {}
+            # Children ended since the last flush, with whether they ended with an error
+            self._ended: list[tuple[RunTree, bool]] = []
         except Exception as e:
             logger.debug(f"Error setting up LangSmith tracer: {e}")
             self._ready = False
@@ -209,9 +318,7 @@ class LangSmithTracer(BaseTracer):
 
     def setup_langsmith(self):
         try:
-            from langsmith import Client
-
-            self._client = Client()
+            self._client = get_langsmith_client()
         except ImportError:
             logger.error("Could not import langsmith. Please install it with `pip install langsmith`.")
             return False
@@ -219,7 +326,12 @@ class LangSmithTracer(BaseTracer):
         return True
 
     def add_trace(
-        self, trace_name: str, trace_type: str, inputs: Dict[str, Any], metadata: Dict[str, Any] | None = None
+        self,
+        trace_name: str,
+        trace_type: str,
+        inputs: Dict[str, Any],
+        metadata: Dict[str, Any] | None = None,
+        start_time: datetime | None = None,
     ):
         if not self._ready:
             return
@@ -233,11 +345,11 @@ class LangSmithTracer(BaseTracer):
             name=trace_name,
             run_type=trace_type,  # type: ignore[arg-type]
             inputs=processed_inputs,
+            start_time=start_time,
         )
         if metadata:
             child.add_metadata(raw_inputs)
         self._children[trace_name] = child
-        self._child_link: dict[str, str] = {}
 
     def _convert_to_langchain_types(self, io_dict: Dict[str, Any]):
         converted = {}
@@ -248,10 +360,9 @@ class LangSmithTracer(BaseTracer):
     def _convert_to_langchain_type(self, value):
         from langflow.schema.message import Message
 
+        # Converted into new containers, the run may still be using the ones it traced
         if isinstance(value, dict):
-            for key, _value in value.copy().items():
-                _value = self._convert_to_langchain_type(_value)
-                value[key] = _value
+            value = {key: self._convert_to_langchain_type(_value) for key, _value in value.items()}
         elif isinstance(value, list):
             value = [self._convert_to_langchain_type(v) for v in value]
         elif isinstance(value, Message):
@@ -265,7 +376,13 @@ class LangSmithTracer(BaseTracer):
             value = value.to_lc_document()
         return value
 
-    def end_trace(self, trace_name: str, outputs: Dict[str, Any] | None = None, error: str | None = None):
+    def end_trace(
+        self,
+        trace_name: str,
+        outputs: Dict[str, Any] | None = None,
+        error: str | None = None,
+        end_time: datetime | None = None,
+    ):
         child = self._children[trace_name]
         raw_outputs = {}
         processed_outputs = {}
@@ -273,30 +390,37 @@ class LangSmithTracer(BaseTracer):
             raw_outputs = outputs
             processed_outputs = self._convert_to_langchain_types(outputs)
         child.add_metadata({"outputs": raw_outputs})
-        child.end(outputs=processed_outputs, error=error)
-        if error:
-            child.patch()
-        else:
-            child.post()
-        self._child_link[trace_name] = child.get_url()
+        child.end(outputs=processed_outputs, error=error, end_time=end_time)
+        self._ended.append((child, bool(error)))
 
-    def add_log(self, trace_name: str, log: Log):
+    def add_log(self, trace_name: str, log: Log, time: datetime | None = None):
         log_dict = {
             "name": log.get("name"),
-            "time": datetime.now(timezone.utc).isoformat(),
+            "time": (time or datetime.now(timezone.utc)).isoformat(),
             "message": log.get("message"),
         }
         self._children[trace_name].add_event(log_dict)
 
+    def flush(self):
+        ended, self._ended = self._ended, []
+        for child, failed in ended:
+            if failed:
+                child.patch()
+            else:
+                child.post()
+            self._child_link[child.name] = child.get_url()
+
     def end(
         self,
         inputs: dict[str, Any],
         outputs: Dict[str, Any],
         error: str | None = None,
         metadata: dict[str, Any] | None = None,
+        end_time: datetime | None = None,
     ):
+        self.flush()
         self._run_tree.add_metadata({"inputs": inputs, "metadata": metadata or {}})
-        self._run_tree.end(outputs=outputs, error=error)
+        self._run_tree.end(outputs=outputs, error=error, end_time=end_time)
         self._run_tree.post()
         wait_for_all_tracers()
         self._run_link = self._run_tree.get_url()
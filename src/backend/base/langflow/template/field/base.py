@@ -177,6 +177,9 @@ class Output(BaseModel):
 
     cache: bool = Field(default=True)
 
+    can_stop: Optional[bool] = Field(default=None)
+    """Whether the component may call `stop` on this output, so the branch it feeds is not taken, like a router."""
+
     def to_dict(self):
         return self.model_dump(by_alias=True, exclude_none=True)
 
@@ -1,11 +1,17 @@
 import ast
 import contextlib
 import importlib
+import importlib.util
+import sys
 from types import FunctionType
 from typing import Dict, List, Optional, Union
 
 from langflow.field_typing.constants import CUSTOM_COMPONENT_SUPPORTED_TYPES
 
+# The first use of a lazily imported module runs its import. Before 3.12.3 two threads using it at
+# once, as the component thread pool does, can both run it or see it half imported (gh-114763).
+LAZY_IMPORTS_ARE_THREAD_SAFE = sys.version_info >= (3, 12, 3)
+
 
 def add_type_ignores():
     if not hasattr(ast, "TypeIgnore"):
@@ -122,7 +128,7 @@ def create_function(code, function_name):
         if isinstance(node, ast.Import):
             for alias in node.names:
                 try:
-                    exec_globals[alias.asname or alias.name] = importlib.import_module(alias.name)
+                    exec_globals[alias.asname or alias.name] = lazy_import_module(alias.name)
                 except ModuleNotFoundError as e:
                     raise ModuleNotFoundError(f"Module {alias.name} not found. Please install it and try again.") from e
 
@@ -198,7 +204,7 @@ def prepare_global_scope(code, module):
         if isinstance(node, ast.Import):
             for alias in node.names:
                 try:
-                    exec_globals[alias.asname or alias.name] = importlib.import_module(alias.name)
+                    exec_globals[alias.asname or alias.name] = lazy_import_module(alias.name)
                 except ModuleNotFoundError as e:
                     raise ModuleNotFoundError(f"Module {alias.name} not found. Please install it and try again.") from e
         elif isinstance(node, ast.ImportFrom) and node.module is not None:
@@ -211,6 +217,34 @@ def prepare_global_scope(code, module):
     return exec_globals
 
 
+def lazy_import_module(name: str):
+    """
+    Imports a module the first time one of its attributes is used.
+
+    Only the plain `import x` statements of component code go through this, so a dependency
+    imported that way is loaded once a component runs code that uses it. `from x import y`
+    statements still load `x` when the code is evaluated, since `y` may be needed to define
+    the class. Modules that are already imported, and submodules, are imported as usual, and so
+    is everything on Python versions whose lazy loader is not thread-safe.
+
+    Raises:
+        ModuleNotFoundError: If the module is not installed.
+    """
+    if name in sys.modules or "." in name or not LAZY_IMPORTS_ARE_THREAD_SAFE:
+        return importlib.import_module(name)
+    spec = importlib.util.find_spec(name)
+    if spec is None:
+        raise ModuleNotFoundError(f"No module named '{name}'", name=name)
+    if spec.loader is None or not hasattr(spec.loader, "exec_module"):
+        return importlib.import_module(name)
+    loader = importlib.util.LazyLoader(spec.loader)
+    spec.loader = loader
+    module = importlib.util.module_from_spec(spec)
+    sys.modules[name] = module
+    loader.exec_module(module)
+    return module
+
+
 def extract_class_code(module, class_name):
     """
     Extracts the AST node for the specified class from the module.
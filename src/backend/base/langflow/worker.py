@@ -1,3 +1,4 @@
+from collections import OrderedDict
 from typing import TYPE_CHECKING, Any, Dict, List, Optional, Union
 
 from asgiref.sync import async_to_sync
@@ -6,8 +7,13 @@ from celery.exceptions import SoftTimeLimitExceeded  # type: ignore
 from langflow.core.celery_app import celery_app
 
 if TYPE_CHECKING:
+    from langflow.graph.graph.base import Graph
     from langflow.graph.vertex.base import Vertex
 
+# Number of runs a worker keeps the graph of, so the vertices it built stay in memory
+WORKER_GRAPHS_SIZE = 32
+_worker_graphs: "OrderedDict[str, Graph]" = OrderedDict()
+
 
 @celery_app.task(acks_late=True)
 def test_celery(word: str) -> str:
@@ -27,6 +33,84 @@ def build_vertex(self, vertex: "Vertex") -> "Vertex":
         raise self.retry(exc=SoftTimeLimitExceeded("Task took too long"), countdown=2) from e
 
 
+@celery_app.task(bind=True)
+def run_vertex(
+    self,
+    run_id: str,
+    vertex_id: str,
+    user_id: Optional[str] = None,
+    fallback_to_env_vars: bool = False,
+    inactive_vertices: Optional[List[str]] = None,
+) -> Dict[str, Any]:
+    """
+    Builds a vertex of a graph run by `CeleryVertexExecutor` and returns a summary of its result.
+    """
+    from langflow.graph.graph.distributed import (
+        get_vertex_states,
+        load_worker_graph,
+        restore_predecessors,
+        store_vertex_result,
+        summarize_vertex,
+        sync_vertex_states,
+    )
+    from langflow.services.cache.service import RedisCache
+    from langflow.services.deps import get_cache_service
+
+    cache_service = get_cache_service()
+    if not isinstance(cache_service, RedisCache):
+        raise ValueError("The celery graph executor requires the redis cache")
+    if (graph := _worker_graphs.get(run_id)) is None:
+        graph = load_worker_graph(cache_service, run_id)
+        _worker_graphs[run_id] = graph
+        if len(_worker_graphs) > WORKER_GRAPHS_SIZE:
+            _worker_graphs.popitem(last=False)
+    _worker_graphs.move_to_end(run_id)
+
+    sync_vertex_states(graph, inactive_vertices or [])
+    vertex = graph.get_vertex(vertex_id)
+    # The predecessors built by other workers
+    missing = {v.id for v in graph.vertices if not v._built}
+    restore_predecessors(cache_service, run_id, vertex, missing)
+    states_before = get_vertex_states(graph)
+    # The API process logs the transaction, the monitor database of a worker is not read by anyone
+    async_to_sync(vertex.build)(user_id=user_id, fallback_to_env_vars=fallback_to_env_vars)
+    by_reference = store_vertex_result(cache_service, run_id, vertex)
+    return summarize_vertex(vertex, by_reference, self.request.hostname, states_before)
+
+
+@celery_app.task(bind=True, acks_late=True, reject_on_worker_lost=True)
+def run_webhook_flow(self, flow_id: str, input_request: Dict[str, Any]) -> Dict[str, Any]:
+    """
+    Runs a flow for a webhook request enqueued by `enqueue_webhook_run`.
+
+    The task is acknowledged once it finishes, so a run lost with its worker is delivered again.
+    A failed run is retried `webhook_max_retries` times, waiting `webhook_retry_backoff` seconds
+    before the first retry and twice as long before each of the next.
+    """
+    from uuid import UUID
+
+    from fastapi.encoders import jsonable_encoder
+
+    from langflow.api.v1.endpoints import simple_run_flow
+    from langflow.api.v1.schemas import SimplifiedAPIRequest
+    from langflow.services.database.models.flow import Flow
+    from langflow.services.deps import get_settings_service, session_scope
+
+    settings = get_settings_service().settings
+    with session_scope() as session:
+        flow = session.get(Flow, UUID(flow_id))
+        if flow is None:
+            # Retrying would not bring the flow back
+            raise ValueError(f"Flow {flow_id} not found")
+        session.expunge(flow)
+    try:
+        result = async_to_sync(simple_run_flow)(flow=flow, input_request=SimplifiedAPIRequest(**input_request))
+    except Exception as exc:
+        countdown = settings.webhook_retry_backoff * 2**self.request.retries
+        raise self.retry(exc=exc, countdown=countdown, max_retries=settings.webhook_max_retries) from exc
+    return jsonable_encoder(result)
+
+
 @celery_app.task(acks_late=True)
 def process_graph_cached_task(
     data_graph: Dict[str, Any],
@@ -993,6 +993,7 @@ export async function postBuildVertex(
   vertexId: string,
   input_value: string,
   files?: string[],
+  runId?: string,
 ): Promise<AxiosResponse<VertexBuildTypeAPI>> {
   // input_value is optional and is a query parameter
   let data = {};
@@ -1002,9 +1003,15 @@ export async function postBuildVertex(
   if (data && files) {
     data["files"] = files;
   }
+  // run_id selects the state of this run on the server
+  const config: AxiosRequestConfig<any> = {};
+  if (runId) {
+    config["params"] = { run_id: runId };
+  }
   return await api.post(
     `${BASE_URL_API}build/${flowId}/vertices/${vertexId}`,
     data,
+    config,
   );
 }
 
@@ -223,6 +223,7 @@ export async function buildVertices({
           id: element.id,
           input_value,
           files,
+          runId,
           onBuildUpdate: (data: VertexBuildTypeAPI, status: BuildStatus) => {
             if (onBuildUpdate) onBuildUpdate(data, status, runId);
           },
@@ -256,6 +257,7 @@ async function buildVertex({
   id,
   input_value,
   files,
+  runId,
   onBuildUpdate,
   onBuildError,
   verticesIds,
@@ -266,6 +268,7 @@ async function buildVertex({
   id: string;
   input_value: string;
   files?: string[];
+  runId?: string;
   onBuildUpdate?: (data: any, status: BuildStatus) => void;
   onBuildError?: (title, list, idList: VertexLayerElementType[]) => void;
   verticesIds: string[];
@@ -273,7 +276,13 @@ async function buildVertex({
   stopBuild: () => void;
 }) {
   try {
-    const buildRes = await postBuildVertex(flowId, id, input_value, files);
+    const buildRes = await postBuildVertex(
+      flowId,
+      id,
+      input_value,
+      files,
+      runId,
+    );
 
     const buildData: VertexBuildTypeAPI = buildRes.data;
     if (onBuildUpdate) {
@@ -0,0 +1,75 @@
+import copy
+import json
+from pathlib import Path
+
+import pytest
+
+DAG_SIZES = [10, 100, 1000]
+DAG_FAN_OUTS = [1, 4]
+DAG_WIDTH = 8
+
+
+def get_component_node() -> dict:
+    """The custom component of the webhook test flow, copied into every vertex of the synthetic flows."""
+    path = Path(__file__).parent.parent / "data" / "WebhookTest.json"
+    data = json.loads(path.read_text())["data"]
+    return next(node for node in data["nodes"] if node["data"]["type"] == "CustomComponent")
+
+
+def make_dag_payload(size: int, fan_out: int, width: int = DAG_WIDTH) -> dict:
+    """
+    Builds a flow of `size` components in layers of `width`, each connected to `fan_out` components
+    of the next layer. The same size and fan-out always give the same flow.
+    """
+    template = get_component_node()
+    nodes = []
+    for index in range(size):
+        node = copy.deepcopy(template)
+        node["id"] = node["data"]["id"] = f"CustomComponent-{index}"
+        nodes.append(node)
+    edges = []
+    for index in range(size - width):
+        layer_start = (index // width + 1) * width
+        targets = {layer_start + (index + offset) % width for offset in range(min(fan_out, width))}
+        for target in sorted(target for target in targets if target < size):
+            source_handle = {
+                "dataType": "CustomComponent",
+                "id": f"CustomComponent-{index}",
+                "name": "output",
+                "output_types": ["Data"],
+            }
+            target_handle = {
+                "fieldName": "input_value",
+                "id": f"CustomComponent-{target}",
+                "inputTypes": ["Data"],
+                "type": "str",
+            }
+            edges.append(
+                {
+                    "id": f"edge-{index}-{target}",
+                    "source": f"CustomComponent-{index}",
+                    "target": f"CustomComponent-{target}",
+                    "data": {"sourceHandle": source_handle, "targetHandle": target_handle},
+                }
+            )
+    return {"nodes": nodes, "edges": edges}
+
+
+@pytest.fixture
+def make_dag():
+    return make_dag_payload
+
+
+@pytest.fixture(params=DAG_SIZES, ids=lambda size: f"{size}v")
+def dag_size(request):
+    return request.param
+
+
+@pytest.fixture(params=DAG_FAN_OUTS, ids=lambda fan_out: f"fanout{fan_out}")
+def dag_fan_out(request):
+    return request.param
+
+
+@pytest.fixture
+def dag_payload(dag_size, dag_fan_out):
+    return make_dag_payload(dag_size, dag_fan_out)
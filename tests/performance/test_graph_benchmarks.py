@@ -0,0 +1,57 @@
+import asyncio
+
+import pytest
+
+from langflow.graph.graph.base import Graph
+from langflow.services.deps import get_chat_service, get_settings_service
+
+pytestmark = pytest.mark.noclient
+
+ROUNDS = 5
+
+
+def test_graph_from_payload(benchmark, dag_payload):
+    graph = benchmark(Graph.from_payload, dag_payload)
+    assert len(graph.vertices) == len(dag_payload["nodes"])
+
+
+def test_layered_topological_sort(benchmark, dag_payload):
+    graph = Graph.from_payload(dag_payload)
+    layers = benchmark(graph.layered_topological_sort, graph.vertices)
+    assert sum(len(layer) for layer in layers) == len(graph.vertices)
+
+
+def test_sort_vertices(benchmark, dag_payload):
+    # Sorting changes the run state of the graph, so every round sorts a new one
+    benchmark.pedantic(
+        lambda graph: graph.sort_vertices(),
+        setup=lambda: ((Graph.from_payload(dag_payload),), {}),
+        rounds=ROUNDS,
+    )
+
+
+@pytest.mark.parametrize("scheduler", ["layered", "ready_queue"])
+def test_graph_process(benchmark, dag_payload, scheduler, monkeypatch):
+    """The overhead of scheduling a run: the components are not built, only marked as built."""
+    monkeypatch.setattr(get_settings_service().settings, "graph_scheduler", scheduler)
+    loop = asyncio.new_event_loop()
+
+    def process(graph: Graph):
+        async def build_vertex(chat_service, vertex_id, **kwargs):
+            vertex = graph.get_vertex(vertex_id)
+            vertex._built = True
+            return None, "", True, {}, vertex
+
+        async def run():
+            first_layer = graph.sort_vertices()
+            graph.set_run_id()
+            await graph._process(first_layer, get_chat_service(), asyncio.Lock(), False, build_vertex)
+
+        loop.run_until_complete(run())
+        return graph
+
+    try:
+        graph = benchmark.pedantic(process, setup=lambda: ((Graph.from_payload(dag_payload),), {}), rounds=ROUNDS)
+    finally:
+        loop.close()
+    assert all(vertex._built for vertex in graph.vertices)
@@ -0,0 +1,76 @@
+import asyncio
+import os
+from types import SimpleNamespace
+
+import pytest
+
+from langflow.graph.graph.base import Graph
+from langflow.services.cache.service import AsyncInMemoryCache
+from langflow.services.chat.service import ChatService
+from langflow.services.session.utils import compute_dict_hash
+
+pytestmark = pytest.mark.noclient
+
+# The redis benchmarks only run when a server is given, e.g. redis://localhost:6379/15
+REDIS_URL = os.getenv("LANGFLOW_BENCHMARK_REDIS_URL")
+
+
+def make_cache_backend(backend: str):
+    if backend == "memory":
+        return AsyncInMemoryCache()
+    if not REDIS_URL:
+        pytest.skip("LANGFLOW_BENCHMARK_REDIS_URL is not set")
+    from langflow.services.cache.service import RedisCache
+
+    cache = RedisCache(url=REDIS_URL)
+    if not cache.is_connected():
+        pytest.skip(f"Could not connect to {REDIS_URL}")
+    return cache
+
+
+@pytest.mark.parametrize("backend", ["memory", "redis"])
+@pytest.mark.parametrize("size", [10, 100])
+def test_chat_service_cache(benchmark, backend, size, make_dag):
+    chat_service = ChatService()
+    chat_service.cache_service = make_cache_backend(backend)
+    graph = Graph.from_payload(make_dag(size, fan_out=4))
+    graph.set_run_id()
+    loop = asyncio.new_event_loop()
+
+    def set_and_get():
+        async def run():
+            await chat_service.set_cache("benchmark", graph)
+            return await chat_service.get_cache("benchmark")
+
+        return loop.run_until_complete(run())
+
+    try:
+        cached = benchmark(set_and_get)
+    finally:
+        loop.run_until_complete(chat_service.clear_cache("benchmark"))
+        loop.close()
+    assert cached["result"] is not None
+
+
+def test_compute_dict_hash(benchmark, dag_payload):
+    assert len(benchmark(compute_dict_hash, dag_payload)) == 64
+
+
+@pytest.mark.parametrize("batch_writes", [False, True])
+def test_monitor_add_row(benchmark, batch_writes, tmp_path, monkeypatch):
+    from langflow.services.monitor import service as monitor_service_module
+
+    monkeypatch.setattr(monitor_service_module, "user_cache_dir", lambda _: str(tmp_path))
+    settings = SimpleNamespace(
+        monitor_batch_writes=batch_writes,
+        monitor_batch_size=100,
+        monitor_flush_interval=1.0,
+        monitor_queue_size=100_000,
+        monitor_overflow_policy="drop_oldest",
+    )
+    monitor_service = monitor_service_module.MonitorService(SimpleNamespace(settings=settings))
+    row = {"vertex_id": "vertex", "inputs": {"input_value": "hello"}, "status": "success", "flow_id": "flow"}
+    try:
+        benchmark(monitor_service.add_row, "transactions", row)
+    finally:
+        monitor_service.teardown()
@@ -1,3 +1,5 @@
+import asyncio
+import json
 import time
 from uuid import UUID, uuid4
 
@@ -5,8 +7,9 @@ import pytest
 from fastapi import status
 from fastapi.testclient import TestClient
 
+from langflow.api.utils import get_last_run_id, get_run_cache_key
 from langflow.custom.directory_reader.directory_reader import DirectoryReader
-from langflow.services.deps import get_settings_service
+from langflow.services.deps import get_chat_service, get_settings_service
 
 
 def run_post(client, flow_id, headers, post_data):
@@ -414,6 +417,27 @@ def test_get_vertices(client, added_flow_with_prompt_and_history, logged_in_head
     ]
 
 
+def test_get_vertices_caches_the_graph_under_its_run(client, added_flow_with_prompt_and_history, logged_in_headers):
+    flow_id = added_flow_with_prompt_and_history["id"]
+    response = client.post(f"/api/v1/build/{flow_id}/vertices", headers=logged_in_headers)
+    assert response.status_code == 200
+    run_id = response.json()["run_id"]
+    chat_service = get_chat_service()
+
+    async def read_cache():
+        return (
+            await chat_service.get_cache(flow_id),
+            await chat_service.get_cache(get_run_cache_key(flow_id, run_id)),
+            await get_last_run_id(flow_id, chat_service),
+        )
+
+    flow_entry, run_entry, last_run_id = asyncio.run(read_cache())
+    # The graph is only cached under its run, the flow points to it
+    assert not flow_entry
+    assert run_entry["result"].run_id == run_id
+    assert last_run_id == run_id
+
+
 def test_build_vertex_invalid_flow_id(client, logged_in_headers):
     uuid = uuid4()
     response = client.post(f"/api/v1/build/{uuid}/vertices/vertex_id", headers=logged_in_headers)
@@ -650,3 +674,61 @@ def test_invalid_flow_id(client, created_api_key):
     response = client.post(f"/api/v1/run/{flow_id}", headers=headers)
     assert response.status_code == status.HTTP_404_NOT_FOUND, response.text
     # Check if the error detail is as expected
+
+
+def parse_sse_events(text):
+    events = []
+    for block in text.strip().split("\n\n"):
+        lines = dict(line.split(": ", 1) for line in block.splitlines())
+        events.append((lines["event"], json.loads(lines["data"])))
+    return events
+
+
+def test_successful_run_with_stream(client, starter_project, created_api_key):
+    headers = {"x-api-key": created_api_key.api_key}
+    flow_id = starter_project["id"]
+    payload = {"input_type": "chat", "output_type": "chat", "input_value": "value1"}
+    response = client.post(f"/api/v1/run/{flow_id}?stream=true", headers=headers, json=payload)
+    assert response.status_code == status.HTTP_200_OK, response.text
+    assert response.headers["content-type"].startswith("text/event-stream")
+    events = parse_sse_events(response.text)
+    assert all(event == "token" for event, _ in events[:-1])
+    event, data = events[-1]
+    assert event == "end", data
+    assert "session_id" in data
+    assert len(data["outputs"]) == 1
+
+
+def test_streamed_run_is_rejected_before_the_stream_starts(client, starter_project, created_api_key, monkeypatch):
+    from langflow.api.v1 import endpoints
+    from langflow.services.task.admission import ExecutionScheduler, Priority
+
+    scheduler = ExecutionScheduler(max_concurrency=1, queue_timeout=0.01)
+    monkeypatch.setattr(endpoints, "get_execution_scheduler", lambda: scheduler)
+    running = scheduler.admit(Priority.API)
+    headers = {"x-api-key": created_api_key.api_key}
+    response = client.post(f"/api/v1/run/{starter_project['id']}?stream=true", headers=headers)
+    assert response.status_code == status.HTTP_429_TOO_MANY_REQUESTS, response.text
+    running.release()
+    assert scheduler.running == 0
+    assert scheduler.queued == 0
+
+
+def test_batch_run_builds_a_failed_shared_setup_once(client, starter_project, created_api_key, monkeypatch):
+    from langflow.api.v1 import endpoints
+
+    calls = []
+
+    async def build_graph_from_flow_plan(*args, **kwargs):
+        calls.append(kwargs)
+        raise ValueError("The setup failed")
+
+    monkeypatch.setattr(endpoints, "build_graph_from_flow_plan", build_graph_from_flow_plan)
+    headers = {"x-api-key": created_api_key.api_key}
+    payload = {"inputs": [{"input_value": str(index)} for index in range(3)], "share_setup": True}
+    response = client.post(f"/api/v1/run/{starter_project['id']}/batch", headers=headers, json=payload)
+    assert response.status_code == status.HTTP_200_OK, response.text
+    results = response.json()["results"]
+    assert [result["error"] for result in results] == ["The setup failed"] * 3
+    # The other inputs get the error of the first setup instead of building it again
+    assert len(calls) == 1
@@ -0,0 +1,96 @@
+import asyncio
+
+import pytest
+
+from langflow.services.task.admission import AdmissionRejectedException, ExecutionScheduler, Priority
+
+
+@pytest.mark.asyncio
+async def test_admission_caps_and_priorities():
+    scheduler = ExecutionScheduler(max_concurrency=1, max_queue_size=2)
+    order = []
+
+    async def run(name, priority):
+        async with scheduler.admit(priority, user_id=name):
+            order.append(name)
+            await asyncio.sleep(0.01)
+
+    running = scheduler.admit(Priority.API, user_id="first")
+    async with running:
+        background = asyncio.create_task(run("background", Priority.BACKGROUND))
+        interactive = asyncio.create_task(run("interactive", Priority.INTERACTIVE))
+        await asyncio.sleep(0)
+        assert scheduler.running == 1
+        assert scheduler.queued == 2
+        # The queue is full
+        with pytest.raises(AdmissionRejectedException):
+            scheduler.admit(Priority.API)
+    await asyncio.gather(background, interactive)
+
+    # The playground goes before the background execution that was queued first
+    assert order == ["interactive", "background"]
+    assert scheduler.running == 0
+    assert scheduler.queued == 0
+
+
+@pytest.mark.asyncio
+async def test_admission_per_user_cap_does_not_block_others():
+    scheduler = ExecutionScheduler(max_concurrency=4, max_per_user=1)
+    async with scheduler.admit(Priority.API, user_id="busy"):
+        waiting = scheduler.admit(Priority.API, user_id="busy")
+        assert not waiting.granted
+        # Another user gets a slot even though an execution is queued ahead of it
+        async with scheduler.admit(Priority.API, user_id="other") as other:
+            assert other.granted
+    async with waiting:
+        assert waiting.granted
+    assert scheduler.running == 0
+
+
+@pytest.mark.asyncio
+async def test_admission_times_out():
+    scheduler = ExecutionScheduler(max_concurrency=1, queue_timeout=0.01)
+    async with scheduler.admit(Priority.API):
+        with pytest.raises(AdmissionRejectedException):
+            async with scheduler.admit(Priority.API):
+                pass
+        assert scheduler.queued == 0
+    assert scheduler.running == 0
+
+
+@pytest.mark.asyncio
+async def test_admission_without_queue_timeout_waits_for_a_slot():
+    scheduler = ExecutionScheduler(max_concurrency=1, queue_timeout=0.01)
+    running = scheduler.admit(Priority.API)
+    await running.__aenter__()
+    waiting = scheduler.admit(Priority.BACKGROUND, queue_timeout=0)
+    entered = asyncio.create_task(waiting.__aenter__())
+    await asyncio.sleep(0.05)
+    assert not entered.done()
+    running.release()
+    running.release()
+    assert await entered is waiting
+    assert scheduler.running == 1
+    waiting.release()
+    assert scheduler.running == 0
+
+
+@pytest.mark.asyncio
+async def test_background_executions_leave_room_in_the_queue():
+    scheduler = ExecutionScheduler(max_concurrency=1, max_queue_size=3, max_background_queue_size=2)
+    async with scheduler.admit(Priority.API):
+        queued = [scheduler.admit(Priority.BACKGROUND, queue_timeout=0) for _ in range(2)]
+        with pytest.raises(AdmissionRejectedException):
+            scheduler.admit(Priority.BACKGROUND, queue_timeout=0)
+        with pytest.raises(AdmissionRejectedException):
+            scheduler.raise_if_full(Priority.BACKGROUND)
+        # The playground can still queue behind the background executions
+        interactive = scheduler.admit(Priority.INTERACTIVE)
+        assert scheduler.queued == 3
+    async with interactive:
+        assert interactive.granted
+    for admission in queued:
+        async with admission:
+            pass
+    assert scheduler.running == 0
+    assert scheduler.queued == 0
@@ -0,0 +1,84 @@
+import hashlib
+from pathlib import Path
+
+import pytest
+
+from langflow.services.storage.blobs import BlobStore
+
+
+def add_file(store: BlobStore, content: bytes, file_path: Path) -> str:
+    file_path.parent.mkdir(parents=True, exist_ok=True)
+    with store.new_temp_file() as f:
+        f.write(content)
+    digest = hashlib.sha256(content).hexdigest()
+    store.add(Path(f.name), digest, file_path)
+    return digest
+
+
+def test_blob_store_deduplicates_and_counts_references(tmp_path):
+    store = BlobStore(tmp_path)
+    first, second = tmp_path / "flow1" / "a.txt", tmp_path / "flow2" / "b.txt"
+    digest = add_file(store, b"same content", first)
+    assert add_file(store, b"same content", second) == digest
+
+    blob_path = store.blob_path(digest)
+    assert first.read_bytes() == second.read_bytes() == b"same content"
+    assert blob_path.stat().st_nlink == 3
+    assert list(store.blobs_dir.glob("*/*")) == [blob_path]
+    assert store.get_blob_digest(first) == digest
+
+    store.set_parsed(digest, "txt", "parsed")
+    assert store.get_parsed(digest, "txt") == "parsed"
+
+    # The blob and its parsed documents go away with the last flow file
+    store.release(first)
+    assert blob_path.exists()
+    store.release(second)
+    assert not blob_path.exists()
+    assert store.get_parsed(digest, "txt") is None
+
+
+def test_blob_store_replaces_files(tmp_path):
+    store = BlobStore(tmp_path)
+    file_path = tmp_path / "flow" / "a.txt"
+    old_digest = add_file(store, b"old", file_path)
+    new_digest = add_file(store, b"new", file_path)
+    assert file_path.read_bytes() == b"new"
+    assert not store.blob_path(old_digest).exists()
+    assert store.blob_path(new_digest).exists()
+
+
+def test_blob_store_links_again_when_another_worker_deletes_the_blob(tmp_path):
+    store = BlobStore(tmp_path)
+    create_blob = store._create_blob
+    created = []
+
+    def create_blob_deleted_by_another_worker(temp_path, blob_path):
+        create_blob(temp_path, blob_path)
+        created.append(blob_path)
+        if len(created) == 1:
+            blob_path.unlink()
+
+    store._create_blob = create_blob_deleted_by_another_worker
+    file_path = tmp_path / "flow" / "a.txt"
+    digest = add_file(store, b"content", file_path)
+    assert len(created) == 2
+    assert file_path.read_bytes() == b"content"
+    assert store.get_blob_digest(file_path) == digest
+    assert not list(store.blobs_dir.glob("*.part"))
+
+
+def test_blob_store_finds_the_blob_to_delete_without_listing_them_after_a_restart(tmp_path, monkeypatch):
+    file_path = tmp_path / "flow" / "a.txt"
+    digest = add_file(BlobStore(tmp_path), b"content", file_path)
+    store = BlobStore(tmp_path)
+    glob = type(store.blobs_dir).glob
+
+    def glob_without_listing_blobs(path, pattern):
+        if path == store.blobs_dir:
+            pytest.fail("The blobs were listed")
+        return glob(path, pattern)
+
+    monkeypatch.setattr(type(store.blobs_dir), "glob", glob_without_listing_blobs)
+    store.release(file_path)
+    assert not store.blob_path(digest).exists()
@@ -45,3 +45,95 @@ async def test_build_graph(client, basic_data_graph):
     assert graph is not None
     assert len(graph.vertices) == len(basic_data_graph["nodes"])
     assert len(graph.edges) == len(basic_data_graph["edges"])
+
+
+def test_memo_index_evicts_least_recently_used():
+    from langflow.graph.vertex.memoization import MemoIndex
+
+    index = MemoIndex()
+    assert index.add("a", 40, max_size=100) == []
+    assert index.add("b", 40, max_size=100) == []
+    assert index.touch("a", ttl=60)
+    # "b" is now the least recently used entry
+    assert index.add("c", 40, max_size=100) == ["b"]
+    assert index.total_size == 80
+    assert not index.touch("b", ttl=60)
+    assert not index.touch("a", ttl=0)
+    assert index.total_size == 40
+
+
+def test_memo_key_depends_on_content(basic_data_graph):
+    from langflow.graph.vertex.memoization import build_memo_key
+
+    graph = Graph.from_payload(basic_data_graph)
+    other_graph = Graph.from_payload(basic_data_graph)
+    vertex = next(vertex for vertex in graph.vertices if not vertex.predecessors)
+    other_vertex = other_graph.get_vertex(vertex.id)
+
+    key = build_memo_key(vertex)
+    assert key is not None
+    assert key == build_memo_key(other_vertex)
+    assert key != build_memo_key(vertex, user_id="another-user")
+
+    param = next(key for key, value in other_vertex.params.items() if isinstance(value, str) and key != "code")
+    other_vertex.params[param] += " changed"
+    assert key != build_memo_key(other_vertex)
+
+
+def test_in_memory_cache_respects_memory_budget():
+    from langflow.services.cache.service import ThreadingInMemoryCache
+    from langflow.services.cache.utils import estimate_size
+
+    item_size = estimate_size("x" * 1000)
+    cache = ThreadingInMemoryCache(max_memory=item_size * 2 + 10)
+    cache.set("a", "x" * 1000)
+    cache.set("b", "y" * 1000)
+    assert cache.get("a") is not None
+    # "b" is now the least recently used entry
+    cache.set("c", "z" * 1000)
+    assert "b" not in cache
+    assert cache.get("missing") is None
+
+    stats = cache.get_stats()
+    assert stats["entries"] == 2
+    assert stats["size_bytes"] == item_size * 2
+    assert stats["evictions"] == 1
+    assert stats["hits"] == 1
+    assert stats["misses"] == 1
+    cache.delete("a")
+    assert cache.get_stats()["size_bytes"] == item_size
+
+
+@pytest.mark.asyncio
+async def test_async_in_memory_cache_evicts_least_frequently_used():
+    from langflow.services.cache.service import AsyncInMemoryCache
+
+    cache = AsyncInMemoryCache(max_size=2, eviction_policy="lfu")
+    await cache.set("a", 1)
+    await cache.set("b", 2)
+    await cache.get("a")
+    await cache.get("a")
+    await cache.get("b")
+    await cache.set("c", 3)
+    assert "b" not in cache
+    assert await cache.get("a") == 1
+    assert cache.get_stats()["evictions"] == 1
+
+
+def test_lookup_cache_invalidates_by_value():
+    from uuid import uuid4
+
+    from langflow.services.cache.lookups import FlowRef, LookupCache, build_flow_ref_cache_key
+
+    cache = LookupCache(ttl=60, max_size=10)
+    flow_ref = FlowRef(id=uuid4(), name="flow", user_id=None, endpoint_name="my-flow", updated_at=None)
+    other_ref = FlowRef(id=uuid4(), name="other", user_id=None, endpoint_name=None, updated_at=None)
+    cache.set(build_flow_ref_cache_key(str(flow_ref.id)), flow_ref)
+    cache.set(build_flow_ref_cache_key("my-flow"), flow_ref)
+    cache.set(build_flow_ref_cache_key(str(other_ref.id)), other_ref)
+
+    # Every name of the flow is dropped with it
+    cache.invalidate(lambda value: value.id == flow_ref.id)
+    assert cache.get(build_flow_ref_cache_key("my-flow")) is None
+    assert cache.get(build_flow_ref_cache_key(str(flow_ref.id))) is None
+    assert cache.get(build_flow_ref_cache_key(str(other_ref.id))) is other_ref
@@ -526,3 +526,126 @@ def test_build_config_field_value_keys(component):
 def test_custom_component_multiple_outputs(code_component_with_multiple_outputs, active_user):
     frontnd_node_dict, _ = build_custom_component_template(code_component_with_multiple_outputs, active_user.id)
     assert frontnd_node_dict["outputs"][0]["types"] == ["Text"]
+
+
+def test_component_registry_snapshot_rebuilds_only_changed_files(tmp_path):
+    import os
+
+    from langflow.custom.directory_reader.snapshot import ComponentRegistrySnapshot
+
+    first_file = tmp_path / "category" / "first.py"
+    second_file = tmp_path / "category" / "second.py"
+    first_file.parent.mkdir()
+    first_file.write_text("first = 1")
+    second_file.write_text("second = 2")
+    file_paths = [str(first_file), str(second_file)]
+
+    snapshot = ComponentRegistrySnapshot(tmp_path / "snapshot.json")
+    for file_path in file_paths:
+        name = os.path.basename(file_path).split(".")[0]
+        snapshot.set_components(
+            file_path, [{"menu": "category", "name": name, "template": {"display_name": name}, "valid": True}]
+        )
+    snapshot.save()
+
+    loaded = ComponentRegistrySnapshot.load(tmp_path / "snapshot.json")
+    assert loaded.split_files(file_paths) == (file_paths, [])
+    assert loaded.build_menu(file_paths) == {
+        "category": {"first": {"display_name": "first"}, "second": {"display_name": "second"}}
+    }
+
+    # Touching a file without changing it keeps it, changing its content does not
+    os.utime(first_file, ns=(0, 0))
+    second_file.write_text("second = 3")
+    assert loaded.split_files(file_paths) == ([str(first_file)], [str(second_file)])
+
+
+def test_component_registry_snapshot_does_not_keep_failed_builds(tmp_path, monkeypatch):
+    from langflow.custom.directory_reader import snapshot as snapshot_module
+    from langflow.custom.directory_reader.snapshot import ComponentRegistrySnapshot
+
+    valid_file = tmp_path / "category" / "valid.py"
+    invalid_file = tmp_path / "category" / "invalid.py"
+    valid_file.parent.mkdir()
+    valid_file.write_text("valid = 1")
+    invalid_file.write_text("import missing_dependency")
+    file_paths = [str(valid_file), str(invalid_file)]
+
+    snapshot = ComponentRegistrySnapshot(tmp_path / "snapshot.json")
+    snapshot.set_components(str(valid_file), [{"menu": "category", "name": "valid", "template": {}, "valid": True}])
+    snapshot.set_components(
+        str(invalid_file), [{"menu": "category", "name": "invalid", "template": {"error": "x"}, "valid": False}]
+    )
+    # The failed build is still served by this process
+    assert set(snapshot.build_menu(file_paths)["category"]) == {"valid", "invalid"}
+    snapshot.save()
+
+    # But the next start builds it again, the dependency may have been installed since
+    loaded = ComponentRegistrySnapshot.load(tmp_path / "snapshot.json")
+    assert loaded.split_files(file_paths) == ([str(valid_file)], [str(invalid_file)])
+
+    # Installing or upgrading a distribution discards the whole snapshot
+    monkeypatch.setattr(snapshot_module, "get_distributions_fingerprint", lambda: "other")
+    loaded = ComponentRegistrySnapshot.load(tmp_path / "snapshot.json")
+    assert loaded.split_files(file_paths) == ([], file_paths)
+
+
+def test_eval_custom_component_code_reuses_classes():
+    from langflow.custom.eval import eval_custom_component_code
+
+    with open("tests/data/component_multiple_outputs.py", "r") as f:
+        code = f.read()
+
+    component_class = eval_custom_component_code(code)
+    assert eval_custom_component_code(code) is component_class
+    assert eval_custom_component_code(code + "\n") is not component_class
+
+    # Instances of the shared class do not share their input values
+    first, second = component_class(), component_class()
+    first._inputs["number"].value = 42
+    assert second._inputs["number"].value != 42
+    first._inputs["input"].input_types.append("Data")
+    assert "Data" not in second._inputs["input"].input_types
+
+
+@pytest.mark.asyncio
+async def test_run_sync_method_by_execution_class():
+    import threading
+
+    from langflow.custom.custom_component.execution import get_execution_class, run_sync_method
+
+    class ThreadComponent(CustomComponent):
+        execution_class = "thread"
+
+        def build(self, value: int):
+            return value, threading.current_thread()
+
+    class InlineComponent(ThreadComponent):
+        execution_class = None
+
+    component = ThreadComponent()
+    assert get_execution_class(component) == "thread"
+    result, thread = await run_sync_method(component, "build", value=1)
+    assert result == 1 and thread is not threading.current_thread()
+
+    inline = InlineComponent()
+    assert get_execution_class(inline) == "asyncio"
+    result, thread = await run_sync_method(inline, "build", value=2)
+    assert result == 2 and thread is threading.current_thread()
+
+
+def test_lazy_imports_are_eager_without_a_thread_safe_loader(tmp_path, monkeypatch):
+    import sys
+
+    from langflow.utils import validate
+
+    (tmp_path / "lazy_probe_module.py").write_text("VALUE = 1\n")
+    monkeypatch.syspath_prepend(str(tmp_path))
+    monkeypatch.setattr(validate, "LAZY_IMPORTS_ARE_THREAD_SAFE", False)
+    try:
+        module = validate.lazy_import_module("lazy_probe_module")
+        # Imported right away, the component threads never run the import of a lazy module at once
+        assert type(module).__name__ == "module"
+        assert module.VALUE == 1
+    finally:
+        sys.modules.pop("lazy_probe_module", None)
@@ -3,13 +3,15 @@ from uuid import UUID, uuid4
 import orjson
 import pytest
 from fastapi.testclient import TestClient
-from sqlmodel import Session
+from sqlmodel import Session, create_engine, select
 
 from langflow.api.v1.schemas import FlowListCreate
 from langflow.initial_setup.setup import load_starter_projects, load_flows_from_directory
+from langflow.services.cache.lookups import FlowRef, build_flow_ref_cache_key, get_flow_ref_cache
 from langflow.services.database.models.base import orjson_dumps
 from langflow.services.database.models.flow import Flow, FlowCreate, FlowUpdate
-from langflow.services.database.utils import session_getter
+from langflow.services.database.service import ThreadedAsyncSession
+from langflow.services.database.utils import get_async_database_url, session_getter
 from langflow.services.deps import get_db_service
 
 
@@ -99,6 +101,66 @@ def test_update_flow(client: TestClient, json_flow: str, active_user, logged_in_
     # assert response.json()["data"] == updated_flow.data
 
 
+def test_update_flow_invalidates_cached_lookups(client: TestClient, json_flow: str, active_user, logged_in_headers):
+    data = orjson.loads(json_flow)["data"]
+    flow = FlowCreate(name=str(uuid4()), description="description", data=data, endpoint_name=f"flow-{uuid4()}")
+    response = client.post("api/v1/flows/", json=flow.model_dump(), headers=logged_in_headers)
+    assert response.status_code == 201
+    created = response.json()
+
+    cache = get_flow_ref_cache()
+    assert cache is not None
+    cache_key = build_flow_ref_cache_key(created["id"])
+    cache.set(
+        cache_key,
+        FlowRef(
+            id=UUID(created["id"]),
+            name=created["name"],
+            user_id=UUID(created["user_id"]),
+            endpoint_name=created["endpoint_name"],
+            updated_at=None,
+        ),
+    )
+
+    response = client.patch(
+        f"api/v1/flows/{created['id']}", json={"endpoint_name": f"renamed-{uuid4()}"}, headers=logged_in_headers
+    )
+    assert response.status_code == 200
+    # The next run reads the new endpoint name and version from the database
+    assert cache.get(cache_key) is None
+
+
+def test_delete_folder_invalidates_cached_lookups(client: TestClient, json_flow: str, active_user, logged_in_headers):
+    response = client.post("api/v1/folders/", json={"name": f"folder-{uuid4()}"}, headers=logged_in_headers)
+    assert response.status_code == 201
+    folder_id = response.json()["id"]
+    data = orjson.loads(json_flow)["data"]
+    flow = FlowCreate(name=str(uuid4()), description="description", data=data, folder_id=folder_id)
+    response = client.post("api/v1/flows/", json=flow.model_dump(mode="json"), headers=logged_in_headers)
+    assert response.status_code == 201
+    created = response.json()
+
+    cache = get_flow_ref_cache()
+    assert cache is not None
+    cache_key = build_flow_ref_cache_key(created["id"])
+    cache.set(
+        cache_key,
+        FlowRef(
+            id=UUID(created["id"]),
+            name=created["name"],
+            user_id=UUID(created["user_id"]),
+            endpoint_name=None,
+            updated_at=None,
+        ),
+    )
+
+    response = client.delete(f"api/v1/folders/{folder_id}", headers=logged_in_headers)
+    assert response.status_code == 204
+    # The flows of the folder are deleted with it, their runs must not find them in the cache
+    assert cache.get(cache_key) is None
+    assert client.get(f"api/v1/flows/{created['id']}", headers=logged_in_headers).status_code == 404
+
+
 def test_delete_flow(client: TestClient, json_flow: str, active_user, logged_in_headers):
     flow = orjson.loads(json_flow)
     data = flow["data"]
@@ -279,3 +341,31 @@ def test_load_flows(client: TestClient, load_flows_dir):
     response = client.get("api/v1/flows/c54f9130-f2fa-4a3e-b22a-3856d946351b")
     assert response.status_code == 200
     assert response.json()["name"] == "BasicExample"
+
+
+def test_async_database_url():
+    assert get_async_database_url("sqlite:///./langflow.db") == "sqlite+aiosqlite:///./langflow.db"
+    assert get_async_database_url("postgres://u:p@h/db") == "postgresql+psycopg://u:p@h/db"
+    assert get_async_database_url("postgresql+psycopg2://u:p@h/db") == "postgresql+psycopg://u:p@h/db"
+    # Async drivers are kept
+    assert get_async_database_url("postgresql+asyncpg://u:p@h/db") == "postgresql+asyncpg://u:p@h/db"
+
+
+@pytest.mark.asyncio
+async def test_threaded_async_session():
+    # Used when the async driver of the database is not installed
+    engine = create_engine("sqlite://", connect_args={"check_same_thread": False})
+    Flow.metadata.create_all(engine)
+    async with ThreadedAsyncSession(engine) as session:
+        session.add(Flow(name="threaded", data={}))
+        await session.commit()
+        flows = (await session.exec(select(Flow).where(Flow.name == "threaded"))).all()
+    assert [flow.name for flow in flows] == ["threaded"]
+
+
+def test_sqlite_connections_wait_for_each_other(tmp_path):
+    # The sync and the async engines open the same file, their connections get the same pragmas
+    engine = create_engine(f"sqlite:///{tmp_path / 'langflow.db'}")
+    with engine.connect() as connection:
+        assert connection.exec_driver_sql("PRAGMA journal_mode").scalar() == "wal"
+        assert connection.exec_driver_sql("PRAGMA busy_timeout").scalar() > 0
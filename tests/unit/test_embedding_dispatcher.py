@@ -0,0 +1,106 @@
+from typing import List
+
+import pytest
+from langchain_core.embeddings import Embeddings
+
+from langflow.base.embeddings.dispatcher import DispatchedEmbeddings, EmbeddingCache, EmbeddingDispatcher
+
+
+class FakeEmbeddings(Embeddings):
+    model = "fake-model"
+
+    def __init__(self, fail_times: int = 0):
+        self.calls: List[List[str]] = []
+        self.fail_times = fail_times
+
+    def embed_documents(self, texts: List[str]) -> List[List[float]]:
+        if self.fail_times:
+            self.fail_times -= 1
+            raise RuntimeError("429 Too Many Requests")
+        self.calls.append(texts)
+        return [[float(len(text))] for text in texts]
+
+    def embed_query(self, text: str) -> List[float]:
+        return self.embed_documents([text])[0]
+
+
+@pytest.fixture
+def dispatcher(monkeypatch):
+    dispatcher = EmbeddingDispatcher(batch_size=2, max_batch_tokens=1000, max_concurrency=2, max_retries=2)
+    monkeypatch.setattr("langflow.base.embeddings.dispatcher.get_embedding_dispatcher", lambda: dispatcher)
+    monkeypatch.setattr("langflow.base.embeddings.dispatcher.time.sleep", lambda _: None)
+    return dispatcher
+
+
+def test_dispatcher_batches_and_caches(dispatcher):
+    client = FakeEmbeddings()
+    embeddings = DispatchedEmbeddings(client)
+    assert embeddings.model == "fake-model"
+
+    texts = ["a", "bb", "ccc", "a", "dddd"]
+    assert embeddings.embed_documents(texts) == [[1.0], [2.0], [3.0], [1.0], [4.0]]
+    # Repeated texts are sent once, in batches of at most two
+    assert sorted(text for call in client.calls for text in call) == ["a", "bb", "ccc", "dddd"]
+    assert all(len(call) <= 2 for call in client.calls)
+
+    client.calls.clear()
+    assert embeddings.embed_documents(["bb", "eeeee"]) == [[2.0], [5.0]]
+    assert client.calls == [["eeeee"]]
+
+
+def test_dispatcher_token_budget_and_backoff(dispatcher):
+    dispatcher.max_batch_tokens = 10
+    assert dispatcher.make_batches(["x" * 40, "y", "z"]) == [[0], [1, 2]]
+
+    client = FakeEmbeddings(fail_times=2)
+    assert DispatchedEmbeddings(client).embed_documents(["retry"]) == [[5.0]]
+
+    client = FakeEmbeddings(fail_times=3)
+    with pytest.raises(RuntimeError):
+        DispatchedEmbeddings(client).embed_documents(["gives up"])
+
+
+def test_cache_key_includes_the_settings_of_the_client():
+    def make_client(**settings):
+        client = FakeEmbeddings()
+        client.__dict__.update(settings)
+        return DispatchedEmbeddings(client).model_key
+
+    base = make_client(base_url="http://a", model_kwargs={"dimensions": 256}, api_key="one")
+    assert make_client(base_url="http://a", model_kwargs={"dimensions": 256}, api_key="one") == base
+    assert make_client(base_url="http://a", model_kwargs={"dimensions": 256}, api_key="two") != base
+    assert make_client(base_url="http://b", model_kwargs={"dimensions": 256}, api_key="one") != base
+    assert make_client(base_url="http://a", model_kwargs={"dimensions": 512}, api_key="one") != base
+    # Provider clients are left out, their repr changes with every instance
+    assert make_client(base_url="http://a", model_kwargs={"dimensions": 256}, api_key="one", client=object()) == base
+
+
+def test_cache_is_bounded_by_bytes():
+    cache = EmbeddingCache(max_bytes=200)
+    cache.set("a", [0.1] * 10)
+    cache.set("b", [0.2] * 10)
+    assert cache.get("a") == [0.1] * 10
+    # 8 bytes per dimension, the least recently used vector is evicted
+    cache.set("c", [0.3] * 10)
+    assert cache.get("b") is None
+    assert cache.get("a") == [0.1] * 10
+    assert cache.size_bytes <= 200
+    # A vector larger than the cache is not kept
+    cache.set("d", [0.4] * 100)
+    assert cache.get("d") is None
+
+
+def test_dispatched_embeddings_turn_off_the_retries_of_the_client():
+    class SDKClient:
+        max_retries = 2
+
+    client = FakeEmbeddings()
+    client.max_retries = 3
+    client.client = SDKClient()
+    embeddings = DispatchedEmbeddings(client)
+    assert client.max_retries == 0
+    assert client.client.max_retries == 0
+    # Private names are not read from the client
+    client._private = "value"
+    with pytest.raises(AttributeError):
+        embeddings._private
@@ -13,6 +13,13 @@ def mock_storage_service():
     # Setup mock behaviors for the service methods as needed
     service.save_file.return_value = None
     service.get_file.return_value = b"file content"  # Binary content for files
+    service.get_file_size.return_value = len(b"file content")
+    service.get_local_path.return_value = None
+
+    async def iter_file(*args, **kwargs):
+        yield b"file content"
+
+    service.iter_file.side_effect = iter_file
     service.list_files.return_value = ["file1.txt", "file2.jpg"]
     service.delete_file.return_value = None
     return service
@@ -102,3 +109,32 @@ def test_file_operations(client, created_api_key, flow):
     # Verify that the file is indeed deleted
     response = client.get(f"api/v1/files/list/{flow_id}", headers=headers)
     assert file_name not in response.json()["files"]
+
+
+def test_download_file_range(client, created_api_key, flow):
+    headers = {"x-api-key": created_api_key.api_key}
+    file_content = b"0123456789"
+    response = client.post(
+        f"api/v1/files/upload/{flow.id}",
+        files={"file": ("range.txt", file_content)},
+        headers=headers,
+    )
+    assert response.status_code == 201
+
+    response = client.get(f"api/v1/files/download/{flow.id}/range.txt", headers={**headers, "Range": "bytes=2-5"})
+    assert response.status_code == 206
+    assert response.content == b"2345"
+    assert response.headers["content-range"] == "bytes 2-5/10"
+
+    response = client.get(f"api/v1/files/download/{flow.id}/range.txt", headers={**headers, "Range": "bytes=-3"})
+    assert response.content == b"789"
+
+    response = client.get(f"api/v1/files/download/{flow.id}/range.txt", headers={**headers, "Range": "bytes=20-"})
+    assert response.status_code == 416
+
+    # Several ranges and invalid ranges are ignored, the whole file is sent
+    for range_header in ["bytes=0-1,4-5", "bytes=5-2", "items=0-1"]:
+        response = client.get(f"api/v1/files/download/{flow.id}/range.txt", headers={**headers, "Range": range_header})
+        assert response.status_code == 200
+        assert response.content == file_content
+        assert "content-range" not in response.headers
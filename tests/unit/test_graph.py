@@ -1,12 +1,17 @@
+import asyncio
 import copy
+import gc
 import json
 import pickle
+from types import SimpleNamespace
 from typing import Type, Union
 
 import pytest
 
 from langflow.graph import Graph
 from langflow.graph.edge.base import Edge
+from langflow.graph.graph.cancellation import CancellationToken, RunCancelledException
+from langflow.graph.graph.profiling import RunProfile
 from langflow.graph.graph.utils import (
     find_last_node,
     process_flow,
@@ -17,7 +22,9 @@ from langflow.graph.graph.utils import (
     update_template,
 )
 from langflow.graph.vertex.base import Vertex
+from langflow.graph.vertex.utils import can_stop_branches
 from langflow.initial_setup.setup import load_starter_projects
+from langflow.interface.initialize.loading import hash_load_from_db_fields
 from langflow.utils.payload import get_root_vertex
 
 # Test cases for the graph module
@@ -416,3 +423,462 @@ async def test_pickle_graph():
     assert pickled is not None
     unpickled = pickle.loads(pickled)
     assert unpickled is not None
+
+
+@pytest.mark.asyncio
+async def test_process_ready_queue_respects_dependencies(basic_graph, monkeypatch):
+    built_order = []
+
+    async def build_vertex(chat_service, vertex_id, **kwargs):
+        built_order.append(vertex_id)
+        return None, "", True, {}, basic_graph.get_vertex(vertex_id)
+
+    monkeypatch.setattr(basic_graph, "build_vertex", build_vertex)
+    first_layer = basic_graph.sort_vertices()
+    vertices_to_run = set(basic_graph.vertices_to_run)
+    await basic_graph._process_ready_queue(first_layer, chat_service=None, fallback_to_env_vars=False)
+
+    assert set(built_order) == vertices_to_run
+    assert len(built_order) == len(set(built_order))
+    for edge in basic_graph.edges:
+        if edge.source_id in built_order and edge.target_id in built_order:
+            assert built_order.index(edge.source_id) < built_order.index(edge.target_id)
+
+
+def test_graph_from_plan_matches_payload(basic_graph_data):
+    from langflow.graph.graph.plan import FlowPlan
+
+    graph = Graph.from_payload(copy.deepcopy(basic_graph_data))
+    plan = FlowPlan.from_graph(graph)
+    expected_layers = graph.sort_vertices(start_component_id=plan.start_component_id)
+
+    planned_graph = Graph.from_plan(plan)
+    assert repr(planned_graph) == repr(graph)
+    assert planned_graph.predecessor_map == graph.predecessor_map
+    assert planned_graph.predecessor_map is not plan.predecessor_map
+    assert planned_graph.sort_vertices(start_component_id=plan.start_component_id) == expected_layers
+    assert planned_graph.sorted_vertices_layers == graph.sorted_vertices_layers
+
+
+def test_run_state_lives_in_run_context(basic_graph):
+    predecessor_map = {key: list(value) for key, value in basic_graph.predecessor_map.items()}
+    first_layer = basic_graph.sort_vertices()
+    basic_graph.set_run_id()
+    for vertex_id in first_layer:
+        basic_graph.remove_from_predecessors(vertex_id)
+
+    assert basic_graph.vertices_to_run is basic_graph.run_context.vertices_to_run
+    assert basic_graph.run_manager is basic_graph.run_context.run_manager
+    # Running the graph must not consume its topology
+    assert basic_graph.predecessor_map == predecessor_map
+
+    restored = pickle.loads(pickle.dumps(basic_graph))
+    assert restored.run_id == basic_graph.run_id
+    assert restored.vertices_to_run == basic_graph.vertices_to_run
+    assert restored.run_manager.run_predecessors == basic_graph.run_manager.run_predecessors
+    assert restored.run_manager.vertices_to_run is restored.vertices_to_run
+
+
+def test_graph_serialization_round_trip(basic_graph):
+    from langflow.graph.graph.serialization import (
+        RUN_CONTEXT_FIELD,
+        VERTEX_FIELD_PREFIX,
+        deserialize_graph,
+        serialize_graph,
+    )
+
+    first_layer = basic_graph.sort_vertices()
+    basic_graph.set_run_id()
+    for vertex_id in first_layer:
+        basic_graph.remove_from_predecessors(vertex_id)
+
+    fields = serialize_graph(basic_graph, full=True)
+    assert all(isinstance(value, bytes) for value in fields.values())
+    restored = deserialize_graph(fields)
+    assert repr(restored) == repr(basic_graph)
+    assert restored.run_id == basic_graph.run_id
+    assert restored.vertices_to_run == basic_graph.vertices_to_run
+    assert dict(restored.run_manager.run_predecessors) == dict(basic_graph.run_manager.run_predecessors)
+
+    # Only the vertices that changed since the last write are encoded again
+    vertex = basic_graph.vertices[0]
+    vertex.add_build_time(0.1)
+    delta = serialize_graph(basic_graph, full=False)
+    assert set(delta) == {RUN_CONTEXT_FIELD, f"{VERTEX_FIELD_PREFIX}{vertex.id}"}
+    assert serialize_graph(basic_graph, full=False).keys() == {RUN_CONTEXT_FIELD}
+
+
+@pytest.mark.asyncio
+async def test_restored_vertices_without_built_objects_are_only_rebuilt_if_pure(basic_graph):
+    vertex = next(vertex for vertex in basic_graph.vertices if vertex.vertex_type == "OpenAI")
+    requester = basic_graph.vertices[0]
+    vertex._lazy_restore = True
+    vertex._built = False
+
+    # Only the components in `memoizable_components` are known to have no side effects
+    with pytest.raises(ValueError, match="cannot be built again"):
+        await vertex.get_result(requester)
+
+
+def test_encode_value_round_trip():
+    from langflow.graph.graph.serialization import decode_value, encode_value
+    from langflow.schema import Data
+    from langflow.schema.message import Message
+
+    value = {"data": [Data(data={"text": "hello"})], "message": Message(text="hi"), "pair": (1, "a")}
+    decoded = decode_value(encode_value(value))
+    assert decoded["data"][0].data == {"text": "hello"}
+    assert decoded["message"].text == "hi"
+    assert decoded["pair"] == (1, "a")
+    with pytest.raises(TypeError):
+        encode_value(object())
+
+
+def test_input_independent_vertices(basic_graph):
+    independent = basic_graph.get_input_independent_vertices()
+    assert independent
+    for position, vertex_id in enumerate(independent):
+        vertex = basic_graph.get_vertex(vertex_id)
+        assert not vertex.is_input and not vertex.is_interface_component
+        # Predecessors are independent too and come first in the build order
+        for predecessor_id in basic_graph.predecessor_map.get(vertex_id, []):
+            assert predecessor_id in independent[:position]
+
+    other_graph = Graph.from_payload(basic_graph.raw_graph_data)
+    vertex = basic_graph.get_vertex(independent[0])
+    vertex._built = True
+    vertex._built_object = object()
+    other_graph.share_built_vertices(basic_graph, independent)
+    shared_vertex = other_graph.get_vertex(independent[0])
+    assert shared_vertex._shared_build
+    assert shared_vertex._built_object is vertex._built_object
+
+
+def make_topology(edges):
+    from types import SimpleNamespace
+
+    vertex_ids = sorted({vertex_id for edge in edges for vertex_id in edge})
+    predecessor_map = {
+        vertex_id: [source for source, target in edges if target == vertex_id] for vertex_id in vertex_ids
+    }
+    successor_map = {vertex_id: [target for source, target in edges if source == vertex_id] for vertex_id in vertex_ids}
+    return SimpleNamespace(
+        vertex_map=dict.fromkeys(vertex_ids), predecessor_map=predecessor_map, successor_map=successor_map
+    )
+
+
+def test_affinity_groups():
+    from langflow.graph.graph.distributed import get_affinity_groups
+
+    # a -> b -> c is a chain, d merges c and e, and x and y form a loop
+    graph = make_topology([("a", "b"), ("b", "c"), ("c", "d"), ("e", "d"), ("x", "y"), ("y", "x")])
+    assert get_affinity_groups(graph) == {"a": "a", "b": "a", "c": "a", "d": "d", "e": "e", "x": "y", "y": "x"}
+
+
+def test_select_worker():
+    from langflow.graph.graph.distributed import CeleryVertexExecutor
+
+    executor = CeleryVertexExecutor(make_topology([("a", "b"), ("c", "d"), ("e", "d"), ("f", "d")]), None, timeout=1)
+    # Nothing ran yet, any worker takes the vertex
+    assert executor.select_worker("b") is None
+    # The worker of the chain
+    executor._group_workers["a"] = "worker-1"
+    assert executor.select_worker("b") == "worker-1"
+    # The worker that built most of the predecessors, unless one of them is only on its worker
+    executor._locations.update({"c": ("worker-2", True), "e": ("worker-2", True), "f": ("worker-3", True)})
+    assert executor.select_worker("d") == "worker-2"
+    executor._locations["f"] = ("worker-3", False)
+    assert executor.select_worker("d") == "worker-3"
+
+
+class FakeRedisClient:
+    def __init__(self):
+        self.values = {}
+
+    def setex(self, key, expiration_time, value):
+        self.values[key] = value
+
+    def get(self, key):
+        return self.values.get(key)
+
+
+def test_store_and_restore_vertex_results():
+    import threading
+    from types import SimpleNamespace
+
+    from langflow.graph.graph.distributed import restore_vertex_result, store_vertex_result
+    from langflow.graph.vertex.memoization import MEMOIZED_ATTRIBUTES
+
+    cache_service = SimpleNamespace(_client=FakeRedisClient(), expiration_time=60)
+    built = SimpleNamespace(id="v", display_name="V", **dict.fromkeys(MEMOIZED_ATTRIBUTES, None))
+    built._built_object = {"text": "built"}
+    assert store_vertex_result(cache_service, "run", built)
+
+    restored = SimpleNamespace(id="v", display_name="V", _built=False, _lazy_restore=True)
+    assert restore_vertex_result(cache_service, "run", restored)
+    assert restored._built_object == {"text": "built"} and restored._built and not restored._lazy_restore
+    assert not restore_vertex_result(cache_service, "other-run", restored)
+
+    # Results that cannot be pickled are not stored
+    built._built_object = threading.Lock()
+    assert not store_vertex_result(cache_service, "unpicklable", built)
+    assert cache_service._client.values.keys() == {"vertex_result:run:v"}
+
+
+@pytest.mark.asyncio
+async def test_local_results_are_stored_for_the_workers():
+    import threading
+    from types import SimpleNamespace
+
+    from langflow.graph.graph.distributed import CeleryVertexExecutor, restore_predecessors
+    from langflow.graph.vertex.memoization import MEMOIZED_ATTRIBUTES
+
+    def make_graph():
+        graph = make_topology([("chat_input", "llm")])
+        for vertex_id in graph.vertex_map:
+            graph.vertex_map[vertex_id] = SimpleNamespace(
+                id=vertex_id,
+                display_name=vertex_id,
+                graph=graph,
+                is_interface_component=vertex_id == "chat_input",
+                is_state=False,
+                frozen=False,
+                _built=False,
+                _lazy_restore=False,
+                **dict.fromkeys(MEMOIZED_ATTRIBUTES),
+            )
+        graph.get_vertex = graph.vertex_map.__getitem__
+        return graph
+
+    graph = make_graph()
+    graph.run_id = "run"
+    built_locally = []
+
+    async def build_vertex(chat_service, vertex_id, **kwargs):
+        built_locally.append(vertex_id)
+        vertex = graph.get_vertex(vertex_id)
+        vertex._built = True
+        return None, None, True, {}, vertex
+
+    graph.build_vertex = build_vertex
+    cache_service = SimpleNamespace(_client=FakeRedisClient(), expiration_time=60)
+    executor = CeleryVertexExecutor(graph, cache_service, timeout=1)
+    graph.get_vertex("chat_input")._built_object = {"text": "hello"}
+    await executor.build_vertex(None, "chat_input")
+
+    # The worker that builds the LLM rebuilds the graph and reads the chat input from the cache
+    worker_graph = make_graph()
+    restore_predecessors(cache_service, "run", worker_graph.get_vertex("llm"), {"chat_input", "llm"})
+    chat_input = worker_graph.get_vertex("chat_input")
+    assert chat_input._built and not chat_input._lazy_restore
+    assert chat_input._built_object == {"text": "hello"}
+
+    # A local result that cannot be pickled keeps its successors local
+    graph.get_vertex("chat_input")._built_object = threading.Lock()
+    await executor.build_vertex(None, "chat_input")
+    await executor.build_vertex(None, "llm")
+    assert built_locally == ["chat_input", "chat_input", "llm"]
+
+
+def test_summarize_vertex_only_sends_the_states_it_changed():
+    from types import SimpleNamespace
+
+    from langflow.graph.graph.distributed import summarize_vertex
+    from langflow.graph.schema import ResultData
+
+    states = {"a": "ACTIVE", "b": "ACTIVE"}
+    graph = SimpleNamespace(
+        vertices=[SimpleNamespace(id=key, state=SimpleNamespace(name=value)) for key, value in states.items()]
+    )
+    vertex = SimpleNamespace(
+        graph=graph, result=ResultData(results={"out": object()}), _built_object_repr=lambda: "repr"
+    )
+    states_before = {"a": "ACTIVE", "b": "INACTIVE"}
+    summary = summarize_vertex(vertex, True, "worker-1", states_before)
+    assert summary["states"] == {"b": "ACTIVE"}
+    assert summary["params"] == "repr" and summary["worker"] == "worker-1" and summary["by_reference"]
+    # Values without a JSON representation are sent as strings
+    assert isinstance(summary["result"]["results"]["out"], str)
+
+
+class FakeAsyncResult:
+    def __init__(self, ready_after: int):
+        self.checks = 0
+        self.ready_after = ready_after
+        self.revoked = False
+
+    def ready(self):
+        self.checks += 1
+        return self.checks > self.ready_after
+
+    def get(self, propagate=True):
+        return {"result": None}
+
+    def revoke(self, terminate=False):
+        self.revoked = terminate
+
+
+@pytest.mark.asyncio
+async def test_wait_for_task_polls_and_revokes():
+    from types import SimpleNamespace
+
+    from langflow.graph.graph.distributed import CeleryVertexExecutor
+
+    vertex = SimpleNamespace(display_name="V")
+    executor = CeleryVertexExecutor(make_topology([]), None, timeout=5)
+    async_result = FakeAsyncResult(ready_after=2)
+    assert await executor.wait_for_task(async_result, vertex) == {"result": None}
+    assert async_result.checks == 3 and not async_result.revoked
+
+    executor.timeout = 0
+    async_result = FakeAsyncResult(ready_after=100)
+    with pytest.raises(TimeoutError):
+        await executor.wait_for_task(async_result, vertex)
+    assert async_result.revoked
+
+    # A cancelled run revokes the task instead of waiting for it
+    executor.timeout = 60
+    async_result = FakeAsyncResult(ready_after=10_000)
+    task = asyncio.create_task(executor.wait_for_task(async_result, vertex))
+    await asyncio.sleep(0.1)
+    task.cancel()
+    with pytest.raises(asyncio.CancelledError):
+        await task
+    assert async_result.revoked
+
+
+def test_reuse_unchanged_vertices(basic_graph_data):
+    previous_graph = Graph.from_payload(copy.deepcopy(basic_graph_data))
+    for vertex in previous_graph.vertices:
+        vertex._built = True
+        vertex._built_object = object()
+
+    # Editing the memory only dirties it and the chain it feeds, not the LLM
+    new_data = copy.deepcopy(basic_graph_data)
+    memory_node = next(node for node in new_data["data"]["nodes"] if node["id"] == "dndnode_83")
+    memory_node["data"]["node"]["template"]["memory_key"]["value"] = "chat_history"
+    graph = Graph.from_payload(new_data)
+    assert graph.get_dirty_vertices(previous_graph) == {"dndnode_83", "dndnode_81"}
+
+    assert graph.reuse_unchanged_vertices(previous_graph) == {"dndnode_82"}
+    llm_vertex = graph.get_vertex("dndnode_82")
+    assert llm_vertex._shared_build
+    assert llm_vertex._built_object is previous_graph.get_vertex("dndnode_82")._built_object
+    assert graph.sort_vertices() == ["dndnode_83"]
+    assert graph.vertices_to_run == {"dndnode_83", "dndnode_81"}
+    # The chain only waits for the memory, the LLM is already built
+    assert graph.run_manager.run_predecessors["dndnode_81"] == ["dndnode_83"]
+
+    # Forced vertices are rebuilt even if they did not change
+    assert graph.get_dirty_vertices(previous_graph, force_vertex_ids=["dndnode_82"]) == set(graph.vertex_map)
+
+    # So are the vertices whose global variables have other values than when they were built
+    previous_graph.get_vertex("dndnode_82").variables_hash = hash_load_from_db_fields({"api_key": "old"}, ["api_key"])
+    unchanged = {"dndnode_82": hash_load_from_db_fields({"api_key": "old"}, ["api_key"])}
+    assert graph.get_dirty_vertices(previous_graph, variables_hashes=unchanged) == {"dndnode_83", "dndnode_81"}
+    changed = {"dndnode_82": hash_load_from_db_fields({"api_key": "new"}, ["api_key"])}
+    assert graph.get_dirty_vertices(previous_graph, variables_hashes=changed) == set(graph.vertex_map)
+
+
+def test_branch_feeders_are_pruned(basic_graph):
+    # Pretend the memory routes to the chain, so the LLM only feeds its branch
+    router = basic_graph.get_vertex("dndnode_83")
+    router.can_stop_branches = True
+    assert basic_graph.get_branch_feeders("dndnode_83") == ["dndnode_82"]
+
+    # The LLM waits for the router instead of being built right away
+    assert basic_graph.sort_vertices() == ["dndnode_83"]
+    assert basic_graph.run_manager.run_predecessors["dndnode_82"] == ["dndnode_83"]
+
+    # The router did not take the branch, so the LLM is never built
+    basic_graph.mark_branch("dndnode_81", "INACTIVE")
+    assert basic_graph.prune_branch_feeders("dndnode_83") == ["dndnode_82"]
+    assert basic_graph.get_vertex("dndnode_82").state.name == "INACTIVE"
+    assert "dndnode_82" not in basic_graph.vertices_to_run
+
+
+def test_only_exclusive_branch_feeders_are_gated():
+    # router -a-> A, router -b-> B, both merge into M
+    # fa feeds A, ffa feeds fa, shared feeds A and B, fm feeds M, mixed feeds A and M
+    successor_map = {
+        "router": ["A", "B"],
+        "A": ["M"],
+        "B": ["M"],
+        "fa": ["A"],
+        "ffa": ["fa"],
+        "shared": ["A", "B"],
+        "fm": ["M"],
+        "mixed": ["A", "M"],
+    }
+    handles = {"A": "a", "B": "b"}
+    graph = SimpleNamespace(
+        successor_map=successor_map,
+        vertices=[SimpleNamespace(id=vertex_id) for vertex_id in [*successor_map, "M"]],
+        get_edge=lambda source, target: SimpleNamespace(source_handle=SimpleNamespace(name=handles[target])),
+    )
+    assert Graph.get_branch_feeders(graph, "router") == ["fa", "ffa"]
+
+
+def test_routers_are_detected_from_their_outputs():
+    assert can_stop_branches([{"name": "true_result", "can_stop": True}], None)
+    assert can_stop_branches([{"name": "result"}], "def build(self):\n    self.stop('result')")
+    # Mentioning `stop` does not make a component a router
+    assert not can_stop_branches([{"name": "result"}], "# do not call self.stop() here\nx = 'self.stop('")
+    assert not can_stop_branches([{"name": "result"}], None)
+
+
+@pytest.mark.asyncio
+async def test_execute_tasks_honors_cancellation(basic_graph):
+    vertex = basic_graph.get_vertex("dndnode_82")
+
+    async def build(delay):
+        await asyncio.sleep(delay)
+        return None, None, None, None, vertex
+
+    # At the deadline the builds in flight are cancelled and the run stops with what it built
+    basic_graph.cancellation.set_timeout(0.05)
+    fast, slow = asyncio.create_task(build(0)), asyncio.create_task(build(10))
+    assert await basic_graph._execute_tasks([fast, slow], lock=asyncio.Lock()) == []
+    assert fast.done() and not fast.cancelled()
+    assert slow.cancelled()
+
+    # A cancelled run fails
+    basic_graph.cancellation = CancellationToken()
+    slow = asyncio.create_task(build(10))
+    basic_graph.cancellation.track(slow)
+    asyncio.get_running_loop().call_later(0.01, basic_graph.cancellation.cancel, "The client disconnected")
+    with pytest.raises(RunCancelledException, match="The client disconnected"):
+        await basic_graph._execute_tasks([slow], lock=asyncio.Lock())
+    assert slow.cancelled()
+
+
+@pytest.mark.asyncio
+async def test_profile_records_wait_and_build_times(basic_graph):
+    async def build_vertex(chat_service, vertex_id, **kwargs):
+        vertex = basic_graph.get_vertex(vertex_id)
+        await asyncio.sleep(0.01)
+        return None, None, None, None, vertex
+
+    basic_graph.profile = RunProfile()
+    first_layer = basic_graph.sort_vertices()
+    await basic_graph._process(first_layer, None, asyncio.Lock(), False, build_vertex)
+
+    builds = basic_graph.profile.to_list()
+    assert {build["vertex_id"] for build in builds} == {"dndnode_81", "dndnode_82", "dndnode_83"}
+    for build in builds:
+        assert build["execute"] >= 0.01
+        assert build["ready"] <= build["started"] <= build["finished"]
+
+
+@pytest.mark.asyncio
+async def test_cache_locks_are_dropped_once_released():
+    from langflow.services.chat.service import CacheLocks
+
+    locks = CacheLocks()
+    lock = locks["flow:run"]
+    async with lock:
+        assert locks["flow:run"] is lock
+        assert len(locks) == 1
+    del lock
+    gc.collect()
+    assert len(locks) == 0
@@ -0,0 +1,88 @@
+import pickle
+import threading
+from concurrent.futures import ThreadPoolExecutor
+from functools import partial
+
+import pytest
+
+from langflow.base.data.ingestion import DataStream, add_documents_in_batches, bounded_map, iter_inputs
+from langflow.base.data.utils import iter_load_data
+from langflow.graph.utils import serialize_field
+from langflow.schema import Data
+
+
+def test_bounded_map_keeps_order_and_reads_ahead_by_at_most_max_in_flight():
+    pulled = []
+
+    def source():
+        for index in range(10):
+            pulled.append(index)
+            yield index
+
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        results = bounded_map(lambda item: item * 2, source(), executor.submit, max_in_flight=3)
+        assert next(results) == 0
+        assert pulled == [0, 1, 2]
+        assert list(results) == [index * 2 for index in range(1, 10)]
+
+
+def test_data_stream_is_never_iterated_to_be_shown():
+    calls = []
+
+    def source():
+        calls.append(threading.get_ident())
+        return iter([Data(text="a"), Data(text="b")])
+
+    stream = DataStream(source, "Test stream")
+    assert repr(stream) == "Test stream"
+    assert serialize_field({"stream": stream}) == {"stream": {"result": "Test stream"}}
+    with pytest.raises(TypeError):
+        iter(stream)
+    assert calls == []
+    assert [item.text for item in iter_inputs([stream, Data(text="c")])] == ["a", "b", "c"]
+    assert len(calls) == 1
+
+
+def test_data_stream_feeds_every_consumer_from_the_start():
+    stream = DataStream(partial(iter, [Data(text="a"), Data(text="b")]), "Test stream")
+    # Two components reading the same stream at once, e.g. a vector store and a second splitter
+    first, second = iter_inputs(stream), iter_inputs(stream)
+    assert next(first).text == "a"
+    assert [item.text for item in second] == ["a", "b"]
+    assert [item.text for item in first] == ["b"]
+
+    # A stream built by a splitter reads the stream it splits again too
+    split = DataStream(partial(iter_inputs, [stream, Data(text="c")]), "Split stream")
+    assert [item.text for item in iter_inputs(split)] == ["a", "b", "c"]
+    assert [item.text for item in iter_inputs(split)] == ["a", "b", "c"]
+    assert stream.reads == 4
+
+
+def test_data_stream_can_be_read_again_after_it_is_pickled(tmp_path):
+    path = tmp_path / "file.txt"
+    path.write_text("content")
+    stream = DataStream(partial(iter_load_data, [str(path)], True, 1), "Test stream")
+    assert [data.data["text"] for data in iter_inputs(stream)] == ["content"]
+    # A graph restored from the cache, or by a worker, hands the stream to its next run
+    restored = pickle.loads(pickle.dumps(stream))
+    assert [data.data["text"] for data in iter_inputs(restored)] == ["content"]
+    assert [data.data["text"] for data in iter_inputs(restored)] == ["content"]
+
+
+def test_iter_load_data_skips_failed_files(tmp_path):
+    paths = []
+    for index in range(5):
+        path = tmp_path / f"file_{index}.txt"
+        path.write_text(f"content {index}")
+        paths.append(str(path))
+    paths.insert(2, str(tmp_path / "missing.txt"))
+
+    loaded = list(iter_load_data(paths, silent_errors=True, max_concurrency=2))
+    assert [data.data["text"] for data in loaded] == [f"content {index}" for index in range(5)]
+
+
+def test_add_documents_in_batches():
+    batches = []
+    count = add_documents_in_batches(batches.append, iter(range(10)), batch_size=4)
+    assert count == 10
+    assert [len(batch) for batch in batches] == [4, 4, 2]
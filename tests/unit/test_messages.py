@@ -1,6 +1,13 @@
 import pytest
 
-from langflow.memory import add_messages, add_messagetables, delete_messages, get_messages, store_message
+from langflow.memory import (
+    add_messages,
+    add_messagetables,
+    delete_messages,
+    get_messages,
+    get_messages_since,
+    store_message,
+)
 from langflow.schema.message import Message
 
 # Assuming you have these imports available
@@ -74,3 +81,56 @@ def test_store_message():
     stored_messages = store_message(message)
     assert len(stored_messages) == 1
     assert stored_messages[0].text == "Stored message"
+
+
+def test_message_window_answers_latest_messages():
+    from langflow.services.chat.message_window import MessageWindows
+
+    windows = MessageWindows(size=3)
+    messages = [Message(text=f"Message {index}", sender="User", sender_name="User") for index in range(3)]
+    windows.load("session", messages[:2], complete=True)
+    windows.append("session", [messages[2]])
+    assert windows.get("session") == (messages, True)
+
+    # Once the oldest message leaves the window it no longer holds the whole session
+    windows.append("session", [Message(text="Message 3", sender="User", sender_name="User")])
+    window_messages, complete = windows.get("session")
+    assert [message.text for message in window_messages] == ["Message 1", "Message 2", "Message 3"]
+    assert not complete
+    windows.append("unknown", messages)
+    assert windows.get("unknown") is None
+
+
+def test_get_messages_reads_from_window():
+    session_id = "window_session_id"
+    add_messages([Message(text="First", sender="User", sender_name="User", session_id=session_id)])
+    # The first read loads the window of the session, the messages added afterwards are appended to it
+    assert [message.text for message in get_messages(session_id=session_id)] == ["First"]
+    add_messages([Message(text="Second", sender="Machine", sender_name="AI", session_id=session_id)])
+    messages = get_messages(session_id=session_id, order="ASC")
+    assert [message.text for message in messages] == ["First", "Second"]
+
+    new_messages, cursor = get_messages_since(session_id, cursor=str(messages[0].data["id"]))
+    assert [message.text for message in new_messages] == ["Second"]
+    assert cursor == str(messages[1].data["id"])
+
+    delete_messages(session_id)
+    assert get_messages(session_id=session_id) == []
+
+
+def test_in_process_message_windows_are_opt_in(monkeypatch):
+    from langflow.services.chat import message_window
+    from langflow.services.deps import get_settings_service
+
+    # The tests run with the in-memory cache, where each worker would keep its own windows
+    monkeypatch.setattr(message_window, "_windows", {})
+    assert message_window.get_message_windows() is None
+
+    monkeypatch.setattr(get_settings_service().settings, "message_window_in_memory", True)
+    monkeypatch.setattr(message_window, "_windows", {})
+    windows = message_window.get_message_windows()
+    assert isinstance(windows, message_window.MessageWindows)
+
+    windows.load("invalidated_session", [Message(text="Old", sender="User", sender_name="User")], complete=True)
+    message_window.invalidate_message_windows(["invalidated_session"])
+    assert windows.get("invalidated_session") is None
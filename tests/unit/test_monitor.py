@@ -0,0 +1,116 @@
+from types import SimpleNamespace
+
+import duckdb
+
+from langflow.services.monitor import metrics
+from langflow.services.monitor.writer import BatchWriter
+
+
+def test_batch_writer_flushes_in_batches():
+    batches = []
+    writer = BatchWriter(batches.append, batch_size=2, flush_interval=60)
+    for index in range(3):
+        assert writer.put("transactions", index)
+    writer.put("messages", "message")
+    # Nothing is written until the batch is full, the interval passes or the writer is flushed
+    assert batches == []
+    writer.flush()
+    assert batches == [{"transactions": [0, 1, 2], "messages": ["message"]}]
+    assert writer.get_stats() == {"queued": 0, "written": 4, "dropped": 0}
+
+
+def test_batch_writer_overflow_policies():
+    batches = []
+    writer = BatchWriter(batches.append, max_queue_size=2, overflow_policy="drop_newest")
+    assert writer.put("transactions", 1)
+    assert writer.put("transactions", 2)
+    assert not writer.put("transactions", 3)
+    writer.flush()
+    assert batches[-1] == {"transactions": [1, 2]}
+
+    writer = BatchWriter(batches.append, max_queue_size=2, overflow_policy="drop_oldest")
+    for value in [1, 2, 3]:
+        assert writer.put("transactions", value)
+    writer.flush()
+    assert batches[-1] == {"transactions": [2, 3]}
+    assert writer.dropped == 1
+
+
+def test_batch_writer_thread_writes_on_interval():
+    batches = []
+    writer = BatchWriter(batches.append, batch_size=100, flush_interval=0.05)
+    writer.start()
+    try:
+        writer.put("transactions", 1)
+        writer._stopped.wait(0.5)
+        assert batches == [{"transactions": [1]}]
+    finally:
+        writer.stop()
+
+
+def test_monitor_service_does_not_hold_the_database_open(tmp_path, monkeypatch):
+    from langflow.services.monitor import service as monitor_service_module
+
+    monkeypatch.setattr(monitor_service_module, "user_cache_dir", lambda _: str(tmp_path))
+    settings = SimpleNamespace(
+        monitor_batch_writes=True,
+        monitor_batch_size=100,
+        monitor_flush_interval=60.0,
+        monitor_queue_size=100,
+        monitor_overflow_policy="drop_oldest",
+    )
+    monitor_service = monitor_service_module.MonitorService(SimpleNamespace(settings=settings))
+    try:
+        row = {"vertex_id": "vertex", "inputs": {"input_value": "hello"}, "status": "success", "flow_id": "flow"}
+        monitor_service.add_row("transactions", row)
+        assert len(monitor_service.get_transactions()) == 1
+        # Another worker, or another configuration, can open the file between two operations
+        with duckdb.connect(str(monitor_service.db_path), read_only=True) as conn:
+            assert conn.execute("SELECT count(*) FROM transactions").fetchone() == (1,)
+    finally:
+        monitor_service.teardown()
+
+
+def test_instrumented_redis_client_keeps_its_protocols(monkeypatch):
+    observed = []
+
+    class Histogram:
+        def labels(self, command):
+            return SimpleNamespace(observe=lambda seconds: observed.append(command))
+
+    class Pipeline:
+        def __init__(self):
+            self.commands = []
+
+        def __enter__(self):
+            return self
+
+        def __exit__(self, *exc_info):
+            return False
+
+        def set(self, *args):
+            self.commands.append(("SET", *args))
+            return self
+
+        def execute(self):
+            return [True for _ in self.commands]
+
+    class Client:
+        def execute_command(self, *args, **options):
+            return args
+
+        def get(self, key):
+            return self.execute_command("GET", key)
+
+        def pipeline(self, transaction=True):
+            return Pipeline()
+
+    monkeypatch.setattr(metrics, "get_metrics", lambda: SimpleNamespace(redis_command_seconds=Histogram()))
+    client = Client()
+    assert metrics.instrument_redis_client(client) is client
+    assert client.get("key") == ("GET", "key")
+    with client.pipeline() as pipe:
+        pipe.set("a", 1).set("b", 2)
+        assert pipe.execute() == [True, True]
+    # The commands are timed when they are sent, those of a pipeline once for the whole pipeline
+    assert observed == ["GET", "PIPELINE"]
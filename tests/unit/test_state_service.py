@@ -0,0 +1,118 @@
+import asyncio
+import fnmatch
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from langflow.services.state.service import InMemoryStateService, RedisStateService
+
+
+def test_append_and_update_state_per_run():
+    state_service = InMemoryStateService(None, num_shards=4)
+    state_service.update_state("messages", "first", run_id="run-1")
+    state_service.append_state("messages", "second", run_id="run-1")
+    state_service.append_state("messages", "other", run_id="run-2")
+
+    assert state_service.get_state("messages", run_id="run-1") == ["first", "second"]
+    assert state_service.get_state("messages", run_id="run-2") == ["other"]
+    assert state_service.get_state("missing", run_id="run-1") == ""
+
+
+def test_concurrent_appends_are_not_lost():
+    state_service = InMemoryStateService(None, num_shards=4)
+    runs = [f"run-{index}" for index in range(8)]
+
+    def append(index: int):
+        state_service.append_state("numbers", index, run_id=runs[index % len(runs)])
+
+    with ThreadPoolExecutor(max_workers=8) as executor:
+        list(executor.map(append, range(800)))
+    assert sum(len(state_service.get_state("numbers", run_id=run_id)) for run_id in runs) == 800
+
+
+def test_observers_can_update_the_state_they_are_notified_of():
+    state_service = InMemoryStateService(None)
+    notified = []
+
+    def observer(key, new_state, append, caller):
+        notified.append((key, new_state, append))
+        if new_state == "ping":
+            # The lock of the run is not held while the observers are called
+            state_service.update_state(key, "pong", run_id="run")
+
+    state_service.subscribe("run", observer)
+    state_service.update_state("status", "ping", run_id="run")
+
+    assert notified == [("status", "ping", False), ("status", "pong", False)]
+    assert state_service.get_state("status", run_id="run") == "pong"
+
+
+class FakeRedis:
+    """The commands of redis-py the state service uses, against a dict shared by the clients of a server."""
+
+    def __init__(self, server: dict):
+        self.server = server
+
+    def ping(self):
+        return True
+
+    def get(self, key):
+        return self.server["data"].get(key)
+
+    def set(self, key, value, ex=None):
+        self.server["data"][key] = value
+
+    def multi(self):
+        pass
+
+    def transaction(self, func, *keys):
+        func(self)
+
+    def publish(self, channel, message):
+        for pattern, handler in self.server["subscribers"]:
+            if fnmatch.fnmatch(channel, pattern):
+                # Delivered on another thread, as the listener thread of redis-py does
+                thread = threading.Thread(target=handler, args=({"data": message},))
+                thread.start()
+                thread.join()
+
+    def pubsub(self, ignore_subscribe_messages=False):
+        return self
+
+    def psubscribe(self, **patterns):
+        self.server["subscribers"].extend(patterns.items())
+
+    def run_in_thread(self, sleep_time=0, daemon=False):
+        return self
+
+    def stop(self):
+        pass
+
+
+@pytest.mark.asyncio
+async def test_redis_state_changes_reach_the_observers_of_the_run_in_other_workers(monkeypatch):
+    import redis
+
+    server: dict = {"data": {}, "subscribers": []}
+    monkeypatch.setattr(redis, "StrictRedis", lambda **kwargs: FakeRedis(server))
+    worker_a = RedisStateService(None)
+    worker_b = RedisStateService(None)
+
+    loop = asyncio.get_running_loop()
+    notified_a, notified_b, other_run = [], [], []
+    worker_a.subscribe("run", lambda *args, **kwargs: notified_a.append((args, kwargs)))
+    worker_b.subscribe(
+        "run", lambda *args, **kwargs: notified_b.append((args, kwargs, asyncio.get_running_loop() is loop))
+    )
+    worker_b.subscribe("other-run", lambda *args, **kwargs: other_run.append(args))
+
+    worker_a.update_state("status", "done", run_id="run", caller="vertex-1")
+    await asyncio.sleep(0)
+
+    assert worker_b.get_state("status", run_id="run") == "done"
+    # Each worker notifies its observers of the run once, the one that made the change included
+    assert notified_a == [(("status", "done"), {"append": False, "caller": "vertex-1"})]
+    # The other worker calls them in the loop they subscribed from
+    assert notified_b == [(("status", "done"), {"append": False, "caller": "vertex-1"}, True)]
+    assert other_run == []
@@ -0,0 +1,49 @@
+import asyncio
+
+import pytest
+
+from langflow.graph.graph.token_channel import TokenChannel, TokenChannelClosedError
+
+
+@pytest.mark.asyncio
+async def test_token_channel_applies_backpressure():
+    channel = TokenChannel(max_size=2)
+    sent = []
+
+    async def produce():
+        for index in range(5):
+            await channel.send("vertex", str(index))
+            sent.append(index)
+        channel.close()
+
+    producer = asyncio.create_task(produce())
+    await asyncio.sleep(0.01)
+    # The producer waits for the reader once the channel is full
+    assert sent == [0, 1]
+    chunks = [chunk async for _, chunk in channel]
+    await producer
+    assert chunks == ["0", "1", "2", "3", "4"]
+
+
+@pytest.mark.asyncio
+async def test_token_channel_is_read_to_the_end_after_close():
+    channel = TokenChannel()
+    await channel.send("vertex", "hello")
+    channel.close()
+    assert [item async for item in channel] == [("vertex", "hello")]
+
+
+@pytest.mark.asyncio
+async def test_token_channel_refuses_chunks_once_closed():
+    channel = TokenChannel(max_size=1)
+    await channel.send("vertex", "hello")
+    # A sender waiting for room fails as soon as the channel is closed
+    blocked = asyncio.create_task(channel.send("vertex", "world"))
+    await asyncio.sleep(0.01)
+    assert not blocked.done()
+    channel.close()
+    with pytest.raises(TokenChannelClosedError):
+        await blocked
+    with pytest.raises(TokenChannelClosedError):
+        await channel.send("vertex", "again")
+    assert [item async for item in channel] == [("vertex", "hello")]
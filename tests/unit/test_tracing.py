@@ -0,0 +1,83 @@
+from types import SimpleNamespace
+
+import pytest
+
+from langflow.services.tracing.base import BaseTracer
+from langflow.services.tracing.service import TracingService
+
+
+class RecordingTracer(BaseTracer):
+    def __init__(self, trace_name=None, trace_type="chain", project_name=None, trace_id=None):
+        self.events = []
+        self.flushes = 0
+
+    @property
+    def ready(self):
+        return True
+
+    def add_trace(self, trace_name, trace_type, inputs, metadata=None, start_time=None):
+        self.events.append(("add_trace", trace_name))
+
+    def end_trace(self, trace_name, outputs=None, error=None, end_time=None):
+        self.events.append(("end_trace", trace_name))
+
+    def add_log(self, trace_name, log, time=None):
+        self.events.append(("add_log", trace_name))
+
+    def flush(self):
+        self.flushes += 1
+
+    def end(self, inputs, outputs, error=None, metadata=None, end_time=None):
+        self.events.append(("end", None))
+
+
+def make_service(**settings) -> TracingService:
+    values = {"tracing_queue_size": 100, "tracing_batch_size": 10, "tracing_flush_interval": 60}
+    values |= settings
+    return TracingService(SimpleNamespace(settings=SimpleNamespace(**values)), None)
+
+
+@pytest.mark.asyncio
+async def test_tracing_exports_in_batches():
+    service = make_service()
+    tracer = RecordingTracer()
+    service._tracers["test"] = tracer
+    await service.start()
+
+    async with service.trace_context("component", "chain", {"input": 1}):
+        service.add_log("component", {"name": "log", "message": "hello", "type": "text"})
+    # Nothing is sent on the run path
+    assert tracer.events == []
+
+    await service.end({})
+    await service.stop()
+    assert tracer.events == [
+        ("add_trace", "component"),
+        ("add_log", "component"),
+        ("end_trace", "component"),
+        ("end", None),
+    ]
+    assert tracer.flushes == 1
+
+
+@pytest.mark.asyncio
+async def test_tracing_drops_traces_when_full():
+    service = make_service(tracing_queue_size=2)
+    tracer = RecordingTracer()
+    service._tracers["test"] = tracer
+
+    service._start_traces("first", "chain", {})
+    service._start_traces("second", "chain", {})
+    # The buffer is full: the third trace and everything about it is dropped
+    service._start_traces("third", "chain", {})
+    service.add_log("third", {"name": "log", "message": "dropped", "type": "text"})
+    service._end_traces("third")
+    service._end_traces("first")
+    await service.end({})
+    await service.flush()
+
+    assert ("add_trace", "third") not in tracer.events
+    assert ("add_log", "third") not in tracer.events
+    assert ("end_trace", "third") not in tracer.events
+    assert tracer.events[-2:] == [("end_trace", "first"), ("end", None)]
+    assert service.dropped_events == 3
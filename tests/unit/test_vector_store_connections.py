@@ -0,0 +1,68 @@
+import gc
+
+from langflow.base.vectorstores.connections import ConnectionRegistry, build_connection_key
+
+
+def test_connection_key_normalizes_params():
+    assert build_connection_key("qdrant", {"url": " http://q ", "api_key": None}) == build_connection_key(
+        "qdrant", {"url": "http://q", "api_key": ""}
+    )
+    assert build_connection_key("qdrant", {"url": "http://q"}) != build_connection_key("weaviate", {"url": "http://q"})
+    assert "secret" not in build_connection_key("qdrant", {"api_key": "secret"})
+
+
+def test_registry_reuses_checks_and_evicts():
+    registry = ConnectionRegistry(max_idle=60, health_check_interval=0)
+    created, closed = [], []
+
+    def factory():
+        created.append(object())
+        return created[-1]
+
+    healthy = {"value": True}
+    borrow = lambda: registry.borrow(  # noqa: E731
+        "store", {"url": "a"}, factory, health_check=lambda _: healthy["value"], close=closed.append
+    )
+    first = borrow()
+    assert borrow() is first
+    assert len(created) == 1
+
+    # A client that fails its health check is replaced
+    healthy["value"] = False
+    second = borrow()
+    assert second is not first and closed == [first]
+
+    # Idle clients are closed
+    registry.max_idle = -1
+    registry.evict_idle()
+    assert len(registry) == 0 and closed == [first, second]
+
+
+def test_registry_only_closes_clients_without_holders():
+    registry = ConnectionRegistry(max_idle=60, health_check_interval=0, max_size=1)
+    closed = []
+
+    class Owner:
+        pass
+
+    owner = Owner()
+    first = registry.borrow(
+        "store", {"url": "a"}, object, health_check=lambda _: True, close=closed.append, owner=owner
+    )
+
+    # The held client is not the one evicted when there are too many
+    other = registry.borrow("store", {"url": "b"}, object, close=closed.append)
+    registry.borrow("store", {"url": "c"}, object, close=closed.append)
+    assert closed == [other]
+
+    # Nor is it closed when idle
+    registry.max_idle = -1
+    registry.evict_idle()
+    assert len(registry) == 1 and len(closed) == 2
+
+    # A held client that fails its health check is replaced, and closed once its holder is gone
+    second = registry.borrow("store", {"url": "a"}, object, health_check=lambda _: False, close=closed.append)
+    assert second is not first and len(closed) == 2
+    del owner
+    gc.collect()
+    assert closed[-1] is first
@@ -0,0 +1,40 @@
+from types import SimpleNamespace
+
+from langflow.services.task.webhook_queue import claim_webhook_task, get_webhook_task_id, release_webhook_task
+
+
+class FakeRedis:
+    def __init__(self):
+        self.keys = {}
+
+    def set(self, key, value, nx=False, ex=None):
+        if nx and key in self.keys:
+            return None
+        self.keys[key] = value
+        return True
+
+    def delete(self, key):
+        self.keys.pop(key, None)
+
+
+def test_webhook_task_ids_are_idempotent():
+    assert get_webhook_task_id("flow", "key") == get_webhook_task_id("flow", "key")
+    assert get_webhook_task_id("flow", "key") != get_webhook_task_id("other flow", "key")
+    # Requests without a key are never duplicates
+    assert get_webhook_task_id("flow") != get_webhook_task_id("flow")
+
+
+def test_webhook_task_is_claimed_once():
+    celery_app = SimpleNamespace(backend=SimpleNamespace(client=FakeRedis()))
+    task_id = get_webhook_task_id("flow", "key")
+    assert claim_webhook_task(celery_app, task_id, ttl=60)
+    assert not claim_webhook_task(celery_app, task_id, ttl=60)
+
+
+def test_released_webhook_task_can_be_claimed_again():
+    celery_app = SimpleNamespace(backend=SimpleNamespace(client=FakeRedis()))
+    task_id = get_webhook_task_id("flow", "key")
+    assert claim_webhook_task(celery_app, task_id, ttl=60)
+    # The broker was down, so the retried request has to be enqueued
+    release_webhook_task(celery_app, task_id)
+    assert claim_webhook_task(celery_app, task_id, ttl=60)